@@ -30,7 +30,11 @@ SOFTWARE.
 
 #include "../types.h"
 
+#include <chrono>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <set>
 
@@ -38,10 +42,127 @@ SOFTWARE.
 
 #include "../../../bricks/net/http/http.h"
 #include "../../../bricks/file/file.h"
+#include "../../../bricks/util/singleton.h"
+
+#ifndef CURRENT_HTTP_CLIENT_DEFAULT_MAX_IDLE_CONNECTIONS_PER_HOST
+#define CURRENT_HTTP_CLIENT_DEFAULT_MAX_IDLE_CONNECTIONS_PER_HOST 16
+#endif
 
 namespace current {
 namespace http {
 
+// The pool of persistent HTTP/1.1 connections, shared by all the `HTTP(...)` calls within the process.
+// A connection is returned into the pool once the response has been fully read from it, provided the server
+// has agreed to keep it open, and is then reused by the next request to the same host and port.
+// The idle connections are closed once they have not been used for `idle_connection_timeout`, and no more than
+// `max_idle_connections_per_host` of them are kept per host. Use `SetEnabled(false)` to connect afresh every time.
+// Only the idle connections are capped: the connections in use are not counted, and there is no limit on them.
+// A request which fails over a reused connection is retried once over a new one, unless its method is not safe
+// to repeat, as the server may have received and processed it before the connection was lost.
+class HTTPClientConnectionPool final {
+ public:
+  HTTPClientConnectionPool& SetEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_ = enabled;
+    if (!enabled_) {
+      idle_connections_.clear();
+    }
+    return *this;
+  }
+
+  HTTPClientConnectionPool& SetMaxIdleConnectionsPerHost(size_t max_idle_connections_per_host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_idle_connections_per_host_ = max_idle_connections_per_host;
+    return *this;
+  }
+
+  HTTPClientConnectionPool& SetIdleConnectionTimeout(std::chrono::milliseconds idle_connection_timeout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_connection_timeout_ = idle_connection_timeout;
+    return *this;
+  }
+
+  bool Enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_;
+  }
+
+  size_t IdleConnections() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t result = 0u;
+    for (const auto& host : idle_connections_) {
+      result += host.second.size();
+    }
+    return result;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_connections_.clear();
+  }
+
+  // Returns an idle connection to `host:port`, or `nullptr` if there is none.
+  std::unique_ptr<current::net::Connection> Acquire(const std::string& host, int port) {
+    std::unique_ptr<current::net::Connection> result;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto cit = idle_connections_.find(HostAndPort(host, port));
+    if (cit != idle_connections_.end()) {
+      std::deque<IdleConnection>& connections = cit->second;
+      const auto now = std::chrono::steady_clock::now();
+      // The most recently used connection is the least likely one to have been closed by the server.
+      while (!result && !connections.empty()) {
+        IdleConnection& candidate = connections.back();
+        if (now - candidate.released_at < idle_connection_timeout_ && IsStillOpen(*candidate.connection)) {
+          result = std::move(candidate.connection);
+        }
+        connections.pop_back();
+      }
+      if (connections.empty()) {
+        idle_connections_.erase(cit);
+      }
+    }
+    return result;
+  }
+
+  // Makes the connection, with the previous response fully read from it, available for the next request.
+  void Release(const std::string& host, int port, std::unique_ptr<current::net::Connection>&& connection) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (enabled_ && max_idle_connections_per_host_) {
+      std::deque<IdleConnection>& connections = idle_connections_[HostAndPort(host, port)];
+      if (connections.size() >= max_idle_connections_per_host_) {
+        connections.pop_front();
+      }
+      connections.push_back(IdleConnection{std::move(connection), std::chrono::steady_clock::now()});
+    }
+  }
+
+ private:
+  struct IdleConnection final {
+    std::unique_ptr<current::net::Connection> connection;
+    std::chrono::steady_clock::time_point released_at;
+  };
+
+  static std::string HostAndPort(const std::string& host, int port) { return host + ':' + std::to_string(port); }
+
+  // A connection which the server has closed, or has sent something unsolicited over, can not be reused.
+  static bool IsStillOpen(current::net::Connection& connection) {
+#ifndef CURRENT_WINDOWS
+    char c;
+    const auto retval = ::recv(connection.socket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return retval < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+#else
+    static_cast<void>(connection);
+    return true;
+#endif  // CURRENT_WINDOWS
+  }
+
+  mutable std::mutex mutex_;
+  bool enabled_ = true;
+  size_t max_idle_connections_per_host_ = CURRENT_HTTP_CLIENT_DEFAULT_MAX_IDLE_CONNECTIONS_PER_HOST;
+  std::chrono::milliseconds idle_connection_timeout_ = std::chrono::seconds(5);
+  std::map<std::string, std::deque<IdleConnection>> idle_connections_;
+};
+
 namespace impl {
 struct HTTPRedirectHelper : current::net::HTTPDefaultHelper {
   struct ConstructionParams {};
@@ -94,46 +215,36 @@ class GenericHTTPClientPOSIX final {
           port = 80;
         }
       }
-      current::net::Connection connection(current::net::Connection(current::net::ClientSocket(parsed_url.host, port)));
-      connection.BlockingWrite(
-          request_method_ + ' ' + parsed_url.path + parsed_url.ComposeParameters() + " HTTP/1.1\r\n", true);
-      connection.BlockingWrite("Host: " + parsed_url.host + "\r\n", true);
-      if (!request_user_agent_.empty()) {
-        connection.BlockingWrite("User-Agent: " + request_user_agent_ + "\r\n", true);
-      }
-      for (const auto& h : request_headers_) {
-        connection.BlockingWrite(h.header + ": " + h.value + "\r\n", true);
-      }
-      if (!request_headers_.cookies.empty()) {
-        connection.BlockingWrite("Cookie: " + request_headers_.CookiesAsString() + "\r\n", true);
+      // `HEAD` responses carry the `Content-Length` of the body which is not sent, so they are never pooled.
+      HTTPClientConnectionPool& pool = current::Singleton<HTTPClientConnectionPool>();
+      const bool use_pool = (request_method_ != "HEAD") && pool.Enabled();
+      std::unique_ptr<current::net::Connection> connection;
+      if (use_pool) {
+        connection = pool.Acquire(parsed_url.host, port);
       }
-      if (!request_body_content_type_.empty()) {
-        connection.BlockingWrite("Content-Type: " + request_body_content_type_ + "\r\n", true);
-      }
-      if (!request_body_contents_.empty() || current::net::NeedContentLengthHeader(request_method_)) {
-        // NOTE(dkorolev): The `try/catch/throw` combo here is a hack for the unit test for HTTP 413 to pass.
-        // It swallows the `SocketWriteException` exception for huge payloads, as Current's HTTP server logic
-        // does intentionally close the HTTP connection prematurely if `Content-Length` exceeds a reasonable limit.
+      bool connection_reused = static_cast<bool>(connection);
+      while (true) {
+        if (!connection) {
+          connection = std::make_unique<current::net::Connection>(current::net::ClientSocket(parsed_url.host, port));
+        }
         try {
-#ifndef CURRENT_WINDOWS
-          connection.BlockingWrite("Content-Length: " + std::to_string(request_body_contents_.length()) + "\r\n", true);
-          connection.BlockingWrite("\r\n", true);
-          connection.BlockingWrite(request_body_contents_, false);
-#else
-          // TODO(grixa): this fix for the PayloadTooLarge test on Windows is temporary, need to revisit it.
-          connection.BlockingWrite("Content-Length: " + std::to_string(request_body_contents_.length()) + "\r\n\r\n" +
-                                       request_body_contents_,
-                                   false);
-#endif
-        } catch (const net::SocketWriteException&) {
-          if (request_body_contents_.length() <= net::constants::kMaxHTTPPayloadSizeInBytes) {
+          SendRequest(*connection, parsed_url, use_pool);
+          http_request_.reset(new CustomHTTPRequestData(*connection, request_data_construction_params_));
+          break;
+        } catch (const current::net::SocketException&) {
+          if (!connection_reused || !IsSafeToRetry(request_method_)) {
             throw;
           }
+          // Most likely, the server has closed the idle connection before it has received the request.
+          // The method is safe, so, even if the server did process the request, retry once, afresh.
+          connection_reused = false;
+          connection = nullptr;
         }
-      } else {
-        connection.BlockingWrite("\r\n", false);
       }
-      http_request_.reset(new CustomHTTPRequestData(connection, request_data_construction_params_));
+      if (use_pool && http_request_->KeepAliveRequested() && http_request_->HasContentLength() &&
+          !http_request_->ReceivedBytesBeyondThisMessage()) {
+        pool.Release(parsed_url.host, port, std::move(connection));
+      }
       // TODO(dkorolev): Rename `Path()`, it's only called so now because of HTTP request/response format.
       // Elaboration:
       // HTTP request  message is: `GET /path HTTP/1.1`, "/path" is the second component of it.
@@ -158,6 +269,56 @@ class GenericHTTPClientPOSIX final {
 
   const CustomHTTPRequestData& HTTPRequest() const { return *http_request_.get(); }
 
+ private:
+  // The methods which do not change the state of the server, and thus can be sent again if their response is lost.
+  static bool IsSafeToRetry(const std::string& method) {
+    return method == "GET" || method == "HEAD" || method == "OPTIONS" || method == "TRACE";
+  }
+
+  void SendRequest(current::net::Connection& connection, const URL& parsed_url, bool keep_alive) {
+    connection.BlockingWrite(
+        request_method_ + ' ' + parsed_url.path + parsed_url.ComposeParameters() + " HTTP/1.1\r\n", true);
+    connection.BlockingWrite("Host: " + parsed_url.host + "\r\n", true);
+    if (!keep_alive) {
+      connection.BlockingWrite("Connection: close\r\n", true);
+    }
+    if (!request_user_agent_.empty()) {
+      connection.BlockingWrite("User-Agent: " + request_user_agent_ + "\r\n", true);
+    }
+    for (const auto& h : request_headers_) {
+      connection.BlockingWrite(h.header + ": " + h.value + "\r\n", true);
+    }
+    if (!request_headers_.cookies.empty()) {
+      connection.BlockingWrite("Cookie: " + request_headers_.CookiesAsString() + "\r\n", true);
+    }
+    if (!request_body_content_type_.empty()) {
+      connection.BlockingWrite("Content-Type: " + request_body_content_type_ + "\r\n", true);
+    }
+    if (!request_body_contents_.empty() || current::net::NeedContentLengthHeader(request_method_)) {
+      // NOTE(dkorolev): The `try/catch/throw` combo here is a hack for the unit test for HTTP 413 to pass.
+      // It swallows the `SocketWriteException` exception for huge payloads, as Current's HTTP server logic
+      // does intentionally close the HTTP connection prematurely if `Content-Length` exceeds a reasonable limit.
+      try {
+#ifndef CURRENT_WINDOWS
+        connection.BlockingWrite("Content-Length: " + std::to_string(request_body_contents_.length()) + "\r\n", true);
+        connection.BlockingWrite("\r\n", true);
+        connection.BlockingWrite(request_body_contents_, false);
+#else
+        // TODO(grixa): this fix for the PayloadTooLarge test on Windows is temporary, need to revisit it.
+        connection.BlockingWrite("Content-Length: " + std::to_string(request_body_contents_.length()) + "\r\n\r\n" +
+                                     request_body_contents_,
+                                 false);
+#endif
+      } catch (const net::SocketWriteException&) {
+        if (request_body_contents_.length() <= net::constants::kMaxHTTPPayloadSizeInBytes) {
+          throw;
+        }
+      }
+    } else {
+      connection.BlockingWrite("\r\n", false);
+    }
+  }
+
  public:
   // Request parameters.
   std::string request_method_ = "";
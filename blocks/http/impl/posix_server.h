@@ -25,16 +25,34 @@ SOFTWARE.
 #ifndef BLOCKS_HTTP_IMPL_POSIX_SERVER_H
 #define BLOCKS_HTTP_IMPL_POSIX_SERVER_H
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 #include <iostream>  // TODO(dkorolev): More robust logging here.
 
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef CURRENT_POSIX
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif  // CURRENT_POSIX
+
 #include "../types.h"
 #include "../request.h"
 
+#include "server_metrics.h"
+
 #include "../../url/url.h"
 
 #include "../../../typesystem/optional.h"
@@ -45,6 +63,8 @@ SOFTWARE.
 #include "../../../bricks/sync/owned_borrowed.h"
 #include "../../../bricks/time/chrono.h"
 #include "../../../bricks/util/accumulative_scoped_deleter.h"
+#include "../../../bricks/util/make_scope_guard.h"
+#include "../../../bricks/util/sha256.h"
 
 namespace current {
 namespace http {
@@ -97,30 +117,76 @@ struct ServeStaticFilesFromOptions {
   // Names of files to serve if a directory URL is requested, in the priority order (first found will be served).
   std::vector<std::string> index_filenames;
 
+  // Whether to send the files from disk via `sendfile()` on each request, instead of keeping them in memory.
+  // The files are then expected to not change while being served.
+  bool serve_from_disk;
+
   explicit ServeStaticFilesFromOptions(std::string route_prefix_in = "/",
                                        std::string public_url_prefix_in = "",
-                                       std::vector<std::string> index_filenames_in = {"index.html", "index.htm"})
+                                       std::vector<std::string> index_filenames_in = {"index.html", "index.htm"},
+                                       bool serve_from_disk_in = false)
       : route_prefix(std::move(route_prefix_in)),
         public_url_prefix(public_url_prefix_in.empty() ? route_prefix : std::move(public_url_prefix_in)),
-        index_filenames(std::move(index_filenames_in)) {}
+        index_filenames(std::move(index_filenames_in)),
+        serve_from_disk(serve_from_disk_in) {}
 };
 
 // Helper to serve a static file.
+// The responses carry the SHA256-based `ETag`, and, for the files from disk, the `Last-Modified` header.
+// Conditional GETs are answered with "304 Not Modified", and single-range `Range` requests are supported.
+// If the pre-gzipped sibling of the file, `*.gz`, is provided, it is served to the clients that accept gzip.
 // TODO(dkorolev): Expose it externally under a better name, and add a comment/example.
 struct StaticFileServer {
-  std::string content;
+  // A representation of the file to serve: either the file itself, or its pre-gzipped sibling.
+  struct Representation final {
+    std::string content;   // The content, unless it is sent from disk.
+    std::string pathname;  // The file to send the content from, if it is sent from disk.
+    uint64_t size;
+    std::string etag;
+
+    explicit Representation(std::string content_in)
+        : content(std::move(content_in)), size(content.size()), etag('"' + SHA256(content) + '"') {}
+
+    static std::shared_ptr<const Representation> FromFile(const std::string& pathname, bool serve_from_disk) {
+      auto result = std::make_shared<Representation>(current::FileSystem::ReadFileAsString(pathname));
+      if (serve_from_disk) {
+        result->pathname = pathname;
+        std::string().swap(result->content);
+      }
+      return result;
+    }
+  };
+
+  std::shared_ptr<const Representation> identity;
+  std::shared_ptr<const Representation> gzipped;  // Null if there is no pre-gzipped sibling.
+  std::chrono::microseconds last_modified;        // Zero if unknown.
   std::string content_type;
   bool serves_directory;
   std::string trailing_slash_redirect_url;
 
-  StaticFileServer(std::string content,
+  StaticFileServer(std::shared_ptr<const Representation> identity,
+                   std::shared_ptr<const Representation> gzipped,
+                   std::chrono::microseconds last_modified,
                    std::string content_type,
                    bool serves_directory,
                    std::string trailing_slash_redirect_url = "")
-      : content(std::move(content)),
-        content_type(content_type),
+      : identity(std::move(identity)),
+        gzipped(std::move(gzipped)),
+        last_modified(last_modified),
+        content_type(std::move(content_type)),
         serves_directory(serves_directory),
-        trailing_slash_redirect_url(trailing_slash_redirect_url) {}
+        trailing_slash_redirect_url(std::move(trailing_slash_redirect_url)) {}
+
+  StaticFileServer(std::string content,
+                   std::string content_type,
+                   bool serves_directory,
+                   std::string trailing_slash_redirect_url = "")
+      : StaticFileServer(std::make_shared<const Representation>(std::move(content)),
+                         nullptr,
+                         std::chrono::microseconds(0),
+                         std::move(content_type),
+                         serves_directory,
+                         std::move(trailing_slash_redirect_url)) {}
 
   void operator()(Request r) {
     if (r.method == "GET") {
@@ -129,7 +195,7 @@ struct StaticFileServer {
         // (`static` is a directory, not a file).
         // 2) Respond with the content if we're serving a file and don't have a trailing slash. Example:
         // `/static/index.html`, `/static/file.png`.
-        r.connection.SendHTTPResponse(content, HTTPResponseCode.OK, net::http::Headers(), content_type);
+        ServeContent(r);
       } else if (!serves_directory && r.url_path_had_trailing_slash) {
         // Respond with HTTP 404 Not Found if we're serving a file and have a trailing slash. Example:
         // `/static/index.html/`.
@@ -154,22 +220,221 @@ struct StaticFileServer {
                                     current::net::constants::kDefaultHTMLContentType);
     }
   }
+
+ private:
+  enum class RangeRequest { WholeContent, Satisfiable, NotSatisfiable };
+
+  void ServeContent(Request& r) const {
+    const bool send_gzipped = gzipped && AcceptsGzip(r.headers.GetOrDefault("Accept-Encoding", ""));
+    const Representation& representation = send_gzipped ? *gzipped : *identity;
+
+    current::net::http::Headers headers({{"ETag", representation.etag}, {"Accept-Ranges", "bytes"}});
+    if (last_modified.count()) {
+      headers.Set("Last-Modified", FormatDateTimeAsIMFFix(last_modified));
+    }
+    if (gzipped) {
+      headers.Set("Vary", "Accept-Encoding");
+    }
+    if (send_gzipped) {
+      headers.Set("Content-Encoding", "gzip");
+    }
+
+    if (IsNotModified(r.headers, representation)) {
+      r.connection.SendHTTPResponse("", HTTPResponseCode.NotModified, headers, content_type);
+      return;
+    }
+
+    uint64_t begin = 0u;
+    uint64_t end = representation.size;
+    current::net::HTTPResponseCodeValue code = HTTPResponseCode.OK;
+    if (r.headers.Has("Range") && IfRangeMatches(r.headers, representation)) {
+      const RangeRequest range = ParseRange(r.headers.Get("Range"), representation.size, begin, end);
+      if (range == RangeRequest::NotSatisfiable) {
+        headers.Set("Content-Range", "bytes */" + current::ToString(representation.size));
+        r.connection.SendHTTPResponse("", HTTPResponseCode.RequestedRangeNotSatisfiable, headers, content_type);
+        return;
+      } else if (range == RangeRequest::Satisfiable) {
+        code = HTTPResponseCode.PartialContent;
+        headers.Set("Content-Range",
+                    "bytes " + current::ToString(begin) + '-' + current::ToString(end - 1u) + '/' +
+                        current::ToString(representation.size));
+      }
+    }
+
+    if (representation.pathname.empty()) {
+      const auto content_begin = representation.content.begin() + static_cast<std::ptrdiff_t>(begin);
+      const auto content_end = representation.content.begin() + static_cast<std::ptrdiff_t>(end);
+      r.connection.SendHTTPResponse(content_begin, content_end, code, headers, content_type);
+    } else {
+      const int fd = ::open(representation.pathname.c_str(), O_RDONLY);
+      if (fd < 0) {
+        // LCOV_EXCL_START
+        r.connection.SendHTTPResponse(current::net::DefaultNotFoundMessage(),
+                                      HTTPResponseCode.NotFound,
+                                      current::net::http::Headers(),
+                                      current::net::constants::kDefaultHTMLContentType);
+        return;
+        // LCOV_EXCL_STOP
+      }
+      const auto file_closer = current::MakeScopeGuard([fd]() { ::close(fd); });
+      r.connection.SendHTTPResponse(current::net::HTTPFileBody{fd, begin, end - begin}, code, headers, content_type);
+    }
+  }
+
+  // Whether `Accept-Encoding` lists `gzip`, or `*`, with a non-zero quality.
+  static bool AcceptsGzip(const std::string& accept_encoding) {
+    for (const std::string& coding : current::strings::Split(accept_encoding, ',')) {
+      const size_t semicolon = coding.find(';');
+      const std::string name = current::strings::ToLower(current::strings::Trim(coding.substr(0u, semicolon)));
+      if (name == "gzip" || name == "x-gzip" || name == "*") {
+        const size_t q = (semicolon == std::string::npos) ? std::string::npos : coding.find("q=", semicolon);
+        return q == std::string::npos || std::atof(coding.c_str() + q + 2u) > 0;
+      }
+    }
+    return false;
+  }
+
+  bool IsNotModified(const current::net::http::Headers& request_headers, const Representation& representation) const {
+    if (request_headers.Has("If-None-Match")) {
+      // The weak comparison, as required for `If-None-Match`: the "W/" prefix is ignored.
+      for (const std::string& etag : current::strings::Split(request_headers.Get("If-None-Match"), ',')) {
+        const std::string trimmed = current::strings::Trim(etag);
+        if (trimmed == "*" || trimmed == representation.etag ||
+            (trimmed.compare(0u, 2u, "W/") == 0 && trimmed.substr(2u) == representation.etag)) {
+          return true;
+        }
+      }
+      // `If-Modified-Since` is ignored if `If-None-Match` is present.
+      return false;
+    }
+    if (last_modified.count() && request_headers.Has("If-Modified-Since")) {
+      const auto since = IMFFixDateTimeStringToTimestamp(request_headers.Get("If-Modified-Since"));
+      return since.count() && last_modified <= since;
+    }
+    return false;
+  }
+
+  // `If-Range` makes the `Range` request conditional on the content being the same as the client has.
+  bool IfRangeMatches(const current::net::http::Headers& request_headers,
+                      const Representation& representation) const {
+    if (!request_headers.Has("If-Range")) {
+      return true;
+    }
+    const std::string& if_range = request_headers.Get("If-Range");
+    if (!if_range.empty() && if_range.front() == '"') {
+      return if_range == representation.etag;
+    } else {
+      return last_modified.count() && if_range == FormatDateTimeAsIMFFix(last_modified);
+    }
+  }
+
+  // Parses the single-range `Range: bytes=...` header into `[begin, end)`. Multiple and malformed ranges are
+  // ignored, as allowed by RFC 7233, in which case the whole content is sent.
+  static RangeRequest ParseRange(const std::string& range, uint64_t size, uint64_t& begin, uint64_t& end) {
+    const std::string prefix = "bytes=";
+    if (range.compare(0u, prefix.length(), prefix) != 0 || range.find(',') != std::string::npos) {
+      return RangeRequest::WholeContent;
+    }
+    const std::string spec = current::strings::Trim(range.substr(prefix.length()));
+    const size_t dash = spec.find('-');
+    if (dash == std::string::npos) {
+      return RangeRequest::WholeContent;
+    }
+    const auto IsNumber = [](const std::string& s) {
+      return !s.empty() && s.length() <= 18u && s.find_first_not_of("0123456789") == std::string::npos;
+    };
+    const std::string first = current::strings::Trim(spec.substr(0u, dash));
+    const std::string last = current::strings::Trim(spec.substr(dash + 1u));
+    if (first.empty()) {
+      // The suffix range, "bytes=-N", is the last N bytes.
+      if (!IsNumber(last)) {
+        return RangeRequest::WholeContent;
+      }
+      const uint64_t suffix = current::FromString<uint64_t>(last);
+      if (!suffix || !size) {
+        return RangeRequest::NotSatisfiable;
+      }
+      begin = (suffix < size) ? size - suffix : 0u;
+      end = size;
+      return RangeRequest::Satisfiable;
+    }
+    if (!IsNumber(first) || !(last.empty() || IsNumber(last))) {
+      return RangeRequest::WholeContent;
+    }
+    const uint64_t first_byte = current::FromString<uint64_t>(first);
+    const uint64_t last_byte = last.empty() ? size - 1u : current::FromString<uint64_t>(last);
+    if (!last.empty() && last_byte < first_byte) {
+      return RangeRequest::WholeContent;
+    }
+    if (first_byte >= size) {
+      return RangeRequest::NotSatisfiable;
+    }
+    begin = first_byte;
+    end = std::min(last_byte, size - 1u) + 1u;
+    return RangeRequest::Satisfiable;
+  }
+};
+
+#ifndef CURRENT_HTTP_SERVER_DEFAULT_WORKER_THREADS
+#define CURRENT_HTTP_SERVER_DEFAULT_WORKER_THREADS 8
+#endif  // CURRENT_HTTP_SERVER_DEFAULT_WORKER_THREADS
+
+// The settings of the HTTP server. Only take effect on the first access to the port, when the server is started.
+struct HTTPServerOptions {
+  // The number of threads to parse and handle the requests in. Different requests are handled concurrently.
+  size_t worker_threads = CURRENT_HTTP_SERVER_DEFAULT_WORKER_THREADS;
+
+  // Whether to keep HTTP/1.1 connections alive between requests. Not supported on non-Linux platforms yet.
+  bool keep_alive = true;
+
+  // The connections which have not sent the next request for this long are closed.
+  std::chrono::milliseconds idle_connection_timeout = std::chrono::seconds(15);
+
+  // Whether to collect the per-route metrics, see `HTTPServerPOSIX::Metrics()`.
+  bool collect_metrics = true;
+
+  HTTPServerOptions() = default;
+  HTTPServerOptions& SetWorkerThreads(size_t value) {
+    worker_threads = value;
+    return *this;
+  }
+  HTTPServerOptions& SetKeepAlive(bool value) {
+    keep_alive = value;
+    return *this;
+  }
+  HTTPServerOptions& SetIdleConnectionTimeout(std::chrono::milliseconds value) {
+    idle_connection_timeout = value;
+    return *this;
+  }
+  HTTPServerOptions& SetCollectMetrics(bool value) {
+    collect_metrics = value;
+    return *this;
+  }
 };
 
 // HTTP server bound to a specific port.
+// On Linux, the listening socket and the idle persistent connections are watched over by a single `epoll`-based
+// thread, which hands off the connections that have data to read to the pool of worker threads.
+// The workers parse the requests and run the handlers, so that a slow handler does not stall the whole port.
 class HTTPServerPOSIX final {
  public:
+  using options_t = HTTPServerOptions;
+
   // The constructor starts listening on the specified port.
   // Since instances of `HTTPServerPOSIX` are created via a singleton,
   // a listening thread will only be created once per port, on the first access to that port.
-  explicit HTTPServerPOSIX(current::net::BarePort port)
-      : terminating_(false),
-        port_(static_cast<uint16_t>(port)),
-        thread_([this, port]() { Thread(current::net::Socket(port)); }) {}
-  explicit HTTPServerPOSIX(current::net::ReservedLocalPort reserved_port)
-      : terminating_(false),
-        port_(reserved_port),
-        thread_([this](current::net::Socket socket) { Thread(std::move(socket)); }, std::move(reserved_port)) {}
+  explicit HTTPServerPOSIX(current::net::BarePort port, const HTTPServerOptions& options = HTTPServerOptions())
+      : options_(options), terminating_(false), port_(static_cast<uint16_t>(port)) {
+    StartWorkerThreads();
+    thread_ = std::thread([this, port]() { Thread(current::net::Socket(port)); });
+  }
+  explicit HTTPServerPOSIX(current::net::ReservedLocalPort reserved_port,
+                           const HTTPServerOptions& options = HTTPServerOptions())
+      : options_(options), terminating_(false), port_(reserved_port) {
+    StartWorkerThreads();
+    thread_ = std::thread([this](current::net::Socket socket) { Thread(std::move(socket)); },
+                          std::move(reserved_port));
+  }
 
   uint16_t LocalPort() const { return port_; }
 
@@ -178,6 +443,16 @@ class HTTPServerPOSIX final {
   // unregistering all handlers will still keep the listening thread up, and it will serve 404-s.
   ~HTTPServerPOSIX() {
     terminating_ = true;
+    {
+      // The connections served at the moment will be closed once their requests have been handled.
+      std::lock_guard<std::mutex> lock(returned_connections_->mutex);
+      returned_connections_->server_is_up = false;
+      returned_connections_->connections.clear();
+    }
+#ifdef CURRENT_POSIX
+    // Notify the polling thread that it should terminate.
+    returned_connections_->WakeUp();
+#else
     // Notify the server thread that it should terminate.
     // Effectively, call `HTTP(GET("/healthz"))`, but in a way that avoids client <=> server dependency.
     // LCOV_EXCL_START
@@ -192,10 +467,20 @@ class HTTPServerPOSIX final {
       // and the consecutive request. Which is perfectly fine, since it implies that the server has terminated.
     }
     // LCOV_EXCL_STOP
+#endif  // CURRENT_POSIX
     // Wait for the thread to terminate.
     if (thread_.joinable()) {
       thread_.join();
     }
+    // Wait for the requests being handled to complete, and for the workers to terminate.
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      queue_.clear();
+    }
+    queue_condition_variable_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
   }
 
   // The bare `Join()` method is only used by small scripts to run the server indefinitely,
@@ -257,24 +542,39 @@ class HTTPServerPOSIX final {
   void UnRegister(const std::string& path,
                   const URLPathArgs::CountMask path_args_count_mask = URLPathArgs::CountMask::None) {
     std::lock_guard<std::mutex> lock(mutex_);
+    const auto it1 = handlers_.find(path);
+    std::vector<size_t> handlers_to_erase;
+    bool handler_does_not_exist = false;
     URLPathArgs::CountMask mask = URLPathArgs::CountMask::None;  // `None` == 1 == (1 << 0).
     for (size_t i = 0; i <= URLPathArgs::MaxArgsCount; ++i, mask <<= 1) {
       if ((path_args_count_mask & mask) == mask) {
-        auto it1 = handlers_.find(path);
-        if (it1 == handlers_.end()) {
-          CURRENT_THROW(HandlerDoesNotExistException(path));
-        }
-        auto& map = it1->second;
-        auto it2 = map.find(i);
-        if (it2 == map.end()) {
-          CURRENT_THROW(HandlerDoesNotExistException(path));
+        if (it1 == handlers_.end() || it1->second.find(i) == it1->second.end()) {
+          handler_does_not_exist = true;
+          break;
         }
-        map.erase(it2);
-        if (map.empty()) {
-          // Maintain the value of `PathHandlersCount()` invariant.
-          handlers_.erase(it1);
+        handlers_to_erase.push_back(i);
+      }
+    }
+    if (!handlers_to_erase.empty()) {
+      auto& map = it1->second;
+      // The routes snapshot borrows the handlers, so it must stop referring to them before they are destroyed.
+      route_handlers_t remaining_handlers;
+      for (const auto& handler : map) {
+        if (std::find(handlers_to_erase.begin(), handlers_to_erase.end(), handler.first) == handlers_to_erase.end()) {
+          remaining_handlers.emplace(handler.first, Borrowed<route_handler_t>(handler.second));
         }
       }
+      PublishRoute(path, remaining_handlers);
+      for (size_t i : handlers_to_erase) {
+        map.erase(i);
+      }
+      if (map.empty()) {
+        // Maintain the value of `PathHandlersCount()` invariant.
+        handlers_.erase(it1);
+      }
+    }
+    if (handler_does_not_exist) {
+      CURRENT_THROW(HandlerDoesNotExistException(path));
     }
   }
 
@@ -282,15 +582,27 @@ class HTTPServerPOSIX final {
                                        const ServeStaticFilesFromOptions& options = ServeStaticFilesFromOptions()) {
     ValidateRoute(options.route_prefix);
 
+    // The requests for all the files served are counted in the metrics of a single route, `/prefix/*`.
+    const std::string metrics_label = options.route_prefix + (options.route_prefix == "/" ? "*" : "/*");
+
     HTTPRoutesScope scope;
     current::FileSystem::ScanDir(
         dir,
-        [this, &options, &scope](const current::FileSystem::ScanDirItemInfo& item_info) {
+        [this, &options, &scope, &metrics_label](const current::FileSystem::ScanDirItemInfo& item_info) {
           // Ignore files named with a leading dot (means hidden in POSIX) before checking MIME type.
           if (item_info.basename.front() == '.') {
             return;
           }
 
+          // The pre-gzipped siblings of the files, `*.gz`, are served along with the files themselves.
+          const std::string gz_extension = ".gz";
+          const std::string& pathname = item_info.pathname;
+          if (pathname.length() > gz_extension.length() &&
+              pathname.compare(pathname.length() - gz_extension.length(), gz_extension.length(), gz_extension) == 0 &&
+              IsRegularFile(pathname.substr(0u, pathname.length() - gz_extension.length()))) {
+            return;
+          }
+
           const std::string content_type(current::net::GetFileMimeType(item_info.basename, ""));
           if (!content_type.empty()) {
             const bool path_components_empty = item_info.path_components_cref.empty();
@@ -319,7 +631,12 @@ class HTTPServerPOSIX final {
 
             // TODO(dkorolev): Wrap keeping file contents into a singleton
             // that keeps a map from a (SHA256) hash to the contents.
-            std::string content = current::FileSystem::ReadFileAsString(item_info.pathname);
+            const auto identity = StaticFileServer::Representation::FromFile(pathname, options.serve_from_disk);
+            const auto gzipped = IsRegularFile(pathname + gz_extension)
+                                     ? StaticFileServer::Representation::FromFile(pathname + gz_extension,
+                                                                                  options.serve_from_disk)
+                                     : nullptr;
+            const auto last_modified = FileModificationTime(pathname);
 
             // If it's an index file, serve it additionally at the route without the filename (i.e. the directory
             // route).
@@ -335,14 +652,15 @@ class HTTPServerPOSIX final {
                                                         (path_components_empty ? "" : path_components_joined + "/");
               CURRENT_ASSERT(trailing_slash_redirect_url.length() > 0 && trailing_slash_redirect_url.back() == '/');
 
-              auto static_file_server =
-                  std::make_unique<StaticFileServer>(content, content_type, true, trailing_slash_redirect_url);
-              scope += Register(route_for_directory, *static_file_server);
+              auto static_file_server = std::make_unique<StaticFileServer>(
+                  identity, gzipped, last_modified, content_type, true, trailing_slash_redirect_url);
+              scope += RegisterStaticFileServer(route_for_directory, *static_file_server, metrics_label);
               static_file_servers_.push_back(std::move(static_file_server));
             }
 
-            auto static_file_server = std::make_unique<StaticFileServer>(std::move(content), content_type, false);
-            scope += Register(route_for_file, *static_file_server);
+            auto static_file_server =
+                std::make_unique<StaticFileServer>(identity, gzipped, last_modified, content_type, false);
+            scope += RegisterStaticFileServer(route_for_file, *static_file_server, metrics_label);
             static_file_servers_.push_back(std::move(static_file_server));
           } else {
             CURRENT_THROW(ServeStaticFilesFromCanNotServeStaticFilesOfUnknownMIMEType(item_info.basename));
@@ -360,16 +678,92 @@ class HTTPServerPOSIX final {
     return handlers_.size();
   }
 
+  // The metrics of the requests served so far, per registered path. The metrics of a path are freed
+  // once all its handlers are unregistered and the requests they serve complete.
+  HTTPServerMetrics Metrics() const {
+    HTTPServerMetrics result;
+    result.port = port_;
+    result.idle_connections = idle_connections_count_.load(std::memory_order_relaxed);
+    result.open_connections = result.idle_connections;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto& route_metrics : route_metrics_) {
+        if (const auto metrics = route_metrics.second.lock()) {
+          result.routes.push_back(metrics->Snapshot());
+          result.open_connections += result.routes.back().in_flight;
+        }
+      }
+    }
+    result.unmatched = unmatched_metrics_->Snapshot();
+    result.open_connections += result.unmatched.in_flight;
+    return result;
+  }
+
+  // The handler serving `Metrics()` as JSON, or in the Prometheus text format, if requested via `?format=prometheus`
+  // or via the `Accept` header, as Prometheus does. Registered as any other handler, for example,
+  // `HTTP(port).Register("/metrics", HTTP(port).MetricsHandler())`.
+  std::function<void(Request)> MetricsHandler() {
+    return [this](Request r) {
+      const std::string accept = r.headers.GetOrDefault("Accept", "");
+      if (r.url.query["format"] == "prometheus" || accept.find("text/plain") != std::string::npos ||
+          accept.find("application/openmetrics-text") != std::string::npos) {
+        r(HTTPServerMetricsAsPrometheusText(Metrics()),
+          HTTPResponseCode.OK,
+          "text/plain; version=0.0.4; charset=utf-8");
+      } else {
+        r(Metrics());
+      }
+    };
+  }
+
  private:
+  static bool IsRegularFile(const std::string& pathname) {
+    struct stat info;
+#ifndef CURRENT_WINDOWS
+    return !::stat(pathname.c_str(), &info) && S_ISREG(info.st_mode);
+#else
+    return !::stat(pathname.c_str(), &info) && (info.st_mode & _S_IFREG);
+#endif  // CURRENT_WINDOWS
+  }
+
+  static std::chrono::microseconds FileModificationTime(const std::string& pathname) {
+    struct stat info;
+    if (::stat(pathname.c_str(), &info)) {
+      return std::chrono::microseconds(0);  // LCOV_EXCL_LINE
+    }
+    return std::chrono::microseconds(static_cast<int64_t>(info.st_mtime) * 1000000);
+  }
+
+  // The handlers of the same path, by the number of URL path args they accept.
+  using route_handler_t = std::function<void(Request)>;
+  using route_handlers_t = std::map<size_t, Borrowed<route_handler_t>>;
+
+  // The registered routes, as a trie keyed by path components. The trie is immutable once published:
+  // the writers, holding `mutex_`, copy the nodes on the path to the updated one and publish the new root,
+  // which shares all the other subtrees with the previous one. The readers do not contend on `mutex_` with the
+  // writers, nor with each other, and the snapshot they have grabbed remains valid for as long as they hold it.
+  // NOTE: Grabbing the snapshot, `std::atomic_load()` of the `shared_ptr`, is not lock-free: libstdc++ guards it
+  //       with a mutex from a small pool, held for just the copy of the pointer and the increment of its count.
+  struct RouteTrieNode final {
+    std::map<std::string, std::shared_ptr<const RouteTrieNode>, std::less<>> children;
+    route_handlers_t handlers;
+    std::shared_ptr<HTTPRouteMetricsCollector> metrics;  // Set along with `handlers`.
+  };
+
   // Although this may look complicated, all it does is making sure the handler, if found,
   // is returned wrapped into a special object which prohibits its de-registration while in use.
   // Note: If the user code handles the request synchronously, the scoped HTTP registerers will do the job.
   // If the user handles the request from another thread, it's the responsibility of the user to make sure
   // the very object ("this") does not get destroyed while the request is being handled.
-  Optional<Borrowed<std::function<void(Request)>>> FindHandler(const std::string& path,
-                                                               URLPathArgs& output_url_args) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-
+  //
+  // The route is resolved in a single pass down the trie snapshot of the path components, without taking `mutex_`.
+  // The longest registered prefix of the path wins, provided it accepts the number of the remaining components
+  // as its URL path args. I.e., just like before, "/foo/bar/baz" is served by the "/foo/bar" handler with one arg
+  // if it exists, then by the "/foo" handler with two args, and then by the "/" one with three.
+  // The metrics collector of the route found is returned via `output_metrics`.
+  Optional<Borrowed<route_handler_t>> FindHandler(const std::string& path,
+                                                  URLPathArgs& output_url_args,
+                                                  std::shared_ptr<HTTPRouteMetricsCollector>& output_metrics) const {
     // LCOV_EXCL_START
     if (path.empty()) {
       std::cerr << "HTTP: path is empty.\n";
@@ -381,98 +775,449 @@ class HTTPServerPOSIX final {
     }
     // LCOV_EXCL_STOP
 
-    // Work with the path by trying to match the full one, then the one with the last component removed,
-    // then the one with two last components removed, etc.
-    // As a component is removed, it's removed from `base_path` and is added to `url_args`.
-    std::string& remaining_path = output_url_args.base_path;
-    remaining_path = path;
+    output_url_args.base_path = "/";
 
-    // Friendly reminder: `remaining_path[0]` is guaranteed to be '/'.
+    const std::shared_ptr<const RouteTrieNode> routes = std::atomic_load(&routes_);
+    if (!routes) {
+      return nullptr;
+    }
+
+    // Empty components, such as the ones from "//" or from trailing slashes, are skipped.
+    size_t components_count = 0u;
+    for (size_t i = 1u; i < path.length(); ++i) {
+      if (path[i] != '/' && path[i - 1u] == '/') {
+        ++components_count;
+      }
+    }
+
+    // Walk down the trie; the deepest node that has the handler for the number of the remaining components wins.
+    const RouteTrieNode* node = routes.get();
+    const RouteTrieNode* best_node = nullptr;
+    const Borrowed<route_handler_t>* best_handler = nullptr;
+    size_t best_depth = 0u;
+    size_t best_end = 0u;  // Where the matched prefix of `path` ends.
+    size_t depth = 0u;
+    size_t offset = 0u;
     while (true) {
-      while (remaining_path.length() > 1 && remaining_path.back() == '/') {
-        remaining_path.resize(remaining_path.length() - 1);
+      const auto cit = node->handlers.find(components_count - depth);
+      if (cit != node->handlers.end()) {
+        best_node = node;
+        best_handler = &cit->second;
+        best_depth = depth;
+        best_end = offset;
+      }
+      while (offset < path.length() && path[offset] == '/') {
+        ++offset;
+      }
+      if (offset == path.length()) {
+        break;
+      }
+      const size_t component_end = std::min(path.find('/', offset), path.length());
+      const auto child = node->children.find(std::string_view(path.data() + offset, component_end - offset));
+      if (child == node->children.end()) {
+        break;
       }
+      node = child->second.get();
+      ++depth;
+      offset = component_end;
+    }
 
-      const auto cit = handlers_.find(remaining_path);
-      if (cit != handlers_.end()) {
-        const auto cit2 = cit->second.find(output_url_args.size());
-        if (cit2 != cit->second.end()) {
-          return Borrowed<std::function<void(Request)>>(cit2->second);
-        }
+    if (!best_handler) {
+      return nullptr;
+    }
+
+    Borrowed<route_handler_t> result(*best_handler);
+    if (!result) {
+      // The handler is being unregistered, and this request has raced with publishing the updated routes.
+      return nullptr;
+    }
+    output_metrics = best_node->metrics;
+
+    // The URL path args are the remaining components, added from the last one to the first one.
+    if (best_depth) {
+      output_url_args.base_path.assign(path, 0u, best_end);
+    }
+    size_t end = path.length();
+    while (end > best_end) {
+      const size_t slash = path.rfind('/', end - 1u);
+      if (slash + 1u < end) {
+        output_url_args.add(URL::DecodeURIComponent(path.substr(slash + 1u, end - slash - 1u)));
       }
+      end = slash;
+    }
+    return result;
+  }
 
-      if (remaining_path == "/") {
-        break;
+  // Returns the copy of `node` with the handlers at `components[depth...]` replaced by `handlers`,
+  // or `nullptr` if the resulting node would have neither handlers nor children.
+  static std::shared_ptr<const RouteTrieNode> UpdatedRouteTrie(
+      const RouteTrieNode* node,
+      const std::vector<std::string>& components,
+      size_t depth,
+      const route_handlers_t& handlers,
+      const std::shared_ptr<HTTPRouteMetricsCollector>& metrics) {
+    auto result = node ? std::make_shared<RouteTrieNode>(*node) : std::make_shared<RouteTrieNode>();
+    if (depth == components.size()) {
+      result->handlers.clear();
+      for (const auto& handler : handlers) {
+        result->handlers.emplace(handler.first, handler.second);
+      }
+      result->metrics = metrics;
+    } else {
+      const auto cit = result->children.find(components[depth]);
+      auto child = UpdatedRouteTrie(
+          cit != result->children.end() ? cit->second.get() : nullptr, components, depth + 1u, handlers, metrics);
+      if (child) {
+        result->children[components[depth]] = std::move(child);
+      } else if (cit != result->children.end()) {
+        result->children.erase(cit);
+      }
+    }
+    if (result->handlers.empty() && result->children.empty()) {
+      return nullptr;
+    }
+    return result;
+  }
+
+  // Publishes the routes with the handlers of `path` replaced by `handlers`. Must be called with `mutex_` locked.
+  // The requests to `path` are counted by the collector already counting them, if any, or else by the one
+  // of `metrics_label`, which defaults to `path`. The collectors are owned by the routes, and freed with them.
+  void PublishRoute(const std::string& path, const route_handlers_t& handlers, const std::string& metrics_label = "") {
+    std::vector<std::string> components;
+    size_t offset = 1u;
+    while (offset < path.length()) {
+      const size_t component_end = std::min(path.find('/', offset), path.length());
+      components.push_back(path.substr(offset, component_end - offset));
+      offset = component_end + 1u;
+    }
+    for (auto it = route_metrics_.begin(); it != route_metrics_.end();) {
+      it = it->second.expired() ? route_metrics_.erase(it) : std::next(it);
+    }
+    const auto routes = std::atomic_load(&routes_);
+    std::shared_ptr<HTTPRouteMetricsCollector> metrics;
+    if (!handlers.empty()) {
+      const RouteTrieNode* node = routes.get();
+      for (size_t i = 0u; node && i < components.size(); ++i) {
+        const auto cit = node->children.find(components[i]);
+        node = cit != node->children.end() ? cit->second.get() : nullptr;
+      }
+      if (node) {
+        metrics = node->metrics;
+      }
+      if (!metrics) {
+        const std::string& label = metrics_label.empty() ? path : metrics_label;
+        auto& collector = route_metrics_[label];
+        metrics = collector.lock();
+        if (!metrics) {
+          metrics = std::make_shared<HTTPRouteMetricsCollector>(label);
+          collector = metrics;
+        }
       }
+    }
+    std::atomic_store(&routes_, UpdatedRouteTrie(routes.get(), components, 0u, handlers, metrics));
+  }
+
+  HTTPRoutesScopeEntry RegisterStaticFileServer(const std::string& path,
+                                                StaticFileServer& static_file_server,
+                                                const std::string& metrics_label) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return DoRegisterHandler(
+        path,
+        [&static_file_server](Request r) { static_file_server(std::move(r)); },
+        URLPathArgs::CountMask::None,
+        ReRegisterRoute::ThrowOnAttempt,
+        metrics_label);
+  }
 
-      const size_t arg_begin_index = remaining_path.rfind('/') + 1;
-      output_url_args.add(URL::DecodeURIComponent(remaining_path.substr(arg_begin_index)));
-      remaining_path.resize(arg_begin_index);
+  // A connection from which the next request is to be read, along with the bytes of it that have been read already.
+  struct PendingConnection final {
+    current::net::Connection connection;
+    current::net::HTTPReadBuffer read_buffer;
+    PendingConnection(current::net::Connection&& connection, current::net::HTTPReadBuffer&& read_buffer)
+        : connection(std::move(connection)), read_buffer(std::move(read_buffer)) {}
+    PendingConnection(PendingConnection&&) = default;
+  };
+
+  // The persistent connections handed back once their responses have been sent, to wait for the next requests.
+  // Owned by both the server and the recyclers of the connections being served, as those may outlive the server.
+  struct ReturnedConnections final {
+    std::mutex mutex;
+    bool server_is_up = true;
+    std::vector<PendingConnection> connections;
+#ifdef CURRENT_POSIX
+    const int wakeup_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    ~ReturnedConnections() { ::close(wakeup_fd); }
+    void WakeUp() {
+      const uint64_t one = 1u;
+      const ssize_t unused = ::write(wakeup_fd, &one, sizeof(one));
+      static_cast<void>(unused);
+    }
+#endif  // CURRENT_POSIX
+  };
+
+  void StartWorkerThreads() {
+#ifdef CURRENT_POSIX
+    if (returned_connections_->wakeup_fd < 0) {
+      CURRENT_THROW(current::net::SocketPollException());  // LCOV_EXCL_LINE
+    }
+    if (options_.keep_alive) {
+      recycler_ = [returned_connections = returned_connections_](current::net::Connection&& connection,
+                                                                 current::net::HTTPReadBuffer&& read_buffer) {
+        std::lock_guard<std::mutex> lock(returned_connections->mutex);
+        if (returned_connections->server_is_up) {
+          returned_connections->connections.emplace_back(std::move(connection), std::move(read_buffer));
+          returned_connections->WakeUp();
+        }
+      };
+    }
+#endif  // CURRENT_POSIX
+    for (size_t i = 0u; i < std::max(options_.worker_threads, static_cast<size_t>(1u)); ++i) {
+      workers_.emplace_back([this]() { WorkerThread(); });
+    }
+  }
+
+  void HandOverToWorker(PendingConnection&& pending_connection) {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      queue_.push_back(std::move(pending_connection));
+    }
+    queue_condition_variable_.notify_one();
+  }
+
+  void WorkerThread() {
+    while (true) {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_condition_variable_.wait(lock, [this]() { return terminating_ || !queue_.empty(); });
+      if (terminating_) {
+        return;
+      }
+      PendingConnection pending_connection(std::move(queue_.front()));
+      queue_.pop_front();
+      lock.unlock();
+      ServeRequest(std::move(pending_connection));
     }
+  }
 
-    return nullptr;
+#ifdef CURRENT_POSIX
+  // The heads longer than this are left for the worker to read the rest of.
+  constexpr static size_t kMaxBytesToReadAheadOfWorker = 64u * 1024u;
+
+  // Appends the bytes that have already arrived on `fd` to the carried over ones of `read_buffer`, without blocking.
+  static ssize_t ReceiveAvailableBytes(SOCKET fd, current::net::HTTPReadBuffer& read_buffer) {
+    constexpr static size_t kReadChunk = 4096u;
+    if (read_buffer.data.size() < read_buffer.carried_over_bytes + kReadChunk + 1u) {
+      read_buffer.data.resize(read_buffer.carried_over_bytes + kReadChunk + 1u);
+    }
+    ssize_t received;
+    do {
+      received = ::recv(fd,
+                        &read_buffer.data[read_buffer.carried_over_bytes],
+                        read_buffer.data.size() - read_buffer.carried_over_bytes - 1u,
+                        MSG_DONTWAIT);
+    } while (received < 0 && errno == EINTR);
+    if (received > 0) {
+      read_buffer.carried_over_bytes += static_cast<size_t>(received);
+    }
+    return received;
   }
 
+  // Accepts the connections and watches over the idle ones, handing over those with requests to the workers.
   void Thread(current::net::Socket socket) {
-    // TODO(dkorolev): Benchmark QPS.
+    const SOCKET listening_fd = socket.socket;
+    const int wakeup_fd = returned_connections_->wakeup_fd;
+    const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+      CURRENT_THROW(current::net::SocketPollException());  // LCOV_EXCL_LINE
+    }
+
+    struct IdleConnection final {
+      PendingConnection pending_connection;
+      std::chrono::steady_clock::time_point idle_since;  // Not `current::time::Now()`, which the tests may mock.
+    };
+    std::unordered_map<SOCKET, IdleConnection> idle_connections;
+
+    const auto Watch = [epoll_fd](int fd) {
+      epoll_event event;
+      event.events = EPOLLIN | EPOLLRDHUP;
+      event.data.fd = fd;
+      return ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+    };
+    const auto WatchIdleConnection = [&](PendingConnection&& pending_connection) {
+      const SOCKET fd = pending_connection.connection.socket;
+      if (Watch(fd)) {
+        idle_connections.emplace(fd, IdleConnection{std::move(pending_connection), std::chrono::steady_clock::now()});
+      }
+    };
+
+    if (!Watch(listening_fd) || !Watch(wakeup_fd)) {
+      ::close(epoll_fd);                                   // LCOV_EXCL_LINE
+      CURRENT_THROW(current::net::SocketPollException());  // LCOV_EXCL_LINE
+    }
+
+    const auto idle_timeout = std::chrono::duration_cast<std::chrono::microseconds>(options_.idle_connection_timeout);
+    const int poll_timeout_ms = static_cast<int>(
+        std::max(static_cast<int64_t>(1), std::min(static_cast<int64_t>(1000), idle_timeout.count() / 1000)));
+    constexpr static int kMaxEvents = 256;
+    epoll_event events[kMaxEvents];
+
     while (!terminating_) {
-      try {
-        auto connection = std::make_unique<current::net::HTTPServerConnection>(socket.Accept());
-        if (terminating_) {
-          // Already terminating. Will not send the response, and this
-          // lack of response should not result in an exception.
-          connection->DoNotSendAnyResponse();
-          break;
-        }
-        URLPathArgs url_path_args;
-        const auto handler = FindHandler(connection->HTTPRequest().URL().path, url_path_args);
-        if (Exists(handler)) {
-          // OK, here's the tricky part with error handling and exceptions in this multithreaded world.
-          // * On the one hand, the connection should be std::move-d into the request,
-          //   since it might end up being served in another thread, via a message queue, etc.
-          //   Thus, the user code is responsible for closing the connection.
-          //   Not to mention that the std::move-d away connection can easily outlive this scope.
-          // * On the other hand, if an exception occurs in user code, we need to return a 500,
-          //   which should obviously happen before the connection object is destructed.
-          //   This seems like a good reason to not std::move it away, or move it away with some flag,
-          //   but I thought hard of it, and don't think it's a good choice -- D.K.
-          //
-          // Solution: Do nothing here. No matter how tempting it is, it won't work across threads. Period.
-          //
-          // The implementation of HTTP connection will return an "INTERNAL SERVER ERROR"
-          // if no response was sent. That's what the user gets. In debugger, they can put a breakpoint there
-          // and see what caused the error.
-          //
-          // It is the job of the user of this library to ensure no exceptions leave their code.
-          // In practice, a top-level try-catch for `const current::Exception& e` is good enough.
+      const int n = ::epoll_wait(epoll_fd, events, kMaxEvents, poll_timeout_ms);
+      if (n < 0 && errno != EINTR) {
+        std::cerr << "HTTP server: `epoll_wait()` failed, errno " << errno << '\n';  // LCOV_EXCL_LINE
+        break;                                                                       // LCOV_EXCL_LINE
+      }
+      for (int i = 0; i < n && !terminating_; ++i) {
+        const int fd = events[i].data.fd;
+        if (fd == listening_fd) {
           try {
-            (*Value(handler))(Request(std::move(connection), url_path_args));
+            // The newly accepted connection is handed over to the worker once the head of the request arrives.
+            WatchIdleConnection(PendingConnection(socket.Accept(), current::net::HTTPReadBuffer()));
           } catch (const current::Exception& e) {  // LCOV_EXCL_LINE
-            // WARNING: This `catch` is really not sufficient, it just logs a message
-            // if a user exception occurred in the same thread that ran the handler.
-            // DO NOT COUNT ON IT.
-            std::cerr << "HTTP route failed in user code: " << e.what() << '\n';  // LCOV_EXCL_LINE
+            std::cerr << "HTTP server: " << e.what() << '\n';  // LCOV_EXCL_LINE
+          }
+        } else if (fd == wakeup_fd) {
+          uint64_t unused;
+          while (::read(wakeup_fd, &unused, sizeof(unused)) > 0) {
+          }
+          std::vector<PendingConnection> returned;
+          {
+            std::lock_guard<std::mutex> lock(returned_connections_->mutex);
+            returned.swap(returned_connections_->connections);
           }
+          for (auto& pending_connection : returned) {
+            if (pending_connection.read_buffer.CarriesOverCompleteHead()) {
+              // The next request has already been sent by the client, no need to wait for it. The connections with
+              // only a part of it are watched as the idle ones, not to have a worker wait for the rest of it.
+              HandOverToWorker(std::move(pending_connection));
+            } else {
+              WatchIdleConnection(std::move(pending_connection));
+            }
+          }
+        } else {
+          const auto it = idle_connections.find(fd);
+          if (it != idle_connections.end()) {
+            // Read what has arrived, and only hand the connection over once the head of the request has, so that no
+            // worker waits for the rest of it. Close the connections the client has closed, or failed. The connections
+            // woken up spuriously, or with a part of the head, remain idle, still subject to the idle timeout.
+            current::net::HTTPReadBuffer& read_buffer = it->second.pending_connection.read_buffer;
+            const ssize_t received = ReceiveAvailableBytes(fd, read_buffer);
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+              continue;  // LCOV_EXCL_LINE
+            }
+            if (received > 0 && !read_buffer.CarriesOverCompleteHead() &&
+                read_buffer.carried_over_bytes < kMaxBytesToReadAheadOfWorker) {
+              continue;
+            }
+            ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            PendingConnection pending_connection(std::move(it->second.pending_connection));
+            idle_connections.erase(it);
+            if (received > 0) {
+              HandOverToWorker(std::move(pending_connection));
+            }
+          }
+        }
+      }
+      const auto now = std::chrono::steady_clock::now();
+      for (auto it = idle_connections.begin(); it != idle_connections.end();) {
+        if (now - it->second.idle_since >= idle_timeout) {
+          ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, it->first, nullptr);
+          it = idle_connections.erase(it);
         } else {
-          connection->SendHTTPResponse(current::net::DefaultNotFoundMessage(),
-                                       HTTPResponseCode.NotFound,
-                                       current::net::http::Headers(),
-                                       current::net::constants::kDefaultHTMLContentType);
+          ++it;
         }
-      } catch (const current::net::ChunkSizeNotAValidHEXValue&) {
-        // The `ChunkSizeNotAValidHEXValue` situation, if emerged, is already handled with a "400 BAD REQUEST" response.
-      } catch (const current::net::HTTPPayloadTooLarge&) {
-        // The `HTTPPayloadTooLarge` situation, if emerged, is already handled with a "413 ENTITY TOO LARGE" response.
-      } catch (const current::net::HTTPRequestBodyLengthNotProvided&) {
-        // The `HTTPRequestBodyLengthNotProvided` situation, if emerged, is already handled with "411 LENGTH REQUIRED".
-      } catch (const current::net::EmptySocketException&) {  // LCOV_EXCL_LINE
-        // Silently discard errors if no data was sent in.
-      } catch (const current::Exception& e) {  // LCOV_EXCL_LINE
-        // TODO(dkorolev): More reliable logging.
-        std::cerr << "HTTP route failed: " << e.what() << '\n';  // LCOV_EXCL_LINE
+      }
+      idle_connections_count_.store(idle_connections.size(), std::memory_order_relaxed);
+    }
+
+    idle_connections.clear();
+    idle_connections_count_.store(0u, std::memory_order_relaxed);
+    ::close(epoll_fd);
+  }
+#else
+  // Without `epoll`, accept the connections in a blocking way, and close them after the responses are sent.
+  void Thread(current::net::Socket socket) {
+    while (!terminating_) {
+      try {
+        current::net::Connection connection(socket.Accept());
+        if (!terminating_) {
+          HandOverToWorker(PendingConnection(std::move(connection), current::net::HTTPReadBuffer()));
+        }
+      } catch (const current::Exception& e) {                       // LCOV_EXCL_LINE
+        std::cerr << "HTTP server: " << e.what() << '\n';  // LCOV_EXCL_LINE
       }
     }
   }
+#endif  // CURRENT_POSIX
+
+  void ServeRequest(PendingConnection&& pending_connection) {
+    try {
+      const auto parse_began_at = std::chrono::steady_clock::now();
+      auto connection = std::make_unique<current::net::HTTPServerConnection>(
+          std::move(pending_connection.connection), std::move(pending_connection.read_buffer), recycler_);
+      if (terminating_) {
+        // Already terminating. Will not send the response, and this
+        // lack of response should not result in an exception.
+        connection->DoNotSendAnyResponse();
+        return;
+      }
+      URLPathArgs url_path_args;
+      std::shared_ptr<HTTPRouteMetricsCollector> metrics;
+      const auto handler = FindHandler(connection->HTTPRequest().URL().path, url_path_args, metrics);
+      if (options_.collect_metrics) {
+        if (!Exists(handler)) {
+          metrics = unmatched_metrics_;
+        }
+        metrics->OnRequestStarted();
+        connection->SetServedRequestObserver(metrics,
+                                             std::chrono::duration_cast<std::chrono::microseconds>(
+                                                 std::chrono::steady_clock::now() - parse_began_at));
+      }
+      if (Exists(handler)) {
+        // OK, here's the tricky part with error handling and exceptions in this multithreaded world.
+        // * On the one hand, the connection should be std::move-d into the request,
+        //   since it might end up being served in another thread, via a message queue, etc.
+        //   Thus, the user code is responsible for closing the connection.
+        //   Not to mention that the std::move-d away connection can easily outlive this scope.
+        // * On the other hand, if an exception occurs in user code, we need to return a 500,
+        //   which should obviously happen before the connection object is destructed.
+        //   This seems like a good reason to not std::move it away, or move it away with some flag,
+        //   but I thought hard of it, and don't think it's a good choice -- D.K.
+        //
+        // Solution: Do nothing here. No matter how tempting it is, it won't work across threads. Period.
+        //
+        // The implementation of HTTP connection will return an "INTERNAL SERVER ERROR"
+        // if no response was sent. That's what the user gets. In debugger, they can put a breakpoint there
+        // and see what caused the error.
+        //
+        // It is the job of the user of this library to ensure no exceptions leave their code.
+        // In practice, a top-level try-catch for `const current::Exception& e` is good enough.
+        try {
+          (*Value(handler))(Request(std::move(connection), url_path_args));
+        } catch (const current::Exception& e) {  // LCOV_EXCL_LINE
+          // WARNING: This `catch` is really not sufficient, it just logs a message
+          // if a user exception occurred in the same thread that ran the handler.
+          // DO NOT COUNT ON IT.
+          std::cerr << "HTTP route failed in user code: " << e.what() << '\n';  // LCOV_EXCL_LINE
+        }
+      } else {
+        connection->SendHTTPResponse(current::net::DefaultNotFoundMessage(),
+                                     HTTPResponseCode.NotFound,
+                                     current::net::http::Headers(),
+                                     current::net::constants::kDefaultHTMLContentType);
+      }
+    } catch (const current::net::ChunkSizeNotAValidHEXValue&) {
+      // The `ChunkSizeNotAValidHEXValue` situation, if emerged, is already handled with a "400 BAD REQUEST" response.
+    } catch (const current::net::HTTPPayloadTooLarge&) {
+      // The `HTTPPayloadTooLarge` situation, if emerged, is already handled with a "413 ENTITY TOO LARGE" response.
+    } catch (const current::net::HTTPRequestBodyLengthNotProvided&) {
+      // The `HTTPRequestBodyLengthNotProvided` situation, if emerged, is already handled with "411 LENGTH REQUIRED".
+    } catch (const current::net::EmptySocketException&) {  // LCOV_EXCL_LINE
+      // Silently discard errors if no data was sent in.
+    } catch (const current::Exception& e) {  // LCOV_EXCL_LINE
+      // TODO(dkorolev): More reliable logging.
+      std::cerr << "HTTP route failed: " << e.what() << '\n';  // LCOV_EXCL_LINE
+    }
+  }
 
   void ValidateRoute(const std::string& path) {
     if (path.empty() || path[0] != '/') {
@@ -484,12 +1229,17 @@ class HTTPServerPOSIX final {
     if (!URL::IsPathValidToRegister(path)) {
       CURRENT_THROW(PathContainsInvalidCharacters("HTTP URL path contains invalid characters: `" + path + "`."));
     }
+    // The routes are matched per path component, and the empty components of the requested paths are skipped.
+    if (path.find("//") != std::string::npos) {
+      CURRENT_THROW(PathContainsInvalidCharacters("HTTP URL path contains an empty component: `" + path + "`."));
+    }
   }
 
   HTTPRoutesScopeEntry DoRegisterHandler(const std::string& path,
                                          std::function<void(Request)> handler,
                                          const URLPathArgs::CountMask path_args_count_mask,
-                                         const ReRegisterRoute policy) {
+                                         const ReRegisterRoute policy,
+                                         const std::string& metrics_label = "") {
     // LCOV_EXCL_START
     if (static_cast<uint16_t>(path_args_count_mask) == 0) {
       return HTTPRoutesScopeEntry();
@@ -521,14 +1271,27 @@ class HTTPServerPOSIX final {
     }
 
     {
-      // Step 2: Update.
-      auto& handlers_per_path = handlers_[path];
+      // Step 2: Update. The routes snapshot borrows the handlers, so the updated one is published
+      // before the handlers it no longer refers to are replaced.
+      std::map<size_t, Owned<route_handler_t>> new_handlers;
       URLPathArgs::CountMask mask = URLPathArgs::CountMask::None;  // `None` == 1 == (1 << 0).
       for (size_t i = 0; i <= URLPathArgs::MaxArgsCount; ++i, mask = mask << 1) {
         if ((path_args_count_mask & mask) == mask) {
-          handlers_per_path[i] = MakeOwned<std::function<void(Request)>>(handler);
+          new_handlers.emplace(i, MakeOwned<route_handler_t>(handler));
         }
       }
+      route_handlers_t route_handlers;
+      for (const auto& new_handler : new_handlers) {
+        route_handlers.emplace(new_handler.first, Borrowed<route_handler_t>(new_handler.second));
+      }
+      auto& handlers_per_path = handlers_[path];
+      for (const auto& existing_handler : handlers_per_path) {
+        route_handlers.emplace(existing_handler.first, Borrowed<route_handler_t>(existing_handler.second));
+      }
+      PublishRoute(path, route_handlers, metrics_label);
+      for (auto& new_handler : new_handlers) {
+        handlers_per_path[new_handler.first] = std::move(new_handler.second);
+      }
     }
 
     if (policy == ReRegisterRoute::SilentlyUpdateExisting) {
@@ -540,14 +1303,33 @@ class HTTPServerPOSIX final {
 
   HTTPServerPOSIX() = delete;
 
+  const HTTPServerOptions options_;
   std::atomic_bool terminating_;
   const uint16_t port_;
   std::thread thread_;
 
-  // TODO(dkorolev): Look into read-write mutexes here.
+  // The pool of threads serving the requests, and the queue of connections with requests to serve.
+  std::vector<std::thread> workers_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_condition_variable_;
+  std::deque<PendingConnection> queue_;
+
+  const std::shared_ptr<ReturnedConnections> returned_connections_ = std::make_shared<ReturnedConnections>();
+  current::net::HTTPKeepAliveConnectionRecycler recycler_;  // Empty if the connections are not to be kept alive.
+
+  // Guards the writers of `handlers_` and `routes_`. `FindHandler()` does not lock it.
   mutable std::mutex mutex_;
 
-  std::map<std::string, std::map<size_t, Owned<std::function<void(Request)>>>> handlers_;
+  std::map<std::string, std::map<size_t, Owned<route_handler_t>>> handlers_;
+  // Must be destructed before `handlers_`, as it borrows them.
+  std::shared_ptr<const RouteTrieNode> routes_;
+
+  // The metrics of the requests served, per registered path, and of those no route has been found for.
+  // The per-path ones are owned by the routes, so only the routes still registered report their metrics.
+  std::map<std::string, std::weak_ptr<HTTPRouteMetricsCollector>> route_metrics_;
+  const std::shared_ptr<HTTPRouteMetricsCollector> unmatched_metrics_ =
+      std::make_shared<HTTPRouteMetricsCollector>("");
+  std::atomic<size_t> idle_connections_count_{0u};
   std::vector<std::unique_ptr<StaticFileServer>> static_file_servers_;
 };
 
@@ -0,0 +1,332 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2014 Dmitry "Dima" Korolev, <dmitry.korolev@gmail.com>.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef BLOCKS_HTTP_IMPL_SERVER_METRICS_H
+#define BLOCKS_HTTP_IMPL_SERVER_METRICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../../bricks/net/http/impl/server.h"
+#include "../../../bricks/strings/util.h"
+
+#include "../../../typesystem/struct.h"
+
+// The number of the copies of the counters of each route. The threads updating the counters are spread across
+// these copies, so that they rarely contend for the same cache lines, and the copies are summed up when reported.
+#ifndef CURRENT_HTTP_SERVER_METRICS_SHARDS
+#define CURRENT_HTTP_SERVER_METRICS_SHARDS 8
+#endif  // CURRENT_HTTP_SERVER_METRICS_SHARDS
+
+namespace current {
+namespace http {
+
+// The histogram of latencies. `counts[i]` is the number of the values within `(buckets_us[i - 1], buckets_us[i]]`,
+// and the last of `counts`, which has one more element than `buckets_us`, is the number of the larger values.
+CURRENT_STRUCT(HTTPServerLatencyHistogram) {
+  CURRENT_FIELD(buckets_us, std::vector<uint64_t>);
+  CURRENT_FIELD(counts, std::vector<uint64_t>);
+  CURRENT_FIELD(count, uint64_t, 0u);
+  CURRENT_FIELD(sum_us, uint64_t, 0u);
+};
+
+CURRENT_STRUCT(HTTPServerRouteMetrics) {
+  CURRENT_FIELD(path, std::string);
+  CURRENT_FIELD(requests, uint64_t, 0u);
+  CURRENT_FIELD(in_flight, uint64_t, 0u);
+  CURRENT_FIELD(bytes_in, uint64_t, 0u);
+  CURRENT_FIELD(bytes_out, uint64_t, 0u);
+  // By status code, "none" if none was sent, and "other" for the codes beyond the first few distinct ones seen.
+  CURRENT_FIELD(responses, (std::map<std::string, uint64_t>));
+  CURRENT_FIELD(parse_time, HTTPServerLatencyHistogram);
+  CURRENT_FIELD(handler_time, HTTPServerLatencyHistogram);
+};
+
+CURRENT_STRUCT(HTTPServerMetrics) {
+  CURRENT_FIELD(port, uint16_t, 0u);
+  CURRENT_FIELD(open_connections, uint64_t, 0u);  // The requests being served, and the idle persistent connections.
+  CURRENT_FIELD(idle_connections, uint64_t, 0u);
+  CURRENT_FIELD(routes, std::vector<HTTPServerRouteMetrics>);
+  CURRENT_FIELD(unmatched, HTTPServerRouteMetrics);  // The requests no route has been found for, served with 404-s.
+};
+
+// The index of the copy of the counters for the calling thread to update.
+inline size_t HTTPServerMetricsShardIndex() {
+  static std::atomic<size_t> next_index(0u);
+  thread_local const size_t index =
+      next_index.fetch_add(1u, std::memory_order_relaxed) % CURRENT_HTTP_SERVER_METRICS_SHARDS;
+  return index;
+}
+
+// Collects the metrics of the requests served by one route. Updating them takes a few relaxed atomic increments
+// of the counters of the calling thread's shard, and no locking. Each shard takes well under a kilobyte:
+// the responses are counted in `kCodeSlots` slots, taken by the status codes in the order they are first seen.
+class HTTPRouteMetricsCollector final : public current::net::HTTPServedRequestObserver {
+ public:
+  constexpr static size_t kBuckets = 17u;
+  static const uint64_t* BucketsUs() {
+    static const uint64_t buckets_us[kBuckets] = {
+        50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000,
+        10000000};
+    return buckets_us;
+  }
+
+  explicit HTTPRouteMetricsCollector(std::string path) : path_(std::move(path)) {}
+
+  // Called by the server once the request is routed here. `OnServedRequest()` follows once it has been served.
+  void OnRequestStarted() { shards_[HTTPServerMetricsShardIndex()].in_flight.fetch_add(1, std::memory_order_relaxed); }
+
+  void OnServedRequest(const current::net::HTTPServedRequestStats& stats) override {
+    Shard& shard = shards_[HTTPServerMetricsShardIndex()];
+    shard.in_flight.fetch_sub(1, std::memory_order_relaxed);
+    shard.requests.fetch_add(1u, std::memory_order_relaxed);
+    shard.bytes_in.fetch_add(stats.bytes_in, std::memory_order_relaxed);
+    shard.bytes_out.fetch_add(stats.bytes_out, std::memory_order_relaxed);
+    const int code = static_cast<int>(stats.code);
+    if (code >= kMinCode && code < kMaxCode) {
+      CodeSlot* slot = nullptr;
+      for (CodeSlot& candidate : shard.responses) {
+        int slot_code = candidate.code.load(std::memory_order_acquire);
+        if (!slot_code && candidate.code.compare_exchange_strong(slot_code, code, std::memory_order_acq_rel)) {
+          slot_code = code;
+        }
+        if (slot_code == code) {
+          slot = &candidate;
+          break;
+        }
+      }
+      (slot ? slot->count : shard.other_responses).fetch_add(1u, std::memory_order_relaxed);
+    } else {
+      shard.no_response.fetch_add(1u, std::memory_order_relaxed);
+    }
+    shard.parse_time.Record(stats.parse_time);
+    shard.handler_time.Record(stats.handler_time);
+  }
+
+  HTTPServerRouteMetrics Snapshot() const {
+    HTTPServerRouteMetrics result;
+    result.path = path_;
+    int64_t in_flight = 0;
+    std::map<int, uint64_t> responses;
+    uint64_t other_responses = 0u;
+    uint64_t no_response = 0u;
+    for (const Shard& shard : shards_) {
+      in_flight += shard.in_flight.load(std::memory_order_relaxed);
+      result.requests += shard.requests.load(std::memory_order_relaxed);
+      result.bytes_in += shard.bytes_in.load(std::memory_order_relaxed);
+      result.bytes_out += shard.bytes_out.load(std::memory_order_relaxed);
+      for (const CodeSlot& slot : shard.responses) {
+        const int code = slot.code.load(std::memory_order_acquire);
+        if (code) {
+          responses[code] += slot.count.load(std::memory_order_relaxed);
+        }
+      }
+      other_responses += shard.other_responses.load(std::memory_order_relaxed);
+      no_response += shard.no_response.load(std::memory_order_relaxed);
+    }
+    // The request may be reported as served from a different shard than the one it was started in.
+    result.in_flight = static_cast<uint64_t>(std::max(in_flight, static_cast<int64_t>(0)));
+    for (const auto& response : responses) {
+      if (response.second) {
+        result.responses[current::ToString(response.first)] = response.second;
+      }
+    }
+    if (other_responses) {
+      result.responses["other"] = other_responses;
+    }
+    if (no_response) {
+      result.responses["none"] = no_response;
+    }
+    result.parse_time = Histogram::Snapshot(shards_, &Shard::parse_time);
+    result.handler_time = Histogram::Snapshot(shards_, &Shard::handler_time);
+    return result;
+  }
+
+ private:
+  constexpr static int kMinCode = 100;
+  constexpr static int kMaxCode = 600;
+  constexpr static size_t kCodeSlots = 16u;
+
+  // The counter of the responses with the status code `code`, or a free one while `code` is zero.
+  struct CodeSlot final {
+    std::atomic<int> code{0};
+    std::atomic<uint64_t> count{0u};
+  };
+
+  struct Histogram final {
+    std::atomic<uint64_t> counts[kBuckets + 1u];
+    std::atomic<uint64_t> sum_us;
+
+    Histogram() : sum_us(0u) {
+      for (auto& count : counts) {
+        count.store(0u, std::memory_order_relaxed);
+      }
+    }
+
+    void Record(std::chrono::microseconds value) {
+      const uint64_t us = static_cast<uint64_t>(std::max(value.count(), static_cast<int64_t>(0)));
+      const uint64_t* buckets_us = BucketsUs();
+      size_t i = 0u;
+      while (i < kBuckets && us > buckets_us[i]) {
+        ++i;
+      }
+      counts[i].fetch_add(1u, std::memory_order_relaxed);
+      sum_us.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    template <typename SHARDS, typename SHARD>
+    static HTTPServerLatencyHistogram Snapshot(const SHARDS& shards, Histogram SHARD::*histogram) {
+      HTTPServerLatencyHistogram result;
+      result.buckets_us.assign(BucketsUs(), BucketsUs() + kBuckets);
+      result.counts.assign(kBuckets + 1u, 0u);
+      for (const auto& shard : shards) {
+        for (size_t i = 0u; i <= kBuckets; ++i) {
+          const uint64_t count = (shard.*histogram).counts[i].load(std::memory_order_relaxed);
+          result.counts[i] += count;
+          result.count += count;
+        }
+        result.sum_us += (shard.*histogram).sum_us.load(std::memory_order_relaxed);
+      }
+      return result;
+    }
+  };
+
+  struct alignas(64) Shard final {
+    std::atomic<int64_t> in_flight{0};
+    std::atomic<uint64_t> requests{0u};
+    std::atomic<uint64_t> bytes_in{0u};
+    std::atomic<uint64_t> bytes_out{0u};
+    CodeSlot responses[kCodeSlots];
+    std::atomic<uint64_t> other_responses{0u};
+    std::atomic<uint64_t> no_response{0u};
+    Histogram parse_time;
+    Histogram handler_time;
+  };
+
+  const std::string path_;
+  Shard shards_[CURRENT_HTTP_SERVER_METRICS_SHARDS];
+};
+
+// Renders the metrics in the Prometheus text exposition format.
+inline std::string HTTPServerMetricsAsPrometheusText(const HTTPServerMetrics& metrics) {
+  std::ostringstream os;
+  const std::string port = current::ToString(metrics.port);
+  const auto Escaped = [](const std::string& s) {
+    std::string result;
+    for (const char c : s) {
+      if (c == '\\' || c == '"') {
+        result += '\\';
+        result += c;
+      } else if (c == '\n') {
+        result += "\\n";
+      } else {
+        result += c;
+      }
+    }
+    return result;
+  };
+  std::vector<const HTTPServerRouteMetrics*> routes;
+  for (const auto& route : metrics.routes) {
+    routes.push_back(&route);
+  }
+  routes.push_back(&metrics.unmatched);
+
+  const auto Header = [&os](const char* name, const char* type, const char* help) {
+    os << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+  };
+  const auto Labels = [&](const HTTPServerRouteMetrics& route) {
+    return "port=\"" + port + "\",route=\"" + Escaped(route.path) + '"';
+  };
+  const auto PerRoute =
+      [&](const char* name, const char* type, const char* help, uint64_t HTTPServerRouteMetrics::*field) {
+        Header(name, type, help);
+        for (const auto* route : routes) {
+          os << name << '{' << Labels(*route) << "} " << (*route).*field << '\n';
+        }
+      };
+  const auto Seconds = [](uint64_t us) {
+    std::ostringstream seconds;
+    seconds << static_cast<double>(us) * 1e-6;
+    return seconds.str();
+  };
+  const auto PerRouteHistogram =
+      [&](const char* name, const char* help, HTTPServerLatencyHistogram HTTPServerRouteMetrics::*field) {
+        Header(name, "histogram", help);
+        for (const auto* route : routes) {
+          const HTTPServerLatencyHistogram& histogram = (*route).*field;
+          uint64_t cumulative = 0u;
+          for (size_t i = 0u; i < histogram.buckets_us.size(); ++i) {
+            cumulative += histogram.counts[i];
+            os << name << "_bucket{" << Labels(*route) << ",le=\"" << Seconds(histogram.buckets_us[i]) << "\"} "
+               << cumulative << '\n';
+          }
+          os << name << "_bucket{" << Labels(*route) << ",le=\"+Inf\"} " << histogram.count << '\n';
+          os << name << "_sum{" << Labels(*route) << "} " << Seconds(histogram.sum_us) << '\n';
+          os << name << "_count{" << Labels(*route) << "} " << histogram.count << '\n';
+        }
+      };
+
+  PerRoute("current_http_requests_total", "counter", "The requests served.", &HTTPServerRouteMetrics::requests);
+  Header("current_http_responses_total", "counter", "The responses sent, by status code.");
+  for (const auto* route : routes) {
+    for (const auto& response : route->responses) {
+      os << "current_http_responses_total{" << Labels(*route) << ",code=\"" << response.first << "\"} "
+         << response.second << '\n';
+    }
+  }
+  PerRoute("current_http_requests_in_flight",
+           "gauge",
+           "The requests being served.",
+           &HTTPServerRouteMetrics::in_flight);
+  PerRoute("current_http_request_bytes_total",
+           "counter",
+           "The bytes received, the heads and the bodies of the requests.",
+           &HTTPServerRouteMetrics::bytes_in);
+  PerRoute("current_http_response_bytes_total",
+           "counter",
+           "The bytes sent, the heads and the bodies of the responses.",
+           &HTTPServerRouteMetrics::bytes_out);
+  PerRouteHistogram("current_http_parse_duration_seconds",
+                    "The time spent receiving and parsing the requests.",
+                    &HTTPServerRouteMetrics::parse_time);
+  PerRouteHistogram("current_http_handler_duration_seconds",
+                    "The time from the request parsed to the response sent.",
+                    &HTTPServerRouteMetrics::handler_time);
+  Header("current_http_open_connections", "gauge", "The requests being served and the idle persistent connections.");
+  os << "current_http_open_connections{port=\"" << port << "\"} " << metrics.open_connections << '\n';
+  Header("current_http_idle_connections", "gauge", "The idle persistent connections.");
+  os << "current_http_idle_connections{port=\"" << port << "\"} " << metrics.idle_connections << '\n';
+  return os.str();
+}
+
+}  // namespace http
+}  // namespace current
+
+#endif  // BLOCKS_HTTP_IMPL_SERVER_METRICS_H
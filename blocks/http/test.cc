@@ -33,7 +33,11 @@ SOFTWARE.
 #include "docu/server/docu_03httpserver_04_test.cc"
 #include "docu/server/docu_03httpserver_05_test.cc"
 
+#include <atomic>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 
 #include "api.h"
 
@@ -44,6 +48,7 @@ SOFTWARE.
 #include "../../bricks/dflags/dflags.h"
 #include "../../bricks/strings/join.h"
 #include "../../bricks/strings/printf.h"
+#include "../../bricks/util/sha256.h"
 #include "../../bricks/util/singleton.h"
 #include "../../bricks/file/file.h"
 #include "../../bricks/exception.h"
@@ -113,6 +118,7 @@ TEST(HTTPAPI, RegisterExceptions) {
   ASSERT_THROW(static_cast<void>(http_server.Register("/wrong_slash/", nullptr)), PathEndsWithSlash);
   // The curly brackets are not necessarily wrong, but `URL::IsPathValidToRegister()` is `false` for them.
   ASSERT_THROW(static_cast<void>(http_server.Register("/{}", nullptr)), PathContainsInvalidCharacters);
+  ASSERT_THROW(static_cast<void>(http_server.Register("/empty//component", nullptr)), PathContainsInvalidCharacters);
 }
 
 TEST(HTTPAPI, RegisterWithURLPathParams) {
@@ -185,6 +191,133 @@ TEST(HTTPAPI, RegisterWithURLPathParams) {
   EXPECT_EQ("/ (foo, bar/baz, meh) ", run("/foo/bar%2Fbaz/meh"));
 }
 
+TEST(HTTPAPI, RoutesFollowUpdatesAndUnRegistrations) {
+  using namespace current::http;
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port));
+
+  const auto run = [port](const std::string& path) -> std::string {
+    const auto response = HTTP(GET(Printf("http://localhost:%d", port) + path));
+    return response.code == HTTPResponseCode.OK ? response.body : current::ToString(static_cast<int>(response.code));
+  };
+  const auto handler = [](const std::string& name) {
+    return [name](Request r) { r(name + " " + r.url.path + " (" + current::strings::Join(r.url_path_args, ", ") + ")"); };
+  };
+
+  auto root = http_server.Register("/", URLPathArgs::CountMask::Any, handler("root"));
+  {
+    const auto scope = http_server.Register("/a/b", handler("ab"));
+    auto scope_one_arg = http_server.Register("/a/b", URLPathArgs::CountMask::One, handler("ab"));
+    EXPECT_EQ(2u, http_server.PathHandlersCount());
+    EXPECT_EQ("ab /a/b ()", run("/a/b"));
+    EXPECT_EQ("ab /a/b (c)", run("/a/b/c"));
+    EXPECT_EQ("root / (a, b, c, d)", run("/a/b/c/d"));
+    EXPECT_EQ("root / (a)", run("/a"));
+    EXPECT_EQ("root / (a, x%y)", run("/a/x%25y"));
+
+    // The intermediate "/a" node has no handlers until this one is registered.
+    auto a = http_server.Register("/a", URLPathArgs::CountMask::Three, handler("a"));
+    EXPECT_EQ("a /a (b, c, d)", run("/a/b/c/d"));
+    EXPECT_EQ("ab /a/b (c)", run("/a/b/c"));
+
+    static_cast<void>(http_server.Register<ReRegisterRoute::SilentlyUpdateExisting>(
+        "/a/b", URLPathArgs::CountMask::One, handler("ab2")));
+    EXPECT_EQ("ab /a/b ()", run("/a/b"));
+    EXPECT_EQ("ab2 /a/b (c)", run("/a/b/c"));
+
+    scope_one_arg = nullptr;
+    EXPECT_EQ("ab /a/b ()", run("/a/b"));
+    EXPECT_EQ("root / (a, b, c)", run("/a/b/c"));
+    ASSERT_THROW(http_server.UnRegister("/a/b", URLPathArgs::CountMask::One), HandlerDoesNotExistException);
+    ASSERT_THROW(http_server.UnRegister("/a/b/c"), HandlerDoesNotExistException);
+  }
+  EXPECT_EQ(1u, http_server.PathHandlersCount());
+  EXPECT_EQ("root / (a, b)", run("/a/b"));
+  root = nullptr;
+  EXPECT_EQ("404", run("/"));
+  EXPECT_EQ(0u, http_server.PathHandlersCount());
+}
+
+TEST(HTTPAPI, PerRouteMetrics) {
+  using namespace current::http;
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port));
+
+  const auto scope =
+      http_server.Register("/ok", [](Request r) { r("OK\n"); }) +
+      http_server.Register("/echo",
+                           URLPathArgs::CountMask::One,
+                           [](Request r) { r(r.body, HTTPResponseCode.Created); }) +
+      http_server.Register("/metrics", http_server.MetricsHandler());
+
+  const std::string url = Printf("http://localhost:%d", port);
+  EXPECT_EQ("OK\n", HTTP(GET(url + "/ok")).body);
+  EXPECT_EQ("OK\n", HTTP(GET(url + "/ok")).body);
+  EXPECT_EQ(201, static_cast<int>(HTTP(POST(url + "/echo/x", "payload", "text/plain")).code));
+  EXPECT_EQ(404, static_cast<int>(HTTP(GET(url + "/nope")).code));
+
+  // The requests are reported once their connections are released, which may happen after the responses arrive.
+  const auto Route = [](const HTTPServerMetrics& metrics, const std::string& path) {
+    for (const auto& route : metrics.routes) {
+      if (route.path == path) {
+        return route;
+      }
+    }
+    return HTTPServerRouteMetrics();
+  };
+  HTTPServerMetrics metrics;
+  do {
+    metrics = http_server.Metrics();
+  } while (Route(metrics, "/ok").requests < 2u || Route(metrics, "/echo").requests < 1u || !metrics.unmatched.requests);
+
+  EXPECT_EQ(port, static_cast<int>(metrics.port));
+  const auto ok = Route(metrics, "/ok");
+  EXPECT_EQ(2u, ok.requests);
+  EXPECT_EQ(0u, ok.in_flight);
+  EXPECT_EQ("{\"200\":2}", JSON(ok.responses));
+  EXPECT_EQ(2u, ok.handler_time.count);
+  EXPECT_EQ(ok.handler_time.buckets_us.size() + 1u, ok.handler_time.counts.size());
+  EXPECT_EQ(2u, ok.parse_time.count);
+  EXPECT_LT(2u * 20u, ok.bytes_in);
+  EXPECT_LT(2u * 20u, ok.bytes_out);
+
+  const auto echo = Route(metrics, "/echo");
+  EXPECT_EQ(1u, echo.requests);
+  EXPECT_EQ("{\"201\":1}", JSON(echo.responses));
+  EXPECT_LT(static_cast<uint64_t>(strlen("payload")), echo.bytes_in);
+
+  EXPECT_EQ("", metrics.unmatched.path);
+  EXPECT_EQ("{\"404\":1}", JSON(metrics.unmatched.responses));
+
+  // The metrics endpoint sees itself in flight.
+  const auto json = ParseJSON<HTTPServerMetrics>(HTTP(GET(url + "/metrics")).body);
+  EXPECT_EQ(2u, Route(json, "/ok").requests);
+  EXPECT_EQ(1u, Route(json, "/metrics").in_flight);
+  EXPECT_LE(1u, json.open_connections);
+
+  const auto prometheus = HTTP(GET(url + "/metrics?format=prometheus"));
+  EXPECT_EQ("text/plain; version=0.0.4; charset=utf-8", prometheus.headers.Get("Content-Type"));
+  const std::string labels = Printf("{port=\"%d\",route=\"/ok\"", port);
+  EXPECT_NE(std::string::npos, prometheus.body.find("# TYPE current_http_requests_total counter\n"));
+  EXPECT_NE(std::string::npos, prometheus.body.find("current_http_requests_total" + labels + "} 2\n"));
+  EXPECT_NE(std::string::npos, prometheus.body.find("current_http_responses_total" + labels + ",code=\"200\"} 2\n"));
+  EXPECT_NE(std::string::npos, prometheus.body.find("current_http_handler_duration_seconds_bucket" + labels +
+                                                    ",le=\"+Inf\"} 2\n"));
+  EXPECT_NE(std::string::npos, prometheus.body.find("current_http_handler_duration_seconds_count" + labels + "} 2\n"));
+  EXPECT_EQ("text/plain; version=0.0.4; charset=utf-8",
+            HTTP(GET(url + "/metrics").SetHeader("Accept", "text/plain")).headers.Get("Content-Type"));
+
+  // The metrics of a route are freed once it is unregistered.
+  {
+    const auto temporary_scope = http_server.Register("/temporary", [](Request r) { r("OK\n"); });
+    EXPECT_EQ("/temporary", Route(http_server.Metrics(), "/temporary").path);
+  }
+  EXPECT_EQ("", Route(http_server.Metrics(), "/temporary").path);
+  EXPECT_EQ("/ok", Route(http_server.Metrics(), "/ok").path);
+}
+
 TEST(HTTPAPI, ComposeURLPathWithURLPathArgs) {
   auto reserved_port = current::net::ReserveLocalPort();
   const int port = reserved_port;
@@ -372,6 +505,182 @@ TEST(HTTPAPI, ConnectionIPAndPort) {
   EXPECT_EQ(1u, http_server.PathHandlersCount());
 }
 
+TEST(HTTPAPI, SlowHandlerDoesNotBlockOtherRequests) {
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port), current::http::HTTPServerOptions().SetWorkerThreads(2u));
+
+  // The "/slow" handler only completes once "/fast" has been served, which requires handling them concurrently.
+  std::atomic_bool fast_served(false);
+  const auto scope = http_server.Register("/slow",
+                                          [&fast_served](Request r) {
+                                            while (!fast_served) {
+                                              std::this_thread::yield();
+                                            }
+                                            r("slow");
+                                          }) +
+                     http_server.Register("/fast", [&fast_served](Request r) {
+                       r("fast");
+                       fast_served = true;
+                     });
+  std::string slow_response;
+  std::thread slow_request([&]() { slow_response = HTTP(GET(Printf("http://localhost:%d/slow", port))).body; });
+  EXPECT_EQ("fast", HTTP(GET(Printf("http://localhost:%d/fast", port))).body);
+  slow_request.join();
+  EXPECT_EQ("slow", slow_response);
+}
+
+TEST(HTTPAPI, KeepAlive) {
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port));
+
+  std::set<uint16_t> client_ports;
+  std::mutex client_ports_mutex;
+  const auto scope = http_server.Register("/keepalive", [&](Request r) {
+    {
+      std::lock_guard<std::mutex> lock(client_ports_mutex);
+      client_ports.insert(r.connection.RemoteIPAndPort().port);
+    }
+    r(r.url.query.get("q", "?"));
+  });
+
+  Connection connection(current::net::ClientSocket("localhost", port));
+  // Three requests sent at once, the last one asking to close the connection after the response.
+  connection.BlockingWrite(
+      "GET /keepalive?q=one HTTP/1.1\r\n\r\n"
+      "POST /keepalive?q=two HTTP/1.1\r\nContent-Length: 4\r\n\r\nBODY"
+      "GET /keepalive?q=three HTTP/1.1\r\nConnection: close\r\n\r\n",
+      false);
+
+  // The responses are parsed by the same logic as the requests, reusing the read buffer the same way.
+  current::net::HTTPReadBuffer read_buffer;
+  for (const std::string expected : {"one", "two", "three"}) {
+    current::net::HTTPRequestData response(connection, std::move(read_buffer));
+    EXPECT_EQ("200", response.RawPath());
+    EXPECT_EQ(expected, response.Body());
+    EXPECT_EQ(expected == "three" ? "close" : "keep-alive", response.headers().Get("Connection"));
+    read_buffer = response.ReleaseReadBufferForNextRequest();
+  }
+  EXPECT_EQ(0u, read_buffer.carried_over_bytes);
+  EXPECT_EQ(1u, client_ports.size());
+}
+
+TEST(HTTPAPI, KeepAliveDoesNotWaitForTheRestOfCarriedOverBytes) {
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port), current::http::HTTPServerOptions().SetWorkerThreads(1u));
+
+  const auto scope = http_server.Register("/keepalive", [](Request r) { r(r.body.empty() ? "GET" : r.body); });
+
+  // The final CRLF and the trailers of a chunked body, and a stray CRLF after the request, must not pin the only
+  // worker waiting for the next request on these connections.
+  Connection chunked(current::net::ClientSocket("localhost", port));
+  chunked.BlockingWrite(
+      "POST /keepalive HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+      "4\r\nBODY\r\n0\r\nX-Trailer: ignored\r\n\r\n",
+      false);
+  current::net::HTTPReadBuffer chunked_read_buffer;
+  {
+    current::net::HTTPRequestData response(chunked, std::move(chunked_read_buffer));
+    EXPECT_EQ("BODY", response.Body());
+    chunked_read_buffer = response.ReleaseReadBufferForNextRequest();
+  }
+
+  Connection stray_crlf(current::net::ClientSocket("localhost", port));
+  stray_crlf.BlockingWrite("GET /keepalive HTTP/1.1\r\n\r\n\r\n", false);
+  {
+    current::net::HTTPRequestData response(stray_crlf);
+    EXPECT_EQ("GET", response.Body());
+  }
+
+  // Nor must a request head that has only partly arrived.
+  Connection partial_head(current::net::ClientSocket("localhost", port));
+  partial_head.BlockingWrite("GET /keepalive HTTP/1.1\r\n", false);
+
+  EXPECT_EQ("GET", HTTP(GET(Printf("http://localhost:%d/keepalive", port))).body);
+
+  partial_head.BlockingWrite("Connection: close\r\n\r\n", false);
+  {
+    current::net::HTTPRequestData response(partial_head);
+    EXPECT_EQ("GET", response.Body());
+  }
+
+  // Both connections remain usable.
+  chunked.BlockingWrite("POST /keepalive HTTP/1.1\r\nContent-Length: 4\r\n\r\nMORE", false);
+  {
+    current::net::HTTPRequestData response(chunked, std::move(chunked_read_buffer));
+    EXPECT_EQ("MORE", response.Body());
+  }
+  stray_crlf.BlockingWrite("GET /keepalive HTTP/1.1\r\nConnection: close\r\n\r\n", false);
+  {
+    current::net::HTTPRequestData response(stray_crlf);
+    EXPECT_EQ("GET", response.Body());
+  }
+}
+
+TEST(HTTPAPI, KeepAliveCanBeDisabled) {
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port), current::http::HTTPServerOptions().SetKeepAlive(false));
+
+  const auto scope = http_server.Register("/close", [](Request r) { r("OK"); });
+  Connection connection(current::net::ClientSocket("localhost", port));
+  connection.BlockingWrite("GET /close HTTP/1.1\r\n\r\n", false);
+  current::net::HTTPRequestData response(connection);
+  EXPECT_EQ("OK", response.Body());
+  EXPECT_EQ("close", response.headers().Get("Connection"));
+}
+
+TEST(HTTPAPI, ClientReusesConnections) {
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port));
+
+  std::set<uint16_t> client_ports;
+  std::mutex client_ports_mutex;
+  const auto scope = http_server.Register("/pooled", [&](Request r) {
+    {
+      std::lock_guard<std::mutex> lock(client_ports_mutex);
+      client_ports.insert(r.connection.RemoteIPAndPort().port);
+    }
+    r("OK");
+  });
+
+  auto& pool = current::Singleton<current::http::HTTPClientConnectionPool>();
+  pool.Clear();
+
+  for (size_t i = 0; i < 5u; ++i) {
+    EXPECT_EQ("OK", HTTP(GET(Printf("http://localhost:%d/pooled", port))).body);
+    EXPECT_EQ("OK", HTTP(POST(Printf("http://localhost:%d/pooled", port), "body")).body);
+  }
+  EXPECT_EQ(1u, client_ports.size());
+  EXPECT_EQ(1u, pool.IdleConnections());
+
+  pool.SetEnabled(false);
+  for (size_t i = 0; i < 3u; ++i) {
+    EXPECT_EQ("OK", HTTP(GET(Printf("http://localhost:%d/pooled", port))).body);
+  }
+  EXPECT_EQ(4u, client_ports.size());
+  EXPECT_EQ(0u, pool.IdleConnections());
+  pool.SetEnabled(true);
+}
+
+TEST(HTTPAPI, ClientDoesNotReuseClosedConnections) {
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port), current::http::HTTPServerOptions().SetKeepAlive(false));
+
+  const auto scope = http_server.Register("/not_pooled", [](Request r) { r("OK"); });
+
+  auto& pool = current::Singleton<current::http::HTTPClientConnectionPool>();
+  pool.Clear();
+  for (size_t i = 0; i < 3u; ++i) {
+    EXPECT_EQ("OK", HTTP(GET(Printf("http://localhost:%d/not_pooled", port))).body);
+  }
+  EXPECT_EQ(0u, pool.IdleConnections());
+}
+
 TEST(HTTPAPI, RespondsWithString) {
   auto reserved_port = current::net::ReserveLocalPort();
   const int port = reserved_port;
@@ -1605,6 +1914,11 @@ TEST(HTTPAPI, ServeStaticFilesFromOptionsCustomRoutePrefix) {
               sub_sub_dir_response.url);
     EXPECT_EQ("<h1>HTML sub_sub_dir index</h1>", sub_sub_dir_response.body);
   }
+
+  // The requests for all the static files are counted under a single route.
+  const auto metrics = http_server.Metrics();
+  ASSERT_EQ(1u, metrics.routes.size());
+  EXPECT_EQ("/static/something/*", metrics.routes.front().path);
 }
 
 TEST(HTTPAPI, ServeStaticFilesFromOptionsCustomRoutePrefixAndPublicUrlPrefixRelative) {
@@ -1833,6 +2147,81 @@ TEST(HTTPAPI, ServeStaticFilesFromOnlyServesFilesOfKnownMIMEType) {
   ASSERT_THROW(http_server.ServeStaticFilesFrom(dir), ServeStaticFilesFromCanNotServeStaticFilesOfUnknownMIMEType);
 }
 
+TEST(HTTPAPI, ServeStaticFilesFromDiskWithETagsRangesAndGzippedSiblings) {
+  using namespace current::http;
+
+  FileSystem::MkDir(FLAGS_net_api_test_tmpdir, FileSystem::MkDirParameters::Silent);
+  const std::string dir = FileSystem::JoinPath(FLAGS_net_api_test_tmpdir, "static_from_disk");
+  const auto dir_remover = current::FileSystem::ScopedRmDir(dir);
+  FileSystem::MkDir(dir, FileSystem::MkDirParameters::Silent);
+  FileSystem::WriteStringToFile("0123456789", FileSystem::JoinPath(dir, "digits.txt").c_str());
+  FileSystem::WriteStringToFile("Not really gzipped.", FileSystem::JoinPath(dir, "digits.txt.gz").c_str());
+  FileSystem::WriteStringToFile("<h1>Index</h1>", FileSystem::JoinPath(dir, "index.html").c_str());
+
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port));
+  const auto scope =
+      http_server.ServeStaticFilesFrom(dir, ServeStaticFilesFromOptions("/", "", {"index.html"}, true));
+  // The `.gz` sibling is not a route of its own.
+  EXPECT_EQ(3u, http_server.PathHandlersCount());
+
+  const std::string url = Printf("http://localhost:%d/digits.txt", port);
+  const auto response = HTTP(GET(url));
+  EXPECT_EQ(200, static_cast<int>(response.code));
+  EXPECT_EQ("0123456789", response.body);
+  EXPECT_EQ("text/plain", response.headers.Get("Content-Type"));
+  EXPECT_EQ('"' + current::SHA256("0123456789") + '"', response.headers.Get("ETag"));
+  EXPECT_EQ("bytes", response.headers.Get("Accept-Ranges"));
+  EXPECT_EQ("Accept-Encoding", response.headers.Get("Vary"));
+  EXPECT_FALSE(response.headers.Has("Content-Encoding"));
+  ASSERT_TRUE(response.headers.Has("Last-Modified"));
+  const std::string etag = response.headers.Get("ETag");
+  const std::string last_modified = response.headers.Get("Last-Modified");
+
+  {
+    const auto gzipped = HTTP(GET(url).SetHeader("Accept-Encoding", "deflate, gzip"));
+    EXPECT_EQ(200, static_cast<int>(gzipped.code));
+    EXPECT_EQ("Not really gzipped.", gzipped.body);
+    EXPECT_EQ("gzip", gzipped.headers.Get("Content-Encoding"));
+    EXPECT_NE(etag, gzipped.headers.Get("ETag"));
+    EXPECT_EQ("0123456789", HTTP(GET(url).SetHeader("Accept-Encoding", "gzip;q=0")).body);
+  }
+
+  {
+    EXPECT_EQ(304, static_cast<int>(HTTP(GET(url).SetHeader("If-None-Match", etag)).code));
+    EXPECT_EQ(304, static_cast<int>(HTTP(GET(url).SetHeader("If-None-Match", "\"foo\", W/" + etag)).code));
+    EXPECT_EQ(200, static_cast<int>(HTTP(GET(url).SetHeader("If-None-Match", "\"foo\"")).code));
+    EXPECT_EQ(304, static_cast<int>(HTTP(GET(url).SetHeader("If-Modified-Since", last_modified)).code));
+    EXPECT_EQ(200,
+              static_cast<int>(
+                  HTTP(GET(url).SetHeader("If-Modified-Since", "Sun, 24 Apr 2016 01:31:01 GMT")).code));
+  }
+
+  {
+    const auto partial = HTTP(GET(url).SetHeader("Range", "bytes=2-4"));
+    EXPECT_EQ(206, static_cast<int>(partial.code));
+    EXPECT_EQ("234", partial.body);
+    EXPECT_EQ("bytes 2-4/10", partial.headers.Get("Content-Range"));
+    EXPECT_EQ("789", HTTP(GET(url).SetHeader("Range", "bytes=7-")).body);
+    EXPECT_EQ("89", HTTP(GET(url).SetHeader("Range", "bytes=-2")).body);
+    EXPECT_EQ("56789", HTTP(GET(url).SetHeader("Range", "bytes=5-100")).body);
+    EXPECT_EQ("0123456789", HTTP(GET(url).SetHeader("Range", "bytes=0-1,5-6")).body);
+    EXPECT_EQ("0123456789", HTTP(GET(url).SetHeader("Range", "bytes=2-4").SetHeader("If-Range", "\"foo\"")).body);
+    EXPECT_EQ("234", HTTP(GET(url).SetHeader("Range", "bytes=2-4").SetHeader("If-Range", etag)).body);
+    const auto unsatisfiable = HTTP(GET(url).SetHeader("Range", "bytes=10-"));
+    EXPECT_EQ(416, static_cast<int>(unsatisfiable.code));
+    EXPECT_EQ("bytes */10", unsatisfiable.headers.Get("Content-Range"));
+  }
+
+  {
+    const auto index = HTTP(GET(Printf("http://localhost:%d/", port)));
+    EXPECT_EQ(200, static_cast<int>(index.code));
+    EXPECT_EQ("<h1>Index</h1>", index.body);
+    EXPECT_FALSE(index.headers.Has("Vary"));
+  }
+}
+
 TEST(HTTPAPI, ResponseSmokeTest) {
   const auto send_response = [](const Response& response, Request request) { request(response); };
 
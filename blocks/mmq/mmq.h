@@ -45,7 +45,19 @@ SOFTWARE.
 //      the messages will be added in the order in which the functions were called. However, for any particular
 //      thread, MMQ DOES GUARANTEE that the order of messages published from this thread will be respected.
 //  Default behavior of MMQ is non-dropping and can be controlled via the `DROP_ON_OVERFLOW` template argument.
-
+//
+// The synchronization between the publishers and the consumer is controlled via the `SYNC` template argument:
+//   1) `MMQSync::Mutex`, the default, guards the buffer with a mutex, and wakes the threads via a condition variable.
+//   2) `MMQSync::LockFreeSinglePublisher` is a lock-free ring buffer, for the case where only one thread publishes.
+//   3) `MMQSync::LockFreeMultiplePublishers` is the same ring buffer, which allows any number of publishing threads.
+//  In the lock-free modes each slot of the buffer carries a sequence number, which tells whether it is free,
+//  or ready to be consumed. The threads waiting for a slot spin for a while first, and then park on a condition
+//  variable, which the other side only signals if someone is parked. The above overflow semantics hold.
+//  With multiple publishers, the publishers themselves are NOT lock-free with respect to each other: the index and
+//  the timestamp of the next message are assigned together, in a short critical section guarded by a spinlock,
+//  which only compares and stores them. The consumer never waits for it, and neither does the copying of the messages.
+
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
@@ -273,8 +285,248 @@ class MMQImpl {
   std::thread consumer_thread_;
 };
 
-template <typename MESSAGE, typename CONSUMER, size_t DEFAULT_BUFFER_SIZE = 1024, bool DROP_ON_OVERFLOW = false>
-using MMQ = ss::EntryPublisher<MMQImpl<MESSAGE, CONSUMER, DEFAULT_BUFFER_SIZE, DROP_ON_OVERFLOW>, MESSAGE>;
+template <typename MESSAGE,
+          typename CONSUMER,
+          size_t DEFAULT_BUFFER_SIZE = 1024,
+          bool DROP_ON_OVERFLOW = false,
+          bool MULTIPLE_PUBLISHERS = true>
+class LockFreeMMQImpl {
+  static_assert(current::ss::IsEntrySubscriber<CONSUMER, MESSAGE>::value, "");
+
+ public:
+  using message_t = MESSAGE;
+  using consumer_t = CONSUMER;
+
+  LockFreeMMQImpl(consumer_t& consumer, size_t buffer_size = DEFAULT_BUFFER_SIZE)
+      : consumer_(consumer), circular_buffer_size_(buffer_size), circular_buffer_(circular_buffer_size_) {
+    for (size_t i = 0u; i < circular_buffer_size_; ++i) {
+      circular_buffer_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    consumer_thread_ = std::thread(&LockFreeMMQImpl::ConsumerThread, this);
+  }
+
+  // The destructor waits for the consumer thread to terminate.
+  ~LockFreeMMQImpl() {
+    destructing_ = true;
+    {
+      std::lock_guard<std::mutex> lock(park_mutex_);
+      park_condition_variable_.notify_all();
+    }
+    consumer_thread_.join();
+  }
+
+ protected:
+  // THREAD SAFE if `MULTIPLE_PUBLISHERS` is set. Otherwise, only one thread at a time may be publishing.
+  template <current::locks::MutexLockStatus, typename TIMESTAMP>  // `MutexLockStatus` is unused by MMQ.
+  idxts_t PublisherPublishImpl(const message_t& message, TIMESTAMP&& timestamp) {
+    return DoPublish(message, std::forward<TIMESTAMP>(timestamp));
+  }
+
+  template <current::locks::MutexLockStatus, typename TIMESTAMP>  // `MutexLockStatus` is unused by MMQ.
+  idxts_t PublisherPublishImpl(message_t&& message, TIMESTAMP&& timestamp) {
+    return DoPublish(std::move(message), std::forward<TIMESTAMP>(timestamp));
+  }
+
+ private:
+  LockFreeMMQImpl(const LockFreeMMQImpl&) = delete;
+  LockFreeMMQImpl(LockFreeMMQImpl&&) = delete;
+  void operator=(const LockFreeMMQImpl&) = delete;
+  void operator=(LockFreeMMQImpl&&) = delete;
+
+  // The entry at the 0-based position `p` is free for the publisher if its `sequence` is `p`,
+  // and is ready for the consumer if its `sequence` is `p + 1`.
+  struct Entry {
+    std::atomic<uint64_t> sequence;
+    idxts_t index_timestamp;
+    message_t message_body;
+  };
+
+  // The number of attempts to check the condition before parking the thread, and, of them, before yielding.
+  constexpr static size_t kSpinIterations = 256u;
+  constexpr static size_t kSpinIterationsBeforeYielding = 64u;
+
+  template <typename M, typename TIMESTAMP>
+  idxts_t DoPublish(M&& message, TIMESTAMP&& user_timestamp) {
+    idxts_t index_timestamp;
+    Entry* entry;
+    if (!ClaimEntry(std::forward<TIMESTAMP>(user_timestamp), index_timestamp, entry)) {
+      return idxts_t();
+    }
+    entry->index_timestamp = index_timestamp;
+    entry->message_body = std::forward<M>(message);
+    // The entry of the 0-based position `index - 1` is ready for the consumer once its sequence number is `index`.
+    entry->sequence.store(index_timestamp.index, std::memory_order_release);
+    WakeUpParkedThreads();
+    return index_timestamp;
+  }
+
+  // Allocates the next entry, assigning it the index and the timestamp. Returns false if the message is dropped.
+  // The `claim_state_` is the number of allocated entries times two, plus one while the allocation is in progress.
+  // Thus the index and the timestamp are always assigned together, and it also serves as the seqlock for `LastIdxTs()`.
+  // The clock is read before the allocation, so that the other publishers do not wait for it. As the publishers
+  // may then enter the allocation in a different order, the default timestamp is bumped to keep them increasing,
+  // while the timestamp provided by the caller must be greater than the last one, or the exception is thrown.
+  template <typename TIMESTAMP>
+  bool ClaimEntry(TIMESTAMP&& user_timestamp, idxts_t& output_index_timestamp, Entry*& output_entry) {
+    constexpr bool is_default_timestamp =
+        std::is_same_v<current::decay_t<TIMESTAMP>, current::time::DefaultTimeArgument>;
+    const auto provided_timestamp = current::time::TimestampAsMicroseconds(user_timestamp);
+    while (true) {
+      uint64_t state = claim_state_.load(std::memory_order_relaxed);
+      if constexpr (MULTIPLE_PUBLISHERS) {
+        // Back off while another publisher holds the claim, yielding to it if it has been preempted.
+        for (size_t attempt = 0u; (state & 1u) || !claim_state_.compare_exchange_weak(state,
+                                                                                       state | 1u,
+                                                                                       std::memory_order_acquire,
+                                                                                       std::memory_order_relaxed);
+             ++attempt) {
+          if (attempt >= kSpinIterationsBeforeYielding) {
+            std::this_thread::yield();
+          }
+          state = claim_state_.load(std::memory_order_relaxed);
+        }
+      } else {
+        claim_state_.store(state | 1u, std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_release);
+
+      const uint64_t position = state >> 1;
+      Entry& entry = circular_buffer_[position % circular_buffer_size_];
+      if (entry.sequence.load(std::memory_order_acquire) != position) {
+        // Overflow. Release the claim, and either discard the message or wait until the entry is consumed.
+        claim_state_.store(state, std::memory_order_release);
+        if (DROP_ON_OVERFLOW || destructing_) {
+          return false;
+        }
+        if (!SpinThenPark([&entry, position]() {
+              return entry.sequence.load(std::memory_order_acquire) >= position;
+            })) {
+          return false;  // LCOV_EXCL_LINE
+        }
+        continue;
+      }
+
+      auto timestamp = provided_timestamp;
+      const std::chrono::microseconds last_timestamp(last_timestamp_us_.load(std::memory_order_relaxed));
+      if (!(timestamp > last_timestamp)) {
+        if (is_default_timestamp) {
+          timestamp = last_timestamp + std::chrono::microseconds(1);
+        } else {
+          claim_state_.store(state, std::memory_order_release);
+          CURRENT_THROW(ss::InconsistentTimestampException(last_timestamp + std::chrono::microseconds(1), timestamp));
+        }
+      }
+      last_timestamp_us_.store(timestamp.count(), std::memory_order_relaxed);
+      claim_state_.store((position + 1u) << 1, std::memory_order_release);
+
+      output_index_timestamp = idxts_t(position + 1u, timestamp);
+      output_entry = &entry;
+      return true;
+    }
+  }
+
+  // The index and the timestamp of the most recently allocated entry.
+  idxts_t LastIdxTs() const {
+    while (true) {
+      const uint64_t state = claim_state_.load(std::memory_order_acquire);
+      if (!(state & 1u)) {
+        const int64_t us = last_timestamp_us_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (claim_state_.load(std::memory_order_relaxed) == state) {
+          return idxts_t(state >> 1, std::chrono::microseconds(us));
+        }
+      }
+    }
+  }
+
+  // Spins for a while, then parks the calling thread until `ready()` holds. Returns false if destructing.
+  template <typename F>
+  bool SpinThenPark(F&& ready) {
+    for (size_t i = 0u; i < kSpinIterations; ++i) {
+      if (destructing_) {
+        return false;
+      }
+      if (ready()) {
+        return true;
+      }
+      if (i >= kSpinIterationsBeforeYielding) {
+        std::this_thread::yield();
+      }
+    }
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    parked_threads_.fetch_add(1u);
+    // Pairs with the fence in `WakeUpParkedThreads()`: either `ready()` observes the update,
+    // or the updating thread observes this thread as parked, and notifies it under `park_mutex_`.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    park_condition_variable_.wait(lock, [this, &ready]() { return destructing_ || ready(); });
+    parked_threads_.fetch_sub(1u);
+    return !destructing_;
+  }
+
+  void WakeUpParkedThreads() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked_threads_.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(park_mutex_);
+      park_condition_variable_.notify_all();
+    }
+  }
+
+  // The thread which extracts fully populated messages from the tail of the buffer and feeds them to the consumer.
+  void ConsumerThread() {
+    // The `tail` position is local to the processing thread.
+    uint64_t tail = 0u;
+    while (true) {
+      Entry& entry = circular_buffer_[tail % circular_buffer_size_];
+      if (!SpinThenPark([&entry, tail]() { return entry.sequence.load(std::memory_order_acquire) == tail + 1u; })) {
+        return;
+      }
+      consumer_(std::move(entry.message_body), entry.index_timestamp, LastIdxTs());
+      // Mark the entry as free for the publisher which will get to it on the next pass over the buffer.
+      entry.sequence.store(tail + circular_buffer_size_, std::memory_order_release);
+      ++tail;
+      WakeUpParkedThreads();
+    }
+  }
+
+  // The instance of the consuming side of the FIFO buffer.
+  consumer_t& consumer_;
+
+  const size_t circular_buffer_size_;
+
+  std::vector<Entry> circular_buffer_;
+
+  // The publishing side and the consuming side are kept on separate cache lines.
+  alignas(64) std::atomic<uint64_t> claim_state_{0u};
+  std::atomic<int64_t> last_timestamp_us_{-1};
+
+  alignas(64) std::atomic_bool destructing_{false};
+  std::atomic<size_t> parked_threads_{0u};
+  std::mutex park_mutex_;
+  std::condition_variable park_condition_variable_;
+
+  std::thread consumer_thread_;
+};
+
+// The synchronization between the publishers and the consumer, see the comment at the top of this file.
+enum class MMQSync : int { Mutex = 0, LockFreeSinglePublisher = 1, LockFreeMultiplePublishers = 2 };
+
+template <typename MESSAGE, typename CONSUMER, size_t DEFAULT_BUFFER_SIZE, bool DROP_ON_OVERFLOW, MMQSync SYNC>
+using MMQImplForSync =
+    std::conditional_t<SYNC == MMQSync::Mutex,
+                       MMQImpl<MESSAGE, CONSUMER, DEFAULT_BUFFER_SIZE, DROP_ON_OVERFLOW>,
+                       LockFreeMMQImpl<MESSAGE,
+                                       CONSUMER,
+                                       DEFAULT_BUFFER_SIZE,
+                                       DROP_ON_OVERFLOW,
+                                       SYNC == MMQSync::LockFreeMultiplePublishers>>;
+
+template <typename MESSAGE,
+          typename CONSUMER,
+          size_t DEFAULT_BUFFER_SIZE = 1024,
+          bool DROP_ON_OVERFLOW = false,
+          MMQSync SYNC = MMQSync::Mutex>
+using MMQ =
+    ss::EntryPublisher<MMQImplForSync<MESSAGE, CONSUMER, DEFAULT_BUFFER_SIZE, DROP_ON_OVERFLOW, SYNC>, MESSAGE>;
 
 }  // namespace mmq
 }  // namespace current
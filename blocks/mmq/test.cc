@@ -39,6 +39,7 @@ SOFTWARE.
 
 using current::mmq::MMPQ;
 using current::mmq::MMQ;
+using current::mmq::MMQSync;
 using current::ss::EntryResponse;
 
 TEST(InMemoryMQ, SmokeTest) {
@@ -265,6 +266,100 @@ TEST(InMemoryMQ, TimeShouldNotGoBack) {
   }
 }
 
+TEST(InMemoryMQ, LockFreeSmokeTest) {
+  current::time::ResetToZero();
+
+  SuspendableConsumer c1;
+  {
+    MMQ<std::string, SuspendableConsumer, 4, false, MMQSync::LockFreeSinglePublisher> mmq(c1);
+    static_assert(current::ss::IsEntryPublisher<decltype(mmq), std::string>::value, "");
+    for (size_t i = 0; i < 25; ++i) {
+      EXPECT_EQ(i + 1u, mmq.Publish(current::strings::Printf("M%02d", static_cast<int>(i))).index);
+    }
+    while (c1.processed_messages_ != 25u) {
+      std::this_thread::yield();
+    }
+  }
+  ASSERT_EQ(25u, c1.messages_.size());
+  EXPECT_EQ("M00", c1.messages_.front());
+  EXPECT_EQ("M24", c1.messages_.back());
+  EXPECT_EQ(25u, c1.total_messages_accepted_by_the_queue_);
+
+  SuspendableConsumer c2;
+  {
+    MMQ<std::string, SuspendableConsumer, 4, false, MMQSync::LockFreeMultiplePublishers> mmq(c2);
+    static_assert(current::ss::IsEntryPublisher<decltype(mmq), std::string>::value, "");
+    mmq.Publish("one", std::chrono::microseconds(100));
+    mmq.Publish("two", std::chrono::microseconds(200));
+    ASSERT_THROW(mmq.Publish("three", std::chrono::microseconds(150)), current::ss::InconsistentTimestampException);
+    mmq.Publish("four", std::chrono::microseconds(300));
+    while (c2.processed_messages_ != 3u) {
+      std::this_thread::yield();
+    }
+  }
+  EXPECT_EQ("one two four", current::strings::Join(c2.messages_, ' '));
+  EXPECT_EQ(3u, c2.total_messages_accepted_by_the_queue_);
+}
+
+TEST(InMemoryMQ, LockFreeDropOnOverflowTest) {
+  current::time::ResetToZero();
+
+  SuspendableConsumer c;
+  MMQ<std::string, SuspendableConsumer, 10, true, MMQSync::LockFreeMultiplePublishers> mmq(c);
+
+  // Same as `DropOnOverflowTest` above: with the consumer suspended, 10 out of 25 messages are accepted.
+  c.suspend_processing_ = true;
+  size_t messages_accepted = 0u;
+  for (size_t i = 0; i < 25; ++i) {
+    if (mmq.Publish(current::strings::Printf("M%02d", static_cast<int>(i))).index) {
+      ++messages_accepted;
+    }
+  }
+  EXPECT_EQ(10u, messages_accepted);
+
+  c.suspend_processing_ = false;
+  while (c.processed_messages_ != 10u) {
+    std::this_thread::yield();
+  }
+  mmq.Publish("Plus one");
+  while (c.processed_messages_ != 11u) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(11u, c.total_messages_accepted_by_the_queue_);
+  EXPECT_EQ(11u, std::set<std::string>(begin(c.messages_), end(c.messages_)).size());
+}
+
+TEST(InMemoryMQ, LockFreeWaitOnOverflowTest) {
+  current::time::ResetToZero();
+
+  SuspendableConsumer c;
+
+  // Many producers, and the buffer much smaller than the number of messages, to have them wait for each other.
+  MMQ<std::string, SuspendableConsumer, 10, false, MMQSync::LockFreeMultiplePublishers> mmq(c);
+
+  const auto producer = [&](char prefix, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      mmq.Publish(current::strings::Printf("%c%04d", prefix, static_cast<int>(i)));
+    }
+  };
+
+  std::vector<std::thread> producers;
+  for (size_t i = 0; i < 10; ++i) {
+    producers.emplace_back(producer, static_cast<char>('a' + i), 1000u);
+  }
+  for (auto& p : producers) {
+    p.join();
+  }
+
+  while (c.processed_messages_ != 10000u) {
+    std::this_thread::yield();
+  }
+
+  // Confirm that none of the messages were dropped, and that all of them are unique.
+  EXPECT_EQ(10000u, c.total_messages_accepted_by_the_queue_);
+  EXPECT_EQ(10000u, std::set<std::string>(c.messages_.begin(), c.messages_.end()).size());
+}
+
 TEST(InMemoryMQ, MMPQAllowsTimeExplicitlyGoingBack) {
   current::time::ResetToZero();
 
@@ -27,13 +27,34 @@ SOFTWARE.
 // The file is replayed at startup to check its integriry and to extract the most recent index/timestamp.
 // Each iterator opens the same file again, to read its first N lines.
 // Iterators never outlive the persister.
+//
+// Optionally, a sidecar binary index file, `<filename>.idx`, is maintained alongside the file.
+// When present and valid, only the tail of the file published after the last index sync is replayed at startup.
+//
+// Optionally, instead of opening the file again, iterators read it via a shared memory mapping of its published part.
+//
+// The entries published by one `Publish()` or `PublishBatch()` call are written into the file with a single `write()`.
+// The `FilePersisterDurability` option defines whether they are flushed right away, and whether they are `fsync()`-ed.
 
 #ifndef BLOCKS_PERSISTENCE_FILE_H
 #define BLOCKS_PERSISTENCE_FILE_H
 
+#include "../../port.h"
+
 #include <atomic>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
 #include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+#ifndef CURRENT_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // CURRENT_WINDOWS
 
 #ifdef CURRENT_BUILD_WITH_PARANOIC_RUNTIME_CHECKS
 #include <iostream>
@@ -54,6 +75,29 @@ SOFTWARE.
 namespace current {
 namespace persistence {
 
+// When the published entries are written and flushed into the file, and thus become visible to the readers.
+enum class FilePersisterDurability : int {
+  FlushPerPublish = 0,  // Each `Publish()` and each `PublishBatch()` is flushed right away. The default.
+  FlushEveryN = 1,      // Once at least `flush_every_n` entries are pending, or on `Flush()` or `UpdateHead()`.
+  FlushEveryT = 2,      // Once `flush_every_t` has passed since the last flush, by a background thread if need be.
+  FSyncPerPublish = 3   // As `FlushPerPublish`, followed by an `fsync()`. No `fsync()` on Windows.
+};
+
+// The optional knobs of the file persister. The default ones keep the file the only thing written to disk.
+struct FilePersisterOptions {
+  // Maintain the sidecar `<filename>.idx` binary index, to only replay the tail of the file at startup.
+  bool use_index_file = false;
+
+  // Have the iterators read the entries from the memory-mapped file, shared by all of them. Ignored on Windows.
+  bool use_mmap_reads = false;
+
+  // With `FlushEveryN` and `FlushEveryT`, the pending entries are already indexed and timestamped,
+  // but `Size()`, iteration and subscribers only see them once they are flushed.
+  FilePersisterDurability durability = FilePersisterDurability::FlushPerPublish;
+  uint64_t flush_every_n = 1000u;
+  std::chrono::microseconds flush_every_t = std::chrono::milliseconds(10);
+};
+
 namespace impl {
 
 namespace constants {
@@ -61,17 +105,161 @@ constexpr char kDirectiveMarker = '#';
 constexpr char kSignatureDirective[] = "#signature";
 constexpr char kHeadDirective[] = "#head";
 constexpr char kHeadFormatString[] = "%020lld";
+constexpr char kIndexFileSuffix[] = ".idx";
+constexpr uint64_t kIndexFileMagic = 0x3130584449543543ull;  // "C5TIDX01", little-endian.
+constexpr uint64_t kIndexFileChecksumBasis = 14695981039346656037ull;  // FNV-1a, 64-bit.
+constexpr uint64_t kIndexFileChecksumPrime = 1099511628211ull;
 }  // namespace constants
 
 typedef int64_t head_value_t;
 
+// The sidecar index file: fixed-width `{offset, timestamp}` records, one per entry, followed by the trailer.
+// The trailer holds the number of records and the running FNV-1a checksum of their bytes,
+// and is rewritten after each appended record. The records are stored in the native byte order.
+// An index file with a missing, torn, or mismatching trailer is ignored, and rebuilt after the full replay.
+class FilePersisterIndexFile final {
+ public:
+  struct Record {
+    int64_t offset;
+    int64_t us;
+  };
+  struct Trailer {
+    uint64_t magic;
+    uint64_t count;
+    uint64_t checksum;
+  };
+  static_assert(sizeof(Record) == 16, "");
+  static_assert(sizeof(Trailer) == 24, "");
+
+  explicit FilePersisterIndexFile(std::string filename) : filename_(std::move(filename)) {}
+
+  // Returns `false` if the index file does not exist or is invalid, in which case the output vectors are untouched.
+  bool Load(std::vector<std::streampos>& offsets, std::vector<std::chrono::microseconds>& timestamps) {
+    std::ifstream fi(filename_, std::ios::binary);
+    if (!fi) {
+      return false;
+    }
+    fi.seekg(0, std::ios::end);
+    const auto size = static_cast<int64_t>(fi.tellg());
+    if (size < static_cast<int64_t>(sizeof(Trailer)) || (size - sizeof(Trailer)) % sizeof(Record)) {
+      return false;
+    }
+    const uint64_t count = (size - sizeof(Trailer)) / sizeof(Record);
+    Trailer trailer;
+    fi.seekg(count * sizeof(Record), std::ios::beg);
+    if (!fi.read(reinterpret_cast<char*>(&trailer), sizeof(Trailer)) || trailer.magic != constants::kIndexFileMagic ||
+        trailer.count != count) {
+      return false;
+    }
+    std::vector<Record> records(static_cast<size_t>(count));
+    fi.seekg(0, std::ios::beg);
+    if (count && !fi.read(reinterpret_cast<char*>(&records[0]), count * sizeof(Record))) {
+      return false;
+    }
+    uint64_t checksum = constants::kIndexFileChecksumBasis;
+    for (const Record& record : records) {
+      checksum = UpdateChecksum(checksum, record);
+    }
+    if (checksum != trailer.checksum) {
+      return false;
+    }
+    for (size_t i = 1u; i < records.size(); ++i) {
+      if (!(records[i].offset > records[i - 1].offset) || !(records[i].us > records[i - 1].us)) {
+        return false;
+      }
+    }
+    offsets.resize(records.size());
+    timestamps.resize(records.size());
+    for (size_t i = 0u; i < records.size(); ++i) {
+      offsets[i] = std::streampos(records[i].offset);
+      timestamps[i] = std::chrono::microseconds(records[i].us);
+    }
+    count_ = count;
+    checksum_ = checksum;
+    file_.open(filename_, std::ios::in | std::ios::out | std::ios::binary);
+    return static_cast<bool>(file_);
+  }
+
+  // Overwrites the index file with the provided records.
+  void Rebuild(const std::vector<std::streampos>& offsets, const std::vector<std::chrono::microseconds>& timestamps) {
+    CURRENT_ASSERT(offsets.size() == timestamps.size());
+    if (file_.is_open()) {
+      file_.close();
+    }
+    file_.open(filename_, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    count_ = 0u;
+    checksum_ = constants::kIndexFileChecksumBasis;
+    std::vector<Record> records(offsets.size());
+    for (size_t i = 0u; i < offsets.size(); ++i) {
+      records[i].offset = static_cast<int64_t>(offsets[i]);
+      records[i].us = timestamps[i].count();
+      checksum_ = UpdateChecksum(checksum_, records[i]);
+    }
+    if (!records.empty()) {
+      file_.write(reinterpret_cast<const char*>(&records[0]), records.size() * sizeof(Record));
+    }
+    count_ = records.size();
+    WriteTrailerAndFlush();
+  }
+
+  // Appends the records from index `begin` on. They are written over the previous trailer with one `write()`,
+  // and the new trailer follows them.
+  void Append(const std::vector<std::streampos>& offsets,
+              const std::vector<std::chrono::microseconds>& timestamps,
+              size_t begin) {
+    CURRENT_ASSERT(offsets.size() == timestamps.size());
+    if (begin >= offsets.size()) {
+      return;
+    }
+    std::vector<Record> records(offsets.size() - begin);
+    for (size_t i = 0u; i < records.size(); ++i) {
+      records[i].offset = static_cast<int64_t>(offsets[begin + i]);
+      records[i].us = timestamps[begin + i].count();
+      checksum_ = UpdateChecksum(checksum_, records[i]);
+    }
+    file_.seekp(count_ * sizeof(Record), std::ios::beg);
+    file_.write(reinterpret_cast<const char*>(&records[0]), records.size() * sizeof(Record));
+    count_ += records.size();
+    WriteTrailerAndFlush();
+  }
+
+  bool bad() const { return file_.bad(); }
+
+ private:
+  static uint64_t UpdateChecksum(uint64_t checksum, const Record& record) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(&record);
+    for (size_t i = 0u; i < sizeof(Record); ++i) {
+      checksum = (checksum ^ p[i]) * constants::kIndexFileChecksumPrime;
+    }
+    return checksum;
+  }
+
+  void WriteTrailerAndFlush() {
+    Trailer trailer;
+    trailer.magic = constants::kIndexFileMagic;
+    trailer.count = count_;
+    trailer.checksum = checksum_;
+    file_.seekp(count_ * sizeof(Record), std::ios::beg);
+    file_.write(reinterpret_cast<const char*>(&trailer), sizeof(Trailer));
+    file_.flush();
+  }
+
+  const std::string filename_;
+  std::fstream file_;
+  uint64_t count_ = 0u;
+  uint64_t checksum_ = constants::kIndexFileChecksumBasis;
+};
+
 // An iterator to read a file line by line, extracting tab-separated `idxts_t index` and `const char* data`.
 // Validates the entries come in the right order of 0-based indexes, and with strictly increasing timestamps.
 template <typename ENTRY>
 class IteratorOverFileOfPersistedEntries {
  public:
-  IteratorOverFileOfPersistedEntries(std::istream& fi, std::streampos offset, uint64_t index_at_offset)
-      : fi_(fi), next_(index_at_offset, std::chrono::microseconds(0)) {
+  IteratorOverFileOfPersistedEntries(std::istream& fi,
+                                     std::streampos offset,
+                                     uint64_t index_at_offset,
+                                     std::chrono::microseconds us_at_offset = std::chrono::microseconds(0))
+      : fi_(fi), next_(index_at_offset, us_at_offset) {
     CURRENT_ASSERT(!fi_.bad());
     if (offset) {
       fi_.seekg(offset, std::ios_base::beg);
@@ -119,6 +307,61 @@ class IteratorOverFileOfPersistedEntries {
   idxts_t next_;
 };
 
+// A read-only memory mapping of the first `size` bytes of the file, which may extend past its end, for the file
+// to grow into without the mapping being recreated. Only the bytes already written into the file may be read.
+// Once the file outgrows it, a new mapping is created, while the old one stays valid for as long as it is referenced.
+class FilePersisterMappedFile final {
+ public:
+  FilePersisterMappedFile(const FilePersisterMappedFile&) = delete;
+  FilePersisterMappedFile& operator=(const FilePersisterMappedFile&) = delete;
+
+  FilePersisterMappedFile(const std::string& filename, size_t size) {
+#ifndef CURRENT_WINDOWS
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+      void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const char*>(data);
+        size_ = size;
+      }
+      ::close(fd);
+    }
+#else
+    static_cast<void>(filename);
+    static_cast<void>(size);
+#endif  // CURRENT_WINDOWS
+  }
+
+  // The size to map the file of `file_size` bytes with: the next power of two, or, past 64MB, the next multiple
+  // of 64MB, so that the mapping is recreated a logarithmic number of times as the file grows, not per append.
+  static size_t SizeToMap(size_t file_size) {
+    constexpr static size_t kMaxPowerOfTwo = static_cast<size_t>(64u) << 20;
+    if (file_size >= kMaxPowerOfTwo) {
+      return (file_size / kMaxPowerOfTwo + 1u) * kMaxPowerOfTwo;
+    }
+    size_t result = 4096u;
+    while (result <= file_size) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  ~FilePersisterMappedFile() {
+#ifndef CURRENT_WINDOWS
+    if (data_) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif  // CURRENT_WINDOWS
+  }
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0u;
+};
+
 template <typename DESIRED, typename ACTUAL>
 struct MakeSureTheRightTypeIsSerialized {
   template <typename T>
@@ -149,14 +392,50 @@ class FilePersister {
     const std::string filename_;
     std::ofstream file_appender_;
     std::fstream head_rewriter_;
+    std::unique_ptr<FilePersisterIndexFile> index_file_;  // Only if `FilePersisterOptions::use_index_file`.
 
-    // `record_offset_.size() == end.next_index`,
+    // The most recent memory mapping of the file, only if `FilePersisterOptions::use_mmap_reads`.
+    // The mapped readers never read past `written_size_`, the size of the file as written, as the mapping is longer.
+    const bool use_mmap_reads_;
+    mutable std::mutex mapping_mutex_;
+    mutable std::shared_ptr<const FilePersisterMappedFile> mapping_;
+    std::atomic<size_t> written_size_{0u};
+
+    const FilePersisterOptions options_;
+
+    // `record_offset_.size() == pending_end_.next_index`,
     // and `record_offset_[i]` is the record_offset_ in bytes where the line for index `i` begins.
-    std::mutex& publish_mutex_ref_;  // Guards `record_offset_`, `head_offset_` and `record_timestamp_`.
+    std::mutex& publish_mutex_ref_;  // Guards everything below, except for `end_`.
     std::vector<std::streampos> record_offset_;
     std::streampos head_offset_;
     std::vector<std::chrono::microseconds> record_timestamp_;
 
+    // The offset of the end of the file, as written, excluding `pending_lines_`.
+    std::streampos append_offset_;
+
+    // The serialized entries not yet written into the file, and the end including them.
+    std::string pending_lines_;
+    end_t pending_end_;
+    std::chrono::steady_clock::time_point last_write_;
+
+#ifndef CURRENT_WINDOWS
+    // The descriptor to `fsync()` the file through, only with `FilePersisterDurability::FSyncPerPublish`.
+    int fsync_fd_ = -1;
+#endif  // CURRENT_WINDOWS
+
+    // With `FilePersisterDurability::FlushEveryT`, the thread writing the pending lines once they are due,
+    // so that the entries of a burst followed by silence do not stay pending, invisible to the readers.
+    // The thread sleeps until there are pending lines, which the publishers tell it via `flusher_pending_`.
+    // The callback, if set, is called by that thread after each write, to wake up the subscribers.
+    std::mutex flusher_mutex_;  // Locked after `publish_mutex_ref_`, never before it.
+    std::condition_variable flusher_cv_;
+    bool flusher_stop_ = false;
+    bool flusher_pending_ = false;
+    std::mutex flusher_callback_mutex_;  // Held while the callback is called, with no other mutex locked.
+    std::function<void()> flusher_callback_;
+    std::thread flusher_;
+
+    // The end of the entries written into the file, as seen by the readers.
     // Just `std::atomic<end_t> end_;` won't work in g++ until 5.1, ref.
     // http://stackoverflow.com/questions/29824570/segfault-in-stdatomic-load/29824840#29824840
     // std::atomic<end_t> end_;
@@ -170,32 +449,228 @@ class FilePersister {
 
     FilePersisterImpl(std::mutex& publish_mutex_ref,
                       const ss::StreamNamespaceName& namespace_name,
-                      const std::string& filename)
+                      const std::string& filename,
+                      const FilePersisterOptions& options)
         : filename_(filename),
           file_appender_(filename, std::ofstream::app | std::ofstream::ate),
           head_rewriter_(filename, std::ofstream::in | std::ofstream::out),
+          index_file_(options.use_index_file
+                          ? std::make_unique<FilePersisterIndexFile>(filename + constants::kIndexFileSuffix)
+                          : nullptr),
+#ifndef CURRENT_WINDOWS
+          use_mmap_reads_(options.use_mmap_reads),
+#else
+          use_mmap_reads_(false),
+#endif  // CURRENT_WINDOWS
+          options_(options),
           publish_mutex_ref_(publish_mutex_ref),
-          head_offset_(0) {
+          head_offset_(0),
+          last_write_(std::chrono::steady_clock::now()) {
       ValidateFileAndInitializeHead(namespace_name);
-      if (file_appender_.bad() || head_rewriter_.bad()) {
+      if (file_appender_.bad() || head_rewriter_.bad() || (index_file_ && index_file_->bad())) {
         CURRENT_THROW(PersistenceFileNotWritable(filename));
       }
+      append_offset_ = file_appender_.tellp();
+      written_size_.store(static_cast<size_t>(append_offset_));
+      pending_end_ = end_.load();
+#ifndef CURRENT_WINDOWS
+      if (options_.durability == FilePersisterDurability::FSyncPerPublish) {
+        // Any descriptor of the file would do, as `fsync()` flushes the data of the file, not of the descriptor.
+        fsync_fd_ = ::open(filename_.c_str(), O_WRONLY);
+      }
+#endif  // CURRENT_WINDOWS
+      if (options_.durability == FilePersisterDurability::FlushEveryT) {
+        flusher_ = std::thread([this]() { FlusherThread(); });
+      }
+    }
+
+    ~FilePersisterImpl() {
+      if (flusher_.joinable()) {
+        {
+          std::lock_guard<std::mutex> lock(flusher_mutex_);
+          flusher_stop_ = true;
+        }
+        flusher_cv_.notify_one();
+        flusher_.join();
+      }
+      WritePendingLines();
+#ifndef CURRENT_WINDOWS
+      if (fsync_fd_ >= 0) {
+        ::close(fsync_fd_);
+      }
+#endif  // CURRENT_WINDOWS
+    }
+
+    void SetFlusherCallback(std::function<void()> callback) {
+      std::lock_guard<std::mutex> lock(flusher_callback_mutex_);
+      flusher_callback_ = std::move(callback);
+    }
+
+    // Sleeps until there are pending lines, then until they are due, and writes them unless a publish has done it
+    // already. No mutex is held while sleeping but `flusher_mutex_`, and none but `flusher_callback_mutex_` while
+    // calling the callback.
+    void FlusherThread() {
+      while (true) {
+        std::chrono::steady_clock::time_point deadline;
+        {
+          std::unique_lock<std::mutex> lock(flusher_mutex_);
+          flusher_cv_.wait(lock, [this]() { return flusher_stop_ || flusher_pending_; });
+          if (flusher_stop_) {
+            return;
+          }
+        }
+        {
+          std::lock_guard<std::mutex> publish_lock(publish_mutex_ref_);
+          deadline = last_write_ + options_.flush_every_t;
+        }
+        {
+          std::unique_lock<std::mutex> lock(flusher_mutex_);
+          if (flusher_cv_.wait_until(lock, deadline, [this]() { return flusher_stop_; })) {
+            return;
+          }
+        }
+        bool written = false;
+        {
+          std::lock_guard<std::mutex> publish_lock(publish_mutex_ref_);
+          if (!pending_lines_.empty() && std::chrono::steady_clock::now() - last_write_ >= options_.flush_every_t) {
+            WritePendingLines();
+            written = true;
+          }
+          if (pending_lines_.empty()) {
+            std::lock_guard<std::mutex> lock(flusher_mutex_);
+            flusher_pending_ = false;
+          }
+        }
+        if (written) {
+          std::lock_guard<std::mutex> lock(flusher_callback_mutex_);
+          if (flusher_callback_) {
+            flusher_callback_();
+          }
+        }
+      }
+    }
+
+    // Returns the memory mapping of the file covering all the bytes written into it so far.
+    std::shared_ptr<const FilePersisterMappedFile> MappingOfWrittenFile() const {
+      std::lock_guard<std::mutex> lock(mapping_mutex_);
+      const size_t written_size = written_size_.load();
+      if (!mapping_ || mapping_->size() < written_size) {
+        mapping_ = std::make_shared<const FilePersisterMappedFile>(filename_,
+                                                                   FilePersisterMappedFile::SizeToMap(written_size));
+      }
+      return mapping_;
+    }
+
+    // Registers the line of the entry, which must end with a newline, to be written by `WritePendingLines()`.
+    void AddPendingLine(const std::string& line, std::chrono::microseconds timestamp) {
+      CURRENT_ASSERT(record_offset_.size() == pending_end_.next_index);
+      CURRENT_ASSERT(record_timestamp_.size() == pending_end_.next_index);
+      record_offset_.push_back(append_offset_ + static_cast<std::streamoff>(pending_lines_.size()));
+      record_timestamp_.push_back(timestamp);
+      if (pending_lines_.empty() && options_.durability == FilePersisterDurability::FlushEveryT) {
+        {
+          std::lock_guard<std::mutex> lock(flusher_mutex_);
+          flusher_pending_ = true;
+        }
+        flusher_cv_.notify_one();
+      }
+      pending_lines_ += line;
+      pending_end_.last_entry_us = pending_end_.head = timestamp;
+      ++pending_end_.next_index;
+      head_offset_ = 0;
+    }
+
+    // Forgets the pending lines added after the `pending_end` and `pending_lines_size` were taken.
+    void RollbackPendingLines(const end_t& pending_end, size_t pending_lines_size, std::streampos head_offset) {
+      record_offset_.resize(static_cast<size_t>(pending_end.next_index));
+      record_timestamp_.resize(static_cast<size_t>(pending_end.next_index));
+      pending_lines_.resize(pending_lines_size);
+      pending_end_ = pending_end;
+      head_offset_ = head_offset;
+    }
+
+    // Writes the pending lines into the file if the durability policy says it's time to.
+    void WritePendingLinesIfDue() {
+      switch (options_.durability) {
+        case FilePersisterDurability::FlushEveryN:
+          if (pending_end_.next_index - end_.load().next_index >= options_.flush_every_n) {
+            WritePendingLines();
+          }
+          break;
+        case FilePersisterDurability::FlushEveryT:
+          if (std::chrono::steady_clock::now() - last_write_ >= options_.flush_every_t) {
+            WritePendingLines();
+          }
+          break;
+        default:
+          WritePendingLines();
+      }
+    }
+
+    // Writes the pending lines into the file with one `write()`, updates the index file, and makes them visible.
+    void WritePendingLines() {
+      if (!pending_lines_.empty()) {
+        file_appender_.write(pending_lines_.data(), pending_lines_.size());
+        file_appender_.flush();
+        append_offset_ += static_cast<std::streamoff>(pending_lines_.size());
+        written_size_.store(static_cast<size_t>(append_offset_));
+        pending_lines_.clear();
+        if (options_.durability == FilePersisterDurability::FSyncPerPublish) {
+          FSync();
+        }
+      }
+      if (index_file_) {
+        index_file_->Append(record_offset_, record_timestamp_, static_cast<size_t>(end_.load().next_index));
+      }
+      last_write_ = std::chrono::steady_clock::now();
+      end_.store(pending_end_);
+    }
+
+    void FSync() const {
+#ifndef CURRENT_WINDOWS
+      if (fsync_fd_ >= 0) {
+        ::fsync(fsync_fd_);
+      }
+#endif  // CURRENT_WINDOWS
     }
 
     // Replay the file but ignore its contents. Used to initialize `end_` at startup.
+    // With the index file loaded and matching the file, only the tail of the file past the indexed entries is replayed.
     void ValidateFileAndInitializeHead(const ss::StreamNamespaceName& namespace_name) {
       std::ifstream fi(filename_);
       if (!fi.bad()) {
-        // Read through all the lines.
-        // Let `IteratorOverFileOfPersistedEntries` maintain its own `next_`, which later becomes `this->end_`.
-        // While reading the file, record the offset of each record and store it in `record_offset_`.
-        IteratorOverFileOfPersistedEntries<ENTRY> cit(fi, 0, 0);
-        const std::streampos offset_zero(0);
-        auto current_offset = offset_zero;
-        auto head = std::chrono::microseconds(-1);
         reflection::StructSchema struct_schema;
         struct_schema.AddType<ENTRY>();
         const auto signature = JSON(ss::StreamSignature(namespace_name, struct_schema.GetSchemaInfo()));
+        const auto validate_signature = [&signature](const std::string& value) {
+          static const auto signature_key_length = strlen(constants::kSignatureDirective);
+          auto offset = signature_key_length;
+          while (std::isspace(value[offset])) {
+            ++offset;
+          }
+          if (value.compare(offset, signature.length(), signature)) {
+            CURRENT_THROW(InvalidStreamSignature(signature, value.substr(offset)));
+          }
+        };
+
+        const std::streampos offset_zero(0);
+        auto current_offset = offset_zero;
+        auto head = std::chrono::microseconds(-1);
+        idxts_t next(0u, std::chrono::microseconds(0));
+        const size_t indexed_entries =
+            index_file_ ? LoadIndexFileAndFindTail(fi, validate_signature, current_offset) : 0u;
+        if (indexed_entries) {
+          head = record_timestamp_.back();
+          next = idxts_t(indexed_entries, head + std::chrono::microseconds(1));
+        } else {
+          fi.clear();
+          fi.seekg(0, std::ios_base::beg);
+        }
+
+        // Read through all the lines, or through the tail past the indexed entries.
+        // Let `IteratorOverFileOfPersistedEntries` maintain its own `next_`, which later becomes `this->end_`.
+        // While reading the file, record the offset of each record and store it in `record_offset_`.
+        IteratorOverFileOfPersistedEntries<ENTRY> cit(fi, current_offset, next.index, next.us);
         while (cit.ProcessNextEntry(
             [&](const idxts_t& current, const char*) {
               CURRENT_ASSERT(current.index == record_offset_.size());
@@ -229,19 +704,13 @@ class FilePersister {
                 if (current_offset != offset_zero) {
                   CURRENT_THROW(InvalidSignatureLocation());
                 }
-                auto offset = signature_key_length;
-                while (std::isspace(value[offset])) {
-                  ++offset;
-                }
-                if (value.compare(offset, signature.length(), signature)) {
-                  CURRENT_THROW(InvalidStreamSignature(signature, value.substr(offset)));
-                }
+                validate_signature(value);
               }
               current_offset = fi.tellg();
             })) {
           ;
         }
-        const auto& next = cit.Next();
+        next = cit.Next();
         // The `next.us` stores the closest possible next entry timestamp,
         // so the last processed entry timestamp is always 1us less.
         end_.store({next.index, next.us - std::chrono::microseconds(1), head});
@@ -249,10 +718,55 @@ class FilePersister {
         if (!current_offset) {
           file_appender_ << constants::kSignatureDirective << ' ' << signature << std::endl;
         }
+        if (index_file_) {
+          if (indexed_entries) {
+            index_file_->Append(record_offset_, record_timestamp_, indexed_entries);
+          } else {
+            index_file_->Rebuild(record_offset_, record_timestamp_);
+          }
+        }
       } else {
         end_.store({0ull, std::chrono::microseconds(-1), std::chrono::microseconds(-1)});
       }
     }
+
+    // Loads the index file into `record_offset_` and `record_timestamp_`, and confirms it matches the file:
+    // the signature, if present, is the right one, and the last indexed entry is where the index says it is.
+    // Returns the number of indexed entries, and sets `tail_offset` to the offset right after the last one of them.
+    // Returns zero, leaving `record_offset_` and `record_timestamp_` empty, if the full replay is needed.
+    template <typename F>
+    size_t LoadIndexFileAndFindTail(std::ifstream& fi, F&& validate_signature, std::streampos& tail_offset) {
+      if (!index_file_->Load(record_offset_, record_timestamp_) || record_offset_.empty()) {
+        record_offset_.clear();
+        record_timestamp_.clear();
+        return 0u;
+      }
+      std::string line;
+      static const auto signature_key_length = strlen(constants::kSignatureDirective);
+      if (std::getline(fi, line) && !line.compare(0, signature_key_length, constants::kSignatureDirective)) {
+        validate_signature(line);
+      }
+      fi.clear();
+      fi.seekg(record_offset_.back(), std::ios_base::beg);
+      bool last_entry_matches = false;
+      if (std::getline(fi, line) && !fi.eof()) {
+        const size_t tab_pos = line.find('\t');
+        if (tab_pos != std::string::npos) {
+          try {
+            const auto last = ParseJSON<idxts_t>(line.substr(0, tab_pos));
+            last_entry_matches = (last.index + 1u == record_offset_.size() && last.us == record_timestamp_.back());
+          } catch (const current::Exception&) {
+          }
+        }
+      }
+      if (!last_entry_matches) {
+        record_offset_.clear();
+        record_timestamp_.clear();
+        return 0u;
+      }
+      tail_offset = fi.tellg();
+      return record_offset_.size();
+    }
   };
 
  public:
@@ -264,8 +778,65 @@ class FilePersister {
 
   FilePersister(std::mutex& publish_mutex_ref,
                 const ss::StreamNamespaceName& namespace_name,
-                const std::string& filename)
-      : file_persister_impl_(MakeOwned<FilePersisterImpl>(publish_mutex_ref, namespace_name, filename)) {}
+                const std::string& filename,
+                const FilePersisterOptions& options = FilePersisterOptions())
+      : file_persister_impl_(MakeOwned<FilePersisterImpl>(publish_mutex_ref, namespace_name, filename, options)) {}
+
+  // Reads the lines of the entries sequentially from the memory-mapped file, remapping it as the file grows.
+  class MappedEntriesReader final {
+   public:
+    MappedEntriesReader(const FilePersisterImpl& file_persister_impl, std::streampos offset, uint64_t index_at_offset)
+        : file_persister_impl_(file_persister_impl),
+          position_(static_cast<size_t>(offset)),
+          index_at_position_(index_at_offset) {}
+
+    // The entries should be requested in the strictly increasing order of their indexes.
+    std::string_view EntryLine(uint64_t index) {
+      while (true) {
+        const std::string_view line = NextLine();
+        if (line.empty() || line[0] != constants::kDirectiveMarker) {
+          if (index_at_position_ == index) {
+            ++index_at_position_;
+            return line;
+          } else if (index_at_position_ > index) {                                 // LCOV_EXCL_LINE
+            CURRENT_THROW(ss::InconsistentIndexException(index, index_at_position_));  // LCOV_EXCL_LINE
+          }
+          ++index_at_position_;
+        }
+      }
+    }
+
+   private:
+    std::string_view NextLine() {
+      const char* eol = FindEndOfLine();
+      if (!eol) {
+        mapping_ = file_persister_impl_.MappingOfWrittenFile();
+        eol = FindEndOfLine();
+        if (!eol) {
+          // End of file. Should never happen as long as the user only iterates over valid ranges.
+          CURRENT_THROW(current::Exception());  // LCOV_EXCL_LINE
+        }
+      }
+      const char* begin = mapping_->data() + position_;
+      position_ += (eol - begin) + 1u;
+      return std::string_view(begin, eol - begin);
+    }
+
+    // Only looks through the bytes written into the file, as the mapping may extend past its end.
+    const char* FindEndOfLine() const {
+      const size_t end = mapping_ ? std::min(mapping_->size(), file_persister_impl_.written_size_.load()) : 0u;
+      if (position_ < end) {
+        return static_cast<const char*>(::memchr(mapping_->data() + position_, '\n', end - position_));
+      } else {
+        return nullptr;
+      }
+    }
+
+    const FilePersisterImpl& file_persister_impl_;
+    std::shared_ptr<const FilePersisterMappedFile> mapping_;
+    size_t position_;
+    uint64_t index_at_position_;
+  };
 
   class Iterator final {
    public:
@@ -288,8 +859,12 @@ class FilePersister {
              uint64_t index_at_offset)
         : file_persister_impl_(std::move(file_persister_impl)), i_(i) {
       if (!filename.empty()) {
-        fi_ = std::make_unique<std::ifstream>(filename);
-        cit_ = std::make_unique<IteratorOverFileOfPersistedEntries<ENTRY>>(*fi_, offset, index_at_offset);
+        if (file_persister_impl_->use_mmap_reads_) {
+          reader_ = std::make_unique<MappedEntriesReader>(*file_persister_impl_, offset, index_at_offset);
+        } else {
+          fi_ = std::make_unique<std::ifstream>(filename);
+          cit_ = std::make_unique<IteratorOverFileOfPersistedEntries<ENTRY>>(*fi_, offset, index_at_offset);
+        }
       }
     }
 
@@ -297,6 +872,19 @@ class FilePersister {
     // The range-based for-loop works fine. -- D.K.
     Entry operator*() const {
       Entry result;
+      if (reader_) {
+        const std::string_view line = reader_->EntryLine(i_);
+        const size_t tab_pos = line.find('\t');
+        if (tab_pos == std::string::npos) {
+          CURRENT_THROW(MalformedEntryException(std::string(line)));
+        }
+        result.idx_ts = ParseJSON<idxts_t>(std::string(line.substr(0, tab_pos)));
+        if (result.idx_ts.index != i_) {
+          CURRENT_THROW(ss::InconsistentIndexException(i_, result.idx_ts.index));  // LCOV_EXCL_LINE
+        }
+        result.entry = ParseJSON<ENTRY>(std::string(line.substr(tab_pos + 1u)));
+        return result;
+      }
       bool found = false;
       while (!found) {
         if (!(cit_->ProcessNextEntry(
@@ -330,6 +918,7 @@ class FilePersister {
     const Borrowed<FilePersisterImpl> file_persister_impl_;
     std::unique_ptr<std::ifstream> fi_;
     std::unique_ptr<IteratorOverFileOfPersistedEntries<ENTRY>> cit_;
+    std::unique_ptr<MappedEntriesReader> reader_;
     uint64_t i_;
   };
 
@@ -345,20 +934,33 @@ class FilePersister {
                    const std::string& filename,
                    uint64_t i,
                    std::streampos offset,
-                   uint64_t)
+                   uint64_t index_at_offset)
         : file_persister_impl_(std::move(file_persister_impl)), i_(i), current_offset_(offset) {
       if (!filename.empty()) {
-        fi_ = std::make_unique<std::ifstream>(filename);
-        CURRENT_ASSERT(!fi_->bad());
-        if (offset) {
-          fi_->seekg(offset, std::ios_base::beg);
+        if (file_persister_impl_->use_mmap_reads_) {
+          reader_ = std::make_unique<MappedEntriesReader>(*file_persister_impl_, offset, index_at_offset);
+        } else {
+          fi_ = std::make_unique<std::ifstream>(filename);
+          CURRENT_ASSERT(!fi_->bad());
+          if (offset) {
+            fi_->seekg(offset, std::ios_base::beg);
+          }
         }
       }
     }
 
     // `operator*` relies on the fact each entry will be requested at most once.
     // The range-based for-loop works fine. -- D.K.
-    std::string operator*() const {
+    // The returned view is only valid until the iterator is advanced or destroyed. With `use_mmap_reads`, it points
+    // right into the mapped file, with no file reads and no copies involved; otherwise, into the line read.
+    std::string_view operator*() const {
+      if (reader_) {
+        if (!current_line_.data()) {
+          current_line_ = reader_->EntryLine(i_);
+          CURRENT_ASSERT(current_line_.empty() || current_line_[0] != constants::kDirectiveMarker);
+        }
+        return current_line_;
+      }
       if (current_entry_.empty()) {
         const auto offset = file_persister_impl_->record_offset_[static_cast<size_t>(i_)];
         if (offset != current_offset_) {
@@ -378,6 +980,7 @@ class FilePersister {
     IteratorUnsafe& operator++() {
       ++i_;
       current_entry_.clear();
+      current_line_ = std::string_view();
       return *this;
     }
     bool operator==(const IteratorUnsafe& rhs) const { return i_ == rhs.i_; }
@@ -388,9 +991,11 @@ class FilePersister {
     Borrowed<FilePersisterImpl> file_persister_impl_;
     bool valid_ = true;
     std::unique_ptr<std::ifstream> fi_;
+    std::unique_ptr<MappedEntriesReader> reader_;
     uint64_t i_;
     mutable std::string current_entry_;
     mutable std::streampos current_offset_;
+    mutable std::string_view current_line_;
   };
 
   template <typename ITERATOR>
@@ -439,41 +1044,39 @@ class FilePersister {
   template <current::locks::MutexLockStatus MLS, typename E, typename TIMESTAMP>
   idxts_t PersisterPublishImpl(E&& entry, const TIMESTAMP provided_timestamp) {
     current::locks::SmartMutexLockGuard<MLS> lock(file_persister_impl_->publish_mutex_ref_);
+    const auto idxts =
+        AddPendingEntry(std::forward<E>(entry), current::time::TimestampAsMicroseconds(provided_timestamp));
+    file_persister_impl_->WritePendingLinesIfDue();
+    return idxts;
+  }
 
-    end_t iterator = file_persister_impl_->end_.load();
-    const auto timestamp = current::time::TimestampAsMicroseconds(provided_timestamp);
-    if (!(timestamp > iterator.head)) {
-#ifdef CURRENT_BUILD_WITH_PARANOIC_RUNTIME_CHECKS
-      std::cerr << "timestamp: " << timestamp.count() << ", iterator.head: " << iterator.head.count() << std::endl;
-#endif  // CURRENT_BUILD_WITH_PARANOIC_RUNTIME_CHECKS
-      CURRENT_THROW(ss::InconsistentTimestampException(iterator.head + std::chrono::microseconds(1), timestamp));
+  // Publishes the entries of the range timestamped with `current::time::Now()`, and writes them into the file at once.
+  // Either all the entries get published, or, if an exception is thrown, none of them do.
+  // Returns the index and timestamp of the last published entry, unless the range is empty.
+  template <current::locks::MutexLockStatus MLS, typename RANGE>
+  Optional<idxts_t> PersisterPublishBatchImpl(RANGE&& entries) {
+    current::locks::SmartMutexLockGuard<MLS> lock(file_persister_impl_->publish_mutex_ref_);
+    const end_t pending_end = file_persister_impl_->pending_end_;
+    const size_t pending_lines_size = file_persister_impl_->pending_lines_.size();
+    const std::streampos head_offset = file_persister_impl_->head_offset_;
+    Optional<idxts_t> result;
+    try {
+      for (const auto& entry : entries) {
+        result = AddPendingEntry(entry, current::time::Now());
+      }
+    } catch (...) {
+      file_persister_impl_->RollbackPendingLines(pending_end, pending_lines_size, head_offset);
+      throw;
     }
-
-    iterator.last_entry_us = iterator.head = timestamp;
-    const auto idxts = idxts_t(iterator.next_index, iterator.last_entry_us);
-    CURRENT_ASSERT(file_persister_impl_->record_offset_.size() == iterator.next_index);
-    CURRENT_ASSERT(file_persister_impl_->record_timestamp_.size() == iterator.next_index);
-    file_persister_impl_->record_offset_.push_back(file_persister_impl_->file_appender_.tellp());
-    file_persister_impl_->record_timestamp_.push_back(timestamp);
-
-    // Explicit `MakeSureTheRightTypeIsSerialized` is essential, otherwise the `Variant`'s case
-    // would be serialized in an unwrapped way when passed directly.
-    file_persister_impl_->file_appender_ << JSON(idxts) << '\t'
-                                         << JSON(MakeSureTheRightTypeIsSerialized<ENTRY, decay_t<E>>::DoIt(
-                                                std::forward<E>(entry)))
-                                         << std::endl;
-    ++iterator.next_index;
-    file_persister_impl_->head_offset_ = 0;
-    file_persister_impl_->end_.store(iterator);
-
-    return idxts;
+    file_persister_impl_->WritePendingLinesIfDue();
+    return result;
   }
 
   template <current::locks::MutexLockStatus MLS>
   idxts_t PersisterPublishUnsafeImpl(const std::string& raw_log_line) {
     current::locks::SmartMutexLockGuard<MLS> lock(file_persister_impl_->publish_mutex_ref_);
 
-    end_t iterator = file_persister_impl_->end_.load();
+    const end_t iterator = file_persister_impl_->pending_end_;
     const auto tab_pos = raw_log_line.find('\t');
     if (tab_pos == std::string::npos) {
       CURRENT_THROW(MalformedEntryException(raw_log_line));
@@ -486,16 +1089,8 @@ class FilePersister {
       CURRENT_THROW(ss::InconsistentTimestampException(iterator.head + std::chrono::microseconds(1), idxts.us));
     }
 
-    iterator.last_entry_us = iterator.head = idxts.us;
-    CURRENT_ASSERT(file_persister_impl_->record_offset_.size() == idxts.index);
-    CURRENT_ASSERT(file_persister_impl_->record_timestamp_.size() == idxts.index);
-    file_persister_impl_->record_offset_.push_back(file_persister_impl_->file_appender_.tellp());
-    file_persister_impl_->record_timestamp_.push_back(idxts.us);
-
-    file_persister_impl_->file_appender_ << raw_log_line << std::endl;
-    ++iterator.next_index;
-    file_persister_impl_->head_offset_ = 0;
-    file_persister_impl_->end_.store(iterator);
+    file_persister_impl_->AddPendingLine(raw_log_line + '\n', idxts.us);
+    file_persister_impl_->WritePendingLinesIfDue();
 
     return idxts;
   }
@@ -504,11 +1099,13 @@ class FilePersister {
   void PersisterUpdateHeadImpl(const TIMESTAMP provided_timestamp) {
     current::locks::SmartMutexLockGuard<MLS> lock(file_persister_impl_->publish_mutex_ref_);
 
-    end_t iterator = file_persister_impl_->end_.load();
+    end_t iterator = file_persister_impl_->pending_end_;
     const auto timestamp = current::time::TimestampAsMicroseconds(provided_timestamp);
     if (!(timestamp > iterator.head)) {
       CURRENT_THROW(ss::InconsistentTimestampException(iterator.head + std::chrono::microseconds(1), timestamp));
     }
+    // The head directive must follow the entries preceding it.
+    file_persister_impl_->WritePendingLines();
     iterator.head = timestamp;
     const auto head_str = Printf(constants::kHeadFormatString, static_cast<long long>(timestamp.count()));
     if (file_persister_impl_->head_offset_) {
@@ -516,14 +1113,31 @@ class FilePersister {
       rewriter.seekp(file_persister_impl_->head_offset_, std::ios_base::beg);
       rewriter << head_str << std::endl;
     } else {
-      auto& file_appender_ = file_persister_impl_->file_appender_;
-      file_appender_ << constants::kHeadDirective << ' ';
-      file_persister_impl_->head_offset_ = file_appender_.tellp();
-      file_appender_ << head_str << std::endl;
+      const std::string head_directive_prefix = std::string(constants::kHeadDirective) + ' ';
+      file_persister_impl_->head_offset_ =
+          file_persister_impl_->append_offset_ + static_cast<std::streamoff>(head_directive_prefix.length());
+      file_persister_impl_->file_appender_ << head_directive_prefix << head_str << std::endl;
+      file_persister_impl_->append_offset_ +=
+          static_cast<std::streamoff>(head_directive_prefix.length() + head_str.length() + 1u);
+      file_persister_impl_->written_size_.store(static_cast<size_t>(file_persister_impl_->append_offset_));
     }
+    file_persister_impl_->pending_end_ = iterator;
     file_persister_impl_->end_.store(iterator);
   }
 
+  // Writes the entries pending per the `FilePersisterDurability` policy into the file, making them visible.
+  template <current::locks::MutexLockStatus MLS>
+  void PersisterFlushImpl() {
+    current::locks::SmartMutexLockGuard<MLS> lock(file_persister_impl_->publish_mutex_ref_);
+    file_persister_impl_->WritePendingLines();
+  }
+
+  // With `FilePersisterDurability::FlushEveryT`, `callback` is called after each write made by the background thread.
+  // Pass an empty function to stop calling it; once this returns, the previous callback is no longer being called.
+  void SetBackgroundFlushCallback(std::function<void()> callback) {
+    file_persister_impl_->SetFlusherCallback(std::move(callback));
+  }
+
   template <current::locks::MutexLockStatus MLS>
   bool PersisterEmptyImpl() const {
     return !file_persister_impl_->end_.load().next_index;
@@ -564,22 +1178,26 @@ class FilePersister {
                                                                         std::chrono::microseconds till) const {
     std::pair<uint64_t, uint64_t> result{static_cast<uint64_t>(-1), static_cast<uint64_t>(-1)};
     current::locks::SmartMutexLockGuard<MLS> lock(file_persister_impl_->publish_mutex_ref_);
+    // Only the entries visible to the readers count, not the pending ones.
+    const auto timestamps_begin = file_persister_impl_->record_timestamp_.begin();
+    const auto timestamps_end =
+        timestamps_begin + static_cast<std::ptrdiff_t>(file_persister_impl_->end_.load().next_index);
     const auto begin_it =
-        std::lower_bound(file_persister_impl_->record_timestamp_.begin(),
-                         file_persister_impl_->record_timestamp_.end(),
+        std::lower_bound(timestamps_begin,
+                         timestamps_end,
                          from,
                          [](std::chrono::microseconds entry_t, std::chrono::microseconds t) { return entry_t < t; });
-    if (begin_it != file_persister_impl_->record_timestamp_.end()) {
-      result.first = std::distance(file_persister_impl_->record_timestamp_.begin(), begin_it);
+    if (begin_it != timestamps_end) {
+      result.first = std::distance(timestamps_begin, begin_it);
     }
     if (till.count() > 0) {
       const auto end_it =
-          std::upper_bound(file_persister_impl_->record_timestamp_.begin(),
-                           file_persister_impl_->record_timestamp_.end(),
+          std::upper_bound(timestamps_begin,
+                           timestamps_end,
                            till,
                            [](std::chrono::microseconds t, std::chrono::microseconds entry_t) { return t < entry_t; });
-      if (end_it != file_persister_impl_->record_timestamp_.end()) {
-        result.second = std::distance(file_persister_impl_->record_timestamp_.begin(), end_it);
+      if (end_it != timestamps_end) {
+        result.second = std::distance(timestamps_begin, end_it);
       }
     }
     return result;
@@ -652,6 +1270,26 @@ class FilePersister {
   }
 
  private:
+  // Serializes the entry into the pending lines. Must be called with the publish mutex locked.
+  template <typename E>
+  idxts_t AddPendingEntry(E&& entry, std::chrono::microseconds timestamp) {
+    const end_t& iterator = file_persister_impl_->pending_end_;
+    if (!(timestamp > iterator.head)) {
+#ifdef CURRENT_BUILD_WITH_PARANOIC_RUNTIME_CHECKS
+      std::cerr << "timestamp: " << timestamp.count() << ", iterator.head: " << iterator.head.count() << std::endl;
+#endif  // CURRENT_BUILD_WITH_PARANOIC_RUNTIME_CHECKS
+      CURRENT_THROW(ss::InconsistentTimestampException(iterator.head + std::chrono::microseconds(1), timestamp));
+    }
+    const auto idxts = idxts_t(iterator.next_index, timestamp);
+    // Explicit `MakeSureTheRightTypeIsSerialized` is essential, otherwise the `Variant`'s case
+    // would be serialized in an unwrapped way when passed directly.
+    file_persister_impl_->AddPendingLine(
+        JSON(idxts) + '\t' +
+            JSON(MakeSureTheRightTypeIsSerialized<ENTRY, decay_t<E>>::DoIt(std::forward<E>(entry))) + '\n',
+        timestamp);
+    return idxts;
+  }
+
   Owned<FilePersisterImpl> file_persister_impl_;  // `Owned`, as iterators borrow it.
 };
 
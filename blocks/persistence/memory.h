@@ -166,6 +166,31 @@ class MemoryPersister {
     return idxts_t(index, timestamp);
   }
 
+  template <current::locks::MutexLockStatus MLS, typename RANGE>
+  Optional<idxts_t> PersisterPublishBatchImpl(RANGE&& entries) {
+    current::locks::SmartMutexLockGuard<MLS> lock(container_->memory_persister_container_mutex_);
+    const auto original_size = container_->entries_.size();
+    const auto original_head = container_->head_;
+    Optional<idxts_t> result;
+    try {
+      for (const auto& entry : entries) {
+        const auto timestamp = current::time::Now();
+        if (!(timestamp > container_->head_)) {
+          CURRENT_THROW(
+              ss::InconsistentTimestampException(container_->head_ + std::chrono::microseconds(1), timestamp));
+        }
+        result = idxts_t(static_cast<uint64_t>(container_->entries_.size()), timestamp);
+        container_->entries_.emplace_back(timestamp, entry);
+        container_->head_ = timestamp;
+      }
+    } catch (...) {
+      container_->entries_.resize(original_size);
+      container_->head_ = original_head;
+      throw;
+    }
+    return result;
+  }
+
   template <current::locks::MutexLockStatus MLS>
   idxts_t PersisterPublishUnsafeImpl(const std::string& raw_log_line) {
     current::locks::SmartMutexLockGuard<MLS> lock(container_->memory_persister_container_mutex_);
@@ -200,6 +225,10 @@ class MemoryPersister {
     container_->head_ = timestamp;
   }
 
+  // Everything published is visible right away, there is nothing to flush.
+  template <current::locks::MutexLockStatus MLS>
+  void PersisterFlushImpl() {}
+
   template <current::locks::MutexLockStatus MLS>
   bool PersisterEmptyImpl() const {
     current::locks::SmartMutexLockGuard<MLS> lock(container_->memory_persister_container_mutex_);
@@ -321,7 +321,7 @@ TEST(PersistenceLayer, File) {
       EXPECT_EQ("foo 0 100,bar 1 200", Join(first_two, ","));
       std::vector<std::string> first_two_unsafe;
       for (const auto& e : impl.IterateUnsafe()) {
-        first_two_unsafe.push_back(e);
+        first_two_unsafe.emplace_back(e);
       }
       EXPECT_EQ(
           "{\"index\":0,\"us\":100}\t{\"s\":\"foo\"},"
@@ -350,7 +350,7 @@ TEST(PersistenceLayer, File) {
       EXPECT_EQ("foo 0 100,bar 1 200,meh 2 500", Join(all_three, ","));
       std::vector<std::string> all_three_unsafe;
       for (const auto& e : impl.IterateUnsafe()) {
-        all_three_unsafe.push_back(e);
+        all_three_unsafe.emplace_back(e);
       }
       EXPECT_EQ(
           "{\"index\":0,\"us\":100}\t{\"s\":\"foo\"},"
@@ -387,7 +387,7 @@ TEST(PersistenceLayer, File) {
       EXPECT_EQ("foo 0 100,bar 1 200,meh 2 500", Join(all_three, ","));
       std::vector<std::string> all_three_unsafe;
       for (const auto& e : impl.IterateUnsafe()) {
-        all_three_unsafe.push_back(e);
+        all_three_unsafe.emplace_back(e);
       }
       EXPECT_EQ(
           "{\"index\":0,\"us\":100}\t{\"s\":\"foo\"},"
@@ -414,7 +414,7 @@ TEST(PersistenceLayer, File) {
       EXPECT_EQ("foo 0 100,bar 1 200,meh 2 500,blah 3 999", Join(all_four, ","));
       std::vector<std::string> all_four_unsafe;
       for (const auto& e : impl.IterateUnsafe()) {
-        all_four_unsafe.push_back(e);
+        all_four_unsafe.emplace_back(e);
       }
       EXPECT_EQ(
           "{\"index\":0,\"us\":100}\t{\"s\":\"foo\"},"
@@ -439,7 +439,7 @@ TEST(PersistenceLayer, File) {
     EXPECT_EQ("foo 0 100,bar 1 200,meh 2 500,blah 3 999", Join(all_four, ","));
     std::vector<std::string> all_four_unsafe;
     for (const auto& e : impl.IterateUnsafe()) {
-      all_four_unsafe.push_back(e);
+      all_four_unsafe.emplace_back(e);
     }
     EXPECT_EQ(
         "{\"index\":0,\"us\":100}\t{\"s\":\"foo\"},"
@@ -556,6 +556,493 @@ TEST(PersistenceLayer, FileDirectives) {
       current::FileSystem::ReadFileAsString(persistence_file_name));
 }
 
+TEST(PersistenceLayer, FileWithIndex) {
+  current::time::ResetToZero();
+
+  using namespace persistence_test;
+
+  using IMPL = current::persistence::File<StorableString>;
+
+  const auto namespace_name = current::ss::StreamNamespaceName("namespace", "entry_name");
+  const std::string persistence_file_name = current::FileSystem::JoinPath(FLAGS_persistence_test_tmpdir, "data");
+  const std::string index_file_name = persistence_file_name + ".idx";
+  const auto file_remover = current::FileSystem::ScopedRmFile(persistence_file_name);
+  const auto index_file_remover = current::FileSystem::ScopedRmFile(index_file_name);
+
+  current::persistence::FilePersisterOptions options;
+  options.use_index_file = true;
+
+  const auto all_entries = [](const IMPL& impl) {
+    std::vector<std::string> result;
+    for (const auto& e : impl.Iterate()) {
+      result.push_back(Printf(
+          "%s %d %d", e.entry.s.c_str(), static_cast<int>(e.idx_ts.index), static_cast<int>(e.idx_ts.us.count())));
+    }
+    return Join(result, ",");
+  };
+
+  {
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name, options);
+    current::time::SetNow(std::chrono::microseconds(100));
+    impl.Publish(StorableString("foo"));
+    current::time::SetNow(std::chrono::microseconds(200));
+    impl.Publish(StorableString("bar"));
+    current::time::SetNow(std::chrono::microseconds(300));
+    impl.UpdateHead();
+    current::time::SetNow(std::chrono::microseconds(500));
+    impl.Publish(StorableString("meh"));
+    current::time::SetNow(std::chrono::microseconds(600));
+    impl.UpdateHead();
+    EXPECT_EQ(3u, impl.Size());
+  }
+
+  // Three 16-byte records and the 24-byte trailer.
+  EXPECT_EQ(3u * 16u + 24u, current::FileSystem::GetFileSize(index_file_name));
+
+  current::reflection::StructSchema struct_schema;
+  struct_schema.AddType<StorableString>();
+  const std::string signature =
+      "#signature " + JSON(current::ss::StreamSignature(namespace_name, struct_schema.GetSchemaInfo())) + '\n';
+  // The index file does not affect the contents of the file.
+  EXPECT_EQ(signature +
+                "{\"index\":0,\"us\":100}\t{\"s\":\"foo\"}\n"
+                "{\"index\":1,\"us\":200}\t{\"s\":\"bar\"}\n"
+                "#head 00000000000000000300\n"
+                "{\"index\":2,\"us\":500}\t{\"s\":\"meh\"}\n"
+                "#head 00000000000000000600\n",
+            current::FileSystem::ReadFileAsString(persistence_file_name));
+
+  {
+    // Replay using the index, with the `#head` directive in the tail past the last indexed entry.
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name, options);
+    EXPECT_EQ(3u, impl.Size());
+    EXPECT_EQ(600, impl.CurrentHead().count());
+    EXPECT_EQ(500, impl.LastPublishedIndexAndTimestamp().us.count());
+    EXPECT_EQ("foo 0 100,bar 1 200,meh 2 500", all_entries(impl));
+    EXPECT_EQ(2u, impl.IndexRangeByTimestampRange(std::chrono::microseconds(201)).first);
+    // The `#head` directive found in the tail is rewritten in place.
+    current::time::SetNow(std::chrono::microseconds(700));
+    impl.UpdateHead();
+  }
+
+  {
+    // Publish without the index, so that the index file lags behind the file.
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name);
+    EXPECT_EQ(700, impl.CurrentHead().count());
+    current::time::SetNow(std::chrono::microseconds(800));
+    impl.Publish(StorableString("new"));
+  }
+  EXPECT_EQ(3u * 16u + 24u, current::FileSystem::GetFileSize(index_file_name));
+
+  {
+    // The tail is replayed and appended to the index.
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name, options);
+    EXPECT_EQ(4u, impl.Size());
+    EXPECT_EQ(800, impl.CurrentHead().count());
+    EXPECT_EQ("foo 0 100,bar 1 200,meh 2 500,new 3 800", all_entries(impl));
+  }
+  EXPECT_EQ(4u * 16u + 24u, current::FileSystem::GetFileSize(index_file_name));
+
+  const std::string file_contents = current::FileSystem::ReadFileAsString(persistence_file_name);
+  EXPECT_EQ(signature +
+                "{\"index\":0,\"us\":100}\t{\"s\":\"foo\"}\n"
+                "{\"index\":1,\"us\":200}\t{\"s\":\"bar\"}\n"
+                "#head 00000000000000000300\n"
+                "{\"index\":2,\"us\":500}\t{\"s\":\"meh\"}\n"
+                "#head 00000000000000000700\n"
+                "{\"index\":3,\"us\":800}\t{\"s\":\"new\"}\n",
+            file_contents);
+
+  {
+    // Confirm the indexed entries are not replayed: a broken index of an indexed entry goes unnoticed.
+    std::string tampered_contents = file_contents;
+    const size_t pos = tampered_contents.find("{\"index\":1,");
+    ASSERT_NE(std::string::npos, pos);
+    tampered_contents[pos + 9] = '7';
+    current::FileSystem::WriteStringToFile(tampered_contents, persistence_file_name.c_str());
+    {
+      std::mutex mutex;
+      IMPL impl(mutex, namespace_name, persistence_file_name, options);
+      EXPECT_EQ(4u, impl.Size());
+    }
+    {
+      std::mutex mutex;
+      ASSERT_THROW(IMPL(mutex, namespace_name, persistence_file_name), current::ss::InconsistentIndexException);
+    }
+    current::FileSystem::WriteStringToFile(file_contents, persistence_file_name.c_str());
+  }
+
+  {
+    // A torn index file is ignored, and rebuilt after the full replay.
+    const std::string index_contents = current::FileSystem::ReadFileAsString(index_file_name);
+    current::FileSystem::WriteStringToFile(index_contents.substr(0, index_contents.length() - 5),
+                                           index_file_name.c_str());
+    {
+      std::mutex mutex;
+      IMPL impl(mutex, namespace_name, persistence_file_name, options);
+      EXPECT_EQ(4u, impl.Size());
+      EXPECT_EQ("foo 0 100,bar 1 200,meh 2 500,new 3 800", all_entries(impl));
+    }
+    EXPECT_EQ(index_contents, current::FileSystem::ReadFileAsString(index_file_name));
+  }
+
+  {
+    // An index file with a wrong checksum is ignored, and rebuilt after the full replay.
+    const std::string index_contents = current::FileSystem::ReadFileAsString(index_file_name);
+    std::string corrupted_index_contents = index_contents;
+    ++corrupted_index_contents[16];
+    current::FileSystem::WriteStringToFile(corrupted_index_contents, index_file_name.c_str());
+    {
+      std::mutex mutex;
+      IMPL impl(mutex, namespace_name, persistence_file_name, options);
+      EXPECT_EQ(4u, impl.Size());
+      EXPECT_EQ("foo 0 100,bar 1 200,meh 2 500,new 3 800", all_entries(impl));
+    }
+    EXPECT_EQ(index_contents, current::FileSystem::ReadFileAsString(index_file_name));
+  }
+
+  {
+    // An index file not matching the file is ignored, and rebuilt after the full replay.
+    current::FileSystem::WriteStringToFile(signature + "{\"index\":0,\"us\":100}\t{\"s\":\"one\"}\n",
+                                           persistence_file_name.c_str());
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name, options);
+    EXPECT_EQ(1u, impl.Size());
+    EXPECT_EQ("one 0 100", all_entries(impl));
+  }
+  EXPECT_EQ(1u * 16u + 24u, current::FileSystem::GetFileSize(index_file_name));
+}
+
+TEST(PersistenceLayer, FileWithMmapReads) {
+  current::time::ResetToZero();
+
+  using namespace persistence_test;
+
+  using IMPL = current::persistence::File<StorableString>;
+
+  const auto namespace_name = current::ss::StreamNamespaceName("namespace", "entry_name");
+  const std::string persistence_file_name = current::FileSystem::JoinPath(FLAGS_persistence_test_tmpdir, "data");
+  const auto file_remover = current::FileSystem::ScopedRmFile(persistence_file_name);
+
+  current::persistence::FilePersisterOptions options;
+  options.use_mmap_reads = true;
+
+  std::mutex mutex;
+  IMPL impl(mutex, namespace_name, persistence_file_name, options);
+  current::time::SetNow(std::chrono::microseconds(100));
+  impl.Publish(StorableString("foo"));
+  current::time::SetNow(std::chrono::microseconds(200));
+  impl.Publish(StorableString("bar"));
+  current::time::SetNow(std::chrono::microseconds(300));
+  impl.UpdateHead();
+
+  const auto all_entries = [&impl](uint64_t begin) {
+    std::vector<std::string> result;
+    for (const auto& e : impl.Iterate(begin)) {
+      result.push_back(Printf(
+          "%s %d %d", e.entry.s.c_str(), static_cast<int>(e.idx_ts.index), static_cast<int>(e.idx_ts.us.count())));
+    }
+    return Join(result, ",");
+  };
+  const auto all_entries_unsafe = [&impl](uint64_t begin) {
+    std::vector<std::string> result;
+    for (const auto& e : impl.IterateUnsafe(begin)) {
+      result.emplace_back(e);
+    }
+    return Join(result, ",");
+  };
+
+  EXPECT_EQ("foo 0 100,bar 1 200", all_entries(0u));
+  EXPECT_EQ(
+      "{\"index\":0,\"us\":100}\t{\"s\":\"foo\"},"
+      "{\"index\":1,\"us\":200}\t{\"s\":\"bar\"}",
+      all_entries_unsafe(0u));
+
+  // The range created before the file has grown keeps working, and the new entries are read as the file grows.
+  auto range = impl.IterateUnsafe(1u);
+  current::time::SetNow(std::chrono::microseconds(500));
+  impl.Publish(StorableString("meh"));
+  {
+    auto it = range.begin();
+    EXPECT_EQ("{\"index\":1,\"us\":200}\t{\"s\":\"bar\"}", std::string(*it));
+  }
+  EXPECT_EQ("foo 0 100,bar 1 200,meh 2 500", all_entries(0u));
+  EXPECT_EQ("meh 2 500", all_entries(2u));
+  EXPECT_EQ(
+      "{\"index\":1,\"us\":200}\t{\"s\":\"bar\"},"
+      "{\"index\":2,\"us\":500}\t{\"s\":\"meh\"}",
+      all_entries_unsafe(1u));
+
+  // Skipping entries without dereferencing them.
+  {
+    auto it = impl.IterateUnsafe().begin();
+    ++it;
+    ++it;
+    EXPECT_EQ("{\"index\":2,\"us\":500}\t{\"s\":\"meh\"}", std::string(*it));
+  }
+
+  // The raw entries are views into the mapped file, valid until their iterator is advanced.
+  {
+    auto iterable = impl.IterateUnsafe(0u, 2u);
+    auto it = iterable.begin();
+    static_assert(std::is_same_v<std::string_view, decltype(*it)>, "");
+    const std::string_view first = *it;
+    EXPECT_EQ(first.data(), (*it).data());
+    EXPECT_EQ("{\"index\":0,\"us\":100}\t{\"s\":\"foo\"}", first);
+  }
+
+  // Many entries, read while being published.
+  for (int i = 0; i < 1000; ++i) {
+    current::time::SetNow(std::chrono::microseconds(1000 + i));
+    impl.Publish(StorableString(current::ToString(i)));
+    if (i % 100 == 0) {
+      uint64_t index = 0u;
+      for (const auto& e : impl.Iterate()) {
+        EXPECT_EQ(index, e.idx_ts.index);
+        ++index;
+      }
+      EXPECT_EQ(impl.Size(), index);
+    }
+  }
+  EXPECT_EQ("{\"index\":1002,\"us\":1999}\t{\"s\":\"999\"}", std::string(*impl.IterateUnsafe(1002u).begin()));
+
+  // The file is mapped with the room to grow into: up to the next power of two, and then up to the next 64MB.
+  using current::persistence::impl::FilePersisterMappedFile;
+  constexpr size_t MB = static_cast<size_t>(1u) << 20;
+  EXPECT_EQ(4096u, FilePersisterMappedFile::SizeToMap(0u));
+  EXPECT_EQ(8192u, FilePersisterMappedFile::SizeToMap(4096u));
+  EXPECT_EQ(64u * MB, FilePersisterMappedFile::SizeToMap(40u * MB));
+  EXPECT_EQ(128u * MB, FilePersisterMappedFile::SizeToMap(64u * MB));
+  EXPECT_EQ(128u * MB, FilePersisterMappedFile::SizeToMap(100u * MB));
+  EXPECT_EQ(192u * MB, FilePersisterMappedFile::SizeToMap(128u * MB));
+}
+
+TEST(PersistenceLayer, MemoryPublishBatch) {
+  current::time::ResetToZero();
+
+  using namespace persistence_test;
+
+  using IMPL = current::persistence::Memory<std::string>;
+
+  const auto namespace_name = current::ss::StreamNamespaceName("namespace", "entry_name");
+
+  std::mutex mutex;
+  IMPL impl(mutex, namespace_name);
+
+  EXPECT_FALSE(Exists(impl.PublishBatch(std::vector<std::string>())));
+
+  // With `max_us` set, each call to mock `Now()` moves the time forward by 1us.
+  current::time::SetNow(std::chrono::microseconds(100), std::chrono::microseconds(1000));
+  const auto last = impl.PublishBatch(std::vector<std::string>({"foo", "bar", "baz"}));
+  ASSERT_TRUE(Exists(last));
+  EXPECT_EQ(2u, Value(last).index);
+  EXPECT_EQ(102, Value(last).us.count());
+  EXPECT_EQ(3u, impl.Size());
+
+  // A failed batch publishes nothing.
+  impl.UpdateHead(std::chrono::microseconds(500));
+  ASSERT_THROW(impl.PublishBatch(std::vector<std::string>({"nope"})), current::ss::InconsistentTimestampException);
+  EXPECT_EQ(3u, impl.Size());
+  EXPECT_EQ(500, impl.CurrentHead().count());
+
+  std::vector<std::string> all;
+  for (const auto& e : impl.Iterate()) {
+    all.push_back(Printf("%s %d", e.entry.c_str(), static_cast<int>(e.idx_ts.us.count())));
+  }
+  EXPECT_EQ("foo 100,bar 101,baz 102", Join(all, ","));
+}
+
+TEST(PersistenceLayer, FilePublishBatch) {
+  current::time::ResetToZero();
+
+  using namespace persistence_test;
+
+  using IMPL = current::persistence::File<StorableString>;
+
+  const auto namespace_name = current::ss::StreamNamespaceName("namespace", "entry_name");
+  const std::string persistence_file_name = current::FileSystem::JoinPath(FLAGS_persistence_test_tmpdir, "data");
+  const auto file_remover = current::FileSystem::ScopedRmFile(persistence_file_name);
+
+  current::reflection::StructSchema struct_schema;
+  struct_schema.AddType<StorableString>();
+  const std::string signature =
+      "#signature " + JSON(current::ss::StreamSignature(namespace_name, struct_schema.GetSchemaInfo())) + '\n';
+
+  {
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name);
+
+    EXPECT_FALSE(Exists(impl.PublishBatch(std::vector<StorableString>())));
+
+    current::time::SetNow(std::chrono::microseconds(100), std::chrono::microseconds(1000));
+    const auto last = impl.PublishBatch(std::vector<StorableString>({StorableString("foo"), StorableString("bar")}));
+    ASSERT_TRUE(Exists(last));
+    EXPECT_EQ(1u, Value(last).index);
+    EXPECT_EQ(101, Value(last).us.count());
+    EXPECT_EQ(2u, impl.Size());
+
+    // A failed batch publishes nothing, and writes nothing.
+    impl.UpdateHead(std::chrono::microseconds(500));
+    ASSERT_THROW(impl.PublishBatch(std::vector<StorableString>({StorableString("nope")})),
+                 current::ss::InconsistentTimestampException);
+    EXPECT_EQ(2u, impl.Size());
+
+    current::time::SetNow(std::chrono::microseconds(600), std::chrono::microseconds(1000));
+    impl.PublishBatch(std::vector<StorableString>({StorableString("meh")}));
+    EXPECT_EQ(3u, impl.Size());
+  }
+
+  EXPECT_EQ(signature +
+                "{\"index\":0,\"us\":100}\t{\"s\":\"foo\"}\n"
+                "{\"index\":1,\"us\":101}\t{\"s\":\"bar\"}\n"
+                "#head 00000000000000000500\n"
+                "{\"index\":2,\"us\":600}\t{\"s\":\"meh\"}\n",
+            current::FileSystem::ReadFileAsString(persistence_file_name));
+
+  {
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name);
+    EXPECT_EQ(3u, impl.Size());
+    std::vector<std::string> all;
+    for (const auto& e : impl.Iterate()) {
+      all.push_back(Printf("%s %d", e.entry.s.c_str(), static_cast<int>(e.idx_ts.us.count())));
+    }
+    EXPECT_EQ("foo 100,bar 101,meh 600", Join(all, ","));
+  }
+}
+
+TEST(PersistenceLayer, FileDurability) {
+  current::time::ResetToZero();
+
+  using namespace persistence_test;
+
+  using IMPL = current::persistence::File<StorableString>;
+
+  const auto namespace_name = current::ss::StreamNamespaceName("namespace", "entry_name");
+  const std::string persistence_file_name = current::FileSystem::JoinPath(FLAGS_persistence_test_tmpdir, "data");
+  const auto file_remover = current::FileSystem::ScopedRmFile(persistence_file_name);
+
+  current::reflection::StructSchema struct_schema;
+  struct_schema.AddType<StorableString>();
+  const std::string signature =
+      "#signature " + JSON(current::ss::StreamSignature(namespace_name, struct_schema.GetSchemaInfo())) + '\n';
+
+  {
+    // Flush every three entries.
+    current::persistence::FilePersisterOptions options;
+    options.durability = current::persistence::FilePersisterDurability::FlushEveryN;
+    options.flush_every_n = 3u;
+
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name, options);
+    current::time::SetNow(std::chrono::microseconds(100));
+    EXPECT_EQ(0u, impl.Publish(StorableString("one")).index);
+    current::time::SetNow(std::chrono::microseconds(200));
+    EXPECT_EQ(1u, impl.Publish(StorableString("two")).index);
+    EXPECT_EQ(0u, impl.Size());
+    EXPECT_EQ(-1, impl.CurrentHead().count());
+    EXPECT_EQ(signature, current::FileSystem::ReadFileAsString(persistence_file_name));
+
+    current::time::SetNow(std::chrono::microseconds(300));
+    EXPECT_EQ(2u, impl.Publish(StorableString("three")).index);
+    EXPECT_EQ(3u, impl.Size());
+    EXPECT_EQ(300, impl.CurrentHead().count());
+
+    current::time::SetNow(std::chrono::microseconds(400));
+    impl.Publish(StorableString("four"));
+    EXPECT_EQ(3u, impl.Size());
+    impl.Flush();
+    EXPECT_EQ(4u, impl.Size());
+
+    // The pending entries are written before the head directive.
+    current::time::SetNow(std::chrono::microseconds(500));
+    impl.Publish(StorableString("five"));
+    EXPECT_EQ(4u, impl.Size());
+    current::time::SetNow(std::chrono::microseconds(600));
+    impl.UpdateHead();
+    EXPECT_EQ(5u, impl.Size());
+    EXPECT_EQ(600, impl.CurrentHead().count());
+
+    // The pending entries are written when the persister is destroyed.
+    current::time::SetNow(std::chrono::microseconds(700));
+    impl.Publish(StorableString("six"));
+    EXPECT_EQ(5u, impl.Size());
+    EXPECT_EQ(-1, static_cast<int64_t>(impl.IndexRangeByTimestampRange(std::chrono::microseconds(700)).first));
+  }
+
+  EXPECT_EQ(signature +
+                "{\"index\":0,\"us\":100}\t{\"s\":\"one\"}\n"
+                "{\"index\":1,\"us\":200}\t{\"s\":\"two\"}\n"
+                "{\"index\":2,\"us\":300}\t{\"s\":\"three\"}\n"
+                "{\"index\":3,\"us\":400}\t{\"s\":\"four\"}\n"
+                "{\"index\":4,\"us\":500}\t{\"s\":\"five\"}\n"
+                "#head 00000000000000000600\n"
+                "{\"index\":5,\"us\":700}\t{\"s\":\"six\"}\n",
+            current::FileSystem::ReadFileAsString(persistence_file_name));
+
+  {
+    // Flush no sooner than in an hour, i.e. only explicitly.
+    current::persistence::FilePersisterOptions options;
+    options.durability = current::persistence::FilePersisterDurability::FlushEveryT;
+    options.flush_every_t = std::chrono::hours(1);
+
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name, options);
+    EXPECT_EQ(6u, impl.Size());
+    current::time::SetNow(std::chrono::microseconds(800));
+    impl.Publish(StorableString("seven"));
+    EXPECT_EQ(6u, impl.Size());
+    impl.Flush();
+    EXPECT_EQ(7u, impl.Size());
+  }
+
+  {
+    // Flush and `fsync()` each publish.
+    current::persistence::FilePersisterOptions options;
+    options.durability = current::persistence::FilePersisterDurability::FSyncPerPublish;
+
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name, options);
+    EXPECT_EQ(7u, impl.Size());
+    current::time::SetNow(std::chrono::microseconds(900));
+    impl.Publish(StorableString("eight"));
+    EXPECT_EQ(8u, impl.Size());
+    std::vector<std::string> all;
+    for (const auto& e : impl.Iterate()) {
+      all.push_back(e.entry.s);
+    }
+    EXPECT_EQ("one,two,three,four,five,six,seven,eight", Join(all, ","));
+  }
+
+  {
+    // The entries of the last burst are flushed in background, with no more publishes to follow.
+    current::persistence::FilePersisterOptions options;
+    options.durability = current::persistence::FilePersisterDurability::FlushEveryT;
+    options.flush_every_t = std::chrono::milliseconds(1);
+
+    std::mutex mutex;
+    IMPL impl(mutex, namespace_name, persistence_file_name, options);
+    std::atomic_int callbacks(0);
+    impl.SetBackgroundFlushCallback([&callbacks]() { ++callbacks; });
+    EXPECT_EQ(8u, impl.Size());
+    current::time::SetNow(std::chrono::microseconds(1000));
+    impl.Publish(StorableString("nine"));
+    current::time::SetNow(std::chrono::microseconds(1100));
+    impl.Publish(StorableString("ten"));
+    while (impl.Size() != 10u) {
+      std::this_thread::yield();
+    }
+    while (!callbacks) {
+      std::this_thread::yield();
+    }
+    impl.SetBackgroundFlushCallback(nullptr);
+  }
+}
+
 TEST(PersistenceLayer, FileExceptions) {
   using namespace persistence_test;
 
@@ -709,7 +1196,7 @@ TEST(PersistenceLayer, FileSafeVsUnsafeIterators) {
   const auto GetUnsafeIterationResult = [&]() -> std::string {
     std::string combined_result;
     for (const auto& e : impl.IterateUnsafe()) {
-      combined_result += e + '\n';
+      combined_result.append(e.data(), e.size()) += '\n';
     }
     return combined_result;
   };
@@ -70,6 +70,15 @@ class EntryPersister : public GenericEntryPersister<ENTRY>, public IMPL {
     return IMPL::template PersisterPublishImpl<MLS>(std::forward<E>(e), us);
   }
 
+  // Publishes all the entries of the range, timestamped with `current::time::Now()`, in one go.
+  // Returns the index and timestamp of the last entry of the range, if it is not empty.
+  template <current::locks::MutexLockStatus MLS = current::locks::MutexLockStatus::NeedToLock,
+            typename RANGE,
+            class = std::enable_if_t<can_publish_range_v<RANGE, ENTRY>>>
+  Optional<idxts_t> PublishBatch(RANGE&& entries) {
+    return IMPL::template PersisterPublishBatchImpl<MLS>(std::forward<RANGE>(entries));
+  }
+
   // Publishes the `raw_log_line` as is without parsing and validating its content.
   template <current::locks::MutexLockStatus MLS = current::locks::MutexLockStatus::NeedToLock>
   idxts_t PublishUnsafe(const std::string& raw_log_line,
@@ -93,6 +102,12 @@ class EntryPersister : public GenericEntryPersister<ENTRY>, public IMPL {
     return IMPL::template PersisterUpdateHeadImpl<MLS>(us);
   }
 
+  // Makes the entries published so far visible, if the persister defers it.
+  template <current::locks::MutexLockStatus MLS = current::locks::MutexLockStatus::NeedToLock>
+  void Flush() {
+    IMPL::template PersisterFlushImpl<MLS>();
+  }
+
   template <current::locks::MutexLockStatus MLS = current::locks::MutexLockStatus::NeedToLock>
   bool Empty() const {
     return IMPL::template PersisterEmptyImpl<MLS>();
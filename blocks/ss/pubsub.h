@@ -70,6 +70,14 @@ class EntryPublisher : public GenericEntryPublisher<ENTRY>, public IMPL {
     return IMPL::template PublisherPublishImpl<MLS>(std::forward<E>(e), us);
   }
 
+  // Publishes all the entries of the range in one go. The subscribers are notified once, after the whole batch.
+  template <MutexLockStatus MLS = MutexLockStatus::NeedToLock,
+            typename RANGE,
+            class = std::enable_if_t<can_publish_range_v<RANGE, ENTRY>>>
+  Optional<idxts_t> PublishBatch(RANGE&& entries) {
+    return IMPL::template PublisherPublishBatchImpl<MLS>(std::forward<RANGE>(entries));
+  }
+
   template <MutexLockStatus MLS = MutexLockStatus::NeedToLock>
   idxts_t PublishUnsafe(std::string&& raw_log_line) {
     return IMPL::template PublisherPublishUnsafeImpl<MLS>(std::move(raw_log_line));
@@ -90,6 +98,12 @@ class EntryPublisher : public GenericEntryPublisher<ENTRY>, public IMPL {
     IMPL::template PublisherUpdateHeadImpl<MLS>(us);
   }
 
+  // Makes the entries published so far visible, if the persister defers it.
+  template <MutexLockStatus MLS = MutexLockStatus::NeedToLock>
+  void Flush() {
+    IMPL::template PublisherFlushImpl<MLS>();
+  }
+
   // NOTE(dkorolev): The publisher ("publishable") has no business knowing the size of the stream (`Empty()`/`Size()`),
   //                 That's what the subscriber ("subscribable") and persister ("iterable") primitives are for.
 };
@@ -28,7 +28,9 @@ SOFTWARE.
 
 #include "../../port.h"
 
+#include <iterator>
 #include <type_traits>
+#include <utility>
 
 namespace current {
 namespace ss {
@@ -39,6 +41,14 @@ inline
 #endif  // CURRENT_FOR_CPP14
     constexpr bool can_publish_v = std::is_constructible_v<STREAM_ENTRY, ENTRY>;
 
+// For `PublishBatch()`: whether each element of the `RANGE` can be published into the stream of `STREAM_ENTRY`.
+template <typename RANGE, typename STREAM_ENTRY>
+#ifndef CURRENT_FOR_CPP14
+inline
+#endif  // CURRENT_FOR_CPP14
+    constexpr bool can_publish_range_v =
+        can_publish_v<std::decay_t<decltype(*std::begin(std::declval<RANGE&>()))>, STREAM_ENTRY>;
+
 }  // namespace ss
 }  // namespace current
 
@@ -237,6 +237,10 @@ struct URLParametersExtractor {
   }
 
   static std::string DecodeURIComponent(const std::string& encoded) {
+    if (encoded.find_first_of("+%") == std::string::npos) {
+      // Most query parameters need no decoding.
+      return encoded;
+    }
     std::ostringstream decoded;
     for (size_t i = 0; i < encoded.length(); ++i) {
       const char c = encoded[i];
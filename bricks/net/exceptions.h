@@ -64,6 +64,7 @@ struct SocketBindException : ServerSocketException {
 
 struct SocketListenException : ServerSocketException {};  // LCOV_EXCL_LINE -- not covered by unit tests.
 struct SocketAcceptException : ServerSocketException {};  // LCOV_EXCL_LINE -- not covered by unit tests.
+struct SocketPollException : ServerSocketException {};    // LCOV_EXCL_LINE -- not covered by unit tests.
 
 struct ConnectionResetByPeer : SocketException {};  // LCOV_EXCL_LINE
 
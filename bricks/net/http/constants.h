@@ -50,6 +50,10 @@ constexpr char kContentLengthHeaderKey[] = "Content-Length";
 constexpr char kTransferEncodingHeaderKey[] = "Transfer-Encoding";
 constexpr char kTransferEncodingChunkedValue[] = "chunked";
 constexpr char kHTTPMethodOverrideHeaderKey[] = "X-HTTP-Method-Override";
+constexpr char kConnectionHeaderKey[] = "Connection";
+constexpr char kConnectionKeepAliveValue[] = "keep-alive";
+constexpr char kConnectionCloseValue[] = "close";
+constexpr char kHTTP11Version[] = "HTTP/1.1";
 
 // By default:
 // * HTTP responses that use `struct Response` will have the CORS header set.
@@ -0,0 +1,183 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Dmitry "Dima" Korolev <dmitry.korolev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef BRICKS_NET_HTTP_IMPL_HEAD_PARSER_H
+#define BRICKS_NET_HTTP_IMPL_HEAD_PARSER_H
+
+#include "../../../port.h"
+
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "../constants.h"
+
+namespace current {
+namespace net {
+
+// A part of the buffer being parsed. Kept as offsets, not pointers, to remain valid as the buffer grows.
+struct HTTPBufferView final {
+  size_t begin = 0u;
+  size_t length = 0u;
+
+  const char* Begin(const char* buffer) const { return buffer + begin; }
+  std::string_view In(const char* buffer) const { return std::string_view(buffer + begin, length); }
+};
+
+// The incremental parser of the head of an HTTP message, i.e. of its first line and of its headers.
+//
+// `Parse(buffer, size)` is to be called each time more bytes have been received into `buffer`. It resumes from where
+// the previous call has stopped, so each received byte is only looked at once, and returns true once the blank line
+// ending the head has been seen. The parser does not allocate memory unless the message has more than
+// `kInlineHeaders` headers: the first line and the headers are kept as views into `buffer`. The keys and the values
+// of the headers are '\0'-terminated in place, so that they can also be used as C strings.
+//
+// Like the rest of the HTTP parsing code, the parser is forgiving: blank lines before the first line are skipped,
+// and the header lines without a colon are ignored.
+class HTTPHeadParser final {
+ public:
+  constexpr static size_t kInlineHeaders = 32u;
+  constexpr static size_t kFirstLinePieces = 3u;
+
+  struct HeaderView final {
+    HTTPBufferView key;
+    HTTPBufferView value;
+  };
+
+  bool Parse(char* buffer, size_t size) {
+    while (!done_) {
+      const char* const lf = (scan_offset_ < size)
+                                 ? static_cast<const char*>(::memchr(buffer + scan_offset_, '\n', size - scan_offset_))
+                                 : nullptr;
+      if (!lf) {
+        scan_offset_ = size;
+        return false;
+      }
+      const size_t lf_offset = static_cast<size_t>(lf - buffer);
+      scan_offset_ = lf_offset + 1u;
+      // Only CRLF ends the line, a standalone LF is a part of it.
+      if (lf_offset > line_begin_ && buffer[lf_offset - 1u] == '\r') {
+        ParseLine(buffer, line_begin_, lf_offset - 1u);
+        line_begin_ = scan_offset_;
+      }
+    }
+    return true;
+  }
+
+  bool Done() const { return done_; }
+
+  // The offset of the first byte after the head, i.e. of the body. Valid once `Parse()` has returned true.
+  size_t HeadLength() const { return line_begin_; }
+
+  // The whitespace-separated pieces of the first line: method, path and version for the request,
+  // and version, code and the first word of the reason phrase for the response.
+  size_t FirstLinePiecesCount() const { return first_line_pieces_count_; }
+  const HTTPBufferView& FirstLinePiece(size_t i) const { return first_line_pieces_[i]; }
+
+  size_t HeadersCount() const { return headers_count_; }
+  const HeaderView& Header(size_t i) const {
+    return i < kInlineHeaders ? inline_headers_[i] : more_headers_[i - kInlineHeaders];
+  }
+
+ private:
+  static bool IsSpaceOrTab(char c) { return c == ' ' || c == '\t'; }
+
+  // Parses the line `[begin, end)`, where `buffer[end]` is the '\r' of its CRLF.
+  void ParseLine(char* buffer, size_t begin, size_t end) {
+    if (!first_line_parsed_) {
+      // It's recommended by W3 to wait for the first line ignoring prior CRLF-s.
+      if (begin != end) {
+        ParseFirstLine(buffer, begin, end);
+        first_line_parsed_ = true;
+      }
+    } else if (begin == end) {
+      // The blank line is what separates HTTP headers from HTTP body.
+      done_ = true;
+    } else {
+      const char* const colon =
+          static_cast<const char*>(::memchr(buffer + begin, constants::kHeaderKeyValueSeparator, end - begin));
+      if (colon) {
+        const size_t colon_offset = static_cast<size_t>(colon - buffer);
+        // Ignore the spaces and tabs before and after the value.
+        size_t value_begin = colon_offset + 1u;
+        while (value_begin < end && IsSpaceOrTab(buffer[value_begin])) {
+          ++value_begin;
+        }
+        size_t value_end = end;
+        while (value_end > value_begin && IsSpaceOrTab(buffer[value_end - 1u])) {
+          --value_end;
+        }
+        buffer[colon_offset] = '\0';
+        buffer[value_end] = '\0';
+        HeaderView header;
+        header.key.begin = begin;
+        header.key.length = colon_offset - begin;
+        header.value.begin = value_begin;
+        header.value.length = value_end - value_begin;
+        if (headers_count_ < kInlineHeaders) {
+          inline_headers_[headers_count_] = header;
+        } else {
+          more_headers_.push_back(header);
+        }
+        ++headers_count_;
+      }
+    }
+  }
+
+  void ParseFirstLine(char* buffer, size_t begin, size_t end) {
+    const auto IsWhitespace = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    size_t i = begin;
+    while (first_line_pieces_count_ < kFirstLinePieces) {
+      while (i < end && IsWhitespace(buffer[i])) {
+        ++i;
+      }
+      if (i == end) {
+        break;
+      }
+      HTTPBufferView& piece = first_line_pieces_[first_line_pieces_count_++];
+      piece.begin = i;
+      while (i < end && !IsWhitespace(buffer[i])) {
+        ++i;
+      }
+      piece.length = i - piece.begin;
+    }
+  }
+
+  size_t scan_offset_ = 0u;  // Where to continue looking for the end of the current line.
+  size_t line_begin_ = 0u;   // The beginning of the current line.
+  bool first_line_parsed_ = false;
+  bool done_ = false;
+
+  HTTPBufferView first_line_pieces_[kFirstLinePieces];
+  size_t first_line_pieces_count_ = 0u;
+
+  HeaderView inline_headers_[kInlineHeaders];
+  std::vector<HeaderView> more_headers_;
+  size_t headers_count_ = 0u;
+};
+
+}  // namespace net
+}  // namespace current
+
+#endif  // BRICKS_NET_HTTP_IMPL_HEAD_PARSER_H
@@ -25,10 +25,14 @@ SOFTWARE.
 #ifndef BRICKS_NET_HTTP_IMPL_SERVER_H
 #define BRICKS_NET_HTTP_IMPL_SERVER_H
 
+#include <chrono>
+#include <functional>
+#include <iostream>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -42,6 +46,8 @@ SOFTWARE.
 
 #include "../../exceptions.h"
 
+#include "head_parser.h"
+
 #include "../../tcp/tcp.h"
 
 #include "../../../../typesystem/serialization/json.h"
@@ -75,6 +81,15 @@ SOFTWARE.
 
 #define CURRENT_BRICKS_HTTP_DEFAULT_CHUNK_CACHE_SIZE (1024 * 1024)
 
+// The defaults for `ChunkedResponseSender::Coalesce()`.
+#ifndef CURRENT_BRICKS_HTTP_DEFAULT_COALESCED_CHUNK_SIZE
+#define CURRENT_BRICKS_HTTP_DEFAULT_COALESCED_CHUNK_SIZE (64 * 1024)
+#endif  // CURRENT_BRICKS_HTTP_DEFAULT_COALESCED_CHUNK_SIZE
+
+#ifndef CURRENT_BRICKS_HTTP_DEFAULT_COALESCED_CHUNK_MAX_DELAY_US
+#define CURRENT_BRICKS_HTTP_DEFAULT_COALESCED_CHUNK_MAX_DELAY_US 10000
+#endif  // CURRENT_BRICKS_HTTP_DEFAULT_COALESCED_CHUNK_MAX_DELAY_US
+
 namespace current {
 namespace net {
 
@@ -94,9 +109,35 @@ struct EventsJournal {
 inline EventsJournal& HTTPDataJournal() { return current::Singleton<EventsJournal>(); }
 #endif  // CURRENT_BRICKS_DEBUG_HTTP
 
+// The `length` bytes of the open file `fd`, starting from `offset`, to send as the body of the HTTP response.
+struct HTTPFileBody final {
+  int fd;
+  uint64_t offset;
+  uint64_t length;
+};
+
 // HTTP response helpers. Used from both `GenericHTTPRequestData` and `GenericHTTPServerConnection`.
 struct HTTPResponder {
   typedef enum { ConnectionClose, ConnectionKeepAlive } ConnectionType;
+
+  // The connection to send the response into, along with the value of the `Connection` header to send.
+  // Implicitly constructible from `Connection&`, in which case the connection is to be closed after the response.
+  // If `sent_code` is set, the code of the response sent is stored there.
+  struct ResponseConnection final {
+    Connection& connection;
+    const ConnectionType connection_type;
+    HTTPResponseCodeValue* const sent_code;
+    ResponseConnection(Connection& connection,
+                       ConnectionType connection_type = ConnectionClose,
+                       HTTPResponseCodeValue* sent_code = nullptr)
+        : connection(connection), connection_type(connection_type), sent_code(sent_code) {}
+    void SetSentCode(HTTPResponseCodeValue code) const {
+      if (sent_code) {
+        *sent_code = code;
+      }
+    }
+  };
+
   static void PrepareHTTPResponseHeader(std::ostream& os,
                                         ConnectionType connection_type,
                                         HTTPResponseCodeValue code = HTTPResponseCode.OK,
@@ -123,17 +164,18 @@ struct HTTPResponder {
 
   // The generic implementation.
   template <typename T>
-  static void SendHTTPResponseImpl(Connection& connection,
+  static void SendHTTPResponseImpl(ResponseConnection connection,
                                    const T& begin,
                                    const T& end,
                                    HTTPResponseCodeValue code,
                                    const http::Headers& headers,
                                    const std::string& content_type) {
     std::ostringstream os;
-    PrepareHTTPResponseHeader(os, ConnectionClose, code, headers, content_type);
+    PrepareHTTPResponseHeader(os, connection.connection_type, code, headers, content_type);
     os << "Content-Length: " << (end - begin) << constants::kCRLF << constants::kCRLF;
-    connection.BlockingWrite(os.str(), true);
-    connection.BlockingWrite(begin, end, false);
+    connection.connection.BlockingWrite(os.str(), true);
+    connection.connection.BlockingWrite(begin, end, false);
+    connection.SetSentCode(code);
   }
 
   // The actual implementations of sending the HTTP response.
@@ -143,7 +185,7 @@ struct HTTPResponder {
   // STL containers of chars and bytes, this does not yet cover std::string.
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& begin,
       const T& end,
       HTTPResponseCodeValue code,
@@ -154,7 +196,7 @@ struct HTTPResponder {
 
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& begin,
       const T& end,
       HTTPResponseCodeValue code,
@@ -165,7 +207,7 @@ struct HTTPResponder {
 
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& begin,
       const T& end,
       const std::string& content_type,
@@ -175,7 +217,7 @@ struct HTTPResponder {
 
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& begin,
       const T& end,
       const http::Headers& headers,
@@ -185,7 +227,7 @@ struct HTTPResponder {
 
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& begin,
       const T& end,
       HTTPResponseCodeValue code) {
@@ -194,7 +236,7 @@ struct HTTPResponder {
 
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& begin,
       const T& end) {
     SendHTTPResponseImpl(connection, begin, end, HTTPResponseCode.OK, http::Headers(), constants::kDefaultContentType);
@@ -203,7 +245,7 @@ struct HTTPResponder {
   // STL containers of chars and bytes.
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& obj,
       HTTPResponseCodeValue code,
       const std::string& content_type,
@@ -213,7 +255,7 @@ struct HTTPResponder {
 
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& obj,
       HTTPResponseCodeValue code,
       const http::Headers& headers,
@@ -223,7 +265,7 @@ struct HTTPResponder {
 
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& obj,
       const std::string& content_type,
       const http::Headers& headers) {
@@ -232,7 +274,7 @@ struct HTTPResponder {
 
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& obj,
       const http::Headers& headers,
       const std::string& content_type) {
@@ -241,20 +283,20 @@ struct HTTPResponder {
 
   template <typename T>
   static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       const T& obj,
       HTTPResponseCodeValue code) {
     SendHTTPResponseImpl(connection, obj.begin(), obj.end(), code, http::Headers(), constants::kDefaultContentType);
   }
 
   template <typename T>
-  static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse( Connection& connection,
+  static std::enable_if_t<sizeof(typename T::value_type) == 1> SendHTTPResponse( ResponseConnection connection,
       const T& obj) {
     SendHTTPResponseImpl(connection, obj.begin(), obj.end(), HTTPResponseCode.OK, http::Headers(), constants::kDefaultContentType);
   }
 
   // Special case to handle std::string.
-  static void SendHTTPResponse(Connection& connection,
+  static void SendHTTPResponse(ResponseConnection connection,
                                const std::string& string,
                                HTTPResponseCodeValue code,
                                const http::Headers& headers,
@@ -262,21 +304,21 @@ struct HTTPResponder {
     SendHTTPResponseImpl(connection, string.begin(), string.end(), code, headers, content_type);
   }
 
-  static void SendHTTPResponse(Connection& connection,
+  static void SendHTTPResponse(ResponseConnection connection,
                                const std::string& string,
                                HTTPResponseCodeValue code,
                                const http::Headers& headers) {
     SendHTTPResponseImpl(connection, string.begin(), string.end(), code, headers, constants::kDefaultContentType);
   }
 
-  static void SendHTTPResponse(Connection& connection,
+  static void SendHTTPResponse(ResponseConnection connection,
                                const std::string& string,
                                HTTPResponseCodeValue code,
                                const std::string& content_type) {
     SendHTTPResponseImpl(connection, string.begin(), string.end(), code, http::Headers(), content_type);
   }
 
-  static void SendHTTPResponse(Connection& connection, const std::string& string, HTTPResponseCodeValue code) {
+  static void SendHTTPResponse(ResponseConnection connection, const std::string& string, HTTPResponseCodeValue code) {
     SendHTTPResponseImpl(connection,
                          string.begin(),
                          string.end(),
@@ -285,7 +327,7 @@ struct HTTPResponder {
                          constants::kDefaultContentType);
   }
 
-  static void SendHTTPResponse(Connection& connection, const std::string& string) {
+  static void SendHTTPResponse(ResponseConnection connection, const std::string& string) {
     SendHTTPResponseImpl(connection,
                          string.begin(),
                          string.end(),
@@ -297,7 +339,7 @@ struct HTTPResponder {
   // Support `CURRENT_STRUCT`-s and `CURRENT_VARIANT`-s.
   template <class T>
   static std::enable_if_t<IS_CURRENT_STRUCT_OR_VARIANT(current::decay_t<T>)> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       T&& object,
       HTTPResponseCodeValue code,
       const http::Headers& headers,
@@ -309,7 +351,7 @@ struct HTTPResponder {
 
   template <class T>
   static std::enable_if_t<IS_CURRENT_STRUCT_OR_VARIANT(current::decay_t<T>)> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       T&& object,
       HTTPResponseCodeValue code,
       const http::Headers& headers) {
@@ -320,7 +362,7 @@ struct HTTPResponder {
 
   template <class T>
   static std::enable_if_t<IS_CURRENT_STRUCT_OR_VARIANT(current::decay_t<T>)> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       T&& object,
       HTTPResponseCodeValue code,
       const std::string& content_type) {
@@ -331,7 +373,7 @@ struct HTTPResponder {
 
   template <class T>
   static std::enable_if_t<IS_CURRENT_STRUCT_OR_VARIANT(current::decay_t<T>)> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       T&& object,
       HTTPResponseCodeValue code) {
     // TODO(dkorolev): We should probably make this not only correct but also efficient.
@@ -341,7 +383,7 @@ struct HTTPResponder {
 
   template <class T>
   static std::enable_if_t<IS_CURRENT_STRUCT_OR_VARIANT(current::decay_t<T>)> SendHTTPResponse(
-      Connection& connection,
+      ResponseConnection connection,
       T&& object) {
     // TODO(dkorolev): We should probably make this not only correct but also efficient.
     const std::string s = JSON(std::forward<T>(object)) + '\n';
@@ -352,6 +394,22 @@ struct HTTPResponder {
                          http::Headers(),
                          constants::kDefaultJSONContentType);
   }
+
+  // The part of a file as the body of the response, sent via `sendfile()`, without reading it into memory.
+  static void SendHTTPResponse(ResponseConnection connection,
+                               const HTTPFileBody& file,
+                               HTTPResponseCodeValue code,
+                               const http::Headers& headers,
+                               const std::string& content_type) {
+    std::ostringstream os;
+    PrepareHTTPResponseHeader(os, connection.connection_type, code, headers, content_type);
+    os << "Content-Length: " << file.length << constants::kCRLF << constants::kCRLF;
+    connection.connection.BlockingWrite(os.str(), file.length > 0u);
+    if (file.length) {
+      connection.connection.BlockingSendFile(file.fd, file.offset, file.length);
+    }
+    connection.SetSentCode(code);
+  }
 };
 
 // HTTPDefaultHelper handles headers and chunked transfers.
@@ -387,6 +445,25 @@ class HTTPDefaultHelper {
   char dummy_ = '\0';
 };
 
+// The read buffer of a persistent HTTP connection, reused across the requests served over this connection.
+// The first `carried_over_bytes` of `data` have already been received, and belong to the next request,
+// as the client is free to send it before having received the response to the previous one.
+struct HTTPReadBuffer final {
+  std::vector<char> data;
+  size_t carried_over_bytes = 0u;
+
+  // Whether the carried over bytes hold the complete head of the next request, so that parsing it will not wait
+  // for more data. The blank lines before the head are skipped, as per RFC 7230, section 3.5.
+  bool CarriesOverCompleteHead() const {
+    const std::string_view carried_over(data.data(), carried_over_bytes);
+    size_t begin = 0u;
+    while (begin + 1u < carried_over.length() && carried_over[begin] == '\r' && carried_over[begin + 1u] == '\n') {
+      begin += 2u;
+    }
+    return begin < carried_over.length() && carried_over.find("\r\n\r\n", begin) != std::string_view::npos;
+  }
+};
+
 // In constructor, GenericHTTPRequestData parses HTTP response from `Connection&` is was provided with.
 // Extracts method, path (URL + parameters), and, if provided, the body.
 //
@@ -408,219 +485,201 @@ class GenericHTTPRequestData : public HELPER {
       const typename HELPER::ConstructionParams& params = typename HELPER::ConstructionParams(),
       const int initial_buffer_size = 16 * 1024 + 1,
       const double buffer_growth_k = 1.95)
-      : HELPER(params), buffer_(initial_buffer_size) {
+      : GenericHTTPRequestData(c, HTTPReadBuffer(), params, initial_buffer_size, buffer_growth_k) {}
+
+  // The constructor to parse the next request from a persistent connection, reusing its read buffer.
+  inline GenericHTTPRequestData(
+      Connection& c,
+      HTTPReadBuffer&& read_buffer,
+      const typename HELPER::ConstructionParams& params = typename HELPER::ConstructionParams(),
+      const int initial_buffer_size = 16 * 1024 + 1,
+      const double buffer_growth_k = 1.95)
+      : HELPER(params), buffer_(std::move(read_buffer.data)) {
     // `offset` is the number of bytes read into `buffer_` so far.
     // `length_cap` is infinity first (size_t is unsigned), and it changes/ to the absolute offset
     // of the end of HTTP body in the buffer_, once `Content-Length` and two consecutive CRLS have been seen.
-    size_t offset = 0;
+    size_t offset = read_buffer.carried_over_bytes;
     size_t length_cap = static_cast<size_t>(-1);
 
-    // `current_line_offset` is the index of the first character after CRLF in `buffer_`.
-    size_t current_line_offset = 0;
+    // Leave room for at least one more byte to read, and for the '\0' after it.
+    buffer_.resize(std::max(buffer_.size(), std::max(static_cast<size_t>(initial_buffer_size), offset + 2)));
 
-    // `body_offset` and `body_length` describe the position of HTTP body, if it's not chunk-encoded.
-    size_t body_offset = static_cast<size_t>(-1);
-    size_t body_length = static_cast<size_t>(-1);
+    // The bytes carried over from the previous request may well contain the whole next request, so
+    // they should be parsed before attempting to read more data, or the server might wait for it forever.
+    bool parse_carried_over_bytes_first = (offset != 0u);
 
-    // `first_line_parsed` denotes whether the line being parsed is not the first one, with method and URL.
-    bool first_line_parsed = false;
+    // `head` is the incremental parser of the first line and the headers, resumed after each read.
+    HTTPHeadParser head;
 
-    // `chunked_transfer_encoding` is set when body should be received in chunks insted of a single read.
-    bool chunked_transfer_encoding = false;
+    // `current_line_offset` is the index of the first character of the chunk size line, if the body is chunked.
+    size_t current_line_offset = 0;
 
     // `receiving_body_in_chunks` is set to true when the parsing is already in the "receive body" mode.
     bool receiving_body_in_chunks = false;
 
     while (offset < length_cap) {
-      size_t chunk;
-      size_t read_count;
-      // Use `offset + 1` instead of just `offset` to leave room for the '\0'.
-      CURRENT_ASSERT(buffer_.size() > offset + 1);
-      // NOTE: This `if` should not be made a `while`, as it may so happen that the boundary between two
-      // consecutively received packets lays right on the final size, but instead of parsing the received body,
-      // the server would wait forever for more data to arrive from the client.
-      chunk = buffer_.size() - offset - 1;
-      read_count = c.BlockingRead(&buffer_[offset], chunk);
-      CURRENT_BRICKS_LOG_HTTP_EVENT(
-          "read %lu bytes while requested %lu (buffer offset %lu)\n", read_count, chunk, offset);
-      offset += read_count;
-      if (read_count == chunk && offset < length_cap) {
-        // The `std::max()` condition is kept just in case we compile Current for a device
-        // that is extremely short on memory, for which `buffer_growth_k` could be some 1.0001. -- D.K.
-        const size_t new_buffer_size =
-            std::max(static_cast<size_t>(buffer_.size() * buffer_growth_k), buffer_.size() + 1);
-        CURRENT_BRICKS_LOG_HTTP_EVENT("resize the buffer %lu -> %lu\n", buffer_.size(), new_buffer_size);
-        buffer_.resize(new_buffer_size);
-      }
-      if (!read_count) {
-        // This is worth re-checking, but as for 2014/12/06 the concensus of reading through man
-        // and StackOverflow is that a return value of zero from read() from a socket indicates
-        // that the socket has been closed by the peer.
-        CURRENT_THROW(ConnectionResetByPeer());  // LCOV_EXCL_LINE
+      if (parse_carried_over_bytes_first) {
+        parse_carried_over_bytes_first = false;
+      } else {
+        size_t chunk;
+        size_t read_count;
+        // Use `offset + 1` instead of just `offset` to leave room for the '\0'.
+        CURRENT_ASSERT(buffer_.size() > offset + 1);
+        // NOTE: This `if` should not be made a `while`, as it may so happen that the boundary between two
+        // consecutively received packets lays right on the final size, but instead of parsing the received body,
+        // the server would wait forever for more data to arrive from the client.
+        chunk = buffer_.size() - offset - 1;
+        read_count = c.BlockingRead(&buffer_[offset], chunk);
+        CURRENT_BRICKS_LOG_HTTP_EVENT(
+            "read %lu bytes while requested %lu (buffer offset %lu)\n", read_count, chunk, offset);
+        offset += read_count;
+        if (read_count == chunk && offset < length_cap) {
+          // The `std::max()` condition is kept just in case we compile Current for a device
+          // that is extremely short on memory, for which `buffer_growth_k` could be some 1.0001. -- D.K.
+          const size_t new_buffer_size =
+              std::max(static_cast<size_t>(buffer_.size() * buffer_growth_k), buffer_.size() + 1);
+          CURRENT_BRICKS_LOG_HTTP_EVENT("resize the buffer %lu -> %lu\n", buffer_.size(), new_buffer_size);
+          buffer_.resize(new_buffer_size);
+        }
+        if (!read_count) {
+          // This is worth re-checking, but as for 2014/12/06 the concensus of reading through man
+          // and StackOverflow is that a return value of zero from read() from a socket indicates
+          // that the socket has been closed by the peer.
+          CURRENT_THROW(ConnectionResetByPeer());  // LCOV_EXCL_LINE
+        }
       }
       buffer_[offset] = '\0';
+      if (!receiving_body_in_chunks) {
+        if (!head.Parse(&buffer_[0], offset)) {
+          continue;
+        }
+        CURRENT_BRICKS_LOG_HTTP_EVENT("http header is parsed\n");
+        const bool chunked_transfer_encoding = OnHeadParsed(c, head);
+        // HTTP body starts right after the blank line.
+        const size_t body_offset = head.HeadLength();
+        if (!chunked_transfer_encoding) {
+          // Non-chunked encoding. Assume BODY follows as raw data.
+          // Only accept HTTP body if Content-Length has been set; ignore it otherwise.
+          if (has_content_length_) {
+            // Has HTTP body to parse.
+            length_cap = body_offset + body_length_;
+            // Keep in mind that `buffer_` should have the size of `length_cap + 1`, to include the `\0'.
+            if (length_cap + 1 > buffer_.size()) {
+              buffer_.resize(length_cap + 1);
+            }
+            if (length_cap > offset) {
+              const size_t bytes_to_read = length_cap - offset;
+              if (bytes_to_read != c.BlockingRead(&buffer_[offset], bytes_to_read, Connection::FillFullBuffer)) {
+                CURRENT_THROW(ConnectionResetByPeer());  // LCOV_EXCL_LINE
+              }
+            }
+            body_buffer_begin_ = &buffer_[body_offset];
+            body_buffer_end_ = body_buffer_begin_ + body_length_;
+            request_end_offset_ = length_cap;
+            received_bytes_ = std::max(offset, length_cap);
+            return;
+          } else {
+            if (NeedContentLengthHeader(method_)) {
+              HTTPResponder::SendHTTPResponse(c,
+                                              net::DefaultLengthRequiredMessage(),
+                                              HTTPResponseCode.LengthRequired,
+                                              http::Headers(),
+                                              net::constants::kDefaultHTMLContentType);
+              CURRENT_THROW(HTTPRequestBodyLengthNotProvided());
+            }
+            request_end_offset_ = body_offset;
+            received_bytes_ = offset;
+            return;
+          }
+        } else {
+          receiving_body_in_chunks = true;
+          current_line_offset = body_offset;
+        }
+      }
       char* next_crlf_ptr;
-      while ((body_offset == static_cast<size_t>(-1) || offset < body_offset) &&
-             (next_crlf_ptr = strstr(&buffer_[current_line_offset], constants::kCRLF))) {
+      while ((next_crlf_ptr = strstr(&buffer_[current_line_offset], constants::kCRLF))) {
         const bool line_is_blank = (next_crlf_ptr == &buffer_[current_line_offset]);
         *next_crlf_ptr = '\0';
         // `next_line_offset` is mutable since reading chunked body will change it.
         size_t next_line_offset = next_crlf_ptr + constants::kCRLFLength - &buffer_[0];
-        if (!first_line_parsed) {
-          if (!line_is_blank) {
-            // It's recommended by W3 to wait for the first line ignoring prior CRLF-s.
-            const std::vector<std::string> pieces =
-                strings::Split<strings::ByWhitespace>(&buffer_[current_line_offset]);
-            if (pieces.size() >= 1) {
-              method_ = pieces[0];
-            }
-            if (pieces.size() >= 2) {
-              raw_path_ = pieces[1];
-              url_ = current::url::URL(raw_path_);
-            }
-            first_line_parsed = true;
-          }
-        } else if (receiving_body_in_chunks) {
-          // Ignore blank lines.
-          if (!line_is_blank) {
-            const size_t chunk_length = static_cast<size_t>([&]() {
-              try {
-                return std::stoi(&buffer_[current_line_offset], nullptr, 16);
-              } catch (const std::invalid_argument&) {
-                // Not a valid hexadecimal chunk size. HTTP bad request is it.
-                HTTPResponder::SendHTTPResponse(c,
-                                                net::DefaultInvalidHEXChunkSizeBadRequestMessage(),
-                                                HTTPResponseCode.BadRequest,
-                                                net::http::Headers(),
-                                                net::constants::kDefaultHTMLContentType);
-                CURRENT_THROW(ChunkSizeNotAValidHEXValue());
-              }
-            }());
-            if (chunk_length == 0) {
-              // Done with the body.
-              HELPER::OnChunkedBodyDone(body_buffer_begin_, body_buffer_end_);
-              return;
-            } else {
-              // A chunk of length `chunk_length` bytes starts right at next_line_offset.
-              size_t chunk_offset = next_line_offset;
-              // First, make sure it has been read.
-              size_t next_offset = chunk_offset + chunk_length;
-              if (offset < next_offset) {
-                const size_t bytes_to_read = next_offset - offset;
-                // We need at least one more byte for the padding `\0`.
-                if (buffer_.size() < next_offset + 1) {
-                  if (chunk_offset >= next_offset + 1 - buffer_.size()) {
-                    CURRENT_BRICKS_LOG_HTTP_EVENT("memmove %lu bytes from offset %lu to fit the entire chunk\n",
-                                                  offset - chunk_offset,
-                                                  chunk_offset);
-                    std::memmove(&buffer_[0], &buffer_[chunk_offset], offset - chunk_offset);
-                    offset -= chunk_offset;
-                    next_offset -= chunk_offset;
-                    chunk_offset = 0;
-                  } else {
-                    // LCOV_EXCL_START
-                    // TODO(dkorolev): See if this can be tested better; now the test for these lines is flaky.
-                    const size_t new_buffer_size =
-                        std::max(static_cast<size_t>(buffer_.size() * buffer_growth_k), next_offset + 1);
-                    CURRENT_BRICKS_LOG_HTTP_EVENT(
-                        "resize the buffer %lu -> %lu to fit the entire chunk\n", buffer_.size(), new_buffer_size);
-                    buffer_.resize(new_buffer_size);
-                    // LCOV_EXCL_STOP
-                  }
-                }
-                if (bytes_to_read != c.BlockingRead(&buffer_[offset], bytes_to_read, Connection::FillFullBuffer)) {
-                  CURRENT_THROW(ConnectionResetByPeer());  // LCOV_EXCL_LINE
-                }
-                CURRENT_BRICKS_LOG_HTTP_EVENT("read %lu more bytes of a chunk at offset %lu\n", bytes_to_read, offset);
-                offset = next_offset;
-                buffer_[offset] = '\0';
-              }
-
-              // Then, append this newly parsed or received chunk to the body.
-              CURRENT_BRICKS_LOG_HTTP_EVENT("process a %lu bytes long chunk\n", chunk_length);
-              HELPER::OnChunk(&buffer_[chunk_offset], chunk_length);
-              CURRENT_ASSERT(body_offset == static_cast<size_t>(-1));
-              next_line_offset = next_offset;
+        // Ignore blank lines.
+        if (!line_is_blank) {
+          const size_t chunk_length = static_cast<size_t>([&]() {
+            try {
+              return std::stoi(&buffer_[current_line_offset], nullptr, 16);
+            } catch (const std::invalid_argument&) {
+              // Not a valid hexadecimal chunk size. HTTP bad request is it.
+              HTTPResponder::SendHTTPResponse(c,
+                                              net::DefaultInvalidHEXChunkSizeBadRequestMessage(),
+                                              HTTPResponseCode.BadRequest,
+                                              net::http::Headers(),
+                                              net::constants::kDefaultHTMLContentType);
+              CURRENT_THROW(ChunkSizeNotAValidHEXValue());
             }
-          }
-        } else if (!line_is_blank) {
-          char* p = strchr(&buffer_[current_line_offset], constants::kHeaderKeyValueSeparator);
-          if (p) {
-            *p++ = '\0';
-            const char* const key = &buffer_[current_line_offset];
-            const char* value = p;
-
-            // Ignore trailing spaces and tabs before and after the value.
-            const auto IsSpaceOrTab = [](const char c) { return c == ' ' || c == '\t'; };
-            while (value < next_crlf_ptr && IsSpaceOrTab(*value)) {
-              ++value;
-            }
-            while (next_crlf_ptr > value && IsSpaceOrTab(*(next_crlf_ptr - 1))) {
-              --next_crlf_ptr;
-            }
-            *next_crlf_ptr = '\0';
-
-            HELPER::OnHeader(key, value);
-            if (HeaderNameEquals(key, constants::kContentLengthHeaderKey)) {
-              body_length = static_cast<size_t>(atoi(value));
-              if (body_length > constants::kMaxHTTPPayloadSizeInBytes) {
-                HTTPResponder::SendHTTPResponse(c,
-                                                net::DefaultRequestEntityTooLargeMessage(),
-                                                HTTPResponseCode.RequestEntityTooLarge,
-                                                http::Headers(),
-                                                net::constants::kDefaultHTMLContentType);
-                CURRENT_THROW(HTTPPayloadTooLarge());
-              }
-            } else if (HeaderNameEquals(key, constants::kHTTPMethodOverrideHeaderKey)) {
-              method_ = current::strings::ToUpper(value);
-            } else if (HeaderNameEquals(key, constants::kTransferEncodingHeaderKey)) {
-              if (HeaderNameEquals(value, constants::kTransferEncodingChunkedValue)) {
-                chunked_transfer_encoding = true;
+          }());
+          if (chunk_length == 0) {
+            // Done with the body. Consume the trailers, if any, and the blank line ending the message, as far as they
+            // have been received, so that they are not taken for the beginning of the next request. Not waiting for
+            // more of them, as some clients end the chunked body with just the "0" line.
+            size_t trailer_offset = next_line_offset;
+            const char* trailer_crlf_ptr;
+            while (trailer_offset < offset &&
+                   (trailer_crlf_ptr = strstr(&buffer_[trailer_offset], constants::kCRLF))) {
+              const bool trailer_is_blank = (trailer_crlf_ptr == &buffer_[trailer_offset]);
+              trailer_offset = trailer_crlf_ptr + constants::kCRLFLength - &buffer_[0];
+              if (trailer_is_blank) {
+                break;
               }
             }
-          }
-        } else {
-          CURRENT_BRICKS_LOG_HTTP_EVENT("http header is parsed\n");
-          // The blank line is what separates HTTP headers from HTTP body.
-          if (!chunked_transfer_encoding) {
-            // HTTP body starts right after this last CRLF.
-            body_offset = next_line_offset;
-            // Non-chunked encoding. Assume BODY follows as raw data.
-            // Only accept HTTP body if Content-Length has been set; ignore it otherwise.
-            if (body_length != static_cast<size_t>(-1)) {
-              // Has HTTP body to parse.
-              length_cap = body_offset + body_length;
-              // Keep in mind that `buffer_` should have the size of `length_cap + 1`, to include the `\0'.
-              if (length_cap + 1 > buffer_.size()) {
-                buffer_.resize(length_cap + 1);
-              }
-              if (length_cap > offset) {
-                const size_t bytes_to_read = length_cap - offset;
-                if (bytes_to_read != c.BlockingRead(&buffer_[offset], bytes_to_read, Connection::FillFullBuffer)) {
-                  CURRENT_THROW(ConnectionResetByPeer());  // LCOV_EXCL_LINE
+            HELPER::OnChunkedBodyDone(body_buffer_begin_, body_buffer_end_);
+            request_end_offset_ = trailer_offset;
+            received_bytes_ = offset;
+            return;
+          } else {
+            // A chunk of length `chunk_length` bytes starts right at next_line_offset.
+            size_t chunk_offset = next_line_offset;
+            // First, make sure it has been read.
+            size_t next_offset = chunk_offset + chunk_length;
+            if (offset < next_offset) {
+              const size_t bytes_to_read = next_offset - offset;
+              // We need at least one more byte for the padding `\0`.
+              if (buffer_.size() < next_offset + 1) {
+                if (chunk_offset >= next_offset + 1 - buffer_.size()) {
+                  CURRENT_BRICKS_LOG_HTTP_EVENT("memmove %lu bytes from offset %lu to fit the entire chunk\n",
+                                                offset - chunk_offset,
+                                                chunk_offset);
+                  std::memmove(&buffer_[0], &buffer_[chunk_offset], offset - chunk_offset);
+                  offset -= chunk_offset;
+                  next_offset -= chunk_offset;
+                  chunk_offset = 0;
+                } else {
+                  // LCOV_EXCL_START
+                  // TODO(dkorolev): See if this can be tested better; now the test for these lines is flaky.
+                  const size_t new_buffer_size =
+                      std::max(static_cast<size_t>(buffer_.size() * buffer_growth_k), next_offset + 1);
+                  CURRENT_BRICKS_LOG_HTTP_EVENT(
+                      "resize the buffer %lu -> %lu to fit the entire chunk\n", buffer_.size(), new_buffer_size);
+                  buffer_.resize(new_buffer_size);
+                  // LCOV_EXCL_STOP
                 }
               }
-              body_buffer_begin_ = &buffer_[body_offset];
-              body_buffer_end_ = body_buffer_begin_ + body_length;
-              return;
-            } else {
-              if (NeedContentLengthHeader(method_)) {
-                HTTPResponder::SendHTTPResponse(c,
-                                                net::DefaultLengthRequiredMessage(),
-                                                HTTPResponseCode.LengthRequired,
-                                                http::Headers(),
-                                                net::constants::kDefaultHTMLContentType);
-                CURRENT_THROW(HTTPRequestBodyLengthNotProvided());
+              if (bytes_to_read != c.BlockingRead(&buffer_[offset], bytes_to_read, Connection::FillFullBuffer)) {
+                CURRENT_THROW(ConnectionResetByPeer());  // LCOV_EXCL_LINE
               }
-              return;
+              CURRENT_BRICKS_LOG_HTTP_EVENT("read %lu more bytes of a chunk at offset %lu\n", bytes_to_read, offset);
+              offset = next_offset;
+              buffer_[offset] = '\0';
             }
-          } else {
-            receiving_body_in_chunks = true;
+
+            // Then, append this newly parsed or received chunk to the body.
+            CURRENT_BRICKS_LOG_HTTP_EVENT("process a %lu bytes long chunk\n", chunk_length);
+            HELPER::OnChunk(&buffer_[chunk_offset], chunk_length);
+            next_line_offset = next_offset;
           }
         }
         current_line_offset = next_line_offset;
       }
-      if (receiving_body_in_chunks && current_line_offset) {
+      if (current_line_offset) {
         if (offset > current_line_offset) {
           CURRENT_BRICKS_LOG_HTTP_EVENT("memmove %lu bytes from offset %lu to the beginning\n",
                                         offset - current_line_offset,
@@ -637,7 +696,14 @@ class GenericHTTPRequestData : public HELPER {
   }
 
   inline const std::string& Method() const { return method_; }
-  inline const current::url::URL& URL() const { return url_; }
+  // The URL is parsed upon the first call, as, for instance, it is not needed for HTTP responses.
+  inline const current::url::URL& URL() const {
+    if (!url_) {
+      url_ = raw_path_.empty() ? std::make_unique<current::url::URL>()
+                               : std::make_unique<current::url::URL>(raw_path_);
+    }
+    return *url_;
+  }
   inline const std::string& RawPath() const { return raw_path_; }
 
   // Note that `Body*()` methods assume that the body was fully read into memory.
@@ -668,7 +734,88 @@ class GenericHTTPRequestData : public HELPER {
     }
   }
 
+  // Whether the client is fine with the connection being reused for further requests once this one is served.
+  inline bool KeepAliveRequested() const { return keep_alive_requested_; }
+
+  // Whether the end of this message is defined by `Content-Length`, as opposed to by closing the connection.
+  inline bool HasContentLength() const { return has_content_length_; }
+
+  // The number of bytes received after the end of this message, i.e. belonging to the next one.
+  inline size_t ReceivedBytesBeyondThisMessage() const { return received_bytes_ - request_end_offset_; }
+
+  // Gives away the buffer, with the already received bytes of the next request moved to its beginning.
+  // Invalidates `Body*()`, and thus may only be called once this request has been fully served.
+  // The blank lines before the next request are dropped, as per RFC 7230, section 3.5.
+  HTTPReadBuffer ReleaseReadBufferForNextRequest() {
+    while (request_end_offset_ + 1u < received_bytes_ && buffer_[request_end_offset_] == '\r' &&
+           buffer_[request_end_offset_ + 1u] == '\n') {
+      request_end_offset_ += 2u;
+    }
+    HTTPReadBuffer result;
+    result.carried_over_bytes = ReceivedBytesBeyondThisMessage();
+    if (result.carried_over_bytes) {
+      std::memmove(&buffer_[0], &buffer_[request_end_offset_], result.carried_over_bytes);
+    }
+    result.data = std::move(buffer_);
+    body_buffer_begin_ = nullptr;
+    body_buffer_end_ = nullptr;
+    return result;
+  }
+
  private:
+  // Extracts what is needed from the first line and the headers. Returns whether the body is chunk-encoded.
+  bool OnHeadParsed(Connection& c, const HTTPHeadParser& head) {
+    const char* const buffer = &buffer_[0];
+    if (head.FirstLinePiecesCount() >= 1) {
+      method_.assign(head.FirstLinePiece(0).Begin(buffer), head.FirstLinePiece(0).length);
+    }
+    if (head.FirstLinePiecesCount() >= 2) {
+      raw_path_.assign(head.FirstLinePiece(1).Begin(buffer), head.FirstLinePiece(1).length);
+    }
+    // HTTP/1.1 connections are persistent by default, unless `Connection: close` is sent.
+    // The version is the last piece of the request line, and the first piece of the response status line.
+    const std::string_view http11(constants::kHTTP11Version);
+    keep_alive_requested_ =
+        (head.FirstLinePiecesCount() >= 3 && head.FirstLinePiece(2).In(buffer) == http11) ||
+        (head.FirstLinePiecesCount() >= 2 && head.FirstLinePiece(0).In(buffer) == http11);
+    bool chunked_transfer_encoding = false;
+    for (size_t i = 0u; i < head.HeadersCount(); ++i) {
+      // The keys and the values are '\0'-terminated in place by the parser.
+      const char* const key = head.Header(i).key.Begin(buffer);
+      const char* const value = head.Header(i).value.Begin(buffer);
+      HELPER::OnHeader(key, value);
+      if (HeaderNameEquals(key, constants::kContentLengthHeaderKey)) {
+        body_length_ = static_cast<size_t>(atoi(value));
+        has_content_length_ = true;
+        if (body_length_ > constants::kMaxHTTPPayloadSizeInBytes) {
+          HTTPResponder::SendHTTPResponse(c,
+                                          net::DefaultRequestEntityTooLargeMessage(),
+                                          HTTPResponseCode.RequestEntityTooLarge,
+                                          http::Headers(),
+                                          net::constants::kDefaultHTMLContentType);
+          CURRENT_THROW(HTTPPayloadTooLarge());
+        }
+      } else if (HeaderNameEquals(key, constants::kHTTPMethodOverrideHeaderKey)) {
+        method_ = current::strings::ToUpper(value);
+      } else if (HeaderNameEquals(key, constants::kTransferEncodingHeaderKey)) {
+        if (HeaderNameEquals(value, constants::kTransferEncodingChunkedValue)) {
+          chunked_transfer_encoding = true;
+        }
+      } else if (HeaderNameEquals(key, constants::kConnectionHeaderKey)) {
+        if (HeaderNameEquals(value, constants::kConnectionCloseValue)) {
+          keep_alive_requested_ = false;
+        } else if (HeaderNameEquals(value, constants::kConnectionKeepAliveValue)) {
+          keep_alive_requested_ = true;
+        }
+      }
+    }
+    if (chunked_transfer_encoding) {
+      // The body of the chunked message is not delimited by `Content-Length`.
+      has_content_length_ = false;
+    }
+    return chunked_transfer_encoding;
+  }
+
   static char NormalizeHeaderChar(char c) { return c != '_' ? std::tolower(c) : '-'; }
   static bool HeaderNameEquals(const char* lhs, const char* rhs) {
     while (*lhs && *rhs) {
@@ -681,13 +828,18 @@ class GenericHTTPRequestData : public HELPER {
 
   // Fields available to the user via getters.
   std::string method_;
-  current::url::URL url_;
+  mutable std::unique_ptr<current::url::URL> url_;
   std::string raw_path_;
 
   // HTTP parsing fields that have to be caried out of the parsing routine.
   std::vector<char> buffer_;                 // The buffer into which data has been read, except for chunked case.
   const char* body_buffer_begin_ = nullptr;  // If BODY has been provided, pointer pair to it.
   const char* body_buffer_end_ = nullptr;    // Will not be nullptr if body_buffer_begin_ is not nullptr.
+  size_t request_end_offset_ = 0u;           // The offset in `buffer_` right after the end of this request.
+  size_t received_bytes_ = 0u;               // The number of bytes in `buffer_` received from the socket.
+  bool keep_alive_requested_ = false;        // Whether the client has asked for a persistent connection.
+  bool has_content_length_ = false;          // Whether the body was read as per the `Content-Length` header.
+  size_t body_length_ = 0u;                  // The value of the `Content-Length` header, if it was provided.
 
   // HTTP body gets converted to an std::string representation as it's first requested.
   // TODO(dkorolev): This pattern is worth revisiting. StringPiece?
@@ -706,17 +858,59 @@ using HTTPRequestData = GenericHTTPRequestData<HTTPDefaultHelper>;
 
 enum class ChunkFlush : bool { NoFlush = false, Flush = true };
 
+// What is known of a request served by `GenericHTTPServerConnection`, once the connection is done with:
+// once the response has been sent in full, or once the connection has been released without sending it.
+struct HTTPServedRequestStats final {
+  HTTPResponseCodeValue code = HTTPResponseCode.InvalidCode;  // `InvalidCode` if no response has been sent.
+  uint64_t bytes_in = 0u;                                      // The head and the body of the request.
+  uint64_t bytes_out = 0u;                                     // The head and the body of the response.
+  std::chrono::microseconds parse_time = std::chrono::microseconds(0);    // Receiving and parsing the request.
+  std::chrono::microseconds handler_time = std::chrono::microseconds(0);  // From then on to the response sent.
+};
+
+// Is notified of each served request it has been attached to, from the thread that has released the connection.
+// Used by the HTTP server to collect the metrics of its routes. Must not throw.
+class HTTPServedRequestObserver {
+ public:
+  virtual ~HTTPServedRequestObserver() = default;
+  virtual void OnServedRequest(const HTTPServedRequestStats& stats) = 0;
+};
+
+// Takes over the connection once the response to the request has been sent in full and the connection is to be
+// kept alive, along with its read buffer, instead of closing it. Used by the HTTP server to serve further requests.
+using HTTPKeepAliveConnectionRecycler = std::function<void(Connection&&, HTTPReadBuffer&&)>;
+
 template <class HTTP_REQUEST_DATA>
 class GenericHTTPServerConnection final : public HTTPResponder {
  public:
-  // The only constructor parses HTTP headers coming from the socket
+  // The constructors parse HTTP headers coming from the socket
   // in the constructor of `message_(connection_)`.
   GenericHTTPServerConnection(
       Connection&& c,
       const typename HTTP_REQUEST_DATA::ConstructionParams& params = typename HTTP_REQUEST_DATA::ConstructionParams(),
       const int initial_buffer_size = 16 * 1024 + 1,
       const double buffer_growth_k = 1.95)
-      : connection_(std::move(c)), message_(connection_, params, initial_buffer_size, buffer_growth_k) {}
+      : connection_(std::move(c)),
+        bytes_read_before_(connection_.BytesRead()),
+        bytes_written_before_(connection_.BytesWritten()),
+        message_(connection_, params, initial_buffer_size, buffer_growth_k) {}
+
+  // The constructor for persistent connections: the response is sent with `Connection: keep-alive`
+  // if the client allows for it, and then the connection is handed over to `recycler` instead of being closed.
+  GenericHTTPServerConnection(
+      Connection&& c,
+      HTTPReadBuffer&& read_buffer,
+      HTTPKeepAliveConnectionRecycler recycler,
+      const typename HTTP_REQUEST_DATA::ConstructionParams& params = typename HTTP_REQUEST_DATA::ConstructionParams(),
+      const int initial_buffer_size = 16 * 1024 + 1,
+      const double buffer_growth_k = 1.95)
+      : connection_(std::move(c)),
+        // The bytes carried over have been read from this connection already, and belong to this request.
+        bytes_read_before_(connection_.BytesRead() - read_buffer.carried_over_bytes),
+        bytes_written_before_(connection_.BytesWritten()),
+        message_(connection_, std::move(read_buffer), params, initial_buffer_size, buffer_growth_k),
+        recycler_(message_.KeepAliveRequested() ? std::move(recycler) : nullptr) {}
+
   ~GenericHTTPServerConnection() {
     if (!responded_) {
       // If a user code throws an exception in a different thread, it will not be caught.
@@ -729,6 +923,7 @@ class GenericHTTPServerConnection final : public HTTPResponder {
                                         HTTPResponseCode.InternalServerError,
                                         http::Headers(),
                                         net::constants::kDefaultHTMLContentType);
+        response_code_ = HTTPResponseCode.InternalServerError;
       } catch (const Exception& e) {
         // No exception should ever leave the destructor.
         if (message_.RawPath() == "/healthz") {
@@ -743,6 +938,33 @@ class GenericHTTPServerConnection final : public HTTPResponder {
       }
       // LCOV_EXCL_STOP
     }
+    if (observer_) {
+      HTTPServedRequestStats stats;
+      stats.code = response_code_;
+      stats.bytes_in = connection_.BytesRead() - bytes_read_before_ - message_.ReceivedBytesBeyondThisMessage();
+      stats.bytes_out = connection_.BytesWritten() - bytes_written_before_;
+      stats.parse_time = parse_time_;
+      stats.handler_time =
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - observed_since_);
+      observer_->OnServedRequest(stats);
+    }
+    if (responded_ && keep_alive_response_sent_) {
+      try {
+        recycler_(std::move(connection_), message_.ReleaseReadBufferForNextRequest());
+      } catch (const std::exception& e) {  // LCOV_EXCL_LINE
+        // No exception should ever leave the destructor.
+        std::cerr << "Failed to keep the HTTP connection alive: " << e.what() << std::endl;  // LCOV_EXCL_LINE
+      }
+    }
+  }
+
+  // Has `observer` notified of this request once it has been served. The time it took to receive and parse
+  // the request is to be measured by the caller, and the handler time is counted from this call on.
+  void SetServedRequestObserver(std::shared_ptr<HTTPServedRequestObserver> observer,
+                                std::chrono::microseconds parse_time) {
+    observer_ = std::move(observer);
+    parse_time_ = parse_time;
+    observed_since_ = std::chrono::steady_clock::now();
   }
 
   template <typename... ARGS>
@@ -750,7 +972,14 @@ class GenericHTTPServerConnection final : public HTTPResponder {
     if (responded_) {
       CURRENT_THROW(AttemptedToSendHTTPResponseMoreThanOnce());
     } else {
-      HTTPResponder::SendHTTPResponse(connection_, std::forward<ARGS>(args)...);
+      if (recycler_) {
+        HTTPResponder::SendHTTPResponse(ResponseConnection(connection_, ConnectionKeepAlive, &response_code_),
+                                        std::forward<ARGS>(args)...);
+        keep_alive_response_sent_ = true;
+      } else {
+        HTTPResponder::SendHTTPResponse(ResponseConnection(connection_, ConnectionClose, &response_code_),
+                                        std::forward<ARGS>(args)...);
+      }
       responded_ = true;
     }
   }
@@ -765,36 +994,85 @@ class GenericHTTPServerConnection final : public HTTPResponder {
       ~Impl() {
         if (!can_no_longer_write_) {
           try {
-            if (cache_size_) {
-              connection_.BlockingWrite(data_cache_, static_cast<size_t>(cache_size_), true);
-            }
-            connection_.BlockingWrite("0", true);
-            // Should send CRLF twice.
-            connection_.BlockingWrite(constants::kCRLF, true);
-            connection_.BlockingWrite(constants::kCRLF, false);
+            // The cached and the coalesced data, if any, and the final "zero" chunk go out in one system call.
+            static const char kLastChunk[] = "0\r\n\r\n";
+            const std::string pending_header = pending_.empty() ? "" : ChunkHeader(pending_.size());
+            const Connection::WriteBuffer buffers[] = {
+                {data_cache_, static_cast<size_t>(cache_size_)},
+                {pending_header.data(), pending_header.size()},
+                {pending_.data(), pending_.size()},
+                {constants::kCRLF, pending_.empty() ? 0u : constants::kCRLFLength},
+                {kLastChunk, sizeof(kLastChunk) - 1u}};
+            connection_.BlockingWriteV(buffers, sizeof(buffers) / sizeof(buffers[0]), false);
           } catch (const SocketException& e) {                                          // LCOV_EXCL_LINE
             std::cerr << "Chunked response closure failed: " << e.what() << std::endl;  // LCOV_EXCL_LINE
           }                                                                             // LCOV_EXCL_LINE
         }
       }
 
+      static std::string ChunkHeader(size_t size) { return strings::Printf("%lX", size) + constants::kCRLF; }
+
+      // Writes the cached chunks, if any, followed by the chunk of `size` bytes at `data`, with one system call.
+      void WriteCacheAndChunk(const std::string& chunk_header, const void* data, size_t size) {
+        const Connection::WriteBuffer buffers[] = {{data_cache_, static_cast<size_t>(cache_size_)},
+                                                   {chunk_header.data(), chunk_header.size()},
+                                                   {data, size},
+                                                   {constants::kCRLF, constants::kCRLFLength}};
+        connection_.BlockingWriteV(buffers, sizeof(buffers) / sizeof(buffers[0]), false);
+        cache_size_ = 0;
+      }
+
+      void EnableCoalescing(size_t max_bytes, std::chrono::microseconds max_delay) {
+        coalesced_chunk_size_ = max_bytes;
+        coalesced_chunk_max_delay_ = max_delay;
+      }
+
+      // Sends whatever has been cached or coalesced so far.
+      void Flush() {
+        try {
+          if (!pending_.empty()) {
+            WriteCacheAndChunk(ChunkHeader(pending_.size()), pending_.data(), pending_.size());
+            pending_.clear();
+          } else if (cache_size_) {
+            connection_.BlockingWrite(data_cache_, static_cast<size_t>(cache_size_), false);
+            cache_size_ = 0;
+          }
+        } catch (const SocketException&) {
+          can_no_longer_write_ = true;
+          throw;
+        }
+      }
+
       // The actual implementation of sending HTTP chunk data.
       template <typename T>
       void SendImpl(T&& data, ChunkFlush flush) {
+        if (coalesced_chunk_size_) {
+          // Many small pieces of data become one HTTP chunk, sent once it is large or old enough.
+          if (!data.empty()) {
+            const auto now = std::chrono::steady_clock::now();
+            if (pending_.empty()) {
+              pending_since_ = now;
+            }
+            pending_.append(&data[0], &data[0] + data.size());
+            if (pending_.size() >= coalesced_chunk_size_ || now - pending_since_ >= coalesced_chunk_max_delay_) {
+              Flush();
+            }
+          }
+          return;
+        }
         if (!data.empty() || (flush == ChunkFlush::Flush && cache_size_)) {
           try {
             if (!data.empty()) {
-              const auto chunk_header = strings::Printf("%lX", data.size()) + constants::kCRLF;
+              const auto chunk_header = ChunkHeader(data.size());
               const auto chunk_size = chunk_header.size() + data.size() + constants::kCRLFLength;
-              if (cache_size_ && (flush == ChunkFlush::Flush || chunk_size > CACHE_SIZE - cache_size_)) {
-                connection_.BlockingWrite(data_cache_, static_cast<size_t>(cache_size_), true);
-                cache_size_ = 0;
-              }
               if (flush == ChunkFlush::Flush || chunk_size > CACHE_SIZE) {
-                connection_.BlockingWrite(chunk_header, true);
-                connection_.BlockingWrite(std::forward<T>(data), true);
-                connection_.BlockingWrite(constants::kCRLF, false);
+                // The cached chunks, the chunk header, the payload and the CRLF go out with a single system call.
+                WriteCacheAndChunk(chunk_header, &data[0], data.size());
               } else {
+                if (cache_size_ && chunk_size > CACHE_SIZE - cache_size_) {
+                  connection_.BlockingWrite(data_cache_, static_cast<size_t>(cache_size_), true);
+                  cache_size_ = 0;
+                }
                 ::memcpy(data_cache_ + cache_size_, chunk_header.c_str(), chunk_header.size());
                 cache_size_ += chunk_header.size();
                 const size_t data_size = data.size();
@@ -840,6 +1118,11 @@ class GenericHTTPServerConnection final : public HTTPResponder {
       bool can_no_longer_write_ = false;
       char data_cache_[CACHE_SIZE];
       uint64_t cache_size_ = 0;
+      // The coalescing mode, enabled by `Coalesce()`: the data not yet sent, and since when it has been waiting.
+      size_t coalesced_chunk_size_ = 0u;
+      std::chrono::microseconds coalesced_chunk_max_delay_ = std::chrono::microseconds(0);
+      std::string pending_;
+      std::chrono::steady_clock::time_point pending_since_;
 
       Impl() = delete;
       Impl(const Impl&) = delete;
@@ -850,6 +1133,23 @@ class GenericHTTPServerConnection final : public HTTPResponder {
 
     explicit ChunkedResponseSender(Connection& connection) : impl_(new Impl(connection)) {}
 
+    // Switches to coalescing the data passed to `Send()`, regardless of its `ChunkFlush` argument, into HTTP chunks
+    // of about `max_bytes`. A chunk is sent once it has reached `max_bytes`, or, upon `Send()`, once its first byte
+    // has been waiting for `max_delay`, or upon an explicit `Flush()`, which is how to send it right away.
+    ChunkedResponseSender& Coalesce(
+        size_t max_bytes = CURRENT_BRICKS_HTTP_DEFAULT_COALESCED_CHUNK_SIZE,
+        std::chrono::microseconds max_delay =
+            std::chrono::microseconds(CURRENT_BRICKS_HTTP_DEFAULT_COALESCED_CHUNK_MAX_DELAY_US)) {
+      impl_->EnableCoalescing(max_bytes, max_delay);
+      return *this;
+    }
+
+    // Sends the data cached or coalesced so far.
+    ChunkedResponseSender& Flush() {
+      impl_->Flush();
+      return *this;
+    }
+
     template <typename T>
     inline ChunkedResponseSender& Send(T&& data, ChunkFlush flush = ChunkFlush::Flush) {
       impl_->Send(std::forward<T>(data), flush);
@@ -890,6 +1190,7 @@ class GenericHTTPServerConnection final : public HTTPResponder {
       PrepareHTTPResponseHeader(os, ConnectionKeepAlive, code, headers, content_type);
       os << "Transfer-Encoding: chunked" << constants::kCRLF << constants::kCRLF;
       connection_.BlockingWrite(os.str(), true);
+      response_code_ = code;
       return ChunkedResponseSender<CACHE_SIZE>(connection_);
     }
   }
@@ -912,8 +1213,18 @@ class GenericHTTPServerConnection final : public HTTPResponder {
 
  private:
   bool responded_ = false;
+  bool keep_alive_response_sent_ = false;
+  HTTPResponseCodeValue response_code_ = HTTPResponseCode.InvalidCode;
   Connection connection_;
+  // Must be initialized before `message_`, which reads the request in its constructor.
+  const uint64_t bytes_read_before_;
+  const uint64_t bytes_written_before_;
   GenericHTTPRequestData<HTTP_REQUEST_DATA> message_;
+  HTTPKeepAliveConnectionRecycler recycler_;  // Only set if the connection may be kept alive.
+
+  std::shared_ptr<HTTPServedRequestObserver> observer_;  // Only set if the request is to be reported.
+  std::chrono::microseconds parse_time_ = std::chrono::microseconds(0);
+  std::chrono::steady_clock::time_point observed_since_;
 
   // Disable any copy/move support for extra safety.
   GenericHTTPServerConnection(const GenericHTTPServerConnection&) = delete;
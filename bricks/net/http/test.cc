@@ -44,6 +44,7 @@ using current::net::Connection;
 using current::net::ConnectionResetByPeer;
 using current::net::DefaultInternalServerErrorMessage;
 using current::net::GetFileMimeType;
+using current::net::HTTPHeadParser;
 using current::net::HTTPRequestData;
 using current::net::HTTPResponseCodeAsString;
 using current::net::HTTPResponseCodeValue;
@@ -68,6 +69,50 @@ CURRENT_STRUCT(HTTPTestObject) {
   CURRENT_DEFAULT_CONSTRUCTOR(HTTPTestObject) : number(42), text("text"), array({1, 2, 3}) {}
 };
 
+TEST(PosixHTTPServerTest, HeadParserResumesAcrossPartialReads) {
+  std::string message =
+      "\r\n"
+      "GET /path?a=1 HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "X-Spaces: \t  value with spaces \t\r\n"
+      "X-Line-Feed: a\nb\r\n"
+      "Not a header\r\n"
+      "\r\n"
+      "body";
+  const size_t head_length = message.length() - 4u;
+  // Feed the message byte by byte, as if each byte was received separately.
+  HTTPHeadParser parser;
+  for (size_t size = 0u; size < head_length; ++size) {
+    ASSERT_FALSE(parser.Parse(&message[0], size)) << size;
+  }
+  ASSERT_TRUE(parser.Parse(&message[0], message.length()));
+  EXPECT_EQ(head_length, parser.HeadLength());
+  const char* buffer = message.c_str();
+  ASSERT_EQ(3u, parser.FirstLinePiecesCount());
+  EXPECT_EQ("GET", parser.FirstLinePiece(0).In(buffer));
+  EXPECT_EQ("/path?a=1", parser.FirstLinePiece(1).In(buffer));
+  EXPECT_EQ("HTTP/1.1", parser.FirstLinePiece(2).In(buffer));
+  ASSERT_EQ(3u, parser.HeadersCount());
+  EXPECT_EQ("Host", parser.Header(0).key.In(buffer));
+  EXPECT_EQ("localhost", parser.Header(0).value.In(buffer));
+  EXPECT_STREQ("value with spaces", parser.Header(1).value.Begin(buffer));
+  EXPECT_EQ("a\nb", parser.Header(2).value.In(buffer));
+  EXPECT_STREQ("X-Line-Feed", parser.Header(2).key.Begin(buffer));
+
+  // More headers than are kept inline.
+  std::string many_headers = "HTTP/1.1 200 OK\r\n";
+  for (size_t i = 0u; i < HTTPHeadParser::kInlineHeaders * 2u; ++i) {
+    many_headers += current::strings::Printf("H%d: %d\r\n", static_cast<int>(i), static_cast<int>(i));
+  }
+  many_headers += "\r\n";
+  HTTPHeadParser another_parser;
+  ASSERT_TRUE(another_parser.Parse(&many_headers[0], many_headers.length()));
+  ASSERT_EQ(HTTPHeadParser::kInlineHeaders * 2u, another_parser.HeadersCount());
+  EXPECT_EQ("200", another_parser.FirstLinePiece(1).In(many_headers.c_str()));
+  EXPECT_EQ("H63", another_parser.Header(63u).key.In(many_headers.c_str()));
+  EXPECT_EQ("63", another_parser.Header(63u).value.In(many_headers.c_str()));
+}
+
 TEST(PosixHTTPServerTest, Smoke) {
   auto reserved_port = current::net::ReserveLocalPort();
   const int port = reserved_port;
@@ -259,6 +304,44 @@ TEST(PosixHTTPServerTest, SmokeChunkedResponse) {
   t.join();
 }
 
+TEST(PosixHTTPServerTest, SmokeCoalescedChunkedResponse) {
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  std::thread t(
+      [](Socket s) {
+        HTTPServerConnection c(s.Accept());
+        auto r = c.SendChunkedHTTPResponse();
+        r.Coalesce(16u, std::chrono::seconds(60));
+        r.Send("one");
+        r.Send("two");
+        r.Flush();
+        r.Send("three");
+        r.Send(std::vector<char>({'f', 'o', 'o'}));
+        r.Send(HTTPTestObject());
+        r.Send("bar");
+      },
+      std::move(reserved_port));
+  Connection connection(ClientSocket("localhost", port));
+  connection.BlockingWrite("GET /chunked HTTP/1.1\r\n", true);
+  connection.BlockingWrite("Host: localhost\r\n", true);
+  connection.BlockingWrite("\r\n", false);
+  ExpectToReceive(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/json; charset=utf-8\r\n"
+      "Connection: keep-alive\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n"
+      "6\r\n"
+      "onetwo\r\n"
+      "34\r\n"
+      "threefoo{\"number\":42,\"text\":\"text\",\"array\":[1,2,3]}\n\r\n"
+      "3\r\n"
+      "bar\r\n"
+      "0\r\n",
+      connection);
+  t.join();
+}
+
 TEST(PosixHTTPServerTest, SmokeChunkedResponseWithCORSHeader) {
   auto reserved_port = current::net::ReserveLocalPort();
   const int port = reserved_port;
@@ -38,6 +38,7 @@ rm -f core ; while true ; do ./.current/test --gtest_throw_on_failure --gtest_ca
 #ifndef BRICKS_NET_TCP_IMPL_POSIX_H
 #define BRICKS_NET_TCP_IMPL_POSIX_H
 
+#include <algorithm>
 #include <type_traits>
 
 #ifndef CURRENT_WINDOWS
@@ -46,9 +47,16 @@ rm -f core ; while true ; do ./.current/test --gtest_throw_on_failure --gtest_ca
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
+#include <signal.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#ifndef CURRENT_APPLE
+#include <pthread.h>
+#include <sys/sendfile.h>
+#endif  // CURRENT_APPLE
+
 // Bricks uses `SOCKET` for socket handles in *nix.
 // Makes it easier to have the code run on both Windows and *nix.
 // NOTE(dkorolev): Some irresponsible elements `#define SOCKET int` in their code,
@@ -412,6 +420,10 @@ class Connection : public SocketHandle {
 
   const IPAndPort& RemoteIPAndPort() const { return remote_ip_and_port_; }
 
+  // The numbers of bytes read from and written into this connection so far. Used for the HTTP server metrics.
+  uint64_t BytesRead() const { return bytes_read_; }
+  uint64_t BytesWritten() const { return bytes_written_; }
+
   // By default, BlockingRead() will return as soon as some data has been read,
   // with the exception being multibyte records (sizeof(T) > 1), where it will keep reading
   // until the boundary of the records, or max_length of them, has been read.
@@ -451,6 +463,7 @@ class Connection : public SocketHandle {
                                errno);
         if (retval > 0) {
           ptr += retval;
+          bytes_read_ += static_cast<uint64_t>(retval);
           if ((policy == BlockingReadPolicy::ReturnASAP) || (ptr == end)) {
             return (ptr - buffer);
           } else {
@@ -546,11 +559,135 @@ class Connection : public SocketHandle {
     } else if (static_cast<size_t>(result) != write_length) {
       CURRENT_THROW(SocketCouldNotWriteEverythingException());  // This one is tested though.
     }
+    bytes_written_ += write_length;
     CURRENT_BRICKS_NET_LOG(
         "S%05d BlockingWrite(%d bytes) : OK\n", static_cast<SOCKET>(socket), static_cast<int>(write_length));
     return *this;
   }
 
+  // A piece of data for `BlockingWriteV()` to send.
+  struct WriteBuffer final {
+    const void* data;
+    size_t size;
+  };
+
+  // Sends `count` buffers back to back, as if they were one contiguous buffer, with a single system call.
+  // Used to send the HTTP chunk header, payload and trailing CRLF without copying them together first.
+  Connection& BlockingWriteV(const WriteBuffer* buffers, size_t count, bool more) {
+#if !defined(CURRENT_WINDOWS)
+    constexpr static size_t kMaxBuffers = 16u;
+    CURRENT_ASSERT(count <= kMaxBuffers);
+    struct iovec iov[kMaxBuffers];
+    size_t iov_count = 0u;
+    size_t write_length = 0u;
+    for (size_t i = 0u; i < count; ++i) {
+      if (buffers[i].size) {
+        CURRENT_ASSERT(buffers[i].data);
+        iov[iov_count].iov_base = const_cast<void*>(buffers[i].data);
+        iov[iov_count].iov_len = buffers[i].size;
+        ++iov_count;
+        write_length += buffers[i].size;
+      }
+    }
+    if (!iov_count) {
+      return *this;
+    }
+    CURRENT_BRICKS_NET_LOG("S%05d BlockingWriteV(%d buffers, %d bytes) ...\n",
+                           static_cast<SOCKET>(socket),
+                           static_cast<int>(iov_count),
+                           static_cast<int>(write_length));
+    struct msghdr message;
+    ::memset(&message, 0, sizeof(message));
+    message.msg_iov = iov;
+    message.msg_iovlen = iov_count;
+#if !defined(CURRENT_APPLE)
+    const int result = static_cast<int>(::sendmsg(socket, &message, MSG_NOSIGNAL | (more ? MSG_MORE : 0)));
+#else
+    static_cast<void>(more);  // Supress the 'unused parameter' warning.
+    const int result = static_cast<int>(::sendmsg(socket, &message, 0));
+#endif
+    if (result < 0) {
+      CURRENT_THROW(SocketWriteException());  // LCOV_EXCL_LINE -- Not covered by the unit tests.
+    } else if (static_cast<size_t>(result) != write_length) {
+      CURRENT_THROW(SocketCouldNotWriteEverythingException());  // LCOV_EXCL_LINE
+    }
+    bytes_written_ += write_length;
+    CURRENT_BRICKS_NET_LOG(
+        "S%05d BlockingWriteV(%d bytes) : OK\n", static_cast<SOCKET>(socket), static_cast<int>(write_length));
+#else
+    // No scatter-gather `send()` with the semantics needed here on Windows, send the buffers one by one.
+    for (size_t i = 0u; i < count; ++i) {
+      if (buffers[i].size) {
+        BlockingWrite(buffers[i].data, buffers[i].size, more || (i + 1u < count));
+      }
+    }
+#endif  // !defined(CURRENT_WINDOWS)
+    return *this;
+  }
+
+  // Sends `length` bytes of the file `fd`, starting from `offset`, without copying them through the user space.
+  // Used to serve static files from disk. The file is expected to be at least `offset + length` bytes long.
+  Connection& BlockingSendFile(int fd, uint64_t offset, uint64_t length) {
+    CURRENT_BRICKS_NET_LOG(
+        "S%05d BlockingSendFile(%d bytes) ...\n", static_cast<SOCKET>(socket), static_cast<int>(length));
+#if !defined(CURRENT_WINDOWS) && !defined(CURRENT_APPLE)
+    // Unlike `send()`, `sendfile()` has no `MSG_NOSIGNAL`. Block `SIGPIPE` for this thread while sending,
+    // and consume the one raised by writing into the connection closed by the other side, if any.
+    sigset_t sigpipe;
+    sigset_t previous_mask;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    ::pthread_sigmask(SIG_BLOCK, &sigpipe, &previous_mask);
+    constexpr static uint64_t kMaxSendFileChunk = (1u << 30);
+    off_t position = static_cast<off_t>(offset);
+    int error = 0;
+    while (length) {
+      const ssize_t result =
+          ::sendfile(socket, fd, &position, static_cast<size_t>(std::min(length, kMaxSendFileChunk)));
+      if (result < 0) {
+        if (errno != EINTR) {
+          error = errno;
+          break;
+        }
+      } else if (result == 0) {
+        // The file is shorter than expected.
+        error = EIO;
+        break;
+      } else {
+        length -= static_cast<uint64_t>(result);
+        bytes_written_ += static_cast<uint64_t>(result);
+      }
+    }
+    if (error == EPIPE) {
+      const struct timespec no_wait = {0, 0};
+      ::sigtimedwait(&sigpipe, nullptr, &no_wait);
+    }
+    ::pthread_sigmask(SIG_SETMASK, &previous_mask, nullptr);
+    if (error == EIO) {
+      CURRENT_THROW(SocketCouldNotWriteEverythingException());  // LCOV_EXCL_LINE
+    } else if (error) {
+      CURRENT_THROW(SocketWriteException());  // LCOV_EXCL_LINE
+    }
+#else
+    // No `sendfile()` with the semantics needed here, send the file piece by piece.
+    char buffer[64 * 1024];
+    if (::lseek(fd, static_cast<long>(offset), SEEK_SET) < 0) {
+      CURRENT_THROW(SocketCouldNotWriteEverythingException());  // LCOV_EXCL_LINE
+    }
+    while (length) {
+      const uint64_t piece = std::min(length, static_cast<uint64_t>(sizeof(buffer)));
+      const int result = static_cast<int>(::read(fd, buffer, static_cast<unsigned int>(piece)));
+      if (result <= 0) {
+        CURRENT_THROW(SocketCouldNotWriteEverythingException());  // LCOV_EXCL_LINE
+      }
+      length -= static_cast<uint64_t>(result);
+      BlockingWrite(buffer, static_cast<size_t>(result), length > 0u);
+    }
+#endif  // !defined(CURRENT_WINDOWS) && !defined(CURRENT_APPLE)
+    CURRENT_BRICKS_NET_LOG("S%05d BlockingSendFile() : OK\n", static_cast<SOCKET>(socket));
+    return *this;
+  }
+
   Connection& BlockingWrite(const char* s, bool more) {
     CURRENT_ASSERT(s);
     return BlockingWrite(s, strlen(s), more);
@@ -575,6 +712,8 @@ class Connection : public SocketHandle {
  private:
   const IPAndPort local_ip_and_port_;
   const IPAndPort remote_ip_and_port_;
+  uint64_t bytes_read_ = 0u;
+  uint64_t bytes_written_ = 0u;
 
   Connection() = delete;
   Connection(const Connection&) = delete;
@@ -28,6 +28,7 @@ SOFTWARE.
 #include "../../port.h"
 
 #include <mutex>
+#include <shared_mutex>
 #include <type_traits>
 
 namespace current {
@@ -40,11 +41,41 @@ struct NoOpLock {
   NoOpLock(ARGS&&...) {}
 };
 
+// A shared mutex that does not let a stream of readers starve the writers: once a writer is waiting for the lock,
+// the readers arriving after it are held back until it is done. Usable with `std::unique_lock<>` and
+// `std::shared_lock<>`.
+class WriterPreferringSharedMutex final {
+ public:
+  void lock() {
+    std::lock_guard<std::mutex> turnstile_lock(turnstile_);
+    mutex_.lock();
+  }
+  void unlock() { mutex_.unlock(); }
+
+  void lock_shared() {
+    { std::lock_guard<std::mutex> turnstile_lock(turnstile_); }
+    mutex_.lock_shared();
+  }
+  void unlock_shared() { mutex_.unlock_shared(); }
+
+ private:
+  std::mutex turnstile_;
+  std::shared_mutex mutex_;
+};
+
 template <MutexLockStatus MLS, class MUTEX = std::mutex>
 using SmartMutexLockGuard = std::conditional_t<MLS == MutexLockStatus::NeedToLock, std::lock_guard<MUTEX>, NoOpLock>;
 
+template <MutexLockStatus MLS, class MUTEX = std::shared_mutex>
+using SmartSharedMutexLockGuard =
+    std::conditional_t<MLS == MutexLockStatus::NeedToLock, std::shared_lock<MUTEX>, NoOpLock>;
+
 static_assert(std::is_same_v<std::lock_guard<std::mutex>, SmartMutexLockGuard<MutexLockStatus::NeedToLock>>, "");
 static_assert(std::is_same_v<NoOpLock, SmartMutexLockGuard<MutexLockStatus::AlreadyLocked>>, "");
+static_assert(std::is_same_v<std::shared_lock<std::shared_mutex>,
+                             SmartSharedMutexLockGuard<MutexLockStatus::NeedToLock>>,
+              "");
+static_assert(std::is_same_v<NoOpLock, SmartSharedMutexLockGuard<MutexLockStatus::AlreadyLocked>>, "");
 
 }  // namespace locks
 }  // namespace current
@@ -27,12 +27,16 @@ SOFTWARE.
 
 #include "../../port.h"
 
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <tuple>
 #include <typeindex>
 #include <typeinfo>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "decay.h"
 #include "typelist.h"
@@ -109,6 +113,20 @@ struct RTTIDispatcherBase<DispatcherInputType::RValueReference, BASE, F, ARGS...
 };
 // LCOV_EXCL_STOP
 
+// The dispatchers are only invoked once the dynamic type of the object is known to be exactly `DERIVED`.
+// Thus, `static_cast<>` is used where it compiles, and `dynamic_cast<>` remains for virtual bases.
+template <typename BASE, typename DERIVED, typename = void>
+struct RTTIDowncast {
+  static const DERIVED* Cast(const BASE* ptr) { return dynamic_cast<const DERIVED*>(ptr); }
+  static DERIVED* Cast(BASE* ptr) { return dynamic_cast<DERIVED*>(ptr); }
+};
+
+template <typename BASE, typename DERIVED>
+struct RTTIDowncast<BASE, DERIVED, std::void_t<decltype(static_cast<DERIVED*>(std::declval<BASE*>()))>> {
+  static const DERIVED* Cast(const BASE* ptr) { return static_cast<const DERIVED*>(ptr); }
+  static DERIVED* Cast(BASE* ptr) { return static_cast<DERIVED*>(ptr); }
+};
+
 template <DispatcherInputType, typename BASE, typename F, typename DERIVED, typename... ARGS>
 struct RTTIDispatcher;
 
@@ -116,7 +134,7 @@ template <typename BASE, typename F, typename DERIVED, typename... ARGS>
 struct RTTIDispatcher<DispatcherInputType::ConstReference, BASE, F, DERIVED, ARGS...> final
     : RTTIDispatcherBase<DispatcherInputType::ConstReference, BASE, F, ARGS...> {
   virtual void HandleByConstReference(const BASE& ref, F&& f, ARGS&&... args) const override {
-    const auto* derived = dynamic_cast<const DERIVED*>(&ref);
+    const auto* derived = RTTIDowncast<BASE, DERIVED>::Cast(&ref);
     if (derived) {
       f(*derived, std::forward<ARGS>(args)...);
     } else {
@@ -129,7 +147,7 @@ template <typename BASE, typename F, typename DERIVED, typename... ARGS>
 struct RTTIDispatcher<DispatcherInputType::Reference, BASE, F, DERIVED, ARGS...> final
     : RTTIDispatcherBase<DispatcherInputType::Reference, BASE, F, ARGS...> {
   virtual void HandleByReference(BASE& ref, F&& f, ARGS&&... args) const override {
-    auto* derived = dynamic_cast<DERIVED*>(&ref);
+    auto* derived = RTTIDowncast<BASE, DERIVED>::Cast(&ref);
     if (derived) {
       f(*derived, std::forward<ARGS>(args)...);
     } else {
@@ -142,7 +160,7 @@ template <typename BASE, typename F, typename DERIVED, typename... ARGS>
 struct RTTIDispatcher<DispatcherInputType::RValueReference, BASE, F, DERIVED, ARGS...> final
     : RTTIDispatcherBase<DispatcherInputType::RValueReference, BASE, F, ARGS...> {
   virtual void HandleByRValueReference(BASE&& ref, F&& f, ARGS&&... args) const override {
-    auto* derived = dynamic_cast<DERIVED*>(&ref);
+    auto* derived = RTTIDowncast<BASE, DERIVED>::Cast(&ref);
     if (derived) {
       f(std::move(*derived), std::forward<ARGS>(args)...);
     } else {
@@ -151,16 +169,113 @@ struct RTTIDispatcher<DispatcherInputType::RValueReference, BASE, F, DERIVED, AR
   }
 };
 
+// Dense, process-wide indexes of the types `RTTIDynamicCall<>` can dispatch to, assigned on first use.
+// The handlers for each call site are kept in a plain array indexed by them.
+// The lookups are read-mostly: they share the lock, and find the indexes by the address of `std::type_info`.
+// Only the first lookup by each address locks exclusively and hashes the type name, as a type may have several
+// `std::type_info` objects across shared libraries.
+class RTTITypeIndexRegistry final {
+ public:
+  constexpr static size_t kUnregistered = static_cast<size_t>(-1);
+
+  size_t Register(const std::type_info& type) {
+    std::lock_guard<std::shared_mutex> lock(mutex_);
+    const auto cit = indexes_.find(std::type_index(type));
+    if (cit != indexes_.end()) {
+      indexes_by_address_[&type] = cit->second;
+      return cit->second;
+    } else {
+      const size_t index = indexes_.size();
+      indexes_[std::type_index(type)] = index;
+      indexes_by_address_[&type] = index;
+      return index;
+    }
+  }
+
+  size_t Find(const std::type_info& type) {
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      const auto cit = indexes_by_address_.find(&type);
+      if (cit != indexes_by_address_.end()) {
+        return cit->second;
+      }
+    }
+    std::lock_guard<std::shared_mutex> lock(mutex_);
+    const auto cit = indexes_.find(std::type_index(type));
+    if (cit == indexes_.end()) {
+      return kUnregistered;
+    }
+    indexes_by_address_[&type] = cit->second;
+    return cit->second;
+  }
+
+ private:
+  std::shared_mutex mutex_;
+  std::unordered_map<std::type_index, size_t> indexes_;
+  std::unordered_map<const std::type_info*, size_t> indexes_by_address_;
+};
+
+template <typename T>
+size_t RTTIDenseTypeIndex() {
+  static const size_t index = Singleton<RTTITypeIndexRegistry>().Register(typeid(T));
+  return index;
+}
+
+// The dense index of the dynamic type of an object, or `kUnregistered`.
+// Each thread caches the indexes by the address of `std::type_info`, so that the registry is only consulted
+// the first time this thread sees a type, or once the type is evicted from the cache by another one.
+// The slot is the top bits of the Fibonacci hash of the address, as the `std::type_info` objects tend to be laid out
+// at regular strides, which the low bits of the address map into the same few slots.
+inline size_t RTTIDenseTypeIndexOf(const std::type_info& type) {
+  struct CacheEntry {
+    const std::type_info* type = nullptr;
+    size_t index = 0u;
+  };
+  constexpr static size_t kCacheSizeLog2 = 8u;
+  thread_local CacheEntry cache[1u << kCacheSizeLog2];
+  const uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&type));
+  CacheEntry& entry = cache[(address * 0x9e3779b97f4a7c15ull) >> (64u - kCacheSizeLog2)];
+  if (entry.type != &type) {
+    const size_t index = Singleton<RTTITypeIndexRegistry>().Find(type);
+    if (index == RTTITypeIndexRegistry::kUnregistered) {
+      return index;  // Not cached, as this type may yet be registered.
+    }
+    entry.type = &type;
+    entry.index = index;
+  }
+  return entry.index;
+}
+
 template <DispatcherInputType DISPATCHER_INPUT_TYPE, typename BASE, typename F, typename... ARGS>
 using RTTIHandlersMap =
     std::unordered_map<std::type_index, std::unique_ptr<RTTIDispatcherBase<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>>>;
 
+template <DispatcherInputType DISPATCHER_INPUT_TYPE, typename BASE, typename F, typename... ARGS>
+using RTTIHandlersArray = std::vector<std::unique_ptr<RTTIDispatcherBase<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>>>;
+
+template <typename T, DispatcherInputType DISPATCHER_INPUT_TYPE, typename BASE, typename F, typename... ARGS>
+void RTTIRegisterHandler(RTTIHandlersMap<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>& map,
+                         RTTIDispatcherBase<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>* handler) {
+  map[std::type_index(typeid(T))].reset(handler);
+}
+
+template <typename T, DispatcherInputType DISPATCHER_INPUT_TYPE, typename BASE, typename F, typename... ARGS>
+void RTTIRegisterHandler(RTTIHandlersArray<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>& array,
+                         RTTIDispatcherBase<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>* handler) {
+  const size_t index = RTTIDenseTypeIndex<T>();
+  if (index >= array.size()) {
+    array.resize(index + 1u);
+  }
+  array[index].reset(handler);
+}
+
 template <DispatcherInputType, typename TYPELIST, typename BASE, typename F, typename... ARGS>
 struct PopulateRTTIHandlers;
 
 template <DispatcherInputType DISPATCHER_INPUT_TYPE, typename BASE, typename F, typename... ARGS>
 struct PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, std::tuple<>, BASE, F, ARGS...> {
-  static void DoIt(RTTIHandlersMap<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>&) {}
+  template <class CONTAINER>
+  static void DoIt(CONTAINER&) {}
 };
 
 template <DispatcherInputType DISPATCHER_INPUT_TYPE,
@@ -170,10 +285,11 @@ template <DispatcherInputType DISPATCHER_INPUT_TYPE,
           typename F,
           typename... ARGS>
 struct PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, std::tuple<T, TS...>, BASE, F, ARGS...> {
-  static void DoIt(RTTIHandlersMap<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>& map) {
+  template <class CONTAINER>
+  static void DoIt(CONTAINER& container) {
     // TODO(dkorolev): Check for duplicate types in input type list? Throw an exception?
-    map[std::type_index(typeid(T))].reset(new RTTIDispatcher<DISPATCHER_INPUT_TYPE, BASE, F, T, ARGS...>());
-    PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, std::tuple<TS...>, BASE, F, ARGS...>::DoIt(map);
+    RTTIRegisterHandler<T>(container, new RTTIDispatcher<DISPATCHER_INPUT_TYPE, BASE, F, T, ARGS...>());
+    PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, std::tuple<TS...>, BASE, F, ARGS...>::DoIt(container);
   }
 };
 
@@ -181,7 +297,8 @@ struct PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, std::tuple<T, TS...>, BASE, F
 // TODO(dkorolev): Revisit this once we will be retiring `std::tuple<>`'s use as typelist.
 template <DispatcherInputType DISPATCHER_INPUT_TYPE, typename BASE, typename F, typename... ARGS>
 struct PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, TypeListImpl<>, BASE, F, ARGS...> {
-  static void DoIt(RTTIHandlersMap<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>&) {}
+  template <class CONTAINER>
+  static void DoIt(CONTAINER&) {}
 };
 
 template <DispatcherInputType DISPATCHER_INPUT_TYPE,
@@ -191,56 +308,92 @@ template <DispatcherInputType DISPATCHER_INPUT_TYPE,
           typename F,
           typename... ARGS>
 struct PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, TypeListImpl<T, TS...>, BASE, F, ARGS...> {
-  static void DoIt(RTTIHandlersMap<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>& map) {
+  template <class CONTAINER>
+  static void DoIt(CONTAINER& container) {
     // TODO(dkorolev): Check for duplicate types in input type list? Throw an exception?
-    map[std::type_index(typeid(T))].reset(new RTTIDispatcher<DISPATCHER_INPUT_TYPE, BASE, F, T, ARGS...>());
-    PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, TypeListImpl<TS...>, BASE, F, ARGS...>::DoIt(map);
+    RTTIRegisterHandler<T>(container, new RTTIDispatcher<DISPATCHER_INPUT_TYPE, BASE, F, T, ARGS...>());
+    PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, TypeListImpl<TS...>, BASE, F, ARGS...>::DoIt(container);
   }
 };
 
+// How `RTTIDynamicCall<>` finds the handler for the dynamic type of the object.
+// `DenseIndex`, the default, is a bounds-checked array lookup by the dense type index, see above.
+// `TypeIndexMap` is the original lookup in a hash map by `std::type_index`, kept for benchmarking.
+enum class RTTIDispatch { DenseIndex, TypeIndexMap };
+
+template <RTTIDispatch, DispatcherInputType, typename TYPELIST, typename BASE, typename F, typename... ARGS>
+struct RTTIPopulatedHandlers;
+
 template <DispatcherInputType DISPATCHER_INPUT_TYPE, typename TYPELIST, typename BASE, typename F, typename... ARGS>
-struct RTTIPopulatedHandlers {
+struct RTTIPopulatedHandlers<RTTIDispatch::TypeIndexMap, DISPATCHER_INPUT_TYPE, TYPELIST, BASE, F, ARGS...> {
   static_assert(is_std_tuple<TYPELIST>::value || IsTypeList<TYPELIST>::value, "");
   RTTIHandlersMap<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...> map;
   RTTIPopulatedHandlers() { PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, TYPELIST, BASE, F, ARGS...>::DoIt(map); }
+
+  const RTTIDispatcherBase<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>* Find(const std::type_info& type) const {
+    const auto handler = map.find(std::type_index(type));
+    return handler != map.end() ? handler->second.get() : nullptr;
+  }
 };
 
 template <DispatcherInputType DISPATCHER_INPUT_TYPE, typename TYPELIST, typename BASE, typename F, typename... ARGS>
-const RTTIDispatcherBase<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>* RTTIFindHandler(const std::type_info& type) {
+struct RTTIPopulatedHandlers<RTTIDispatch::DenseIndex, DISPATCHER_INPUT_TYPE, TYPELIST, BASE, F, ARGS...> {
   static_assert(is_std_tuple<TYPELIST>::value || IsTypeList<TYPELIST>::value, "");
-  static RTTIPopulatedHandlers<DISPATCHER_INPUT_TYPE, TYPELIST, BASE, F, ARGS...> singleton;
-  const auto handler = singleton.map.find(std::type_index(type));
-  if (handler != singleton.map.end()) {
-    return handler->second.get();
+  RTTIHandlersArray<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...> array;
+  RTTIPopulatedHandlers() { PopulateRTTIHandlers<DISPATCHER_INPUT_TYPE, TYPELIST, BASE, F, ARGS...>::DoIt(array); }
+
+  // The types registered after this array was populated have greater indexes, and fail the bounds check.
+  const RTTIDispatcherBase<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>* Find(const std::type_info& type) const {
+    const size_t index = RTTIDenseTypeIndexOf(type);
+    return index < array.size() ? array[index].get() : nullptr;
+  }
+};
+
+template <RTTIDispatch DISPATCH,
+          DispatcherInputType DISPATCHER_INPUT_TYPE,
+          typename TYPELIST,
+          typename BASE,
+          typename F,
+          typename... ARGS>
+const RTTIDispatcherBase<DISPATCHER_INPUT_TYPE, BASE, F, ARGS...>* RTTIFindHandler(const std::type_info& type) {
+  static RTTIPopulatedHandlers<DISPATCH, DISPATCHER_INPUT_TYPE, TYPELIST, BASE, F, ARGS...> singleton;
+  const auto* handler = singleton.Find(type);
+  if (handler) {
+    return handler;
   } else {
     CURRENT_THROW(SpecificUnlistedTypeException<BASE>());  // LCOV_EXCL_LINE
   }
 }
 
 // Returning values from RTTI-dispatched calls is not supported. Pass in another parameter by pointer/reference.
-template <typename TYPELIST, typename BASE>
+template <RTTIDispatch DISPATCH, typename TYPELIST, typename BASE>
 struct RTTIDynamicCallWrapper {
   template <typename... REST>
   static void RunHandle(const BASE& ref, REST&&... rest) {
-    RTTIFindHandler<DispatcherInputType::ConstReference, TYPELIST, BASE, REST...>(typeid(ref))
+    RTTIFindHandler<DISPATCH, DispatcherInputType::ConstReference, TYPELIST, BASE, REST...>(typeid(ref))
         ->HandleByConstReference(ref, std::forward<REST>(rest)...);
   }
   template <typename... REST>
   static void RunHandle(BASE& ref, REST&&... rest) {
-    RTTIFindHandler<DispatcherInputType::Reference, TYPELIST, BASE, REST...>(typeid(ref))
+    RTTIFindHandler<DISPATCH, DispatcherInputType::Reference, TYPELIST, BASE, REST...>(typeid(ref))
         ->HandleByReference(ref, std::forward<REST>(rest)...);
   }
   template <typename... REST>
   static void RunHandle(BASE&& ref, REST&&... rest) {
-    RTTIFindHandler<DispatcherInputType::RValueReference, TYPELIST, BASE, REST...>(typeid(ref))
+    RTTIFindHandler<DISPATCH, DispatcherInputType::RValueReference, TYPELIST, BASE, REST...>(typeid(ref))
         ->HandleByRValueReference(std::move(ref), std::forward<REST>(rest)...);
   }
 };
 
+template <RTTIDispatch DISPATCH, typename TYPELIST, typename BASE, typename... REST>
+void RTTIDynamicCallVia(BASE&& ref, REST&&... rest) {
+  RTTIDynamicCallWrapper<DISPATCH, TYPELIST, current::decay_t<BASE>>::RunHandle(std::forward<BASE>(ref),
+                                                                                std::forward<REST>(rest)...);
+}
+
 template <typename TYPELIST, typename BASE, typename... REST>
 void RTTIDynamicCall(BASE&& ref, REST&&... rest) {
-  RTTIDynamicCallWrapper<TYPELIST, current::decay_t<BASE>>::RunHandle(std::forward<BASE>(ref),
-                                                                      std::forward<REST>(rest)...);
+  RTTIDynamicCallVia<RTTIDispatch::DenseIndex, TYPELIST>(std::forward<BASE>(ref), std::forward<REST>(rest)...);
 }
 
 }  // namespace metaprogramming
@@ -277,6 +277,61 @@ TEST(TemplateMetaprogrammingInternalTest, NonemptyConstructorForCombiner) {
   EXPECT_EQ(42, joined(0));
 }
 
+namespace rtti_dispatch_unittest {
+
+struct Base {
+  virtual ~Base() = default;
+};
+struct Plain : Base {};
+struct VirtuallyDerived : virtual Base {};
+struct Unlisted : Plain {};
+
+struct Visitor {
+  std::string s;
+  void operator()(const Plain&) { s += "Plain "; }
+  void operator()(Plain&) { s += "MutablePlain "; }
+  void operator()(const VirtuallyDerived&) { s += "VirtuallyDerived "; }
+  void operator()(VirtuallyDerived&) { s += "MutableVirtuallyDerived "; }
+};
+
+template <current::metaprogramming::RTTIDispatch DISPATCH>
+std::string DispatchAll() {
+  using current::metaprogramming::RTTIDynamicCallVia;
+  using current::metaprogramming::UnlistedTypeException;
+  Plain plain;
+  VirtuallyDerived virtually_derived;
+  Unlisted unlisted;
+  Visitor visitor;
+  RTTIDynamicCallVia<DISPATCH, TypeList<Plain, VirtuallyDerived>>(static_cast<const Base&>(plain), visitor);
+  RTTIDynamicCallVia<DISPATCH, TypeList<Plain, VirtuallyDerived>>(static_cast<Base&>(plain), visitor);
+  RTTIDynamicCallVia<DISPATCH, TypeList<Plain, VirtuallyDerived>>(static_cast<const Base&>(virtually_derived),
+                                                                  visitor);
+  RTTIDynamicCallVia<DISPATCH, TypeList<Plain, VirtuallyDerived>>(static_cast<Base&>(virtually_derived), visitor);
+  // Dispatching is by the exact dynamic type: a type derived from a listed one is not listed itself.
+  try {
+    RTTIDynamicCallVia<DISPATCH, TypeList<Plain, VirtuallyDerived>>(static_cast<const Base&>(unlisted), visitor);
+  } catch (const UnlistedTypeException&) {
+    visitor.s += "Unlisted";
+  }
+  return visitor.s;
+}
+
+}  // namespace rtti_dispatch_unittest
+
+TEST(TemplateMetaprogrammingInternalTest, RTTIDynamicCallDispatch) {
+  using namespace rtti_dispatch_unittest;
+  using current::metaprogramming::RTTIDispatch;
+  const std::string golden = "Plain MutablePlain VirtuallyDerived MutableVirtuallyDerived Unlisted";
+  EXPECT_EQ(golden, DispatchAll<RTTIDispatch::DenseIndex>());
+  EXPECT_EQ(golden, DispatchAll<RTTIDispatch::TypeIndexMap>());
+
+  // A type that got its dense index only after the array of handlers for this call site was populated.
+  using current::metaprogramming::RTTIDenseTypeIndex;
+  EXPECT_EQ(RTTIDenseTypeIndex<Plain>(), RTTIDenseTypeIndex<Plain>());
+  EXPECT_NE(RTTIDenseTypeIndex<Plain>(), RTTIDenseTypeIndex<Unlisted>());
+  EXPECT_EQ(golden, DispatchAll<RTTIDispatch::DenseIndex>());
+}
+
 // ********************************************************************************
 // * `current::decay_t` test, moved here from `decay.h`.
 // ********************************************************************************
@@ -50,6 +50,16 @@ SOFTWARE.
 namespace current {
 namespace time {
 
+// The source of the wall time behind `Now()`, selectable at runtime with `SetNowClockSource()`.
+enum class NowClockSource : int {
+  // `std::chrono::system_clock`, the default. On Linux it is the vDSO `clock_gettime(CLOCK_REALTIME)`.
+  SystemClock = 0,
+  // The vDSO `clock_gettime(CLOCK_REALTIME_COARSE)`, several times cheaper, where available, and `SystemClock`
+  // otherwise. Its resolution is the scheduler tick, 1ms to 4ms. Since `Now()` is strictly increasing, the values
+  // returned within one tick are one microsecond apart, and thus may run ahead of the wall time under heavy load.
+  Coarse = 1
+};
+
 #ifdef CURRENT_MOCK_TIME
 
 // LCOV_EXCL_START
@@ -94,6 +104,10 @@ inline void ResetToZero() {
   impl.max_mock_now_value = std::chrono::microseconds(1000ll * 1000ll * 1000ll);
 }
 
+// The clock source makes no difference for the mock time.
+inline void SetNowClockSource(NowClockSource) {}
+inline NowClockSource GetNowClockSource() { return NowClockSource::SystemClock; }
+
 template <typename T>
 void SleepUntil(T) {}
 
@@ -101,27 +115,50 @@ void SleepUntil(T) {}
 
 // Since chrono::system_clock is not monotonic, and chrono::steady_clock is not guaranteed to be Epoch,
 // use a simple wrapper around chrono::system_clock to make it strictly increasing.
+// The clock is read once per call, and the strict increase is ensured with a lock-free compare-and-swap.
 struct EpochClockGuaranteeingMonotonicity {
   mutable std::atomic<int64_t> monotonic_now_us;
+  std::atomic<NowClockSource> source;
 
-  EpochClockGuaranteeingMonotonicity() : monotonic_now_us(0ll) {}
+  EpochClockGuaranteeingMonotonicity() : monotonic_now_us(0ll), source(NowClockSource::SystemClock) {}
+
+  static int64_t WallTimeMicroseconds(NowClockSource source) {
+#ifdef CLOCK_REALTIME_COARSE
+    if (source == NowClockSource::Coarse) {
+      struct timespec ts;
+      ::clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+      return static_cast<int64_t>(ts.tv_sec) * 1000000ll + static_cast<int64_t>(ts.tv_nsec / 1000);
+    }
+#else
+    static_cast<void>(source);
+#endif  // CLOCK_REALTIME_COARSE
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
 
   inline std::chrono::microseconds Now() const {
-    int64_t now, previous_now;
+    const int64_t wall_now = WallTimeMicroseconds(source.load(std::memory_order_relaxed));
+    // The read-modify-write operations on `monotonic_now_us` are totally ordered, so no stronger memory order
+    // is needed for the values to be strictly increasing. On contention, retry without re-reading the clock.
+    int64_t previous_now = monotonic_now_us.load(std::memory_order_relaxed);
+    int64_t now;
     do {
-      now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
-                .count();
-      previous_now = monotonic_now_us.load();
-      if (!(now > previous_now)) {
-        now = previous_now + 1;
-      }
-    } while (!monotonic_now_us.compare_exchange_strong(previous_now, now));
+      now = (wall_now > previous_now) ? wall_now : previous_now + 1;
+    } while (!monotonic_now_us.compare_exchange_weak(previous_now, now, std::memory_order_relaxed));
     return std::chrono::microseconds(now);
   }
 };
 
 inline std::chrono::microseconds Now() { return Singleton<EpochClockGuaranteeingMonotonicity>().Now(); }
 
+inline void SetNowClockSource(NowClockSource source) {
+  Singleton<EpochClockGuaranteeingMonotonicity>().source.store(source, std::memory_order_relaxed);
+}
+
+inline NowClockSource GetNowClockSource() {
+  return Singleton<EpochClockGuaranteeingMonotonicity>().source.load(std::memory_order_relaxed);
+}
+
 template <typename T>
 inline void SleepUntil(T moment) {
   const auto now = Now();
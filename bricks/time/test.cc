@@ -22,8 +22,11 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 *******************************************************************************/
 
-#include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <set>
+#include <thread>
+#include <vector>
 
 #include "chrono.h"
 
@@ -46,6 +49,43 @@ TEST(Time, SmokeTest) {
   EXPECT_LE(dt, 50000 + allowed_skew);
 }
 
+TEST(Time, NowIsStrictlyIncreasingWithEitherClockSource) {
+  using current::time::NowClockSource;
+  for (const NowClockSource source : {NowClockSource::Coarse, NowClockSource::SystemClock}) {
+    current::time::SetNowClockSource(source);
+    EXPECT_TRUE(current::time::GetNowClockSource() == source);
+    const std::chrono::microseconds begin = current::time::Now();
+    std::vector<std::vector<std::chrono::microseconds>> values(4u);
+    std::vector<std::thread> threads;
+    for (auto& per_thread_values : values) {
+      threads.emplace_back([&per_thread_values]() {
+        for (size_t i = 0u; i < 10000u; ++i) {
+          per_thread_values.push_back(current::time::Now());
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    std::set<int64_t> all_values;
+    for (const auto& per_thread_values : values) {
+      for (size_t i = 0u; i < per_thread_values.size(); ++i) {
+        EXPECT_LT(begin, per_thread_values[i]);
+        if (i) {
+          EXPECT_LT(per_thread_values[i - 1u], per_thread_values[i]);
+        }
+        all_values.insert(per_thread_values[i].count());
+      }
+    }
+    EXPECT_EQ(40000u, all_values.size());
+    // Within the skew of the coarse clock, the strictly increasing time stays close to the wall time.
+    const int64_t wall_now =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    EXPECT_LE(std::abs(current::time::Now().count() - wall_now), 1000000);
+  }
+}
+
 #else
 
 #ifndef CURRENT_COVERAGE_REPORT_MODE
@@ -159,6 +159,8 @@ struct GenericMapAccessor final {
 
   bool Has(const key_t& x) const { return map_.find(x) != map_.end(); }
 
+  iterator_t Find(const key_t& x) const { return iterator_t(map_.find(x)); }
+
   template <typename U = MAP, class = std::enable_if_t<!sfinae::is_unordered_map<U>::value>>
   iterator_t LowerBound(const key_t& x) const {
     return iterator_t(map_.lower_bound(x));
@@ -167,6 +169,10 @@ struct GenericMapAccessor final {
   iterator_t UpperBound(const key_t& x) const {
     return iterator_t(map_.upper_bound(x));
   }
+  template <typename U = MAP, class = std::enable_if_t<sfinae::is_unordered_map<U>::value>>
+  size_t BucketCount() const {
+    return map_.bucket_count();
+  }
 
   iterator_t begin() const { return iterator_t(map_.cbegin()); }
   iterator_t end() const { return iterator_t(map_.cend()); }
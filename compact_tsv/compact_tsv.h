@@ -34,6 +34,7 @@ SOFTWARE.
 #include <unordered_map>
 #include <vector>
 
+#include "../bricks/exception.h"
 #include "../bricks/template/weed.h"
 #include "../bricks/strings/chunk.h"
 #include "../bricks/util/singleton.h"
@@ -109,6 +110,10 @@ using DispatcherImplSelector = DispatcherImpl<CW<F, std::vector<std::string>>::i
 
 }  // namespace efficient_tsv_parser_dispatcher
 
+struct CompactTSVUnpackException : current::Exception {
+  using current::Exception::Exception;
+};
+
 // At most 254 columns, at most 64KB per entry, at most 4B of distinct strings + metadata in total.
 // Rationale behind the number "254": 0..253 => update value for this col, 254 => row ready, 255 => new string.
 class CompactTSV {
@@ -147,11 +152,15 @@ class CompactTSV {
     done_ = true;
   }
 
+  // The size of the packed data so far, to decide when to start a new block, see `compact_tsv_file.h`.
+  size_t PackedSize() const { return data_.size(); }
+
   const std::string& GetPackedString() const {
     CURRENT_ASSERT(done_);  // TODO(batman): Exception.
     return data_;
   }
 
+  // Throws `CompactTSVUnpackException` if the packed data is corrupt, before reading past its end.
   template <typename F>
   static size_t Unpack(F&& f, const uint8_t* data, size_t length) {
     efficient_tsv_parser_dispatcher::DispatcherImplSelector<F> dispatcher;
@@ -160,32 +169,45 @@ class CompactTSV {
     const uint8_t* end = data + length;
     size_t total = 0u;
     while (p != end) {
-      CURRENT_ASSERT(p < end);  // TODO(batman): Exception.
       const index_type index = *reinterpret_cast<const index_type*>(p);
       p += sizeof(index_type);
-      CURRENT_ASSERT(p <= end);  // TODO(batman): Exception.
       if (index == markers().storage) {
+        if (static_cast<size_t>(end - p) < sizeof(length_type)) {
+          CURRENT_THROW(CompactTSVUnpackException("String length out of bounds."));
+        }
         const length_type length = *reinterpret_cast<const length_type*>(p);
         p += sizeof(length_type);
+        if (static_cast<size_t>(end - p) <= static_cast<size_t>(length)) {
+          CURRENT_THROW(CompactTSVUnpackException("String out of bounds."));
+        }
         p += length;
         ++p;
-        CURRENT_ASSERT(p <= end);  // TODO(batman): Exception.
       } else if (index == markers().row_done) {
-        CURRENT_ASSERT(!dispatcher.Empty());
+        if (dispatcher.Empty()) {
+          CURRENT_THROW(CompactTSVUnpackException("Empty row."));
+        }
         if (!dim) {
           dim = dispatcher.Dim();
-        } else {
-          CURRENT_ASSERT(dim == dispatcher.Dim());  // TODO(batman): Exception.
+        } else if (dim != dispatcher.Dim()) {
+          CURRENT_THROW(CompactTSVUnpackException("Rows of different lengths."));
         }
         dispatcher.Emit(std::forward<F>(f));
         ++total;
       } else {
-        const offset_type offset = *reinterpret_cast<const offset_type*>(p);
+        if (static_cast<size_t>(end - p) < sizeof(offset_type)) {
+          CURRENT_THROW(CompactTSVUnpackException("String offset out of bounds."));
+        }
+        const size_t offset = static_cast<size_t>(*reinterpret_cast<const offset_type*>(p));
         p += sizeof(offset_type);
+        // The string must be followed by the null character within the data, for the `const char*` callbacks.
+        if (offset >= length || length - offset <= sizeof(length_type) ||
+            length - offset - sizeof(length_type) <=
+                static_cast<size_t>(*reinterpret_cast<const length_type*>(data + offset))) {
+          CURRENT_THROW(CompactTSVUnpackException("String referenced out of bounds."));
+        }
         dispatcher.Update(index,
                           reinterpret_cast<const char*>(data + offset + sizeof(length_type)),
                           *reinterpret_cast<const length_type*>(data + offset));
-        CURRENT_ASSERT(p <= end);  // TODO(batman): Exception.
       }
     }
     return total;
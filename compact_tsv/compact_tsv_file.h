@@ -0,0 +1,326 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Dmitry "Dima" Korolev <dmitry.korolev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+// The streaming, block-seekable version of `CompactTSV`, for datasets larger than RAM.
+//
+// `CompactTSVFileWriter` packs the rows into consecutive, self-contained `CompactTSV` blocks, and writes each
+// block into the file as soon as it is complete. Thus, only one block is ever kept in memory.
+// Each block has its own strings table, and repeats all the values of its first row.
+//
+// The file is the blocks, followed by the index footer:
+//   * for each block, three `uint64_t`-s: its offset in the file, its length, and the number of rows in it,
+//   * the number of blocks, as an `uint64_t`, and
+//   * the eight-byte signature, `kCompactTSVFileSignature`.
+//
+// `CompactTSVFileReader` maps the file into memory, and unpacks all the blocks, any single block, or all the blocks
+// in parallel, from multiple threads.
+
+#ifndef COMPACTTSV_COMPACTTSV_FILE_H
+#define COMPACTTSV_COMPACTTSV_FILE_H
+
+#include "../port.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef CURRENT_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // CURRENT_WINDOWS
+
+#include "compact_tsv.h"
+
+#include "../bricks/exception.h"
+#include "../bricks/file/file.h"
+#include "../bricks/strings/util.h"
+
+// The default size of a block, before it is written into the file. Must stay well below 4GB.
+#ifndef CURRENT_COMPACT_TSV_DEFAULT_BLOCK_SIZE
+#define CURRENT_COMPACT_TSV_DEFAULT_BLOCK_SIZE (16u * 1024u * 1024u)
+#endif
+
+constexpr char kCompactTSVFileSignature[] = "CTSVBLK1";
+static_assert(sizeof(kCompactTSVFileSignature) == 9u, "The signature must be eight bytes, plus the null character.");
+
+struct CompactTSVFileException : current::Exception {
+  using current::Exception::Exception;
+};
+
+struct CompactTSVFileBlock {
+  uint64_t offset;
+  uint64_t length;
+  uint64_t rows;
+};
+
+class CompactTSVFileWriter final {
+ public:
+  // With `max_block_rows` of zero, the blocks are only bounded by `max_block_bytes`.
+  explicit CompactTSVFileWriter(const std::string& file_name,
+                                size_t max_block_bytes = CURRENT_COMPACT_TSV_DEFAULT_BLOCK_SIZE,
+                                size_t max_block_rows = 0u)
+      : file_name_(file_name),
+        max_block_bytes_(max_block_bytes),
+        max_block_rows_(max_block_rows),
+        fo_(file_name, std::ofstream::binary | std::ofstream::trunc) {
+    if (!fo_.good()) {
+      CURRENT_THROW(CompactTSVFileException("Can not open `" + file_name_ + "` for writing."));
+    }
+  }
+
+  ~CompactTSVFileWriter() {
+    if (!done_) {
+      try {
+        Finalize();
+      } catch (const current::Exception&) {  // LCOV_EXCL_LINE
+      }
+    }
+  }
+
+  void operator()(const std::vector<std::string>& row) {
+    CURRENT_ASSERT(!done_);  // TODO(batman): Exception.
+    if (!block_) {
+      // All the blocks share the number of columns of the very first row.
+      block_ = std::make_unique<CompactTSV>(dim_);
+    }
+    (*block_)(row);
+    dim_ = row.size();
+    ++block_rows_;
+    if (block_->PackedSize() >= max_block_bytes_ || (max_block_rows_ && block_rows_ >= max_block_rows_)) {
+      FlushBlock();
+    }
+  }
+
+  void Finalize() {
+    CURRENT_ASSERT(!done_);  // TODO(batman): Exception.
+    done_ = true;
+    FlushBlock();
+    const uint64_t count = blocks_.size();
+    for (const CompactTSVFileBlock& block : blocks_) {
+      Write(&block.offset, sizeof(block.offset));
+      Write(&block.length, sizeof(block.length));
+      Write(&block.rows, sizeof(block.rows));
+    }
+    Write(&count, sizeof(count));
+    Write(kCompactTSVFileSignature, sizeof(kCompactTSVFileSignature) - 1u);
+    fo_.close();
+    if (!fo_) {
+      CURRENT_THROW(CompactTSVFileException("Failed to finalize `" + file_name_ + "`."));  // LCOV_EXCL_LINE
+    }
+  }
+
+  const std::vector<CompactTSVFileBlock>& Blocks() const { return blocks_; }
+
+ private:
+  void FlushBlock() {
+    if (block_) {
+      block_->Finalize();
+      const std::string& packed = block_->GetPackedString();
+      blocks_.push_back(CompactTSVFileBlock{offset_, packed.length(), block_rows_});
+      Write(packed.data(), packed.length());
+      block_ = nullptr;
+      block_rows_ = 0u;
+    }
+  }
+
+  void Write(const void* data, size_t length) {
+    fo_.write(static_cast<const char*>(data), length);
+    if (!fo_.good()) {
+      CURRENT_THROW(CompactTSVFileException("Failed to write into `" + file_name_ + "`."));  // LCOV_EXCL_LINE
+    }
+    offset_ += length;
+  }
+
+  const std::string file_name_;
+  const size_t max_block_bytes_;
+  const size_t max_block_rows_;
+  std::ofstream fo_;
+  bool done_ = false;
+  size_t dim_ = 0u;
+  std::unique_ptr<CompactTSV> block_;  // The block being filled, if any.
+  uint64_t block_rows_ = 0u;
+  uint64_t offset_ = 0u;
+  std::vector<CompactTSVFileBlock> blocks_;
+};
+
+class CompactTSVFileReader final {
+ public:
+  CompactTSVFileReader(const CompactTSVFileReader&) = delete;
+  CompactTSVFileReader& operator=(const CompactTSVFileReader&) = delete;
+
+  explicit CompactTSVFileReader(const std::string& file_name) : file_name_(file_name) {
+#ifndef CURRENT_WINDOWS
+    const int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+      CURRENT_THROW(CompactTSVFileException("Can not open `" + file_name + "`."));
+    }
+    struct stat st;
+    if (::fstat(fd, &st)) {
+      ::close(fd);                                                                 // LCOV_EXCL_LINE
+      CURRENT_THROW(CompactTSVFileException("Can not stat `" + file_name + "`."));  // LCOV_EXCL_LINE
+    }
+    if (st.st_size > 0) {
+      void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+      if (data == MAP_FAILED) {
+        ::close(fd);                                                                // LCOV_EXCL_LINE
+        CURRENT_THROW(CompactTSVFileException("Can not map `" + file_name + "`."));  // LCOV_EXCL_LINE
+      }
+      mapped_ = static_cast<const uint8_t*>(data);
+      size_ = static_cast<size_t>(st.st_size);
+    }
+    ::close(fd);
+    data_ = mapped_;
+#else
+    contents_ = current::FileSystem::ReadFileAsString(file_name);
+    data_ = reinterpret_cast<const uint8_t*>(contents_.data());
+    size_ = contents_.length();
+#endif  // CURRENT_WINDOWS
+    try {
+      ReadIndex(file_name);
+    } catch (const CompactTSVFileException&) {
+      Unmap();
+      throw;
+    }
+  }
+
+  ~CompactTSVFileReader() { Unmap(); }
+
+  size_t BlockCount() const { return blocks_.size(); }
+  const CompactTSVFileBlock& Block(size_t block_index) const { return blocks_.at(block_index); }
+  uint64_t TotalRows() const { return total_rows_; }
+
+  // The row callbacks are the same as those of `CompactTSV::Unpack()`. The `const char*`-based ones point right
+  // into the mapped file, and stay valid for as long as the reader is alive.
+  // Throws `CompactTSVFileException` if the block is corrupt, having possibly called `f` for some of its rows.
+  template <typename F>
+  size_t UnpackBlock(size_t block_index, F&& f) const {
+    const CompactTSVFileBlock& block = blocks_.at(block_index);
+    try {
+      return CompactTSV::Unpack(std::forward<F>(f), data_ + block.offset, static_cast<size_t>(block.length));
+    } catch (const CompactTSVUnpackException& e) {
+      CURRENT_THROW(CompactTSVFileException("`" + file_name_ + "` has a corrupt block " +
+                                            current::ToString(block_index) + ": " + e.OriginalDescription()));
+    }
+  }
+
+  template <typename F>
+  size_t Unpack(F&& f) const {
+    size_t total = 0u;
+    for (size_t i = 0u; i < blocks_.size(); ++i) {
+      total += UnpackBlock(i, f);
+    }
+    return total;
+  }
+
+  // Calls `f(block_index)` once for each block, from `threads` worker threads, normally to `UnpackBlock()` it.
+  // The order of the blocks is not preserved. The first exception thrown by `f` is rethrown once all threads are done.
+  template <typename F>
+  void ForEachBlockInParallel(F&& f, size_t threads = std::thread::hardware_concurrency()) const {
+    std::atomic<size_t> next_block(0u);
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+    std::vector<std::thread> workers;
+    const size_t workers_count = std::max(static_cast<size_t>(1u), std::min(threads, blocks_.size()));
+    for (size_t t = 0u; t < workers_count; ++t) {
+      workers.emplace_back([this, &f, &next_block, &exception, &exception_mutex]() {
+        size_t block_index;
+        while ((block_index = next_block++) < blocks_.size()) {
+          try {
+            f(block_index);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(exception_mutex);
+            if (!exception) {
+              exception = std::current_exception();
+            }
+            next_block = blocks_.size();
+          }
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+ private:
+  void ReadIndex(const std::string& file_name) {
+    const size_t signature_length = sizeof(kCompactTSVFileSignature) - 1u;
+    if (size_ < sizeof(uint64_t) + signature_length ||
+        std::memcmp(data_ + size_ - signature_length, kCompactTSVFileSignature, signature_length)) {
+      CURRENT_THROW(CompactTSVFileException("`" + file_name + "` is not a blocked CompactTSV file."));
+    }
+    uint64_t count;
+    std::memcpy(&count, data_ + size_ - signature_length - sizeof(uint64_t), sizeof(uint64_t));
+    const size_t footer_length = signature_length + sizeof(uint64_t);
+    if (count > (size_ - footer_length) / (3u * sizeof(uint64_t))) {
+      CURRENT_THROW(CompactTSVFileException("`" + file_name + "` has a broken blocks index."));
+    }
+    const size_t index_offset = size_ - footer_length - static_cast<size_t>(count) * 3u * sizeof(uint64_t);
+    blocks_.resize(static_cast<size_t>(count));
+    for (size_t i = 0u; i < blocks_.size(); ++i) {
+      const uint8_t* p = data_ + index_offset + i * 3u * sizeof(uint64_t);
+      std::memcpy(&blocks_[i].offset, p, sizeof(uint64_t));
+      std::memcpy(&blocks_[i].length, p + sizeof(uint64_t), sizeof(uint64_t));
+      std::memcpy(&blocks_[i].rows, p + 2u * sizeof(uint64_t), sizeof(uint64_t));
+      if (blocks_[i].offset > index_offset || blocks_[i].length > index_offset - blocks_[i].offset) {
+        CURRENT_THROW(CompactTSVFileException("`" + file_name + "` has a block out of bounds."));
+      }
+      total_rows_ += blocks_[i].rows;
+    }
+  }
+
+  void Unmap() {
+#ifndef CURRENT_WINDOWS
+    if (mapped_) {
+      ::munmap(const_cast<uint8_t*>(mapped_), size_);
+      mapped_ = nullptr;
+    }
+#endif  // CURRENT_WINDOWS
+  }
+
+  const std::string file_name_;
+#ifndef CURRENT_WINDOWS
+  const uint8_t* mapped_ = nullptr;
+#else
+  std::string contents_;
+#endif  // CURRENT_WINDOWS
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0u;
+  std::vector<CompactTSVFileBlock> blocks_;
+  uint64_t total_rows_ = 0u;
+};
+
+#endif  // COMPACTTSV_COMPACTTSV_FILE_H
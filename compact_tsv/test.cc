@@ -26,9 +26,12 @@ SOFTWARE.
 // TODO(batman): Test '\0'-s within input strings.
 
 #include "compact_tsv.h"
+#include "compact_tsv_file.h"
 #include "gen.h"
 
 #include "../bricks/time/chrono.h"
+#include "../bricks/strings/join.h"
+#include "../bricks/strings/split.h"
 #include "../bricks/strings/util.h"
 #include "../bricks/dflags/dflags.h"
 #include "../3rdparty/gtest/gtest-main-with-dflags.h"
@@ -38,6 +41,7 @@ DEFINE_size_t(cols, 4u, "Number of cols.");
 DEFINE_double(scale, 5.0, "Exponential distribution parameter.");
 DEFINE_size_t(random_seed, 42, "Random seed.");
 DEFINE_bool(benchmark, false, "Set to 'true' to measure how long does unpacking take.");
+DEFINE_string(compact_tsv_test_tmpdir, ".current", "Local path for the test to create temporary files in.");
 
 TEST(CompactTSV, Smoke) {
   const bool run_test =
@@ -137,3 +141,115 @@ TEST(CompactTSV, Smoke) {
     // LCOV_EXCL_STOP
   }
 }
+
+TEST(CompactTSV, BlockedFile) {
+  const std::string file_name = current::FileSystem::JoinPath(FLAGS_compact_tsv_test_tmpdir, "blocked");
+  const auto file_remover = current::FileSystem::ScopedRmFile(file_name);
+
+  const size_t rows = 1000u;
+  std::ostringstream golden;
+  CompactTSV whole;
+  {
+    // Blocks of at most 64 rows, and at most 1KB.
+    CompactTSVFileWriter writer(file_name, 1024u, 64u);
+    CreateTSV(
+        [&](const std::vector<size_t> &row) {
+          std::vector<std::string> row_of_strings(row.size());
+          for (size_t i = 0; i < row.size(); ++i) {
+            row_of_strings[i] = current::ToString(row[i]);
+          }
+          whole(row_of_strings);
+          writer(row_of_strings);
+        },
+        rows,
+        4u,
+        50.0);
+    writer.Finalize();
+    EXPECT_LT(16u, writer.Blocks().size());
+  }
+  whole.Finalize();
+  CompactTSV::Unpack(
+      [&golden](const std::vector<std::string> &row) { golden << current::strings::Join(row, ' ') << '\n'; },
+      whole.GetPackedString());
+
+  const CompactTSVFileReader reader(file_name);
+  EXPECT_EQ(rows, reader.TotalRows());
+  ASSERT_LT(16u, reader.BlockCount());
+
+  // Sequential unpacking of all the blocks.
+  {
+    std::ostringstream os;
+    EXPECT_EQ(rows,
+              reader.Unpack([&os](const std::vector<std::pair<const char *, size_t>> &row) {
+                for (size_t i = 0; i < row.size(); ++i) {
+                  os << (i ? " " : "") << std::string(row[i].first, row[i].second);
+                }
+                os << '\n';
+              }));
+    EXPECT_EQ(golden.str(), os.str());
+  }
+
+  // Random access to a single block.
+  {
+    const size_t block_index = reader.BlockCount() / 2u;
+    uint64_t first_row = 0u;
+    for (size_t i = 0u; i < block_index; ++i) {
+      first_row += reader.Block(i).rows;
+    }
+    std::vector<std::string> golden_rows = current::strings::Split(golden.str(), '\n');
+    std::vector<std::string> block_rows;
+    EXPECT_EQ(reader.Block(block_index).rows,
+              reader.UnpackBlock(block_index, [&block_rows](const std::vector<std::string> &row) {
+                block_rows.push_back(current::strings::Join(row, ' '));
+              }));
+    ASSERT_FALSE(block_rows.empty());
+    for (size_t i = 0u; i < block_rows.size(); ++i) {
+      EXPECT_EQ(golden_rows[first_row + i], block_rows[i]);
+    }
+  }
+
+  // Parallel unpacking, with the rows collected per block to restore the order.
+  {
+    std::vector<std::string> per_block(reader.BlockCount());
+    reader.ForEachBlockInParallel(
+        [&](size_t block_index) {
+          std::ostringstream os;
+          reader.UnpackBlock(block_index, [&os](const std::vector<current::strings::UniqueChunk> &row) {
+            for (size_t i = 0; i < row.size(); ++i) {
+              os << (i ? " " : "") << std::string(row[i].c_str(), row[i].length());
+            }
+            os << '\n';
+          });
+          per_block[block_index] = os.str();
+        },
+        4u);
+    EXPECT_EQ(golden.str(), current::strings::Join(per_block, ""));
+  }
+
+  // Broken files.
+  {
+    const std::string broken_file_name = current::FileSystem::JoinPath(FLAGS_compact_tsv_test_tmpdir, "broken");
+    const auto broken_file_remover = current::FileSystem::ScopedRmFile(broken_file_name);
+    current::FileSystem::WriteStringToFile(whole.GetPackedString(), broken_file_name.c_str());
+    ASSERT_THROW(CompactTSVFileReader{broken_file_name}, CompactTSVFileException);
+    std::string truncated = current::FileSystem::ReadFileAsString(file_name);
+    truncated.erase(0u, truncated.length() / 2u);
+    current::FileSystem::WriteStringToFile(truncated, broken_file_name.c_str());
+    ASSERT_THROW(CompactTSVFileReader{broken_file_name}, CompactTSVFileException);
+  }
+
+  // A corrupt block, referring to a string past its end.
+  {
+    const std::string broken_file_name = current::FileSystem::JoinPath(FLAGS_compact_tsv_test_tmpdir, "corrupt");
+    const auto broken_file_remover = current::FileSystem::ScopedRmFile(broken_file_name);
+    std::string corrupt = current::FileSystem::ReadFileAsString(file_name);
+    corrupt.replace(0u, 5u, std::string("\x00\xff\xff\xff\xff", 5u));
+    current::FileSystem::WriteStringToFile(corrupt, broken_file_name.c_str());
+    CompactTSVFileReader corrupt_reader(broken_file_name);
+    ASSERT_THROW(corrupt_reader.UnpackBlock(0u, [](const std::vector<std::string> &) {}), CompactTSVFileException);
+    std::string truncated_block = whole.GetPackedString();
+    truncated_block.resize(truncated_block.length() / 2u);
+    ASSERT_THROW(CompactTSV::Unpack([](const std::vector<std::string> &) {}, truncated_block),
+                 CompactTSVUnpackException);
+  }
+}
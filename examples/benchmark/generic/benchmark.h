@@ -55,7 +55,7 @@ struct ScenariosRegisterer {
   }
   void Synopsis() const {
     std::cout << "./.current/run --scenario={scenario} [--threads={threads_to_query_from}] "
-                 "[--secons={seconds_to_run_benchmark_for}."
+                 "[--secons={seconds_to_run_benchmark_for}] [--rate={open_loop_total_qps}] [--output_json]."
               << std::endl;
     for (const auto& scenario : map) {
       std::cout << "\t--scenario=" << scenario.first << " : " << scenario.second.first << std::endl;
@@ -0,0 +1,116 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2016 Dmitry "Dima" Korolev <dmitry.korolev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef EXAMPLES_BENCHMARK_GENERIC_HISTOGRAM_H
+#define EXAMPLES_BENCHMARK_GENERIC_HISTOGRAM_H
+
+#include "../../../port.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// The HDR-style histogram of latencies: the values are grouped into power-of-two ranges, each split into
+// `kSubBuckets / 2` linear buckets, so any recorded value is known within 1/64th of it, from nanoseconds to hours,
+// at a fixed cost of one increment per value. The histograms of different threads are merged by adding them up.
+class LatencyHistogram final {
+ public:
+  constexpr static int kSubBucketBits = 7;
+  constexpr static uint64_t kSubBuckets = (1ull << kSubBucketBits);
+  constexpr static size_t kBuckets = static_cast<size_t>((64 - kSubBucketBits + 2) * (kSubBuckets / 2));
+
+  LatencyHistogram() : counts_(kBuckets, 0u) {}
+
+  void Record(uint64_t value) {
+    ++counts_[IndexOf(value)];
+    ++total_count_;
+    total_sum_ += value;
+    max_ = std::max(max_, value);
+  }
+
+  void Merge(const LatencyHistogram& rhs) {
+    for (size_t i = 0u; i < kBuckets; ++i) {
+      counts_[i] += rhs.counts_[i];
+    }
+    total_count_ += rhs.total_count_;
+    total_sum_ += rhs.total_sum_;
+    max_ = std::max(max_, rhs.max_);
+  }
+
+  uint64_t Count() const { return total_count_; }
+  uint64_t Max() const { return max_; }
+  double Mean() const { return total_count_ ? static_cast<double>(total_sum_) / total_count_ : 0.0; }
+
+  // The value below or at which `percentile` percent of the recorded values are, up to the precision of the buckets.
+  uint64_t Percentile(double percentile) const {
+    if (!total_count_) {
+      return 0u;
+    }
+    const uint64_t rank = std::max(
+        static_cast<uint64_t>(1u),
+        std::min(total_count_, static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total_count_) + 0.5)));
+    uint64_t seen = 0u;
+    for (size_t i = 0u; i < kBuckets; ++i) {
+      seen += counts_[i];
+      if (seen >= rank) {
+        return std::min(max_, HighestValueOf(i));
+      }
+    }
+    return max_;  // LCOV_EXCL_LINE
+  }
+
+ private:
+  // The values below `kSubBuckets` have a bucket each. Above it, the bucket of the value is defined by the position
+  // of its highest bit, `shift + kSubBucketBits - 1`, and by the `kSubBucketBits - 1` bits that follow it.
+  static size_t IndexOf(uint64_t value) {
+    if (value < kSubBuckets) {
+      return static_cast<size_t>(value);
+    }
+    int highest_bit = 63;
+    while (!(value >> highest_bit)) {
+      --highest_bit;
+    }
+    const int shift = highest_bit - (kSubBucketBits - 1);
+    return static_cast<size_t>(shift) * (kSubBuckets / 2) + static_cast<size_t>(value >> shift);
+  }
+
+  static uint64_t LowestValueOf(size_t index) {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    const size_t shift = index / (kSubBuckets / 2) - 1u;
+    return static_cast<uint64_t>(index - shift * (kSubBuckets / 2)) << shift;
+  }
+
+  static uint64_t HighestValueOf(size_t index) {
+    return index + 1u < kBuckets ? LowestValueOf(index + 1u) - 1u : ~static_cast<uint64_t>(0u);
+  }
+
+  std::vector<uint64_t> counts_;
+  uint64_t total_count_ = 0u;
+  uint64_t total_sum_ = 0u;
+  uint64_t max_ = 0u;
+};
+
+#endif  // EXAMPLES_BENCHMARK_GENERIC_HISTOGRAM_H
@@ -24,8 +24,13 @@ SOFTWARE.
 
 #include "../../../current.h"
 
+#include "histogram.h"
+
 #include "scenario_golden_1k_qps.h"
+#include "scenario_binary.h"
 #include "scenario_json.h"
+#include "scenario_rtti.h"
+#include "scenario_variant.h"
 #include "scenario_simple_http.h"
 #include "scenario_storage.h"
 #include "scenario_nginx_client.h"
@@ -43,8 +48,37 @@ DEFINE_int32(threads,
              "the measurement may be imprecise when run against a high-latency network,"
              "as more time would be spent waiting than running. Thus, this tool is only good for local tests.");
 
+DEFINE_double(rate,
+              0,
+              "Set to run the queries in the open loop, at this total number of queries per second, evenly spread "
+              "across the threads. The latency of each query is then measured from the moment it was scheduled to "
+              "start, not from the moment it has actually started, so that a stalled query is not hiding the delay "
+              "of the ones behind it. Leave zero to run the queries back to back, in the closed loop.");
+
+DEFINE_bool(output_json, false, "Output the results as JSON, for tracking them across runs.");
+
+CURRENT_STRUCT(BenchmarkLatencies) {
+  CURRENT_FIELD(p50_us, double);
+  CURRENT_FIELD(p90_us, double);
+  CURRENT_FIELD(p99_us, double);
+  CURRENT_FIELD(p999_us, double);
+  CURRENT_FIELD(max_us, double);
+  CURRENT_FIELD(mean_us, double);
+};
+
+CURRENT_STRUCT(BenchmarkResults) {
+  CURRENT_FIELD(scenario, std::string);
+  CURRENT_FIELD(mode, std::string);
+  CURRENT_FIELD(threads, int32_t);
+  CURRENT_FIELD(seconds, double);
+  CURRENT_FIELD(target_qps, double);
+  CURRENT_FIELD(queries, uint64_t);
+  CURRENT_FIELD(qps, double);
+  CURRENT_FIELD(latency, BenchmarkLatencies);
+};
+
 static double NowInSeconds() {
-  // Don't use `current::time::Now()`, as it's under a mutex, and guaranteed to increase by at least 1 per call.
+  // Don't use `current::time::Now()`, as it's guaranteed to increase by at least 1 per call.
   return 1e-6 *
          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
              .count();
@@ -53,9 +87,10 @@ static double NowInSeconds() {
 template <typename SCENARIO>
 void Run(const SCENARIO& scenario) {
   struct Thread {
-    Thread(const SCENARIO& scenario, double total_seconds)
+    Thread(const SCENARIO& scenario, double total_seconds, double rate)
         : scenario_(scenario),
           wall_time_second_end_(NowInSeconds() + total_seconds),
+          rate_(rate),
           queries_completed_within_desired_timeframe_(0u),
           thread_(&Thread::ThreadFunction, this) {}
 
@@ -63,27 +98,59 @@ void Run(const SCENARIO& scenario) {
 
     const SCENARIO& scenario_;
     const double wall_time_second_end_;
+    const double rate_;
     size_t queries_completed_within_desired_timeframe_;
+    LatencyHistogram latency_ns_;
     std::thread thread_;
 
     // The thread function runs the queries continuously. It only counts the queries
     // completed within the originally desired number of seconds in the final number.
     void ThreadFunction() {
+      if (rate_ > 0) {
+        ThreadFunctionOpenLoop();
+        return;
+      }
+      while (true) {
+        const auto begin = std::chrono::steady_clock::now();
+        scenario_->RunOneQuery();
+        const auto end = std::chrono::steady_clock::now();
+
+        if (NowInSeconds() >= wall_time_second_end_) {
+          break;
+        }
+
+        ++queries_completed_within_desired_timeframe_;
+        latency_ns_.Record(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+      }
+    }
+
+    // In the open loop, the queries are scheduled at the fixed rate, regardless of how long do they take.
+    void ThreadFunctionOpenLoop() {
+      const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / rate_));
+      auto scheduled = std::chrono::steady_clock::now();
       while (true) {
+        std::this_thread::sleep_until(scheduled);
         scenario_->RunOneQuery();
+        const auto end = std::chrono::steady_clock::now();
 
         if (NowInSeconds() >= wall_time_second_end_) {
           break;
         }
 
         ++queries_completed_within_desired_timeframe_;
+        latency_ns_.Record(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - scheduled).count()));
+        scheduled += interval;
       }
     }
   };
 
+  const double rate_per_thread = FLAGS_rate > 0 ? FLAGS_rate / FLAGS_threads : 0.0;
   std::vector<std::unique_ptr<Thread>> threads(FLAGS_threads);
   for (auto& t : threads) {
-    t = std::make_unique<Thread>(scenario, FLAGS_seconds);
+    t = std::make_unique<Thread>(scenario, FLAGS_seconds, rate_per_thread);
   }
 
   for (auto& t : threads) {
@@ -91,12 +158,35 @@ void Run(const SCENARIO& scenario) {
   }
 
   size_t total_queries = 0u;
+  LatencyHistogram latency_ns;
   for (auto& t : threads) {
     total_queries += t->queries_completed_within_desired_timeframe_;
+    latency_ns.Merge(t->latency_ns_);
   }
 
   const double qps = total_queries / FLAGS_seconds;
-  std::cout << std::setw(3) << qps << " QPS." << std::endl;
+  BenchmarkResults results;
+  results.scenario = FLAGS_scenario;
+  results.mode = FLAGS_rate > 0 ? "open_loop" : "closed_loop";
+  results.threads = FLAGS_threads;
+  results.seconds = FLAGS_seconds;
+  results.target_qps = FLAGS_rate;
+  results.queries = total_queries;
+  results.qps = qps;
+  results.latency.p50_us = 1e-3 * latency_ns.Percentile(50);
+  results.latency.p90_us = 1e-3 * latency_ns.Percentile(90);
+  results.latency.p99_us = 1e-3 * latency_ns.Percentile(99);
+  results.latency.p999_us = 1e-3 * latency_ns.Percentile(99.9);
+  results.latency.max_us = 1e-3 * latency_ns.Max();
+  results.latency.mean_us = 1e-3 * latency_ns.Mean();
+
+  if (FLAGS_output_json) {
+    std::cout << JSON(results) << std::endl;
+  } else {
+    std::cout << std::setw(3) << qps << " QPS, latency p50 " << results.latency.p50_us << "us, p90 "
+              << results.latency.p90_us << "us, p99 " << results.latency.p99_us << "us, p99.9 "
+              << results.latency.p999_us << "us, max " << results.latency.max_us << "us." << std::endl;
+  }
 }
 
 int main(int argc, char** argv) {
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# Compares the QPS of the `current_http_server` scenario with and without the HTTP client connection pool.
+
+if [ ! -f .current/run ] ; then
+  echo "Building '.current/run' to run the tests. You may want to check the compilation flags."
+  make .current/run
+fi
+
+CMD="./.current/run --scenario=current_http_server"
+
+for THREADS in 1 4 16 ; do
+  for CONNECTION_POOL in true false ; do
+    echo -n "threads=$THREADS"
+    [ $CONNECTION_POOL == true ] && echo -n ",pool : " || echo -n ",no pool : "
+    $CMD \
+      --threads=$THREADS \
+      --simple_http_connection_pool=$CONNECTION_POOL \
+      --seconds=5
+  done
+done
@@ -0,0 +1,70 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2016 Dmitry "Dima" Korolev <dmitry.korolev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef EXAMLPES_BENCHMARK_GENERIC_SCENARIO_BINARY_H
+#define EXAMLPES_BENCHMARK_GENERIC_SCENARIO_BINARY_H
+
+#include "../../../port.h"
+
+#include "../../../typesystem/serialization/binary.h"
+
+#include "scenario_json.h"  // The very `TopLevel` object of the JSON benchmark, for the apples-to-apples comparison.
+
+#ifndef CURRENT_MAKE_CHECK_MODE
+DEFINE_string(binary, "gen", "Binary serialization action to take in the performance test, gen/parse/both.");
+#else
+DECLARE_string(binary);
+#endif
+
+SCENARIO(binary, "Binary serialization performance test, on the object of the `json` scenario.") {
+  const TopLevel test_object;
+  const std::string test_object_binary;
+  std::function<void()> f;
+
+  binary() : test_object(), test_object_binary(Binary(test_object)) {
+    if (ParseBinary<TopLevel>(test_object_binary).name != test_object.name) {
+      std::cerr << "The binary serialization round trip is broken." << std::endl;
+      CURRENT_ASSERT(false);
+    }
+    std::cerr << "Binary size: " << test_object_binary.length() << " bytes, JSON size: " << JSON(test_object).length()
+              << " bytes." << std::endl;
+    if (FLAGS_binary == "gen") {
+      f = [this]() { Binary(test_object); };
+    } else if (FLAGS_binary == "parse") {
+      f = [this]() { ParseBinary<TopLevel>(test_object_binary); };
+    } else if (FLAGS_binary == "both") {
+      f = [this]() { ParseBinary<TopLevel>(Binary(test_object)); };
+    } else {
+      std::cerr << "The `--binary` flag must be 'gen', 'parse', or 'both'." << std::endl;
+      CURRENT_ASSERT(false);
+    }
+  }
+
+  void RunOneQuery() override { f(); }
+};
+
+REGISTER_SCENARIO(binary);
+
+#endif  // EXAMLPES_BENCHMARK_GENERIC_SCENARIO_BINARY_H
@@ -36,7 +36,7 @@ SOFTWARE.
 #include "../../../bricks/dflags/dflags.h"
 
 #ifndef CURRENT_MAKE_CHECK_MODE
-DEFINE_string(json, "gen", "JSON action to take in the performance test, gen/parse/both.");
+DEFINE_string(json, "gen", "JSON action to take in the performance test, gen/gen_via_document/parse/both.");
 #else
 DECLARE_string(json);
 #endif
@@ -173,19 +173,22 @@ SCENARIO(json, "JSON performance test.") {
   std::function<void()> f;
 
   json() : test_object(), test_object_json(JSON(test_object)) {
-    if (test_object_json.length() != test_object_json_golden_length) {
+    if (test_object_json.length() != test_object_json_golden_length ||
+        test_object_json != JSONViaRapidJSONDocument(test_object)) {
       std::cerr << "Actual JSON length: " << test_object_json.length() << ", expected "
                 << test_object_json_golden_length << std::endl;
       CURRENT_ASSERT(false);
     }
     if (FLAGS_json == "gen") {
       f = [this]() { JSON(test_object); };
+    } else if (FLAGS_json == "gen_via_document") {
+      f = [this]() { JSONViaRapidJSONDocument(test_object); };
     } else if (FLAGS_json == "parse") {
       f = [this]() { ParseJSON<TopLevel>(test_object_json); };
     } else if (FLAGS_json == "both") {
       f = [this]() { ParseJSON<TopLevel>(JSON(test_object)); };
     } else {
-      std::cerr << "The `--json` flag must be 'gen', 'parse', or 'both'." << std::endl;
+      std::cerr << "The `--json` flag must be 'gen', 'gen_via_document', 'parse', or 'both'." << std::endl;
       CURRENT_ASSERT(false);
     }
   }
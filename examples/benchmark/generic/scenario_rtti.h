@@ -0,0 +1,118 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2016 Dmitry "Dima" Korolev <dmitry.korolev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef EXAMLPES_BENCHMARK_GENERIC_SCENARIO_RTTI_H
+#define EXAMLPES_BENCHMARK_GENERIC_SCENARIO_RTTI_H
+
+#include "../../../port.h"
+
+#include "../../../bricks/template/rtti_dynamic_call.h"
+
+#include "benchmark.h"
+
+#include "../../../bricks/dflags/dflags.h"
+
+#ifndef CURRENT_MAKE_CHECK_MODE
+DEFINE_string(rtti_dispatch, "dense", "The `RTTIDynamicCall<>` dispatch to benchmark, dense/map.");
+DEFINE_uint32(rtti_batch, 1000u, "The number of objects to dispatch per query.");
+#else
+DECLARE_string(rtti_dispatch);
+DECLARE_uint32(rtti_batch);
+#endif
+
+namespace benchmark_rtti {
+
+struct Message {
+  virtual ~Message() = default;
+};
+
+// Eight message types, to have the hash map of the `TypeIndexMap` dispatch hold more than a couple of entries.
+template <int N>
+struct MessageOfType : Message {
+  uint64_t value = N;
+};
+
+using messages_t = TypeListImpl<MessageOfType<0>,
+                                MessageOfType<1>,
+                                MessageOfType<2>,
+                                MessageOfType<3>,
+                                MessageOfType<4>,
+                                MessageOfType<5>,
+                                MessageOfType<6>,
+                                MessageOfType<7>>;
+
+struct Sum {
+  uint64_t sum = 0u;
+  template <int N>
+  void operator()(const MessageOfType<N>& message) {
+    sum += message.value;
+  }
+};
+
+template <int... NS>
+std::vector<std::unique_ptr<Message>> MakeBatch(size_t size, std::integer_sequence<int, NS...>) {
+  using factory_t = std::unique_ptr<Message> (*)();
+  const factory_t factories[] = {[]() -> std::unique_ptr<Message> { return std::make_unique<MessageOfType<NS>>(); }...};
+  std::vector<std::unique_ptr<Message>> result;
+  for (size_t i = 0u; i < size; ++i) {
+    result.push_back(factories[i % sizeof...(NS)]());
+  }
+  return result;
+}
+
+}  // namespace benchmark_rtti
+
+SCENARIO(rtti, "`RTTIDynamicCall<>` dispatch performance test, dense type indexes vs. `std::type_index` hash map.") {
+  std::vector<std::unique_ptr<benchmark_rtti::Message>> batch;
+  std::function<void()> f;
+
+  rtti() : batch(benchmark_rtti::MakeBatch(FLAGS_rtti_batch, std::make_integer_sequence<int, 8>())) {
+    using current::metaprogramming::RTTIDispatch;
+    if (FLAGS_rtti_dispatch == "dense") {
+      f = [this]() { Dispatch<RTTIDispatch::DenseIndex>(); };
+    } else if (FLAGS_rtti_dispatch == "map") {
+      f = [this]() { Dispatch<RTTIDispatch::TypeIndexMap>(); };
+    } else {
+      std::cerr << "The `--rtti_dispatch` flag must be 'dense' or 'map'." << std::endl;
+      CURRENT_ASSERT(false);
+    }
+  }
+
+  template <current::metaprogramming::RTTIDispatch DISPATCH>
+  void Dispatch() {
+    benchmark_rtti::Sum sum;
+    for (const auto& message : batch) {
+      current::metaprogramming::RTTIDynamicCallVia<DISPATCH, benchmark_rtti::messages_t>(
+          static_cast<const benchmark_rtti::Message&>(*message), sum);
+    }
+    CURRENT_ASSERT(sum.sum == (batch.size() / 8u) * 28u + (batch.size() % 8u) * (batch.size() % 8u - 1u) / 2u);
+  }
+
+  void RunOneQuery() override { f(); }
+};
+
+REGISTER_SCENARIO(rtti);
+
+#endif  // EXAMLPES_BENCHMARK_GENERIC_SCENARIO_RTTI_H
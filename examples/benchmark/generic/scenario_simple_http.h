@@ -40,11 +40,15 @@ DEFINE_string(simple_http_local_route, "/perftest", "Local route for `current_ht
 DEFINE_string(simple_http_test_body,
               "+current -nginx\n",
               "Golden HTTP body to return for the `current_http_server` scenario.");
+DEFINE_bool(simple_http_connection_pool,
+            true,
+            "Set to false to have the HTTP client connect afresh for every request, instead of reusing connections.");
 #else
 DECLARE_uint16(simple_http_local_port);
 DECLARE_uint16(simple_http_local_top_port);
 DECLARE_string(simple_http_local_route);
 DECLARE_string(simple_http_test_body);
+DECLARE_bool(simple_http_connection_pool);
 #endif
 
 SCENARIO(current_http_server, "Use Current's HTTP stack for simple HTTP client-server handshake.") {
@@ -52,6 +56,7 @@ SCENARIO(current_http_server, "Use Current's HTTP stack for simple HTTP client-s
   HTTPRoutesScope scope;
 
   current_http_server() {
+    current::Singleton<current::http::HTTPClientConnectionPool>().SetEnabled(FLAGS_simple_http_connection_pool);
     const auto handler = [](Request r) { r(FLAGS_simple_http_test_body); };
     for (uint16_t port = FLAGS_simple_http_local_port;
          port <= std::max(FLAGS_simple_http_local_top_port, FLAGS_simple_http_local_port);
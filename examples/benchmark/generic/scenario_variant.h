@@ -0,0 +1,162 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2016 Dmitry "Dima" Korolev <dmitry.korolev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef EXAMLPES_BENCHMARK_GENERIC_SCENARIO_VARIANT_H
+#define EXAMLPES_BENCHMARK_GENERIC_SCENARIO_VARIANT_H
+
+#include "../../../port.h"
+
+#include "../../../typesystem/struct.h"
+#include "../../../typesystem/variant.h"
+#include "../../../typesystem/serialization/json.h"
+
+#include "benchmark.h"
+
+#include "../../../bricks/dflags/dflags.h"
+
+#ifndef CURRENT_MAKE_CHECK_MODE
+DEFINE_string(variant_type, "heap", "The type of variant to benchmark, heap/inline.");
+DEFINE_string(variant_action, "create", "Variant action to take in the performance test, create/copy/call/json.");
+DEFINE_uint32(variant_batch, 100u, "The number of variant objects to process per query.");
+#else
+DECLARE_string(variant_type);
+DECLARE_string(variant_action);
+DECLARE_uint32(variant_batch);
+#endif
+
+namespace benchmark_variant {
+
+CURRENT_STRUCT(Tick) {
+  CURRENT_FIELD(sequence, uint64_t, 0u);
+  CURRENT_FIELD(price, double, 0.0);
+};
+
+CURRENT_STRUCT(Trade) {
+  CURRENT_FIELD(sequence, uint64_t, 0u);
+  CURRENT_FIELD(quantity, uint32_t, 0u);
+  CURRENT_FIELD(price, double, 0.0);
+};
+
+CURRENT_STRUCT(Heartbeat) { CURRENT_FIELD(sequence, uint64_t, 0u); };
+
+struct SumSequences {
+  uint64_t sum = 0u;
+  template <typename T>
+  void operator()(const T& x) {
+    sum += x.sequence;
+  }
+};
+
+template <typename VARIANT>
+struct Impl {
+  std::vector<VARIANT> batch;
+  std::vector<std::string> batch_json;
+
+  explicit Impl(size_t size) {
+    batch.reserve(size);
+    for (size_t i = 0u; i < size; ++i) {
+      batch.push_back(Make(i));
+      batch_json.push_back(JSON(batch.back()));
+    }
+  }
+
+  static VARIANT Make(size_t i) {
+    if (i % 3u == 0u) {
+      Tick tick;
+      tick.sequence = i;
+      return tick;
+    } else if (i % 3u == 1u) {
+      Trade trade;
+      trade.sequence = i;
+      return trade;
+    } else {
+      Heartbeat heartbeat;
+      heartbeat.sequence = i;
+      return heartbeat;
+    }
+  }
+
+  std::function<void()> Action(const std::string& action) {
+    if (action == "create") {
+      return [this]() {
+        std::vector<VARIANT> result;
+        result.reserve(batch.size());
+        for (size_t i = 0u; i < batch.size(); ++i) {
+          result.push_back(Make(i));
+        }
+      };
+    } else if (action == "copy") {
+      return [this]() { std::vector<VARIANT> copy(batch); };
+    } else if (action == "call") {
+      return [this]() {
+        SumSequences sum;
+        for (const auto& v : batch) {
+          v.Call(sum);
+        }
+        CURRENT_ASSERT(sum.sum == batch.size() * (batch.size() - 1u) / 2u);
+      };
+    } else if (action == "json") {
+      return [this]() {
+        for (const auto& json : batch_json) {
+          ParseJSON<VARIANT>(json);
+        }
+      };
+    } else {
+      std::cerr << "The `--variant_action` flag must be 'create', 'copy', 'call', or 'json'." << std::endl;
+      CURRENT_ASSERT(false);
+      return nullptr;  // LCOV_EXCL_LINE
+    }
+  }
+};
+
+}  // namespace benchmark_variant
+
+SCENARIO(variant, "Heap-allocated `Variant` vs. inline `InlineVariant` performance test.") {
+  using heap_t = Variant<benchmark_variant::Tick, benchmark_variant::Trade, benchmark_variant::Heartbeat>;
+  using inline_t = InlineVariant<benchmark_variant::Tick, benchmark_variant::Trade, benchmark_variant::Heartbeat>;
+
+  std::unique_ptr<benchmark_variant::Impl<heap_t>> heap_impl;
+  std::unique_ptr<benchmark_variant::Impl<inline_t>> inline_impl;
+  std::function<void()> f;
+
+  variant() {
+    if (FLAGS_variant_type == "heap") {
+      heap_impl = std::make_unique<benchmark_variant::Impl<heap_t>>(FLAGS_variant_batch);
+      f = heap_impl->Action(FLAGS_variant_action);
+    } else if (FLAGS_variant_type == "inline") {
+      inline_impl = std::make_unique<benchmark_variant::Impl<inline_t>>(FLAGS_variant_batch);
+      f = inline_impl->Action(FLAGS_variant_action);
+    } else {
+      std::cerr << "The `--variant_type` flag must be 'heap' or 'inline'." << std::endl;
+      CURRENT_ASSERT(false);
+    }
+  }
+
+  void RunOneQuery() override { f(); }
+};
+
+REGISTER_SCENARIO(variant);
+
+#endif  // EXAMLPES_BENCHMARK_GENERIC_SCENARIO_VARIANT_H
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ The MIT License (MIT)
+
+ Copyright (c) 2016 Grigory Nikolaenko <nikolaenko.grigory@gmail.com>
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ *******************************************************************************/
+
+// Compares the throughput of the mutex-based and the lock-free `MMQ`-s.
+// The single-publisher lock-free queue is only benchmarked with one publishing thread.
+
+#include "../../../blocks/mmq/mmq.h"
+
+#include "../../../bricks/dflags/dflags.h"
+#include "../../../bricks/time/chrono.h"
+
+DEFINE_uint32(publishers, 4, "The number of threads publishing into the multiple publishers queues.");
+DEFINE_uint32(messages, 1000000, "The number of messages to publish from each thread.");
+
+struct CountingConsumerImpl {
+  std::atomic<uint64_t> consumed{0u};
+  current::ss::EntryResponse operator()(uint64_t, idxts_t, idxts_t) {
+    consumed.fetch_add(1u, std::memory_order_relaxed);
+    return current::ss::EntryResponse::More;
+  }
+};
+
+using CountingConsumer = current::ss::EntrySubscriber<CountingConsumerImpl, uint64_t>;
+
+// Returns the number of messages per second passed through the queue.
+template <current::mmq::MMQSync SYNC>
+double Run(uint32_t publishers) {
+  CountingConsumer consumer;
+  current::mmq::MMQ<uint64_t, CountingConsumer, 1024, false, SYNC> mmq(consumer);
+
+  const uint64_t total = static_cast<uint64_t>(publishers) * FLAGS_messages;
+  // Not `current::time::Now()`, as it would run ahead of the wall time when more than one message per microsecond
+  // is published.
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < publishers; ++t) {
+    threads.emplace_back([&mmq]() {
+      for (uint32_t i = 0; i < FLAGS_messages; ++i) {
+        mmq.Publish(i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (consumer.consumed.load() != total) {
+    std::this_thread::yield();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return 1e6 * total / std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+  ParseDFlags(&argc, &argv);
+
+  using current::mmq::MMQSync;
+
+  std::cout << "One publisher, messages per second:" << std::endl;
+  std::cout << "* Mutex:\t" << static_cast<uint64_t>(Run<MMQSync::Mutex>(1u)) << std::endl;
+  std::cout << "* Lock-free SPSC:\t" << static_cast<uint64_t>(Run<MMQSync::LockFreeSinglePublisher>(1u)) << std::endl;
+  std::cout << "* Lock-free MPSC:\t" << static_cast<uint64_t>(Run<MMQSync::LockFreeMultiplePublishers>(1u))
+            << std::endl;
+
+  std::cout << FLAGS_publishers << " publishers, messages per second:" << std::endl;
+  std::cout << "* Mutex:\t" << static_cast<uint64_t>(Run<MMQSync::Mutex>(FLAGS_publishers)) << std::endl;
+  std::cout << "* Lock-free MPSC:\t"
+            << static_cast<uint64_t>(Run<MMQSync::LockFreeMultiplePublishers>(FLAGS_publishers)) << std::endl;
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <atomic>
+
+#include "schema.h"
+
+#include "../../../bricks/dflags/dflags.h"
+
+DEFINE_uint32(entries, 10000u, "The number of entries to populate the storage with before the benchmark.");
+DEFINE_uint16(readers, 4u, "The number of threads running read-only transactions.");
+DEFINE_uint16(writers, 1u, "The number of threads running read-write transactions.");
+DEFINE_uint32(reads_per_transaction, 10u, "The number of lookups performed by each read-only transaction.");
+DEFINE_double(seconds, 5.0, "The duration of the benchmark.");
+
+using in_memory_storage_t = TestStorage<StreamInMemoryStreamPersister>;
+
+int main(int argc, char** argv) {
+  ParseDFlags(&argc, &argv);
+
+  auto storage = in_memory_storage_t::CreateMasterStorage();
+  storage
+      ->ReadWriteTransaction([](MutableFields<in_memory_storage_t> fields) {
+        for (uint32_t i = 0u; i < FLAGS_entries; ++i) {
+          fields.entries.Add(Entry(static_cast<EntryID>(i), current::ToString(i)));
+        }
+      })
+      .Go();
+
+  std::atomic_bool done(false);
+  std::atomic<uint64_t> total_reads(0u);
+  std::atomic<uint64_t> total_writes(0u);
+
+  std::vector<std::thread> threads;
+  for (uint16_t r = 0u; r < FLAGS_readers; ++r) {
+    threads.emplace_back([&, r]() {
+      uint64_t reads = 0u;
+      uint64_t key = r;
+      while (!done) {
+        storage
+            ->ReadOnlyTransaction([&key](ImmutableFields<in_memory_storage_t> fields) {
+              for (uint32_t i = 0u; i < FLAGS_reads_per_transaction; ++i) {
+                key = (key * 1000003u + 1u) % FLAGS_entries;
+                CURRENT_ASSERT(Exists(fields.entries[static_cast<EntryID>(key)]));
+              }
+            })
+            .Go();
+        ++reads;
+      }
+      total_reads += reads;
+    });
+  }
+  for (uint16_t w = 0u; w < FLAGS_writers; ++w) {
+    threads.emplace_back([&, w]() {
+      uint64_t writes = 0u;
+      uint64_t key = w;
+      while (!done) {
+        storage
+            ->ReadWriteTransaction([&key](MutableFields<in_memory_storage_t> fields) {
+              key = (key * 1000003u + 1u) % FLAGS_entries;
+              fields.entries.Add(Entry(static_cast<EntryID>(key), current::ToString(key + 1u)));
+            })
+            .Go();
+        ++writes;
+      }
+      total_writes += writes;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(FLAGS_seconds * 1e6)));
+  done = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::cout << "Readers: " << FLAGS_readers << ", writers: " << FLAGS_writers << std::endl;
+  std::cout << "* Read-only transactions: " << static_cast<uint64_t>(total_reads / FLAGS_seconds) << " per second\n";
+  std::cout << "* Read-write transactions: " << static_cast<uint64_t>(total_writes / FLAGS_seconds) << " per second"
+            << std::endl;
+}
@@ -32,7 +32,7 @@ SOFTWARE.
 
 #ifndef CURRENT_PROFILER
 
-#define CURRENT_PROFILER_SCOPE(scope)
+#define CURRENT_PROFILER_SCOPE(scope) static_cast<void>(0)
 #define CURRENT_PROFILER_HTTP_ROUTE(scope, port, route)
 
 #else
@@ -41,7 +41,19 @@ SOFTWARE.
 #error "No `CURRENT_PROFILER` in `CURRENT_COVERAGE_REPORT_MODE` please."
 #endif
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CURRENT_PROFILER_USES_TSC
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define CURRENT_PROFILER_USES_TSC
+#endif
 
 #include "../blocks/http/api.h"
 #include "../bricks/time/chrono.h"
@@ -51,6 +63,11 @@ SOFTWARE.
 #error "No `CURRENT_PROFILER` in `CURRENT_MOCK_TIME` please."
 #endif
 
+// The maximum number of distinct `CURRENT_PROFILER_SCOPE`-s in the binary. The ones beyond it are not profiled.
+#ifndef CURRENT_PROFILER_MAX_SCOPES
+#define CURRENT_PROFILER_MAX_SCOPES 4096
+#endif  // CURRENT_PROFILER_MAX_SCOPES
+
 namespace current {
 namespace profiler {
 
@@ -70,209 +87,314 @@ CURRENT_STRUCT(PerThreadReporting) {
 
 CURRENT_STRUCT(ProfilingReport) {
   CURRENT_FIELD(thread, std::vector<PerThreadReporting>);
-  CURRENT_FIELD(profiling_overhead, std::chrono::microseconds);
-  CURRENT_FIELD(profiling_mutex_overhead, std::chrono::microseconds);
+  CURRENT_FIELD(profiling_overhead, std::chrono::microseconds);  // Estimated, from the number of scopes entered.
   CURRENT_FIELD(reporting_overhead, std::chrono::microseconds);
 };
 
+// The timestamps of the profiler: the TSC where available, and `steady_clock` ticks otherwise.
+// They are only converted into microseconds when the report is generated.
+inline uint64_t ProfilerTicks() {
+#ifdef CURRENT_PROFILER_USES_TSC
+  return static_cast<uint64_t>(__rdtsc());
+#else
+  return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif  // CURRENT_PROFILER_USES_TSC
+}
+
 struct Profiler {
+  // Recording a scope only touches the data of the current thread, and never locks.
+  // Each thread keeps its own call tree, the nodes of which are only ever appended, and never move in memory.
+  // The counters of the nodes are atomic, written by their thread and read by the reporter, so the report can be
+  // generated at any time, with no cooperation from the profiled threads.
   class StateMaintainer {
    private:
-    struct State {
-      struct PerThread {
-        struct Trie {
-          // `Now()` if within it, `0` if currently not there.
-          std::chrono::microseconds us_entered = std::chrono::microseconds(0);
-          // Total across all the times this scope was entered.
-          std::chrono::microseconds us_total = std::chrono::microseconds(0);
-          // The number of times this scope was entered.
-          uint64_t entries = 0;
-          // Sub-scopes within this scope, if any.
-          std::map<const char*, Trie> children;
-
-          std::chrono::microseconds ComputeTotalMicroseconds(std::chrono::microseconds now) const {
-            if (us_entered.count()) {
-              CURRENT_ASSERT(now >= us_entered);
-              return std::chrono::microseconds(us_total.count() + (now - us_entered).count());
-            } else {
-              return us_total;
-            }
-          }
-          void RecursiveReset(std::chrono::microseconds now) {
-            us_total = std::chrono::microseconds(0);
-            if (us_entered.count()) {
-              us_entered = now;
-            }
-            entries = 1;
-            for (auto& e : children) {
-              e.second.RecursiveReset(now);
-            }
+    constexpr static uint32_t kNone = static_cast<uint32_t>(-1);
+    constexpr static uint32_t kRootScope = static_cast<uint32_t>(-2);
+
+    struct PerThread final {
+      struct Node final {
+        uint32_t scope_id = kNone;
+        std::atomic<uint32_t> first_child{kNone};
+        std::atomic<uint32_t> next_sibling{kNone};
+        std::atomic<uint64_t> entries{0u};
+        std::atomic<uint64_t> ticks_total{0u};
+        // The timestamp of entering this scope if within it, `0` if currently not there.
+        std::atomic<uint64_t> ticks_entered{0u};
+      };
+
+      constexpr static uint32_t kNodesPerChunk = 1024u;
+      constexpr static uint32_t kMaxChunks = 1024u;
+
+      const std::thread::id thread_id;
+      std::atomic<Node*> chunks[kMaxChunks];
+      std::vector<std::unique_ptr<Node[]>> owned_chunks;
+      std::atomic<uint32_t> nodes_count{0u};
+      std::vector<uint32_t> stack;  // Only accessed by the thread itself.
+
+      // The values as of the last reset, by node index. Only accessed by the reporter.
+      std::vector<std::pair<uint64_t, uint64_t>> reset_baseline;
+
+      explicit PerThread(std::thread::id thread_id) : thread_id(thread_id) {
+        for (auto& chunk : chunks) {
+          chunk.store(nullptr, std::memory_order_relaxed);
+        }
+        const uint32_t root = AddNode(kRootScope);
+        Node& node = At(root);
+        node.entries.store(1u, std::memory_order_relaxed);
+        node.ticks_entered.store(ProfilerTicks(), std::memory_order_relaxed);
+        stack.reserve(64u);
+        stack.push_back(root);
+      }
+
+      Node& At(uint32_t index) const {
+        return chunks[index / kNodesPerChunk].load(std::memory_order_acquire)[index % kNodesPerChunk];
+      }
+
+      uint32_t AddNode(uint32_t scope_id) {
+        const uint32_t index = nodes_count.load(std::memory_order_relaxed);
+        if (index / kNodesPerChunk >= kMaxChunks) {
+          return kNone;  // LCOV_EXCL_LINE
+        }
+        if (!(index % kNodesPerChunk)) {
+          owned_chunks.emplace_back(new Node[kNodesPerChunk]);
+          chunks[index / kNodesPerChunk].store(owned_chunks.back().get(), std::memory_order_release);
+        }
+        At(index).scope_id = scope_id;
+        nodes_count.store(index + 1u, std::memory_order_release);
+        return index;
+      }
+
+      uint32_t FindOrAddChild(uint32_t parent_index, uint32_t scope_id) {
+        Node& parent = At(parent_index);
+        for (uint32_t i = parent.first_child.load(std::memory_order_relaxed); i != kNone;
+             i = At(i).next_sibling.load(std::memory_order_relaxed)) {
+          if (At(i).scope_id == scope_id) {
+            return i;
           }
-        };
-        Trie trie;
-        std::stack<std::pair<const char*, Trie*> > stack;
-        PerThread() {
-          trie.us_entered = current::time::Now();
-          trie.entries = 1;
-          stack.push(std::make_pair("", &trie));
         }
-      };
-      std::unordered_map<std::thread::id, PerThread> per_thread;
-      std::chrono::microseconds total_spent_in_profiling = std::chrono::microseconds(0);
-      std::chrono::microseconds spent_in_reporting = std::chrono::microseconds(0);
-      std::chrono::microseconds spent_in_mutex_locking = std::chrono::microseconds(0);
-      void Reset() {
-        total_spent_in_profiling = std::chrono::microseconds(0);
-        spent_in_reporting = std::chrono::microseconds(0);
-        spent_in_mutex_locking = std::chrono::microseconds(0);
-        for (auto& e : per_thread) {
-          e.second.trie.RecursiveReset(current::time::Now());
+        const uint32_t child = AddNode(scope_id);
+        if (child != kNone) {
+          At(child).next_sibling.store(parent.first_child.load(std::memory_order_relaxed), std::memory_order_relaxed);
+          // Publish the fully initialized node to the reporter.
+          parent.first_child.store(child, std::memory_order_release);
         }
+        return child;
       }
-      ProfilingReport GenerateReport() const {
-        const std::chrono::microseconds now = current::time::Now();
-        ProfilingReport report;
-        report.profiling_overhead = total_spent_in_profiling - spent_in_reporting;
-        report.reporting_overhead = spent_in_reporting;
-        report.profiling_mutex_overhead = spent_in_mutex_locking;
-        std::vector<PerThreadReporting> thread;
-        thread.reserve(per_thread.size());
-        for (const auto& per_thread_element : per_thread) {
-          std::function<void(const PerThread::Trie& input,
-                             std::chrono::microseconds total_us,
-                             PerThreadReporting& output,
-                             const char* stack)>
-              recursive_fill;
-          recursive_fill = [now, &recursive_fill](const PerThread::Trie& input,
-                                                  std::chrono::microseconds total_us,
-                                                  PerThreadReporting& output,
-                                                  const char* stack) {
-            output.scope = stack;
-            output.entries = input.entries;
-            CURRENT_ASSERT(output.entries);
-            output.us = input.ComputeTotalMicroseconds(now);
-            output.us_per_entry = 1.0 * output.us.count() / output.entries;
-            output.absolute_best_possible_qps = output.us.count() ? (1e6 / output.us_per_entry) : 1e6;
-            output.ratio_of_parent = total_us.count() ? (1.0 * output.us.count() / total_us.count()) : 1.0;
-            output.subscope.reserve(input.children.size());
-            for (const auto& scope : input.children) {
-              output.subscope.resize(output.subscope.size() + 1);
-              recursive_fill(scope.second, output.us, output.subscope.back(), scope.first);
-            }
-            CURRENT_ASSERT(output.subscope.size() == input.children.size());
-            std::chrono::microseconds subscope_total = std::chrono::microseconds(0);
-            for (const auto& subscope : output.subscope) {
-              subscope_total += subscope.us;
-            }
-            CURRENT_ASSERT(subscope_total <= output.us);
-            output.subscope_total_ratio_of_parent =
-                output.us.count() ? (1.0 * subscope_total.count() / output.us.count()) : 1.0;
-            std::sort(output.subscope.begin(), output.subscope.end());
-          };
-          thread.resize(thread.size() + 1);
-          std::ostringstream thread_id_as_string;
-          thread_id_as_string << "C++ thread with internal ID " << per_thread_element.first;
-          recursive_fill(per_thread_element.second.trie,
-                         per_thread_element.second.trie.ComputeTotalMicroseconds(now),
-                         thread.back(),
-                         thread_id_as_string.str().c_str());
+
+      void Enter(uint32_t scope_id) {
+        // Once out of nodes, the scopes entered from within the one not recorded are not recorded either.
+        const uint32_t child = (stack.back() != kNone) ? FindOrAddChild(stack.back(), scope_id) : kNone;
+        if (child != kNone) {
+          Node& node = At(child);
+          node.entries.store(node.entries.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+          node.ticks_entered.store(ProfilerTicks(), std::memory_order_relaxed);
         }
-        CURRENT_ASSERT(thread.size() == per_thread.size());
-        report.thread = thread;
-        return report;
+        stack.push_back(child);
+      }
+
+      void Leave(uint32_t scope_id) {
+        CURRENT_ASSERT(stack.size() > 1u);  // Should have at least the root node left in the stack.
+        const uint32_t index = stack.back();
+        stack.pop_back();
+        if (index != kNone) {
+          Node& node = At(index);
+          CURRENT_ASSERT(node.scope_id == scope_id);
+          const uint64_t now = ProfilerTicks();
+          const uint64_t entered = node.ticks_entered.load(std::memory_order_relaxed);
+          node.ticks_total.store(node.ticks_total.load(std::memory_order_relaxed) + (now - entered),
+                                 std::memory_order_relaxed);
+          node.ticks_entered.store(0u, std::memory_order_relaxed);
+        }
+#ifdef NDEBUG
+        static_cast<void>(scope_id);
+#endif
+      }
+
+      // The number of entries and the total ticks spent in the scope, including the ongoing entry, if any.
+      std::pair<uint64_t, uint64_t> Totals(uint32_t index, uint64_t now) const {
+        const Node& node = At(index);
+        const uint64_t entered = node.ticks_entered.load(std::memory_order_relaxed);
+        const uint64_t total = node.ticks_total.load(std::memory_order_relaxed);
+        return std::make_pair(node.entries.load(std::memory_order_relaxed),
+                              total + ((entered && now > entered) ? now - entered : 0u));
       }
     };
 
    public:
-    void EnterScope(const char* scope) {
-      CURRENT_ASSERT(scope);
-      CURRENT_ASSERT(*scope);
-      Guarded([scope](std::chrono::microseconds now, State::PerThread& per_thread) {
-        CURRENT_ASSERT(now.count());
-        CURRENT_ASSERT(!per_thread.stack.empty());
-        State::PerThread::Trie& node = (*per_thread.stack.top().second).children[scope];
-        node.us_entered = now;
-        ++node.entries;
-        per_thread.stack.push(std::make_pair(scope, &node));
-      });
+    StateMaintainer() : start_ticks_(ProfilerTicks()), start_time_(std::chrono::steady_clock::now()) {
+      // Estimate the cost of recording a scope, to report the overall profiling overhead.
+      constexpr static uint32_t kCalibrationIterations = 1000u;
+      PerThread calibration(std::this_thread::get_id());
+      const uint64_t begin = ProfilerTicks();
+      for (uint32_t i = 0u; i < kCalibrationIterations; ++i) {
+        calibration.Enter(0u);
+        calibration.Leave(0u);
+      }
+      ticks_per_entry_ = 1.0 * (ProfilerTicks() - begin) / kCalibrationIterations;
     }
 
-    void LeaveScope(const char* scope) {
+    // Called once per `CURRENT_PROFILER_SCOPE`, when it is first reached.
+    uint32_t RegisterScope(const char* scope) {
       CURRENT_ASSERT(scope);
       CURRENT_ASSERT(*scope);
-      Guarded([scope](std::chrono::microseconds now, State::PerThread& per_thread) {
-        CURRENT_ASSERT(now.count());
-        CURRENT_ASSERT(!per_thread.stack.empty());
-        CURRENT_ASSERT(scope == per_thread.stack.top().first);
-        State::PerThread::Trie& node = (*per_thread.stack.top().second);
-        CURRENT_ASSERT(node.us_entered <= now);
-        node.us_total += (now - node.us_entered);
-        node.us_entered = std::chrono::microseconds(0);
-        per_thread.stack.pop();
-        CURRENT_ASSERT(!per_thread.stack.empty());  // Should have at least the root trie node left in the stack.
-      });
+      const uint32_t scope_id = scopes_count_.fetch_add(1u);
+      if (scope_id < CURRENT_PROFILER_MAX_SCOPES) {
+        scope_names_[scope_id].store(scope, std::memory_order_release);
+        return scope_id;
+      } else {
+        return kNone;  // LCOV_EXCL_LINE
+      }
+    }
+
+    void EnterScope(uint32_t scope_id) {
+      if (scope_id != kNone) {
+        ThisThread().Enter(scope_id);
+      }
+    }
+
+    void LeaveScope(uint32_t scope_id) {
+      if (scope_id != kNone) {
+        ThisThread().Leave(scope_id);
+      }
     }
 
     void Report(Request request) {
-      Guarded([this, &request](std::chrono::microseconds unused_now, const State::PerThread& unused_per_thread_state) {
-        static_cast<void>(unused_now);
-        static_cast<void>(unused_per_thread_state);
-        if (request.url.query.has("reset")) {
-          state_.Reset();
-          request("The profiler has been reset.\n");
-        } else {
-          const std::chrono::microseconds pre_report = current::time::Now();
-          request(state_.GenerateReport());
-          const std::chrono::microseconds post_report = current::time::Now();
-          state_.spent_in_reporting += (post_report - pre_report);
-        }
-      });
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (request.url.query.has("reset")) {
+        Reset();
+        request("The profiler has been reset.\n");
+      } else {
+        const auto pre_report = std::chrono::steady_clock::now();
+        request(GenerateReport());
+        spent_in_reporting_ +=
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - pre_report);
+      }
     }
 
    private:
-    template <typename F>
-    void Guarded(F&& f) {
-      const std::chrono::microseconds pre_mutex_lock = current::time::Now();
-      std::lock_guard<std::mutex> lock(mutex_);
-      const std::chrono::microseconds post_mutex_lock = current::time::Now();
-      f(post_mutex_lock, state_.per_thread[std::this_thread::get_id()]);
-      const std::chrono::microseconds post_guarded_code = current::time::Now();
-      state_.total_spent_in_profiling += (post_guarded_code - pre_mutex_lock);
-      state_.spent_in_mutex_locking += (post_mutex_lock - pre_mutex_lock);
+    PerThread& ThisThread() {
+      thread_local PerThread* per_thread = nullptr;
+      if (!per_thread) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.emplace_back(std::make_unique<PerThread>(std::this_thread::get_id()));
+        per_thread = threads_.back().get();
+      }
+      return *per_thread;
     }
 
-    struct Scope {
-      Scope(const char*) {}
-      const char* scope;
-    };
+    void Reset() {
+      const uint64_t now = ProfilerTicks();
+      for (auto& per_thread : threads_) {
+        const uint32_t nodes_count = per_thread->nodes_count.load(std::memory_order_acquire);
+        per_thread->reset_baseline.resize(nodes_count);
+        for (uint32_t i = 0u; i < nodes_count; ++i) {
+          per_thread->reset_baseline[i] = per_thread->Totals(i, now);
+        }
+      }
+      spent_in_reporting_ = std::chrono::microseconds(0);
+    }
 
-    std::mutex mutex_;
-    State state_;
+    ProfilingReport GenerateReport() const {
+      const uint64_t now = ProfilerTicks();
+      const double elapsed_us = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                                        std::chrono::steady_clock::now() - start_time_)
+                                                        .count());
+      const double us_per_tick = (elapsed_us > 0 && now > start_ticks_) ? elapsed_us / (now - start_ticks_) : 0.0;
+      const auto ToMicroseconds = [us_per_tick](uint64_t ticks) {
+        return std::chrono::microseconds(static_cast<int64_t>(us_per_tick * ticks));
+      };
+
+      ProfilingReport report;
+      uint64_t total_entries = 0u;
+      report.thread.reserve(threads_.size());
+      for (const auto& per_thread : threads_) {
+        const PerThread& t = *per_thread;
+        std::function<void(uint32_t, std::chrono::microseconds, PerThreadReporting&)> recursive_fill;
+        recursive_fill = [&](uint32_t index, std::chrono::microseconds parent_us, PerThreadReporting& output) {
+          auto totals = t.Totals(index, now);
+          if (index < t.reset_baseline.size()) {
+            totals.first -= std::min(totals.first, t.reset_baseline[index].first);
+            totals.second -= std::min(totals.second, t.reset_baseline[index].second);
+          }
+          const uint32_t scope_id = t.At(index).scope_id;
+          if (scope_id != kRootScope) {
+            output.scope = scope_names_[scope_id].load(std::memory_order_acquire);
+            total_entries += totals.first;
+          }
+          output.entries = totals.first;
+          output.us = ToMicroseconds(totals.second);
+          output.us_per_entry = output.entries ? 1.0 * output.us.count() / output.entries : output.us.count();
+          output.absolute_best_possible_qps = output.us.count() ? (1e6 / output.us_per_entry) : 1e6;
+          output.ratio_of_parent = parent_us.count() ? (1.0 * output.us.count() / parent_us.count()) : 1.0;
+          std::chrono::microseconds subscope_total = std::chrono::microseconds(0);
+          for (uint32_t i = t.At(index).first_child.load(std::memory_order_acquire); i != kNone;
+               i = t.At(i).next_sibling.load(std::memory_order_acquire)) {
+            output.subscope.resize(output.subscope.size() + 1);
+            recursive_fill(i, output.us, output.subscope.back());
+            subscope_total += output.subscope.back().us;
+          }
+          output.subscope_total_ratio_of_parent =
+              output.us.count() ? (1.0 * subscope_total.count() / output.us.count()) : 1.0;
+          std::sort(output.subscope.begin(), output.subscope.end());
+        };
+        report.thread.resize(report.thread.size() + 1);
+        recursive_fill(0u, std::chrono::microseconds(0), report.thread.back());
+        std::ostringstream thread_id_as_string;
+        thread_id_as_string << "C++ thread with internal ID " << t.thread_id;
+        report.thread.back().scope = thread_id_as_string.str();
+      }
+      report.profiling_overhead = ToMicroseconds(static_cast<uint64_t>(ticks_per_entry_ * total_entries));
+      report.reporting_overhead = spent_in_reporting_;
+      return report;
+    }
+
+    const uint64_t start_ticks_;
+    const std::chrono::steady_clock::time_point start_time_;
+    double ticks_per_entry_ = 0.0;
+
+    std::atomic<uint32_t> scopes_count_{0u};
+    std::atomic<const char*> scope_names_[CURRENT_PROFILER_MAX_SCOPES] = {};
+
+    // Guards the list of threads, and the reporting. Never locked when recording the scopes.
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<PerThread>> threads_;
+    std::chrono::microseconds spent_in_reporting_ = std::chrono::microseconds(0);
   };
 
   class ScopedStateMaintainer {
    public:
-    explicit ScopedStateMaintainer(const char* scope) : scope_(scope) {
-      CURRENT_ASSERT(scope);
-      CURRENT_ASSERT(*scope);
-      current::Singleton<StateMaintainer>().EnterScope(scope_);
+    explicit ScopedStateMaintainer(uint32_t scope_id) : scope_id_(scope_id) {
+      current::Singleton<StateMaintainer>().EnterScope(scope_id_);
     }
-    ~ScopedStateMaintainer() { current::Singleton<StateMaintainer>().LeaveScope(scope_); }
+    ~ScopedStateMaintainer() { current::Singleton<StateMaintainer>().LeaveScope(scope_id_); }
 
    private:
     ScopedStateMaintainer() = delete;
-    const char* const scope_;
+    const uint32_t scope_id_;
   };
 
+  // Only accepts the string literals, as the names of the scopes are not copied.
+  template <size_t N>
+  static uint32_t RegisterScope(const char (&scope)[N]) {
+    return current::Singleton<StateMaintainer>().RegisterScope(scope);
+  }
+
   static void HTTPRoute(Request request) { current::Singleton<StateMaintainer>().Report(std::move(request)); }
 };
 
 // Preprocessor token pasting occurs before recursive macro expansion, hence three-stage magic.
 #define CURRENT_PROFILER_SCOPE_CONCATENATE_HELPER_IMPL(a, b) a##b
 #define PROFILER_SCOPE_CONCATENATE_HELPER(a, b) CURRENT_PROFILER_SCOPE_CONCATENATE_HELPER_IMPL(a, b)
-#define CURRENT_PROFILER_SCOPE(scope)                                                                     \
-  ::current::profiler::Profiler::ScopedStateMaintainer PROFILER_SCOPE_CONCATENATE_HELPER(profiler_scope_, \
-                                                                                         __LINE__)(scope)
+// The ID of the scope is assigned once per `CURRENT_PROFILER_SCOPE`, as the function-local static of its lambda
+// is initialized, and its name is captured then, never to change. Hence `scope` must be a string literal.
+// The macro expands into a single declaration, so it is safe as the body of an unbraced `if`, although the scope
+// profiled then ends right away.
+#define CURRENT_PROFILER_SCOPE(scope)                                                                          \
+  ::current::profiler::Profiler::ScopedStateMaintainer PROFILER_SCOPE_CONCATENATE_HELPER(profiler_scope_,      \
+                                                                                         __LINE__)([]() {      \
+    static const uint32_t scope_id = ::current::profiler::Profiler::RegisterScope(scope);                      \
+    return scope_id;                                                                                           \
+  }())
 
 #define CURRENT_PROFILER_HTTP_ROUTE(scope, port, route)                            \
   do {                                                                             \
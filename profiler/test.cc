@@ -0,0 +1,94 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Dmitry "Dima" Korolev <dmitry.korolev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#define CURRENT_PROFILER
+
+#include "profiler.h"
+
+#include "../blocks/http/api.h"
+#include "../bricks/strings/printf.h"
+
+#include "../3rdparty/gtest/gtest-main.h"
+
+namespace profiler_test {
+
+inline void Inner() { CURRENT_PROFILER_SCOPE("inner"); }
+
+inline void Outer(bool conditional) {
+  CURRENT_PROFILER_SCOPE("outer");
+  Inner();
+  Inner();
+  if (conditional) CURRENT_PROFILER_SCOPE("conditional");  // Must expand into a single statement.
+}
+
+inline const current::profiler::PerThreadReporting* FindScope(const current::profiler::PerThreadReporting& node,
+                                                               const std::string& scope) {
+  if (node.scope == scope) {
+    return &node;
+  }
+  for (const auto& subscope : node.subscope) {
+    if (const auto result = FindScope(subscope, scope)) {
+      return result;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace profiler_test
+
+TEST(Profiler, Scopes) {
+  using namespace profiler_test;
+  using namespace current::profiler;
+
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  HTTP(std::move(reserved_port));
+  HTTPRoutesScope scope;
+  CURRENT_PROFILER_HTTP_ROUTE(scope, port, "/profiler");
+
+  std::thread([]() {
+    Outer(false);
+    Outer(true);
+  }).join();
+
+  const auto report = ParseJSON<ProfilingReport>(HTTP(GET(current::strings::Printf("http://localhost:%d/profiler",
+                                                                                  port))).body);
+  const PerThreadReporting* outer = nullptr;
+  for (const auto& thread : report.thread) {
+    if ((outer = FindScope(thread, "outer"))) {
+      break;
+    }
+  }
+  ASSERT_TRUE(outer != nullptr);
+  EXPECT_EQ(2u, outer->entries);
+  const auto inner = FindScope(*outer, "inner");
+  ASSERT_TRUE(inner != nullptr);
+  EXPECT_EQ(4u, inner->entries);
+  const auto conditional = FindScope(*outer, "conditional");
+  ASSERT_TRUE(conditional != nullptr);
+  EXPECT_EQ(1u, conditional->entries);
+
+  EXPECT_EQ("The profiler has been reset.\n",
+            HTTP(GET(current::strings::Printf("http://localhost:%d/profiler?reset", port))).body);
+}
@@ -40,6 +40,11 @@ SOFTWARE.
 #include "../blocks/http/api.h"
 #include "../bricks/template/call_if.h"
 
+// The number of entries read per read-only transaction in the `?export&stream` mode.
+#ifndef CURRENT_STORAGE_STREAMED_EXPORT_BATCH_SIZE
+#define CURRENT_STORAGE_STREAMED_EXPORT_BATCH_SIZE 1000
+#endif  // CURRENT_STORAGE_STREAMED_EXPORT_BATCH_SIZE
+
 namespace current {
 namespace storage {
 namespace rest {
@@ -135,6 +140,13 @@ struct PerFieldRESTfulHandlerGenerator {
     using DELETEHandler = DataHandlerImpl<DELETE, top_level_operation_t, specific_field_t, entry_t, key_t>;
 
     const auto generic_data_handler = [&storage, restful_url_prefix, field_name](Request request) {
+      if (request.method == "GET" && request.url_path_args.empty() && !request.url.query.has("key") &&
+          request.url.query.has(kRESTfulExportURLQueryParameter) &&
+          request.url.query.has(kRESTfulExportStreamURLQueryParameter)) {
+        // The streamed `?export` runs its own transactions, and must not hold the publishing mutex while sending.
+        StreamFieldExport<key_t, entry_t>(storage, std::move(request));
+        return;
+      }
       // TODO(dkorolev): Pass `BorrowedWithCallback<Storage>` into the request handler.
       auto generic_input = RESTfulGenericInput<STORAGE>(storage, restful_url_prefix);
       std::lock_guard<std::mutex> lock(storage.UnderlyingStream()->Impl()->publishing_mutex);
@@ -298,6 +310,114 @@ struct PerFieldRESTfulHandlerGenerator {
         });
   }
 
+  // The `?export&stream` mode: the whole field as chunked JSON lines, one entry per line, `?export=detailed` included.
+  // Unlike the plain `?export`, the response is never built in memory as a whole. The entries are read in batches,
+  // each within its own read-only transaction, so that the writers are only blocked for the duration of a single batch.
+  // As the field may change between the batches, the export must resume from where it has left off by key:
+  // the ordered containers resume from the first key not less than the last exported one, while for the unordered
+  // containers, which may be rehashed in between, the keys to export are collected upfront, in one transaction,
+  // and then looked up batch by batch, skipping the ones erased meanwhile. Other containers can not be streamed.
+  template <typename KEY, typename ENTRY>
+  static void StreamFieldExport(STORAGE& storage, Request request) {
+#ifndef CURRENT_ALLOW_STORAGE_EXPORT_FROM_MASTER
+    if (storage.IsMasterStorage()) {
+      request(ErrorResponse(
+          generic::RESTError("NotFollowerMode", "Can only request full export from a Follower storage."),
+          HTTPResponseCode.Forbidden));
+      return;
+    }
+#endif  // CURRENT_ALLOW_STORAGE_EXPORT_FROM_MASTER
+    constexpr cursor::ResumeBy resume_by = cursor::ResumeByFor<specific_field_t>();
+    if (resume_by == cursor::ResumeBy::Index) {
+      request(ErrorResponse(generic::RESTError("StreamedExportNotSupported",
+                                               "The streamed export is only supported for dictionaries."),
+                            HTTPResponseCode.BadRequest));
+      return;
+    }
+    using detailed_export_helper_t = hypermedia::DetailedExportEntryHelper<KEY, ENTRY>;
+    using detailed_export_entry_t = hypermedia::HypermediaRESTDetailedExportEntry<detailed_export_helper_t>;
+    const bool detailed = (request.url.query[kRESTfulExportURLQueryParameter] == "detailed");
+    const uint32_t nshards = FromString<uint32_t>(request.url.query.get(kRESTfulExportNShardsURLQueryParameter, "0"));
+    const uint32_t shard = FromString<uint32_t>(request.url.query.get(kRESTfulExportShardURLQueryParameter, "0"));
+    const auto hasher = GenericHashFunction<KEY>();
+    const auto in_shard = [&](const auto& key) { return nshards <= 1u || (hasher(key) % nshards) == shard; };
+    const auto append_entry = [&](std::string& batch, const specific_field_t& field, const auto& cit) {
+      if (detailed) {
+        const auto last_modified = field.LastModified(cit.key());
+        CURRENT_ASSERT(Exists(last_modified));
+        batch += JSON<JSONFormat::Minimalistic>(
+            detailed_export_entry_t(Value(last_modified), detailed_export_helper_t(cit.key(), *cit)));
+      } else {
+        batch += JSON<JSONFormat::Minimalistic>(*cit);
+      }
+      batch += '\n';
+    };
+    auto response = request.SendChunkedResponse();
+    try {
+      if constexpr (resume_by == cursor::ResumeBy::LowerBound) {
+        std::string cursor;
+        bool done = false;
+        while (!done) {
+          std::string batch;
+          storage
+              .ReadOnlyTransaction([&](immutable_fields_t) {
+                const specific_field_t& field = storage(::current::storage::ImmutableFieldByIndex<INDEX>());
+                uint64_t index;
+                auto cit = ResumeFromCollectionCursor(field, cursor, index);
+                for (uint64_t i = 0u; i < CURRENT_STORAGE_STREAMED_EXPORT_BATCH_SIZE && cit != field.end();
+                     ++i, ++cit, ++index) {
+                  if (in_shard(cit.key())) {
+                    append_entry(batch, field, cit);
+                  }
+                }
+                if (cit != field.end()) {
+                  cursor = ComposeCollectionCursor(field, index, cit);
+                } else {
+                  done = true;
+                }
+              })
+              .Go();
+          if (!batch.empty()) {
+            response.Send(batch);
+          }
+        }
+      } else {
+        using field_key_t = current::decay_t<decltype(std::declval<const specific_field_t&>().begin().key())>;
+        std::vector<field_key_t> keys;
+        storage
+            .ReadOnlyTransaction([&](immutable_fields_t) {
+              const specific_field_t& field = storage(::current::storage::ImmutableFieldByIndex<INDEX>());
+              for (auto cit = field.begin(); cit != field.end(); ++cit) {
+                if (in_shard(cit.key())) {
+                  keys.push_back(cit.key());
+                }
+              }
+            })
+            .Go();
+        for (size_t begin = 0u; begin < keys.size(); begin += CURRENT_STORAGE_STREAMED_EXPORT_BATCH_SIZE) {
+          const size_t end = std::min(keys.size(), begin + CURRENT_STORAGE_STREAMED_EXPORT_BATCH_SIZE);
+          std::string batch;
+          storage
+              .ReadOnlyTransaction([&](immutable_fields_t) {
+                const specific_field_t& field = storage(::current::storage::ImmutableFieldByIndex<INDEX>());
+                for (size_t i = begin; i < end; ++i) {
+                  const auto cit = field.Find(keys[i]);
+                  if (cit != field.end()) {
+                    append_entry(batch, field, cit);
+                  }
+                }
+              })
+              .Go();
+          if (!batch.empty()) {
+            response.Send(batch);
+          }
+        }
+      }
+    } catch (const current::net::NetworkException&) {  // LCOV_EXCL_LINE
+      // The client has disconnected, nothing else to do.
+    }
+  }
+
   template <typename FIELD_TYPE, typename ENTRY_TYPE_WRAPPER, typename GENERIC_HANDLER>
   void RegisterAdditionalFieldDataHandlers(const std::string& field_name,
                                            semantics::rest::RESTWithSingleKey,
@@ -309,6 +429,69 @@ struct PerFieldRESTfulHandlerGenerator {
                                                            URLPathArgs::CountMask::Any,
                                                            generic_data_handler)));
     }
+    using entry_indexes_t = ::current::storage::sfinae::entry_indexes_t<typename ENTRY_TYPE_WRAPPER::entry_t>;
+    RegisterSecondaryIndexDataHandlers(field_name, entry_indexes_t());
+  }
+
+  template <typename... ENTRY_INDEXES>
+  void RegisterSecondaryIndexDataHandlers(const std::string& field_name, Indexes<ENTRY_INDEXES...>) {
+    const std::string dot = ".";
+    (registerer(storage_handlers_map_entry_t(field_name,
+                                             RESTfulRoute(kRESTfulDataURLComponent,
+                                                          dot + ENTRY_INDEXES::IndexName(),
+                                                          URLPathArgs::CountMask::One,
+                                                          GenerateSecondaryIndexHandler<ENTRY_INDEXES>()))),
+     ...);
+    static_cast<void>(field_name);
+    static_cast<void>(dot);
+  }
+
+  // Lookups by the secondary indexes of the entries, `GET /data/{field}.{index}/{value}`, respond the same way
+  // regardless of `REST_IMPL`, in the format of `?export`: with the entry for the unique indexes, and with the entries
+  // as JSON lines, possibly none, for the non-unique ones.
+  template <typename ENTRY_INDEX>
+  std::function<void(Request)> GenerateSecondaryIndexHandler() {
+    auto& storage = this->storage;  // For lambdas.
+    return [&storage](Request request) {
+      if (request.method != "GET") {
+        request(REST_IMPL::ErrorMethodNotAllowed(request.method, "Only GET method is allowed for index lookups."));
+        return;
+      }
+      std::lock_guard<std::mutex> lock(storage.UnderlyingStream()->Impl()->publishing_mutex);
+      const std::string url_index_key = request.url_path_args[0];
+      storage
+          .template ReadOnlyTransaction<current::locks::MutexLockStatus::AlreadyLocked>(
+              [&storage, url_index_key](immutable_fields_t) -> Response {
+                const specific_field_t& field = storage(::current::storage::ImmutableFieldByIndex<INDEX>());
+                const auto& index = field.template Index<ENTRY_INDEX>();
+                using index_key_t = typename current::decay_t<decltype(index)>::index_key_t;
+                return RespondWithSecondaryIndexLookup(index[FromString<index_key_t>(url_index_key)], url_index_key);
+              },
+              std::move(request))
+          .Detach();
+    };
+  }
+
+  template <typename ENTRY>
+  static Response RespondWithSecondaryIndexLookup(const ImmutableOptional<ENTRY>& result,
+                                                  const std::string& url_index_key) {
+    if (Exists(result)) {
+      return Value(result);
+    } else {
+      return ErrorResponse(
+          ResourceNotFoundError("The requested resource was not found.", {{"key", url_index_key}}),
+          HTTPResponseCode.NotFound);
+    }
+  }
+
+  template <typename ENTRIES>
+  static Response RespondWithSecondaryIndexLookup(const ENTRIES& entries, const std::string&) {
+    std::string result;
+    for (const auto& entry : entries) {
+      result += JSON<JSONFormat::Minimalistic>(entry);
+      result += '\n';
+    }
+    return result;
   }
 
   template <typename ENTRY_TYPE_WRAPPER, typename PARTIAL_KEY_OPERATION>
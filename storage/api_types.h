@@ -28,6 +28,8 @@ SOFTWARE.
 #include "storage.h"
 #include "container/sfinae.h"
 
+#include "../bricks/util/base64.h"
+
 #include "../blocks/http/api.h"
 
 namespace current {
@@ -44,6 +46,7 @@ const std::string kRESTfulCQSQueryURLComponent = "cqs/query";
 const std::string kRESTfulExportURLQueryParameter = "export";
 const std::string kRESTfulExportNShardsURLQueryParameter = "nshards";  // Number of shards.
 const std::string kRESTfulExportShardURLQueryParameter = "shard";      // Shard to export.
+const std::string kRESTfulExportStreamURLQueryParameter = "stream";    // Send as chunked JSON lines, in batches.
 
 enum class FieldExportFormat {
   Simple,   // Single entry object JSON or one JSON per line for collections, no timestamps.
@@ -580,6 +583,158 @@ std::string ComposeRESTfulKey(const T& iterator) {
   return ComposeRESTfulKeyImpl<PARTICULAR_FIELD, ENTRY, typename T::value_t>::DoIt(iterator);
 };
 
+// The opaque cursors to paginate through the collections with: the index of the next element, and, if the collection
+// can be resumed from a key, the key of that element. Resuming from a cursor then takes one lookup, instead of
+// skipping all the elements before the index.
+//
+// The ordered containers are resumed from the first element not less than the key, which remains correct regardless
+// of the changes made to the container in between. The unordered ones are resumed from the element with the key, and
+// the position is stable for as long as that element is there and the container has not been rehashed. Should the
+// element be gone, the iteration resumes from the index. Should the container have been rehashed, which the cursor
+// tells by its number of buckets, the cursor is invalid, as the iteration order has changed.
+struct InvalidCollectionCursorException : Exception {
+  using Exception::Exception;
+};
+
+namespace cursor {
+
+template <typename SPAN>
+constexpr auto HasLowerBound(int)
+    -> decltype(std::declval<const SPAN&>().LowerBound(std::declval<const SPAN&>().begin().key()), bool()) {
+  return true;
+}
+template <typename>
+constexpr bool HasLowerBound(...) {
+  return false;
+}
+
+template <typename SPAN>
+constexpr auto HasFind(int)
+    -> decltype(std::declval<const SPAN&>().Find(std::declval<const SPAN&>().begin().key()), bool()) {
+  return true;
+}
+template <typename>
+constexpr bool HasFind(...) {
+  return false;
+}
+
+enum class ResumeBy { Index, Find, LowerBound };
+
+template <typename SPAN>
+constexpr ResumeBy ResumeByFor() {
+  return HasLowerBound<SPAN>(0) ? ResumeBy::LowerBound : HasFind<SPAN>(0) ? ResumeBy::Find : ResumeBy::Index;
+}
+
+template <typename SPAN, ResumeBy = ResumeByFor<SPAN>()>
+struct Impl {
+  template <typename ITERATOR>
+  static std::string Payload(const SPAN&, const ITERATOR&) {
+    return "";
+  }
+  static decltype(std::declval<const SPAN&>().begin()) Resume(const SPAN& span, const std::string&, bool& resumed) {
+    resumed = false;
+    return span.begin();
+  }
+};
+
+template <typename SPAN>
+struct ImplWithKey {
+  using key_t = current::decay_t<decltype(std::declval<const SPAN&>().begin().key())>;
+};
+
+// The payload is the number of buckets, followed by the key.
+template <typename SPAN>
+struct Impl<SPAN, ResumeBy::Find> : ImplWithKey<SPAN> {
+  template <typename ITERATOR>
+  static std::string Payload(const SPAN& span, const ITERATOR& iterator) {
+    return current::ToString(span.BucketCount()) + ' ' +
+           JSON(static_cast<const typename ImplWithKey<SPAN>::key_t&>(iterator.key()));
+  }
+  static decltype(std::declval<const SPAN&>().begin()) Resume(const SPAN& span,
+                                                              const std::string& payload,
+                                                              bool& resumed) {
+    const size_t space = payload.find(' ');
+    if (space == 0u || space == std::string::npos || payload.find_first_not_of("0123456789") != space) {
+      CURRENT_THROW(InvalidCollectionCursorException("Malformed cursor."));
+    }
+    if (current::FromString<size_t>(payload.substr(0u, space)) != span.BucketCount()) {
+      CURRENT_THROW(InvalidCollectionCursorException("The collection has been rehashed since the cursor was issued."));
+    }
+    auto iterator = span.Find(ParseJSON<typename ImplWithKey<SPAN>::key_t>(payload.substr(space + 1u)));
+    resumed = (iterator != span.end());
+    return iterator;
+  }
+};
+
+template <typename SPAN>
+struct Impl<SPAN, ResumeBy::LowerBound> : ImplWithKey<SPAN> {
+  template <typename ITERATOR>
+  static std::string Payload(const SPAN&, const ITERATOR& iterator) {
+    return JSON(static_cast<const typename ImplWithKey<SPAN>::key_t&>(iterator.key()));
+  }
+  static decltype(std::declval<const SPAN&>().begin()) Resume(const SPAN& span,
+                                                              const std::string& payload,
+                                                              bool& resumed) {
+    resumed = true;
+    return span.LowerBound(ParseJSON<typename ImplWithKey<SPAN>::key_t>(payload));
+  }
+};
+
+template <typename SPAN>
+decltype(std::declval<const SPAN&>().begin()) SkipElements(const SPAN& span, uint64_t count) {
+  auto iterator = span.begin();
+  for (uint64_t i = 0u; i < count && iterator != span.end(); ++i) {
+    ++iterator;
+  }
+  return iterator;
+}
+
+}  // namespace cursor
+
+// Composes the cursor pointing to `iterator`, which is the element number `index` of `span`.
+template <typename SPAN, typename ITERATOR>
+std::string ComposeCollectionCursor(const SPAN& span, uint64_t index, const ITERATOR& iterator) {
+  std::string cursor = Base64URLEncode(current::ToString(index) + ' ' + cursor::Impl<SPAN>::Payload(span, iterator));
+  while (!cursor.empty() && cursor.back() == '=') {
+    cursor.pop_back();
+  }
+  return cursor;
+}
+
+// Returns the iterator to continue iterating over `span` from, and sets `index` to the index of its element.
+// The empty cursor stands for the beginning of the collection.
+template <typename SPAN>
+decltype(std::declval<const SPAN&>().begin()) ResumeFromCollectionCursor(const SPAN& span,
+                                                                         const std::string& cursor,
+                                                                         uint64_t& index) {
+  index = 0u;
+  if (cursor.empty()) {
+    return span.begin();
+  }
+  for (const char c : cursor) {
+    if (!(std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_')) {
+      CURRENT_THROW(InvalidCollectionCursorException("Invalid character in the cursor."));
+    }
+  }
+  const std::string decoded = Base64URLDecode(cursor);
+  const size_t space = decoded.find(' ');
+  if (space == 0u || space == std::string::npos || decoded.find_first_not_of("0123456789") != space) {
+    CURRENT_THROW(InvalidCollectionCursorException("Malformed cursor."));
+  }
+  index = current::FromString<uint64_t>(decoded.substr(0u, space));
+  try {
+    bool resumed;
+    auto iterator = cursor::Impl<SPAN>::Resume(span, decoded.substr(space + 1u), resumed);
+    if (resumed) {
+      return iterator;
+    }
+  } catch (const TypeSystemParseJSONException&) {
+    CURRENT_THROW(InvalidCollectionCursorException("Malformed cursor key."));
+  }
+  // Can not be resumed from the key, skip the elements before the index.
+  return cursor::SkipElements(span, index);
+}
+
 template <typename, typename>
 struct GenericMatrixIteratorImplSelector;
 
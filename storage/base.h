@@ -248,6 +248,17 @@ struct FieldsBase : BASE {
   }
 };
 
+// Where and how often to save the snapshots of the storage, so that its restart loads the latest snapshot
+// and only replays the tail of the stream after it, instead of the whole stream.
+struct StorageSnapshotParams {
+  std::string file_name;              // Empty for no snapshots.
+  uint64_t every_n_transactions = 0;  // Zero to only save the snapshots via `SaveSnapshot()`.
+
+  StorageSnapshotParams() = default;
+  explicit StorageSnapshotParams(const std::string& file_name, uint64_t every_n_transactions = 0)
+      : file_name(file_name), every_n_transactions(every_n_transactions) {}
+};
+
 // Default custom persister parameter, to enable binding Storage to a custom Stream.
 namespace persister {
 struct NoCustomPersisterParam {};
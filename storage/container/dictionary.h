@@ -27,11 +27,13 @@ SOFTWARE.
 #define CURRENT_STORAGE_CONTAINER_DICTIONARY_H
 
 #include "common.h"
+#include "indexes.h"
 #include "sfinae.h"
 
 #include "../base.h"
 
 #include "../../typesystem/optional.h"
+#include "../../bricks/util/iterator.h"  // For `sfinae::is_unordered_map`.
 
 namespace current {
 namespace storage {
@@ -50,6 +52,7 @@ class GenericDictionary {
   using entry_t = T;
   using key_t = sfinae::entry_key_t<T>;
   using map_t = MAP<key_t, T>;
+  using indexes_t = SecondaryIndexes<T, MAP, sfinae::entry_indexes_t<T>>;
   using semantics_t = storage::semantics::Dictionary;
 
   GenericDictionary(const std::string& field_name, MutationJournal& journal)
@@ -83,6 +86,7 @@ class GenericDictionary {
     const auto now = current::time::Now();
     const auto key = sfinae::GetKey(object);
     const auto map_iterator = map_.find(key);
+    ThrowIfViolatesUniqueIndexes(map_iterator != map_.end() ? &map_iterator->second : nullptr, object);
     const auto lm_iterator = last_modified_.find(key);
     if (map_iterator != map_.end()) {
       const T& previous_object = map_iterator->second;
@@ -90,24 +94,24 @@ class GenericDictionary {
       const auto previous_timestamp = lm_iterator->second;
       journal_.LogMutation(UPDATE_EVENT(now, object), [this, key, previous_object, previous_timestamp]() {
         last_modified_[key] = previous_timestamp;
-        map_[key] = previous_object;
+        SetEntry(key, previous_object);
       });
     } else {
       if (lm_iterator != last_modified_.end()) {
         const auto previous_timestamp = lm_iterator->second;
         journal_.LogMutation(UPDATE_EVENT(now, object), [this, key, previous_timestamp]() {
           last_modified_[key] = previous_timestamp;
-          map_.erase(key);
+          EraseEntry(key);
         });
       } else {
         journal_.LogMutation(UPDATE_EVENT(now, object), [this, key]() {
           last_modified_.erase(key);
-          map_.erase(key);
+          EraseEntry(key);
         });
       }
     }
     last_modified_[key] = now;
-    map_[key] = object;
+    SetEntry(key, object);
   }
 
   void Erase(sfinae::CF<key_t> key) {
@@ -120,9 +124,10 @@ class GenericDictionary {
       const auto previous_timestamp = lm_iterator->second;
       journal_.LogMutation(DELETE_EVENT(now, previous_object), [this, key, previous_object, previous_timestamp]() {
         last_modified_[key] = previous_timestamp;
-        map_[key] = previous_object;
+        SetEntry(key, previous_object);
       });
       last_modified_[key] = now;
+      indexes_.Erase(map_iterator->second);
       map_.erase(map_iterator);
     }
   }
@@ -131,23 +136,30 @@ class GenericDictionary {
   // NOTE(dkorolev): The `patch_object` parameter should be passed by value,
   // as otherwise it won't be valid during the possible rollback.
   template <typename E = entry_t>
-  std::enable_if_t<HasPatch<E>(), bool>::type Patch(sfinae::CF<key_t> key,
-                                                    const typename E::patch_object_t patch_object) {
+  std::enable_if_t<HasPatch<E>(), bool> Patch(sfinae::CF<key_t> key,
+                                              const typename E::patch_object_t patch_object) {
     static_assert(std::is_same_v<E, entry_t>, "");
     const auto now = current::time::Now();
     const auto map_iterator = map_.find(key);
     if (map_iterator != map_.end()) {
       const T& previous_object = map_iterator->second;
+      if (!indexes_t::empty) {
+        T patched_object = previous_object;
+        patched_object.PatchWith(patch_object);
+        ThrowIfViolatesUniqueIndexes(&previous_object, patched_object);
+      }
       const auto lm_iterator = last_modified_.find(key);
       CURRENT_ASSERT(lm_iterator != last_modified_.end());
       const auto previous_timestamp = lm_iterator->second;
       journal_.LogMutation(PATCH_EVENT_OR_VOID(now, key, patch_object),
                            [this, key, previous_object, previous_timestamp]() {
                              last_modified_[key] = previous_timestamp;
-                             map_[key] = previous_object;
+                             SetEntry(key, previous_object);
                            });
       last_modified_[key] = now;
+      indexes_.Erase(map_iterator->second);
       map_iterator->second.PatchWith(patch_object);
+      indexes_.Insert(map_iterator->second);
       return true;
     } else {
       return false;
@@ -168,11 +180,30 @@ class GenericDictionary {
   void operator()(const UPDATE_EVENT& e) {
     const auto key = sfinae::GetKey(e.data);
     last_modified_[key] = e.us;
-    map_[key] = e.data;
+    SetEntry(key, e.data);
   }
   void operator()(const DELETE_EVENT& e) {
     last_modified_[e.key] = e.us;
-    map_.erase(e.key);
+    EraseEntry(e.key);
+  }
+
+  // Passes to `f` the mutations which recreate the contents of this container, including the last modified
+  // timestamps of the erased entries, when applied to an empty one. Used to save the snapshots of the storage.
+  template <typename F>
+  void ExportAsMutations(F&& f) const {
+    for (const auto& element : last_modified_) {
+      if (map_.find(element.first) == map_.end()) {
+        DELETE_EVENT e;
+        e.us = element.second;
+        e.key = element.first;
+        f(std::move(e));
+      }
+    }
+    for (const auto& element : map_) {
+      const auto lm_cit = last_modified_.find(element.first);
+      CURRENT_ASSERT(lm_cit != last_modified_.end());
+      f(UPDATE_EVENT(lm_cit->second, element.second));
+    }
   }
 #ifdef CURRENT_STORAGE_PATCH_SUPPORT
   struct DummyStructForNonExistentPatch {};  // Essential, as can't form a reference to `void` even if disabled.
@@ -181,7 +212,9 @@ class GenericDictionary {
     auto it = map_.find(e.key);
     if (it != map_.end()) {
       last_modified_[e.key] = e.us;
+      indexes_.Erase(it->second);
       it->second.PatchWith(e.patch);
+      indexes_.Insert(it->second);
     }
   }
 #endif  // CURRENT_STORAGE_PATCH_SUPPORT
@@ -204,9 +237,55 @@ class GenericDictionary {
   Iterator begin() const { return Iterator(map_.cbegin()); }
   Iterator end() const { return Iterator(map_.cend()); }
 
+  // To resume iterating from a certain key, as the cursor-based pagination of the REST API does.
+  Iterator Find(sfinae::CF<key_t> key) const { return Iterator(map_.find(key)); }
+  template <typename U = map_t, class = std::enable_if_t<!current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+  Iterator LowerBound(sfinae::CF<key_t> key) const {
+    return Iterator(map_.lower_bound(key));
+  }
+  // The iteration order of an unordered container only holds for as long as its number of buckets does.
+  template <typename U = map_t, class = std::enable_if_t<current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+  size_t BucketCount() const {
+    return map_.bucket_count();
+  }
+
+  // The secondary index `INDEX`, one of those listed in `T::storage_indexes_t`.
+  template <typename INDEX>
+  const typename indexes_t::template index_t<INDEX>& Index() const {
+    return indexes_.template Get<INDEX>();
+  }
+
  private:
+  // The entries are only placed and removed via these two, to keep the secondary indexes in sync.
+  void SetEntry(sfinae::CF<key_t> key, const T& object) {
+    auto iterator = map_.find(key);
+    if (iterator != map_.end()) {
+      indexes_.Erase(iterator->second);
+      iterator->second = object;
+    } else {
+      iterator = map_.emplace(key, object).first;
+    }
+    indexes_.Insert(iterator->second);
+  }
+
+  void EraseEntry(sfinae::CF<key_t> key) {
+    const auto iterator = map_.find(key);
+    if (iterator != map_.end()) {
+      indexes_.Erase(iterator->second);
+      map_.erase(iterator);
+    }
+  }
+
+  void ThrowIfViolatesUniqueIndexes(const T* current, const T& object) const {
+    const char* index_name = indexes_.ViolatedUniqueIndex(current, object);
+    if (index_name) {
+      CURRENT_THROW(StorageUniqueIndexViolationException(field_name_, index_name));
+    }
+  }
+
   const std::string field_name_;
   map_t map_;
+  indexes_t indexes_;
   std::unordered_map<key_t, std::chrono::microseconds, GenericHashFunction<key_t>> last_modified_;
   MutationJournal& journal_;
 };
@@ -0,0 +1,327 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Maxim Zhurovich <zhurovich@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+// Secondary indexes on the fields of dictionary entries, declared within the entry type itself:
+//
+//   CURRENT_STRUCT(User) {
+//     CURRENT_FIELD(key, std::string);
+//     CURRENT_FIELD(email, std::string);
+//     CURRENT_FIELD(city, std::string);
+//     CURRENT_STORAGE_INDEX(by_email, email, UnorderedUnique);
+//     CURRENT_STORAGE_INDEX(by_city, city, OrderedNonUnique);
+//     using storage_indexes_t = ::current::storage::Indexes<by_email, by_city>;
+//   };
+//
+// The indexes are kept in sync by `Add()`, `Erase()`, `Patch()`, by the rollbacks, and by replaying the persisted
+// mutations. An `Add()` or `Patch()` that would break a unique index throws `StorageUniqueIndexViolationException`,
+// leaving the dictionary intact, so that the transaction is rolled back unless the exception is handled.
+//
+// Within a transaction, `fields.users.Index<User::by_email>()["me@example.com"]` is an `ImmutableOptional<User>`,
+// and `fields.users.Index<User::by_city>()["Tallinn"]` is the range of users, with `Size()`, `begin()` and `end()`.
+// The indexes can be iterated over as a whole, and the ordered ones also support `LowerBound()` and `UpperBound()`.
+
+#ifndef CURRENT_STORAGE_CONTAINER_INDEXES_H
+#define CURRENT_STORAGE_CONTAINER_INDEXES_H
+
+#include <tuple>
+
+#include "common.h"
+#include "sfinae.h"
+
+#include "../exceptions.h"
+
+#include "../../typesystem/optional.h"
+#include "../../bricks/util/iterator.h"  // For `sfinae::is_unordered_map`.
+
+#define CURRENT_STORAGE_INDEX(index_name, field, index_type)  \
+  struct index_name : ::current::storage::index::index_type { \
+    static const char* IndexName() { return #index_name; }    \
+    template <typename ENTRY>                                 \
+    static const auto& ExtractIndexKey(const ENTRY& entry) {  \
+      return entry.field;                                     \
+    }                                                         \
+  }
+
+namespace current {
+namespace storage {
+
+template <typename... INDEXES>
+struct Indexes {};
+
+struct StorageUniqueIndexViolationException : StorageException {
+  StorageUniqueIndexViolationException(const std::string& field_name, const std::string& index_name)
+      : StorageException("Unique index `" + index_name + "` of `" + field_name + "` violated.") {}
+};
+
+namespace index {
+
+template <template <typename...> class MAP, bool UNIQUE>
+struct IndexType {
+  template <typename INDEX_KEY, typename VALUE>
+  using map_t = MAP<INDEX_KEY, VALUE>;
+  constexpr static bool unique = UNIQUE;
+};
+
+using OrderedUnique = IndexType<container::Ordered, true>;
+using UnorderedUnique = IndexType<container::Unordered, true>;
+using OrderedNonUnique = IndexType<container::Ordered, false>;
+using UnorderedNonUnique = IndexType<container::Unordered, false>;
+
+}  // namespace index
+
+namespace sfinae {
+
+template <typename ENTRY>
+constexpr bool HasIndexes(char) {
+  return false;
+}
+
+template <typename ENTRY>
+constexpr auto HasIndexes(int) -> decltype(std::declval<typename ENTRY::storage_indexes_t>(), bool()) {
+  return true;
+}
+
+template <typename ENTRY, bool HAS_INDEXES>
+struct impl_entry_indexes_t {
+  using type = Indexes<>;
+};
+
+template <typename ENTRY>
+struct impl_entry_indexes_t<ENTRY, true> {
+  using type = typename ENTRY::storage_indexes_t;
+};
+
+template <typename ENTRY>
+using entry_indexes_t = typename impl_entry_indexes_t<ENTRY, HasIndexes<ENTRY>(0)>::type;
+
+}  // namespace sfinae
+
+namespace container {
+
+// The index points to the entries of the dictionary, which stay in place until erased, as both `std::map<>`
+// and `std::unordered_map<>` never move their elements. `MAP` is the map type of the dictionary itself.
+template <typename ENTRY, typename INDEX, template <typename...> class MAP, bool UNIQUE = INDEX::unique>
+class SecondaryIndex;
+
+// The unique index: index key -> entry.
+template <typename ENTRY, typename INDEX, template <typename...> class MAP>
+class SecondaryIndex<ENTRY, INDEX, MAP, true> {
+ public:
+  using entry_t = ENTRY;
+  using index_key_t = current::decay_t<decltype(INDEX::ExtractIndexKey(std::declval<const ENTRY&>()))>;
+  using map_t = typename INDEX::template map_t<index_key_t, const ENTRY*>;
+
+  bool Empty() const { return map_.empty(); }
+  size_t Size() const { return map_.size(); }
+  bool Has(sfinae::CF<index_key_t> index_key) const { return map_.find(index_key) != map_.end(); }
+
+  ImmutableOptional<ENTRY> operator[](sfinae::CF<index_key_t> index_key) const {
+    const auto iterator = map_.find(index_key);
+    if (iterator != map_.end()) {
+      return ImmutableOptional<ENTRY>(FromBarePointer(), iterator->second);
+    } else {
+      return nullptr;
+    }
+  }
+
+  struct Iterator final {
+    using iterator_t = typename map_t::const_iterator;
+    using value_t = sfinae::CF<ENTRY>;
+    iterator_t iterator;
+    explicit Iterator(iterator_t iterator) : iterator(std::move(iterator)) {}
+    void operator++() { ++iterator; }
+    bool operator==(const Iterator& rhs) const { return iterator == rhs.iterator; }
+    bool operator!=(const Iterator& rhs) const { return !operator==(rhs); }
+    copy_free<index_key_t> key() const { return iterator->first; }
+    const ENTRY& operator*() const { return *iterator->second; }
+    const ENTRY* operator->() const { return iterator->second; }
+  };
+
+  Iterator begin() const { return Iterator(map_.cbegin()); }
+  Iterator end() const { return Iterator(map_.cend()); }
+
+  template <typename U = map_t, class = std::enable_if_t<!current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+  Iterator LowerBound(sfinae::CF<index_key_t> index_key) const {
+    return Iterator(map_.lower_bound(index_key));
+  }
+  template <typename U = map_t, class = std::enable_if_t<!current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+  Iterator UpperBound(sfinae::CF<index_key_t> index_key) const {
+    return Iterator(map_.upper_bound(index_key));
+  }
+
+  // Whether `entry` can not be placed instead of `current`, the entry under the same primary key, if any.
+  bool Conflicts(const ENTRY* current, const ENTRY& entry) const {
+    const auto iterator = map_.find(INDEX::ExtractIndexKey(entry));
+    return iterator != map_.end() && iterator->second != current;
+  }
+  void Insert(const ENTRY& entry) { map_[INDEX::ExtractIndexKey(entry)] = &entry; }
+  void Erase(const ENTRY& entry) {
+    const auto iterator = map_.find(INDEX::ExtractIndexKey(entry));
+    if (iterator != map_.end() && iterator->second == &entry) {
+      map_.erase(iterator);
+    }
+  }
+
+ private:
+  map_t map_;
+};
+
+// The non-unique index: index key -> primary key -> entry, with the entries under the same index key
+// iterated over in the order of the dictionary itself.
+template <typename ENTRY, typename INDEX, template <typename...> class MAP>
+class SecondaryIndex<ENTRY, INDEX, MAP, false> {
+ public:
+  using entry_t = ENTRY;
+  using key_t = sfinae::entry_key_t<ENTRY>;
+  using index_key_t = current::decay_t<decltype(INDEX::ExtractIndexKey(std::declval<const ENTRY&>()))>;
+  using entries_t = MAP<key_t, const ENTRY*>;
+  using map_t = typename INDEX::template map_t<index_key_t, entries_t>;
+
+  // The entries under a single index key.
+  class Entries final {
+   public:
+    explicit Entries(const entries_t& entries) : entries_(entries) {}
+
+    bool Empty() const { return entries_.empty(); }
+    size_t Size() const { return entries_.size(); }
+
+    struct Iterator final {
+      using iterator_t = typename entries_t::const_iterator;
+      using value_t = sfinae::CF<ENTRY>;
+      iterator_t iterator;
+      explicit Iterator(iterator_t iterator) : iterator(std::move(iterator)) {}
+      void operator++() { ++iterator; }
+      bool operator==(const Iterator& rhs) const { return iterator == rhs.iterator; }
+      bool operator!=(const Iterator& rhs) const { return !operator==(rhs); }
+      copy_free<key_t> key() const { return iterator->first; }
+      const ENTRY& operator*() const { return *iterator->second; }
+      const ENTRY* operator->() const { return iterator->second; }
+    };
+
+    Iterator begin() const { return Iterator(entries_.cbegin()); }
+    Iterator end() const { return Iterator(entries_.cend()); }
+
+   private:
+    const entries_t& entries_;
+  };
+
+  bool Empty() const { return map_.empty(); }
+  size_t Size() const { return map_.size(); }  // The number of distinct index keys.
+  bool Has(sfinae::CF<index_key_t> index_key) const { return map_.find(index_key) != map_.end(); }
+
+  Entries operator[](sfinae::CF<index_key_t> index_key) const {
+    const auto iterator = map_.find(index_key);
+    if (iterator != map_.end()) {
+      return Entries(iterator->second);
+    } else {
+      static const entries_t empty;
+      return Entries(empty);
+    }
+  }
+
+  struct Iterator final {
+    using iterator_t = typename map_t::const_iterator;
+    iterator_t iterator;
+    explicit Iterator(iterator_t iterator) : iterator(std::move(iterator)) {}
+    void operator++() { ++iterator; }
+    bool operator==(const Iterator& rhs) const { return iterator == rhs.iterator; }
+    bool operator!=(const Iterator& rhs) const { return !operator==(rhs); }
+    copy_free<index_key_t> key() const { return iterator->first; }
+    Entries operator*() const { return Entries(iterator->second); }
+  };
+
+  Iterator begin() const { return Iterator(map_.cbegin()); }
+  Iterator end() const { return Iterator(map_.cend()); }
+
+  template <typename U = map_t, class = std::enable_if_t<!current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+  Iterator LowerBound(sfinae::CF<index_key_t> index_key) const {
+    return Iterator(map_.lower_bound(index_key));
+  }
+  template <typename U = map_t, class = std::enable_if_t<!current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+  Iterator UpperBound(sfinae::CF<index_key_t> index_key) const {
+    return Iterator(map_.upper_bound(index_key));
+  }
+
+  bool Conflicts(const ENTRY*, const ENTRY&) const { return false; }
+  void Insert(const ENTRY& entry) { map_[INDEX::ExtractIndexKey(entry)][sfinae::GetKey(entry)] = &entry; }
+  void Erase(const ENTRY& entry) {
+    const auto iterator = map_.find(INDEX::ExtractIndexKey(entry));
+    if (iterator != map_.end()) {
+      iterator->second.erase(sfinae::GetKey(entry));
+      if (iterator->second.empty()) {
+        map_.erase(iterator);
+      }
+    }
+  }
+
+ private:
+  map_t map_;
+};
+
+// All the secondary indexes of a dictionary. Empty, and thus free, unless the entry type declares any.
+template <typename ENTRY, template <typename...> class MAP, typename INDEXES>
+class SecondaryIndexes;
+
+template <typename ENTRY, template <typename...> class MAP, typename... INDEXES>
+class SecondaryIndexes<ENTRY, MAP, Indexes<INDEXES...>> {
+ public:
+  constexpr static bool empty = (sizeof...(INDEXES) == 0u);
+
+  template <typename INDEX>
+  using index_t = SecondaryIndex<ENTRY, INDEX, MAP>;
+
+  template <typename INDEX>
+  const index_t<INDEX>& Get() const {
+    return std::get<index_t<INDEX>>(indexes_);
+  }
+
+  // Returns the name of the unique index `entry` would violate if placed instead of `current`, or `nullptr`.
+  const char* ViolatedUniqueIndex(const ENTRY* current, const ENTRY& entry) const {
+    const char* result = nullptr;
+    static_cast<void>(
+        ((std::get<index_t<INDEXES>>(indexes_).Conflicts(current, entry) && (result = INDEXES::IndexName())) || ...));
+    static_cast<void>(current);
+    static_cast<void>(entry);
+    return result;
+  }
+
+  void Insert(const ENTRY& entry) {
+    (std::get<index_t<INDEXES>>(indexes_).Insert(entry), ...);
+    static_cast<void>(entry);
+  }
+
+  void Erase(const ENTRY& entry) {
+    (std::get<index_t<INDEXES>>(indexes_).Erase(entry), ...);
+    static_cast<void>(entry);
+  }
+
+ private:
+  std::tuple<index_t<INDEXES>...> indexes_;
+};
+
+}  // namespace container
+}  // namespace storage
+}  // namespace current
+
+#endif  // CURRENT_STORAGE_CONTAINER_INDEXES_H
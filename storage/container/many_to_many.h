@@ -151,6 +151,25 @@ class GenericManyToMany {
   }
   void operator()(const DELETE_EVENT& e) { DoEraseWithLastModified(e.us, std::make_pair(e.key.first, e.key.second)); }
 
+  // Passes to `f` the mutations which recreate the contents of this container, including the last modified
+  // timestamps of the erased entries, when applied to an empty one. Used to save the snapshots of the storage.
+  template <typename F>
+  void ExportAsMutations(F&& f) const {
+    for (const auto& element : last_modified_) {
+      if (map_.find(element.first) == map_.end()) {
+        DELETE_EVENT e;
+        e.us = element.second;
+        e.key = element.first;
+        f(std::move(e));
+      }
+    }
+    for (const auto& element : map_) {
+      const auto lm_cit = last_modified_.find(element.first);
+      CURRENT_ASSERT(lm_cit != last_modified_.end());
+      f(UPDATE_EVENT(lm_cit->second, *element.second));
+    }
+  }
+
   template <typename OUTER_MAP>
   struct OuterAccessor final {
     using OUTER_KEY = typename OUTER_MAP::key_type;
@@ -165,6 +184,7 @@ class GenericManyToMany {
       bool operator==(const OuterIterator& rhs) const { return iterator == rhs.iterator; }
       bool operator!=(const OuterIterator& rhs) const { return !operator==(rhs); }
       sfinae::CF<OUTER_KEY> OuterKeyForPartialHypermediaCollectionView() const { return iterator->first; }
+      sfinae::CF<OUTER_KEY> key() const { return iterator->first; }
       size_t TotalElementsForHypermediaCollectionView() const { return iterator->second.size(); }
       using value_t = GenericMapAccessor<INNER_MAP>;
       void has_range_element_t() {}
@@ -191,6 +211,18 @@ class GenericManyToMany {
 
     OuterIterator begin() const { return OuterIterator(map_.cbegin()); }
     OuterIterator end() const { return OuterIterator(map_.cend()); }
+
+    OuterIterator Find(const OUTER_KEY& key) const { return OuterIterator(map_.find(key)); }
+    template <typename U = OUTER_MAP,
+              class = std::enable_if_t<!current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+    OuterIterator LowerBound(const OUTER_KEY& key) const {
+      return OuterIterator(map_.lower_bound(key));
+    }
+    template <typename U = OUTER_MAP,
+              class = std::enable_if_t<current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+    size_t BucketCount() const {
+      return map_.bucket_count();
+    }
   };
 
   using rows_outer_accessor_t = OuterAccessor<forward_map_t>;
@@ -216,6 +248,8 @@ class GenericManyToMany {
   using iterator_t = GenericMapIterator<whole_matrix_map_t>;
   iterator_t begin() const { return iterator_t(map_.begin()); }
   iterator_t end() const { return iterator_t(map_.end()); }
+  iterator_t Find(const key_t& key) const { return iterator_t(map_.find(key)); }
+  size_t BucketCount() const { return map_.bucket_count(); }
 
  private:
   void DoUpdateWithLastModified(std::chrono::microseconds us, const key_t& key, const T& object) {
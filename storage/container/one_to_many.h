@@ -197,6 +197,25 @@ class GenericOneToMany {
   }
   void operator()(const DELETE_EVENT& e) { DoEraseWithLastModified(e.us, std::make_pair(e.key.first, e.key.second)); }
 
+  // Passes to `f` the mutations which recreate the contents of this container, including the last modified
+  // timestamps of the erased entries, when applied to an empty one. Used to save the snapshots of the storage.
+  template <typename F>
+  void ExportAsMutations(F&& f) const {
+    for (const auto& element : last_modified_) {
+      if (map_.find(element.first) == map_.end()) {
+        DELETE_EVENT e;
+        e.us = element.second;
+        e.key = element.first;
+        f(std::move(e));
+      }
+    }
+    for (const auto& element : map_) {
+      const auto lm_cit = last_modified_.find(element.first);
+      CURRENT_ASSERT(lm_cit != last_modified_.end());
+      f(UPDATE_EVENT(lm_cit->second, *element.second));
+    }
+  }
+
   template <typename ROWS_MAP>
   struct RowsAccessor final {
     using key_t = typename ROWS_MAP::key_type;
@@ -211,6 +230,7 @@ class GenericOneToMany {
       bool operator==(const RowsIterator& rhs) const { return iterator == rhs.iterator; }
       bool operator!=(const RowsIterator& rhs) const { return !operator==(rhs); }
       sfinae::CF<key_t> OuterKeyForPartialHypermediaCollectionView() const { return iterator->first; }
+      sfinae::CF<key_t> key() const { return iterator->first; }
       size_t TotalElementsForHypermediaCollectionView() const { return iterator->second.size(); }
       using value_t = GenericMapAccessor<elements_map_t>;
       void has_range_element_t() {}
@@ -238,6 +258,18 @@ class GenericOneToMany {
 
     RowsIterator begin() const { return RowsIterator(map_.cbegin()); }
     RowsIterator end() const { return RowsIterator(map_.cend()); }
+
+    RowsIterator Find(const key_t& key) const { return RowsIterator(map_.find(key)); }
+    template <typename U = ROWS_MAP,
+              class = std::enable_if_t<!current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+    RowsIterator LowerBound(const key_t& key) const {
+      return RowsIterator(map_.lower_bound(key));
+    }
+    template <typename U = ROWS_MAP,
+              class = std::enable_if_t<current::stl_wrappers::sfinae::is_unordered_map<U>::value>>
+    size_t BucketCount() const {
+      return map_.bucket_count();
+    }
   };
 
   using rows_outer_accessor_t = RowsAccessor<forward_map_t>;
@@ -257,6 +289,8 @@ class GenericOneToMany {
   using iterator_t = GenericMapIterator<elements_map_t>;
   iterator_t begin() const { return iterator_t(map_.begin()); }
   iterator_t end() const { return iterator_t(map_.end()); }
+  iterator_t Find(const key_t& key) const { return iterator_t(map_.find(key)); }
+  size_t BucketCount() const { return map_.bucket_count(); }
 
  private:
   void DoUpdateWithLastModified(std::chrono::microseconds us, const key_t& key, const T& object) {
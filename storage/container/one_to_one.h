@@ -246,6 +246,25 @@ class GenericOneToOne {
   }
   void operator()(const DELETE_EVENT& e) { DoEraseWithLastModified(e.us, std::make_pair(e.key.first, e.key.second)); }
 
+  // Passes to `f` the mutations which recreate the contents of this container, including the last modified
+  // timestamps of the erased entries, when applied to an empty one. Used to save the snapshots of the storage.
+  template <typename F>
+  void ExportAsMutations(F&& f) const {
+    for (const auto& element : last_modified_) {
+      if (map_.find(element.first) == map_.end()) {
+        DELETE_EVENT e;
+        e.us = element.second;
+        e.key = element.first;
+        f(std::move(e));
+      }
+    }
+    for (const auto& element : map_) {
+      const auto lm_cit = last_modified_.find(element.first);
+      CURRENT_ASSERT(lm_cit != last_modified_.end());
+      f(UPDATE_EVENT(lm_cit->second, *element.second));
+    }
+  }
+
   using rows_outer_accessor_t = GenericMapAccessor<forward_map_t>;
   rows_outer_accessor_t Rows() const { return GenericMapAccessor<forward_map_t>(forward_); }
 
@@ -257,6 +276,8 @@ class GenericOneToOne {
   using iterator_t = GenericMapIterator<elements_map_t>;
   iterator_t begin() const { return iterator_t(map_.begin()); }
   iterator_t end() const { return iterator_t(map_.end()); }
+  iterator_t Find(const key_t& key) const { return iterator_t(map_.find(key)); }
+  size_t BucketCount() const { return map_.bucket_count(); }
 
  private:
   void DoUpdateWithLastModified(std::chrono::microseconds us, const key_t& key, const T& object) {
@@ -72,6 +72,10 @@ struct ReadWriteTransactionInFollowerStorageException : StorageException {
   using StorageException::StorageException;
 };
 
+struct StorageSnapshotException : StorageException {
+  using StorageException::StorageException;
+};
+
 struct StorageInGracefulShutdownException : InGracefulShutdownException {
   using InGracefulShutdownException::InGracefulShutdownException;
 };
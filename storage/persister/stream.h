@@ -26,18 +26,33 @@ SOFTWARE.
 #ifndef CURRENT_STORAGE_PERSISTER_STREAM_H
 #define CURRENT_STORAGE_PERSISTER_STREAM_H
 
+#include <condition_variable>
+#include <fstream>
+#include <thread>
+
 #include "common.h"
 #include "../base.h"
 #include "../exceptions.h"
 #include "../transaction.h"
 #include "../../stream/stream.h"
 
+#include "../../bricks/file/file.h"
 #include "../../bricks/sync/locks.h"
 
 namespace current {
 namespace storage {
 namespace persister {
 
+// The first line of the snapshot file. The rest of it are the JSON-serialized mutations, one per line,
+// which recreate the state of the storage after the stream entries up to `next_index` have been applied.
+CURRENT_STRUCT(StorageSnapshotHeader) {
+  CURRENT_FIELD(next_index, uint64_t);
+  CURRENT_FIELD(last_applied_us, std::chrono::microseconds);
+  CURRENT_DEFAULT_CONSTRUCTOR(StorageSnapshotHeader) : next_index(0u), last_applied_us(-1) {}
+  CURRENT_CONSTRUCTOR(StorageSnapshotHeader)(uint64_t next_index, std::chrono::microseconds last_applied_us)
+      : next_index(next_index), last_applied_us(last_applied_us) {}
+};
+
 template <typename MUTATIONS_VARIANT, template <typename> class UNDERLYING_PERSISTER, typename STREAM_RECORD_TYPE>
 class StreamStreamPersisterImpl final {
  public:
@@ -47,19 +62,19 @@ class StreamStreamPersisterImpl final {
       std::conditional_t<std::is_same_v<STREAM_RECORD_TYPE, NoCustomPersisterParam>, transaction_t, STREAM_RECORD_TYPE>;
   using stream_t = stream::Stream<stream_entry_t, UNDERLYING_PERSISTER>;
   using fields_update_function_t = std::function<void(const variant_t&)>;
+  using fields_export_function_t = std::function<void(const fields_update_function_t&)>;
+  using fields_mutex_t = current::locks::WriterPreferringSharedMutex;
 
   struct StreamSubscriberImpl {
     using EntryResponse = current::ss::EntryResponse;
     using TerminationResponse = current::ss::TerminationResponse;
-    using replay_function_t = std::function<void(const transaction_t&, std::chrono::microseconds)>;
+    using replay_function_t = std::function<void(const transaction_t&, idxts_t)>;
     replay_function_t replay_f_;
-    uint64_t next_replay_index_ = 0u;
 
     StreamSubscriberImpl(replay_function_t f) : replay_f_(f) {}
 
     EntryResponse operator()(const transaction_t& transaction, idxts_t current, idxts_t) {
-      replay_f_(transaction, current.us);
-      next_replay_index_ = current.index + 1u;
+      replay_f_(transaction, current);
       return EntryResponse::More;
     }
 
@@ -73,34 +88,58 @@ class StreamStreamPersisterImpl final {
   struct Master {};
   struct Following {};
 
-  StreamStreamPersisterImpl(Master, fields_update_function_t f, Borrowed<stream_t> stream)
+  StreamStreamPersisterImpl(Master,
+                            fields_update_function_t f,
+                            fields_export_function_t export_f,
+                            Borrowed<stream_t> stream,
+                            const StorageSnapshotParams& snapshot_params)
       : fields_update_f_(f),
+        fields_export_f_(export_f),
+        snapshot_params_(snapshot_params),
         stream_publishing_mutex_ref_(stream->Impl()->publishing_mutex),
         stream_(std::move(stream)),
         publisher_used_(stream_->BecomeFollowingStream()) {
-    subscriber_instance_ = std::make_unique<StreamSubscriber>(
-        [this](const transaction_t& transaction, std::chrono::microseconds timestamp) {
+    subscriber_instance_ =
+        std::make_unique<StreamSubscriber>([this](const transaction_t& transaction, idxts_t idxts) {
           std::lock_guard<std::mutex> lock(stream_publishing_mutex_ref_);
-          ApplyMutationsFromLockedSectionOrConstructor(transaction, timestamp);
+          ApplyMutationsFromLockedSectionOrConstructor(transaction, idxts);
         });
     std::lock_guard<std::mutex> lock(stream_publishing_mutex_ref_);
-    SyncReplayStreamFromLockedSectionOrConstructor(0u);
+    LoadSnapshotFromConstructor();
+    SyncReplayStreamFromLockedSectionOrConstructor(next_stream_index_);
+    StartSnapshotThreadFromConstructor();
   }
 
-  StreamStreamPersisterImpl(Following, fields_update_function_t f, Borrowed<stream_t> stream)
+  StreamStreamPersisterImpl(Following,
+                            fields_update_function_t f,
+                            fields_export_function_t export_f,
+                            Borrowed<stream_t> stream,
+                            const StorageSnapshotParams& snapshot_params)
       : fields_update_f_(f),
+        fields_export_f_(export_f),
+        snapshot_params_(snapshot_params),
         stream_publishing_mutex_ref_(stream->Impl()->publishing_mutex),
         stream_(std::move(stream)) {
-    subscriber_instance_ = std::make_unique<StreamSubscriber>(
-        [this](const transaction_t& transaction, std::chrono::microseconds timestamp) {
+    subscriber_instance_ =
+        std::make_unique<StreamSubscriber>([this](const transaction_t& transaction, idxts_t idxts) {
           std::lock_guard<std::mutex> lock(stream_publishing_mutex_ref_);
-          ApplyMutationsFromLockedSectionOrConstructor(transaction, timestamp);
+          ApplyMutationsFromLockedSectionOrConstructor(transaction, idxts);
         });
     std::lock_guard<std::mutex> lock(stream_publishing_mutex_ref_);
+    LoadSnapshotFromConstructor();
     SubscribeToStreamFromLockedSection();
+    StartSnapshotThreadFromConstructor();
   }
 
   ~StreamStreamPersisterImpl() {
+    if (snapshot_thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(snapshot_thread_mutex_);
+        snapshot_thread_stop_ = true;
+      }
+      snapshot_thread_cv_.notify_one();
+      snapshot_thread_.join();
+    }
     std::lock_guard<std::mutex> master_follower_change_lock(master_follower_change_mutex_);
     TerminateStreamSubscriptionFromLockedSection();
   }
@@ -131,11 +170,41 @@ class StreamStreamPersisterImpl final {
         transaction.mutations.emplace_back(BypassVariantTypeCheck(), std::move(entry));
       }
       std::swap(transaction.meta, journal.transaction_meta);
-      Value(publisher_used_)
-          ->template Publish<current::locks::MutexLockStatus::AlreadyLocked>(std::move(transaction), timestamp);
+      const idxts_t idxts =
+          Value(publisher_used_)
+              ->template Publish<current::locks::MutexLockStatus::AlreadyLocked>(std::move(transaction), timestamp);
       SetLastAppliedTimestampFromLockedSection(timestamp);
+      next_stream_index_ = idxts.index + 1u;
+      journal.Clear();
+      CountTransactionAndMaybeScheduleSnapshotFromLockedSection();
+    } else {
+      journal.Clear();
+    }
+  }
+
+  // Saves the snapshot of the storage. Only the master storage does, as the followers share its snapshot file.
+  // The fields are copied, as mutations, with the publishing mutex of the stream locked, so that they do not change
+  // meanwhile. The read-only transactions do not wait for that, and nothing waits for the snapshot to be serialized
+  // and written, which happens after the mutex is unlocked.
+  // Important: The publishing mutex of the respective stream must be unlocked!
+  void SaveSnapshot() {
+    if (snapshot_params_.file_name.empty()) {
+      CURRENT_THROW(StorageSnapshotException("No snapshot file name was provided for this storage."));
+    }
+    // Held throughout, so that the snapshots are written one at a time, and in the order they were copied in.
+    std::lock_guard<std::mutex> snapshot_write_lock(snapshot_write_mutex_);
+    StorageSnapshotHeader header;
+    std::vector<variant_t> mutations;
+    {
+      std::lock_guard<std::mutex> lock(stream_publishing_mutex_ref_);
+      if (!IsMasterStoragePersister<current::locks::MutexLockStatus::AlreadyLocked>()) {
+        CURRENT_THROW(StorageSnapshotException("Only the master storage saves the snapshots."));
+      }
+      header = StorageSnapshotHeader(next_stream_index_, last_applied_timestamp_);
+      fields_export_f_([&mutations](const variant_t& mutation) { mutations.push_back(mutation); });
+      transactions_since_snapshot_ = 0u;
     }
-    journal.Clear();
+    WriteSnapshot(header, mutations);
   }
 
   void ExposeRawLogViaHTTP(uint16_t port, const std::string& route) {
@@ -145,6 +214,11 @@ class StreamStreamPersisterImpl final {
                                      [this](Request r) { (*Borrowed<stream_t>(stream_))(std::move(r)); });
   }
 
+  // Guards the fields of the storage: held exclusively while they are mutated, be it by a read-write transaction
+  // or by replaying the stream, and shared by read-only transactions, so that readers do not block each other.
+  // Always locked after the publishing mutex of the stream by the writers; the readers do not need the latter.
+  fields_mutex_t& FieldsMutex() const { return fields_mutex_; }
+
   Borrowed<stream_t> BorrowStream() const { return stream_; }
   const WeakBorrowed<stream_t>& Stream() const { return stream_; }
   WeakBorrowed<stream_t>& Stream() { return stream_; }
@@ -167,9 +241,8 @@ class StreamStreamPersisterImpl final {
       std::lock_guard<std::mutex> lock(stream_publishing_mutex_ref_);
       publisher_used_ = nullptr;
       publisher_used_ = stream_->template BecomeFollowingStream<current::locks::MutexLockStatus::AlreadyLocked>();
-      const uint64_t save_replay_index = subscriber_instance_->next_replay_index_;
       subscriber_instance_ = nullptr;
-      SyncReplayStreamFromLockedSectionOrConstructor(save_replay_index);
+      SyncReplayStreamFromLockedSectionOrConstructor(next_stream_index_);
     }
   }
 
@@ -183,17 +256,133 @@ class StreamStreamPersisterImpl final {
          stream_->Data()->template Iterate<current::locks::MutexLockStatus::AlreadyLocked>(from_idx)) {
       if (Exists<transaction_t>(stream_record.entry)) {
         const transaction_t& transaction = Value<transaction_t>(stream_record.entry);
-        ApplyMutationsFromLockedSectionOrConstructor(transaction, stream_record.idx_ts.us);
+        ApplyMutationsFromLockedSectionOrConstructor(transaction, stream_record.idx_ts);
       }
     }
   }
 
-  void ApplyMutationsFromLockedSectionOrConstructor(const transaction_t& transaction,
-                                                    std::chrono::microseconds timestamp) {
+  void ApplyMutationsFromLockedSectionOrConstructor(const transaction_t& transaction, idxts_t idxts) {
+    std::lock_guard<fields_mutex_t> fields_lock(fields_mutex_);
     for (const auto& mutation : transaction.mutations) {
       fields_update_f_(mutation);
     }
-    SetLastAppliedTimestampFromLockedSection(timestamp);
+    SetLastAppliedTimestampFromLockedSection(idxts.us);
+    next_stream_index_ = idxts.index + 1u;
+  }
+
+  // Loads the snapshot, if there is one, so that only the stream entries starting from `next_stream_index_`
+  // are to be replayed. The snapshot is only used if it matches the stream: the last stream entry reflected
+  // in the snapshot should be there, with the very timestamp recorded in the snapshot. The snapshot which is empty,
+  // malformed, or does not match the stream is logged and ignored, and the stream is then replayed in full. It is
+  // parsed as a whole before any of it is applied, so that the fields remain intact should it be ignored.
+  void LoadSnapshotFromConstructor() {
+    if (snapshot_params_.file_name.empty()) {
+      return;
+    }
+    std::ifstream fi(snapshot_params_.file_name);
+    if (!fi.good()) {
+      return;  // No snapshot saved yet.
+    }
+    try {
+      std::string line;
+      if (!std::getline(fi, line)) {
+        CURRENT_THROW(StorageSnapshotException("Empty snapshot file `" + snapshot_params_.file_name + "`."));
+      }
+      const auto header = ParseJSON<StorageSnapshotHeader>(line);
+      if (header.next_index && !StreamHasEntryFromLockedSection(header.next_index - 1u, header.last_applied_us)) {
+        CURRENT_THROW(StorageSnapshotException("The snapshot `" + snapshot_params_.file_name +
+                                               "` does not match the stream of the storage."));
+      }
+      std::vector<variant_t> mutations;
+      while (std::getline(fi, line)) {
+        mutations.push_back(ParseJSON<variant_t>(line));
+      }
+      if (fi.bad()) {
+        CURRENT_THROW(StorageSnapshotException("Cannot read the snapshot `" + snapshot_params_.file_name + "`."));
+      }
+      std::lock_guard<fields_mutex_t> fields_lock(fields_mutex_);
+      for (const auto& mutation : mutations) {
+        fields_update_f_(mutation);
+      }
+      last_applied_timestamp_ = header.last_applied_us;
+      next_stream_index_ = header.next_index;
+    } catch (const StorageSnapshotException& e) {
+      std::cerr << "Ignoring the storage snapshot: " << e.what() << std::endl;
+    } catch (const TypeSystemParseJSONException& e) {
+      std::cerr << "Ignoring the malformed storage snapshot `" << snapshot_params_.file_name << "`: " << e.what()
+                << std::endl;
+    }
+  }
+
+  bool StreamHasEntryFromLockedSection(uint64_t index, std::chrono::microseconds us) const {
+    const auto& data = stream_->Data();
+    if (index >= data->template Size<current::locks::MutexLockStatus::AlreadyLocked>()) {
+      return false;
+    }
+    for (const auto& stream_record :
+         data->template Iterate<current::locks::MutexLockStatus::AlreadyLocked>(index, index + 1u)) {
+      return stream_record.idx_ts.us == us;
+    }
+    return false;  // LCOV_EXCL_LINE
+  }
+
+  // Writes the snapshot into a temporary file, and then renames it into `snapshot_params_.file_name`,
+  // so that a crash while saving the snapshot does not leave the previous one corrupted.
+  void WriteSnapshot(const StorageSnapshotHeader& header, const std::vector<variant_t>& mutations) const {
+    const std::string temporary_file_name = snapshot_params_.file_name + ".tmp";
+    {
+      std::ofstream fo(temporary_file_name);
+      if (!fo.good()) {
+        CURRENT_THROW(StorageSnapshotException("Cannot write the snapshot into `" + temporary_file_name + "`."));
+      }
+      fo << JSON(header) << '\n';
+      for (const variant_t& mutation : mutations) {
+        fo << JSON(mutation) << '\n';
+      }
+      if (!fo.good()) {
+        CURRENT_THROW(StorageSnapshotException("Cannot write the snapshot into `" + temporary_file_name + "`."));
+      }
+    }
+    FileSystem::RenameFile(temporary_file_name, snapshot_params_.file_name);
+  }
+
+  // The periodic snapshots are saved by their own thread, so that the transaction which is due to trigger one
+  // does not wait for it, and neither does any other transaction, except for the ones which come in while
+  // the fields are being copied. Only the master storage counts the transactions, as it is the one to save them.
+  void CountTransactionAndMaybeScheduleSnapshotFromLockedSection() {
+    if (snapshot_thread_.joinable() && ++transactions_since_snapshot_ >= snapshot_params_.every_n_transactions) {
+      transactions_since_snapshot_ = 0u;
+      {
+        std::lock_guard<std::mutex> lock(snapshot_thread_mutex_);
+        snapshot_due_ = true;
+      }
+      snapshot_thread_cv_.notify_one();
+    }
+  }
+
+  void StartSnapshotThreadFromConstructor() {
+    if (!snapshot_params_.file_name.empty() && snapshot_params_.every_n_transactions) {
+      snapshot_thread_ = std::thread([this]() { SnapshotThread(); });
+    }
+  }
+
+  // Failing to save a periodic snapshot is reported, but does not fail anything; the next attempt will be made later.
+  void SnapshotThread() {
+    std::unique_lock<std::mutex> lock(snapshot_thread_mutex_);
+    while (true) {
+      snapshot_thread_cv_.wait(lock, [this]() { return snapshot_due_ || snapshot_thread_stop_; });
+      if (snapshot_thread_stop_) {
+        return;
+      }
+      snapshot_due_ = false;
+      lock.unlock();
+      try {
+        SaveSnapshot();
+      } catch (const current::Exception& e) {
+        std::cerr << "Failed to save the storage snapshot: " << e.what() << std::endl;
+      }
+      lock.lock();
+    }
   }
 
  private:
@@ -201,7 +390,8 @@ class StreamStreamPersisterImpl final {
   void SubscribeToStreamFromLockedSection() {
     CURRENT_ASSERT(!subscriber_scope_);
     CURRENT_ASSERT(subscriber_instance_);
-    subscriber_scope_ = std::move(stream_->template Subscribe<transaction_t>(*subscriber_instance_));
+    subscriber_scope_ =
+        std::move(stream_->template Subscribe<transaction_t>(*subscriber_instance_, next_stream_index_));
   }
 
   // Invariant: `master_follower_change_mutex_` is locked.
@@ -215,8 +405,11 @@ class StreamStreamPersisterImpl final {
 
  private:
   fields_update_function_t fields_update_f_;
+  fields_export_function_t fields_export_f_;
+  const StorageSnapshotParams snapshot_params_;
 
   std::mutex& stream_publishing_mutex_ref_;  // == `stream_->Impl()->publishing_mutex`.
+  mutable fields_mutex_t fields_mutex_;
   Borrowed<stream_t> stream_;
   Optional<Borrowed<typename stream_t::publisher_t>> publisher_used_;  // Set iff the storage is the master storage.
 
@@ -225,6 +418,16 @@ class StreamStreamPersisterImpl final {
   current::stream::SubscriberScope subscriber_scope_;
 
   std::chrono::microseconds last_applied_timestamp_ = std::chrono::microseconds(-1);  // Replayed or from the master.
+  uint64_t next_stream_index_ = 0u;  // The index of the first stream entry not yet applied to the fields.
+  uint64_t transactions_since_snapshot_ = 0u;
+
+  // The thread saving the periodic snapshots, only if `snapshot_params_.every_n_transactions` is set.
+  std::mutex snapshot_write_mutex_;  // Locked before `stream_publishing_mutex_ref_`, never after it.
+  std::mutex snapshot_thread_mutex_;
+  std::condition_variable snapshot_thread_cv_;
+  bool snapshot_due_ = false;
+  bool snapshot_thread_stop_ = false;
+  std::thread snapshot_thread_;
 
   HTTPRoutesScope handlers_scope_;
 };
@@ -26,6 +26,7 @@ SOFTWARE.
 // Hypermedia: A rather hacky solution for Hypermedia REST API supporting:
 // * Rich JSON format (top-level `url_*` fields, and actual data in `data`.)
 // * Poor man's stateless "pagination" through collections and collection "slices" (rows/cols of matrices).
+// * Cursor-based pagination, via `?cursor=`, each page of which takes the time proportional to its size.
 // * Full and brief fields sets.
 
 #ifndef CURRENT_STORAGE_REST_HYPERMEDIA_H
@@ -86,6 +87,9 @@ struct HypermediaResponseFormatter {
     // For poor man's pagination when viewing the collection.
     mutable uint64_t query_i = 0u;
     mutable uint64_t query_n = 10u;  // Default page size.
+
+    // For cursor-based pagination, set if `?cursor=` is passed in. The empty one stands for the first page.
+    Optional<std::string> query_cursor;
   };
 
   template <typename ENTRY>
@@ -116,6 +120,11 @@ struct HypermediaResponseFormatter {
                                                     HypermediaRESTFullCollectionRecord<inner_element_t>,
                                                     HypermediaRESTBriefCollectionRecord<inner_element_t>>;
 
+    if (Exists(context.query_cursor)) {
+      return BuildCursorResponseWithCollection<PARTICULAR_FIELD, ENTRY, collection_element_t>(
+          context, pagination_url, collection_url, std::forward<ITERABLE>(span));
+    }
+
     HypermediaRESTCollectionResponse<collection_element_t> response;
     response.url_directory = collection_url;
 
@@ -173,6 +182,49 @@ struct HypermediaResponseFormatter {
 
     return Response(response, HTTPResponseCode.OK);
   }
+
+  // Cursor-based pagination. The page starts right from where the cursor points to, and ends with composing
+  // the cursor for the next page, so that browsing the whole collection takes the time linear in its size.
+  template <typename PARTICULAR_FIELD, typename ENTRY, typename COLLECTION_ELEMENT, typename ITERABLE>
+  static Response BuildCursorResponseWithCollection(const Context& context,
+                                                    const std::string& pagination_url,
+                                                    const std::string& collection_url,
+                                                    ITERABLE&& span) {
+    using span_t = current::decay_t<ITERABLE>;
+    const std::string& cursor = Value(context.query_cursor);
+    const auto gen_page_url = [&pagination_url, &context](const std::string& url_cursor) {
+      return pagination_url + "?cursor=" + url_cursor + "&n=" + current::ToString(context.query_n);
+    };
+
+    HypermediaRESTCursorCollectionResponse<COLLECTION_ELEMENT> response;
+    response.url = gen_page_url(cursor);
+    response.url_directory = collection_url;
+    response.total = span.Size();
+
+    try {
+      uint64_t index;
+      auto iterator = ResumeFromCollectionCursor(static_cast<const span_t&>(span), cursor, index);
+      response.i = index;
+      response.data.reserve(static_cast<size_t>(std::min(context.query_n, static_cast<uint64_t>(response.total))));
+      for (; iterator != span.end() && response.data.size() < context.query_n; ++iterator, ++index) {
+        using iterator_t = decltype(iterator);
+        response.data.resize(response.data.size() + 1);
+        COLLECTION_ELEMENT& record = response.data.back();
+        record.url = collection_url + '/' + ComposeRESTfulKey<PARTICULAR_FIELD, ENTRY>(iterator);
+        PopulateCollectionRecord<ENTRY, typename current::decay_t<typename iterator_t::value_t>>::DoIt(
+            record.DataOrBriefByRef(), iterator);
+      }
+      response.n = response.data.size();
+      if (iterator != span.end()) {
+        response.url_next_page =
+            gen_page_url(ComposeCollectionCursor(static_cast<const span_t&>(span), index, iterator));
+      }
+    } catch (const InvalidCollectionCursorException& e) {
+      return ErrorResponse(InvalidCursorError(e.OriginalDescription(), cursor), HTTPResponseCode.BadRequest);
+    }
+
+    return Response(response, HTTPResponseCode.OK);
+  }
 };
 
 }  // namespace hypermedia
@@ -199,6 +251,9 @@ struct Hypermedia : generic::Structured<hypermedia::HypermediaResponseFormatter>
       context.brief = ((q["fields"] == "brief") || q.has("brief")) && !q.has("full");
       context.query_i = current::FromString<uint64_t>(q.get("i", current::ToString(context.query_i)));
       context.query_n = current::FromString<uint64_t>(q.get("n", current::ToString(context.query_n)));
+      if (q.has("cursor")) {
+        context.query_cursor = q["cursor"];
+      }
 
       SUPER_GET_HANDLER_GENERATOR::Enter(std::move(request), std::forward<F>(next));
     }
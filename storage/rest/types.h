@@ -161,6 +161,10 @@ inline generic::RESTError ResourceWasModifiedError(const std::string& message,
                              {"resource_last_modified_us", ToString(last_modified)}});
 }
 
+inline generic::RESTError InvalidCursorError(const std::string& message, const std::string& cursor) {
+  return generic::RESTError("InvalidCursor", message, {{"cursor", cursor}});
+}
+
 }  // namespace helpers
 
 namespace simple {
@@ -237,6 +241,18 @@ CURRENT_STRUCT_T(HypermediaRESTCollectionResponse) {
   CURRENT_FIELD(data, std::vector<T>);
 };
 
+// The page of the collection browsed via `?cursor=`, which only links to the next page.
+CURRENT_STRUCT_T(HypermediaRESTCursorCollectionResponse) {
+  CURRENT_FIELD(success, bool, true);
+  CURRENT_FIELD(url, std::string);
+  CURRENT_FIELD(url_directory, std::string);
+  CURRENT_FIELD(i, uint64_t);
+  CURRENT_FIELD(n, uint64_t);
+  CURRENT_FIELD(total, uint64_t);
+  CURRENT_FIELD(url_next_page, Optional<std::string>);
+  CURRENT_FIELD(data, std::vector<T>);
+};
+
 // The simplest way to pass universal dictionary/matrix key and entry to the templated Current struct.
 template <typename KEY, typename ENTRY>
 struct DetailedExportEntryHelper {
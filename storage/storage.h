@@ -28,6 +28,7 @@ SOFTWARE.
 // * (Ordered/Unordered)Dictionary<T> <=> std::(map/unordered_map)<key_t, T>
 //   Empty(), Size(), operator[](key), Erase(key) [, iteration, {lower/upper}_bound].
 //   `key_t` is either the type of `T.key` or of `T.get_key()`.
+//   Secondary indexes, if declared via `T::storage_indexes_t`, are available as `Index<T::index_name>()`.
 //
 // * (Ordered/Unordered)(One/Many)To(One/Many)<T> <=> { row_t, col_t } -> T, two `std::(map/unordered_map)<>`-s.
 //   Entries are stored in third `std::unordered_map<std::pair<row_t, col_t>, std::unique_ptr<T>>`.
@@ -303,6 +304,7 @@ class StorageImpl {
   using fields_variant_t = Variant<fields_type_list_t>;
   using persister_t = PERSISTER<fields_variant_t, CUSTOM_PERSISTER_PARAM>;
   using stream_t = typename persister_t::stream_t;
+  using fields_mutex_t = typename persister_t::fields_mutex_t;
 
  private:
   FIELDS fields_;
@@ -318,20 +320,48 @@ class StorageImpl {
 
   template <typename... ARGS>
   static Owned<StorageImpl> CreateMasterStorage(ARGS&&... args) {
-    return MakeOwned<StorageImpl>(typename persister_t::Master(), CreateStreamAsWell(), std::forward<ARGS>(args)...);
+    return MakeOwned<StorageImpl>(
+        typename persister_t::Master(), StorageSnapshotParams(), CreateStreamAsWell(), std::forward<ARGS>(args)...);
   }
 
   template <typename... ARGS>
   static Owned<StorageImpl> CreateFollowingStorage(ARGS&&... args) {
-    return MakeOwned<StorageImpl>(typename persister_t::Following(), CreateStreamAsWell(), std::forward<ARGS>(args)...);
+    return MakeOwned<StorageImpl>(
+        typename persister_t::Following(), StorageSnapshotParams(), CreateStreamAsWell(), std::forward<ARGS>(args)...);
   }
 
   static Owned<StorageImpl> CreateMasterStorageAtopExistingStream(Borrowed<stream_t> stream) {
-    return MakeOwned<StorageImpl>(typename persister_t::Master(), UseExistingStream(), stream);
+    return MakeOwned<StorageImpl>(typename persister_t::Master(), StorageSnapshotParams(), UseExistingStream(), stream);
   }
 
   static Owned<StorageImpl> CreateFollowingStorageAtopExistingStream(Borrowed<stream_t> stream) {
-    return MakeOwned<StorageImpl>(typename persister_t::Following(), UseExistingStream(), stream);
+    return MakeOwned<StorageImpl>(
+        typename persister_t::Following(), StorageSnapshotParams(), UseExistingStream(), stream);
+  }
+
+  // The `...WithSnapshots` versions load the latest snapshot of the storage, if there is one, instead of replaying
+  // the stream from its very beginning, and save the snapshots periodically and/or on `SaveSnapshot()`.
+  template <typename... ARGS>
+  static Owned<StorageImpl> CreateMasterStorageWithSnapshots(const StorageSnapshotParams& snapshots, ARGS&&... args) {
+    return MakeOwned<StorageImpl>(
+        typename persister_t::Master(), snapshots, CreateStreamAsWell(), std::forward<ARGS>(args)...);
+  }
+
+  template <typename... ARGS>
+  static Owned<StorageImpl> CreateFollowingStorageWithSnapshots(const StorageSnapshotParams& snapshots,
+                                                                ARGS&&... args) {
+    return MakeOwned<StorageImpl>(
+        typename persister_t::Following(), snapshots, CreateStreamAsWell(), std::forward<ARGS>(args)...);
+  }
+
+  static Owned<StorageImpl> CreateMasterStorageAtopExistingStreamWithSnapshots(
+      Borrowed<stream_t> stream, const StorageSnapshotParams& snapshots) {
+    return MakeOwned<StorageImpl>(typename persister_t::Master(), snapshots, UseExistingStream(), stream);
+  }
+
+  static Owned<StorageImpl> CreateFollowingStorageAtopExistingStreamWithSnapshots(
+      Borrowed<stream_t> stream, const StorageSnapshotParams& snapshots) {
+    return MakeOwned<StorageImpl>(typename persister_t::Following(), snapshots, UseExistingStream(), stream);
   }
 
  private:
@@ -341,18 +371,44 @@ class StorageImpl {
   struct UseExistingStream {};
 
   template <typename CONSTRUCTION_TYPE>
-  StorageImpl(CONSTRUCTION_TYPE, UseExistingStream, Borrowed<stream_t> stream)
-      : persister_(
-            CONSTRUCTION_TYPE(), [this](const fields_variant_t& entry) { entry.Call(fields_); }, stream),
+  StorageImpl(CONSTRUCTION_TYPE, const StorageSnapshotParams& snapshots, UseExistingStream, Borrowed<stream_t> stream)
+      : persister_(CONSTRUCTION_TYPE(),
+                   [this](const fields_variant_t& entry) { entry.Call(fields_); },
+                   [this](const std::function<void(const fields_variant_t&)>& f) { ExportFieldsAsMutations(f); },
+                   stream,
+                   snapshots),
         transaction_policy_(persister_, fields_.current_storage_mutation_journal_) {}
 
   template <typename CONSTRUCTION_TYPE, typename... ARGS>
-  StorageImpl(CONSTRUCTION_TYPE, CreateStreamAsWell, ARGS&&... args)
+  StorageImpl(CONSTRUCTION_TYPE, const StorageSnapshotParams& snapshots, CreateStreamAsWell, ARGS&&... args)
       : owned_stream_(std::move(stream_t::CreateStream(std::forward<ARGS>(args)...))),
-        persister_(
-            CONSTRUCTION_TYPE(), [this](const fields_variant_t& entry) { entry.Call(fields_); }, Value(owned_stream_)),
+        persister_(CONSTRUCTION_TYPE(),
+                   [this](const fields_variant_t& entry) { entry.Call(fields_); },
+                   [this](const std::function<void(const fields_variant_t&)>& f) { ExportFieldsAsMutations(f); },
+                   Value(owned_stream_),
+                   snapshots),
         transaction_policy_(persister_, fields_.current_storage_mutation_journal_) {}
 
+  // The `BLAH` template parameter is required to fight the "explicit specialization in class scope" error.
+  template <typename BLAH, int I>
+  struct ExportFieldsByIndex {
+    static void ExportThem(const FIELDS& fields, const std::function<void(const fields_variant_t&)>& f) {
+      ExportFieldsByIndex<BLAH, I - 1>::ExportThem(fields, f);
+      fields(::current::storage::ImmutableFieldByIndex<I - 1>(), [&f](const auto& field) {
+        field.ExportAsMutations([&f](auto&& mutation) { f(fields_variant_t(std::move(mutation))); });
+      });
+    }
+  };
+
+  template <typename BLAH>
+  struct ExportFieldsByIndex<BLAH, 0> {
+    static void ExportThem(const FIELDS&, const std::function<void(const fields_variant_t&)>&) {}
+  };
+
+  void ExportFieldsAsMutations(const std::function<void(const fields_variant_t&)>& f) const {
+    ExportFieldsByIndex<void, FIELDS_COUNT>::ExportThem(fields_, f);
+  }
+
  public:
   template <current::locks::MutexLockStatus MLS = current::locks::MutexLockStatus::NeedToLock>
   bool IsMasterStorage() {
@@ -388,6 +444,7 @@ class StorageImpl {
     if (!IsMasterStorage<current::locks::MutexLockStatus::AlreadyLocked>()) {
       CURRENT_THROW(ReadWriteTransactionInFollowerStorageException());
     }
+    std::lock_guard<fields_mutex_t> fields_lock(persister_.FieldsMutex());
     return transaction_policy_.TransactionFromLockedSection([&f, this]() { return f(fields_); });
   }
 
@@ -398,6 +455,7 @@ class StorageImpl {
     if (!IsMasterStorage<current::locks::MutexLockStatus::AlreadyLocked>()) {
       CURRENT_THROW(ReadWriteTransactionInFollowerStorageException());
     }
+    std::lock_guard<fields_mutex_t> fields_lock(persister_.FieldsMutex());
     return transaction_policy_.TransactionFromLockedSection([&f1, this]() { return f1(fields_); },
                                                             std::forward<F2>(f2));
   }
@@ -405,7 +463,7 @@ class StorageImpl {
   template <current::locks::MutexLockStatus MLS = current::locks::MutexLockStatus::NeedToLock, typename F>
   ::current::Future<::current::storage::TransactionResult<f_result_t<F>>, ::current::StrictFuture::Strict>
   ReadOnlyTransaction(F&& f) const {
-    current::locks::SmartMutexLockGuard<MLS> lock(persister_.Stream()->Impl()->publishing_mutex);
+    current::locks::SmartSharedMutexLockGuard<MLS, fields_mutex_t> fields_lock(persister_.FieldsMutex());
     return transaction_policy_.TransactionFromLockedSection(
         [&f, this]() { return f(static_cast<const FIELDS&>(fields_)); });
   }
@@ -413,7 +471,7 @@ class StorageImpl {
   template <current::locks::MutexLockStatus MLS = current::locks::MutexLockStatus::NeedToLock, typename F1, typename F2>
   ::current::Future<::current::storage::TransactionResult<void>, ::current::StrictFuture::Strict> ReadOnlyTransaction(
       F1&& f1, F2&& f2) const {
-    current::locks::SmartMutexLockGuard<MLS> lock(persister_.Stream()->Impl()->publishing_mutex);
+    current::locks::SmartSharedMutexLockGuard<MLS, fields_mutex_t> fields_lock(persister_.FieldsMutex());
     return transaction_policy_.TransactionFromLockedSection(
         [&f1, this]() { return f1(static_cast<const FIELDS&>(fields_)); }, std::forward<F2>(f2));
   }
@@ -448,6 +506,11 @@ class StorageImpl {
 
   void GracefulShutdown() { transaction_policy_.GracefulShutdown(); }
 
+  // Saves the snapshot of the storage into the file passed in `StorageSnapshotParams` at construction.
+  // Read-only transactions may run meanwhile, while the writes and the replay only wait for the fields to be copied.
+  // Only the master storage saves the snapshots.
+  void SaveSnapshot() { persister_.SaveSnapshot(); }
+
  private:
   StorageImpl() = delete;
   StorageImpl(const StorageImpl&) = delete;
@@ -479,6 +542,7 @@ class NullStoragePersisterImpl {
  public:
   using variant_t = MUTATIONS_VARIANT;
   using transaction_t = Transaction<variant_t>;
+  using fields_mutex_t = current::locks::WriterPreferringSharedMutex;
 
   // NOTE(dkorolev): Commented out to not make the compiler match the type.
   // using fields_update_function_t = std::function<void(const variant_t&)>;
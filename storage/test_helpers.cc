@@ -118,6 +118,26 @@ CURRENT_STORAGE(TestStorage) {
   CURRENT_STORAGE_FIELD(oone_to_umany, CellOrderedOneToUnorderedMany);
 };
 
+CURRENT_STRUCT(Person) {
+  CURRENT_FIELD(key, std::string);
+  CURRENT_FIELD(email, std::string);
+  CURRENT_FIELD(city, std::string);
+  CURRENT_FIELD(age, uint32_t);
+
+  CURRENT_STORAGE_INDEX(by_email, email, UnorderedUnique);
+  CURRENT_STORAGE_INDEX(by_city, city, UnorderedNonUnique);
+  CURRENT_STORAGE_INDEX(by_age, age, OrderedNonUnique);
+  using storage_indexes_t = ::current::storage::Indexes<by_email, by_city, by_age>;
+
+  CURRENT_CONSTRUCTOR(Person)
+  (const std::string& key = "", const std::string& email = "", const std::string& city = "", uint32_t age = 0u)
+      : key(key), email(email), city(city), age(age) {}
+};
+
+CURRENT_STORAGE_FIELD_ENTRY(OrderedDictionary, Person, PersonDictionary);
+
+CURRENT_STORAGE(IndexedStorage) { CURRENT_STORAGE_FIELD(person, PersonDictionary); };
+
 }  // namespace transactional_storage_test
 
 static_assert(std::is_same<transactional_storage_test::RecordDictionary::update_event_t::storage_field_t,
@@ -24,6 +24,7 @@ SOFTWARE.
 *******************************************************************************/
 
 #define CURRENT_MOCK_TIME
+#define CURRENT_STORAGE_STREAMED_EXPORT_BATCH_SIZE 2  // To have the streamed `?export` span several transactions.
 
 #include "../test_helpers.cc"
 
@@ -662,6 +663,219 @@ std::sort(strings.begin(), strings.end());
 }
 }
 
+TEST(TransactionalStorage, RESTfulAPICursorAndStreamedExportTest) {
+  current::time::ResetToZero();
+
+  using namespace transactional_storage_test;
+  using namespace current::storage::rest;
+  using storage_t = SimpleStorage<StreamInMemoryStreamPersister>;
+  using users_page_t =
+      hypermedia::HypermediaRESTCursorCollectionResponse<hypermedia::HypermediaRESTFullCollectionRecord<SimpleUser>>;
+  using posts_page_t =
+      hypermedia::HypermediaRESTCursorCollectionResponse<hypermedia::HypermediaRESTFullCollectionRecord<SimplePost>>;
+
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port));
+  static_cast<void>(http_server);
+
+  auto stream = storage_t::stream_t::CreateStream();
+  auto storage = storage_t::CreateMasterStorageAtopExistingStream(stream);
+
+  const auto base_url = current::strings::Printf("http://localhost:%d", port);
+
+  const auto rest = RESTfulStorage<storage_t, current::storage::rest::Hypermedia>(*storage, port, "/hypermedia", "");
+
+  for (int i = 1; i <= 5; ++i) {
+    const std::string key = "u" + current::ToString(i);
+    EXPECT_EQ(201, static_cast<int>(HTTP(PUT(base_url + "/hypermedia/data/user/" + key, SimpleUser(key, "X"))).code));
+    EXPECT_EQ(201, static_cast<int>(HTTP(PUT(base_url + "/hypermedia/data/post/" + key, SimplePost(key, "Y"))).code));
+  }
+
+  {
+    // Browse the ordered collection page by page, following `url_next_page`.
+    std::vector<std::string> keys;
+    std::string url = "/data/user?cursor=&n=2";
+    size_t pages = 0u;
+    while (true) {
+      const auto response = HTTP(GET(base_url + "/hypermedia" + url));
+      ASSERT_EQ(200, static_cast<int>(response.code));
+      const auto page = ParseJSON<users_page_t>(response.body);
+      EXPECT_EQ(5u, page.total);
+      EXPECT_EQ(keys.size(), page.i);
+      for (const auto& record : page.data) {
+        keys.push_back(record.data.key);
+      }
+      ++pages;
+      if (!Exists(page.url_next_page)) {
+        break;
+      }
+      url = Value(page.url_next_page);
+    }
+    EXPECT_EQ(3u, pages);
+    EXPECT_EQ("u1,u2,u3,u4,u5", current::strings::Join(keys, ','));
+  }
+
+  {
+    // Browse the unordered collection, the order of the keys is unspecified, but each must be seen exactly once.
+    std::set<std::string> keys;
+    std::string url = "/data/post?cursor=&n=3";
+    while (true) {
+      const auto response = HTTP(GET(base_url + "/hypermedia" + url));
+      ASSERT_EQ(200, static_cast<int>(response.code));
+      const auto page = ParseJSON<posts_page_t>(response.body);
+      for (const auto& record : page.data) {
+        EXPECT_TRUE(keys.insert(record.data.key).second);
+      }
+      if (!Exists(page.url_next_page)) {
+        break;
+      }
+      url = Value(page.url_next_page);
+    }
+    EXPECT_EQ(5u, keys.size());
+  }
+
+  {
+    // The cursor of the ordered collection survives the deletion of the very element it points to.
+    const auto first_page = ParseJSON<users_page_t>(HTTP(GET(base_url + "/hypermedia/data/user?cursor=&n=2")).body);
+    ASSERT_EQ(2u, first_page.data.size());
+    ASSERT_TRUE(Exists(first_page.url_next_page));
+    EXPECT_EQ(200, static_cast<int>(HTTP(DELETE(base_url + "/hypermedia/data/user/u3")).code));
+    const auto second_page =
+        ParseJSON<users_page_t>(HTTP(GET(base_url + "/hypermedia" + Value(first_page.url_next_page))).body);
+    ASSERT_EQ(2u, second_page.data.size());
+    EXPECT_EQ("u4", second_page.data[0].data.key);
+    EXPECT_EQ("u5", second_page.data[1].data.key);
+    EXPECT_FALSE(Exists(second_page.url_next_page));
+  }
+
+  {
+    // A malformed cursor is a bad request.
+    const auto response = HTTP(GET(base_url + "/hypermedia/data/user?cursor=not*a*cursor"));
+    EXPECT_EQ(400, static_cast<int>(response.code));
+    EXPECT_EQ("InvalidCursor", Value(ParseJSON<generic::RESTGenericResponse>(response.body).error).name);
+  }
+
+  // The streamed export is only available off the followers.
+  EXPECT_EQ(403, static_cast<int>(HTTP(GET(base_url + "/hypermedia/data/user?export&stream")).code));
+
+  {
+    current::Owned<storage_t> following_storage = storage_t::CreateFollowingStorageAtopExistingStream(stream);
+    while (following_storage->LastAppliedTimestamp() < storage->LastAppliedTimestamp()) {
+      std::this_thread::yield();
+    }
+    const auto follower_rest = RESTfulStorage<storage_t>(*following_storage, port, "/follower", "");
+
+    // The batch size is set to two for this test, so that the four users are exported via several transactions.
+    EXPECT_EQ(
+        "{\"key\":\"u1\",\"name\":\"X\"}\n"
+        "{\"key\":\"u2\",\"name\":\"X\"}\n"
+        "{\"key\":\"u4\",\"name\":\"X\"}\n"
+        "{\"key\":\"u5\",\"name\":\"X\"}\n",
+        HTTP(GET(base_url + "/follower/data/user?export&stream")).body);
+
+    const auto detailed = current::strings::Split<current::strings::ByLines>(
+        HTTP(GET(base_url + "/follower/data/user?export=detailed&stream")).body);
+    ASSERT_EQ(4u, detailed.size());
+    EXPECT_EQ(0u, detailed[2].find("{\"key\":\"u4\",\"timestamp_us\":"));
+
+    std::set<std::string> sharded;
+    for (const std::string shard : {"0", "1"}) {
+      const auto lines = current::strings::Split<current::strings::ByLines>(
+          HTTP(GET(base_url + "/follower/data/post?export&stream&nshards=2&shard=" + shard)).body);
+      for (const auto& line : lines) {
+        EXPECT_TRUE(sharded.insert(ParseJSON<SimplePost>(line).key).second);
+      }
+    }
+    EXPECT_EQ(5u, sharded.size());
+
+    // The unordered dictionary is exported by the keys collected upfront, in full, in batches.
+    const auto all_posts = current::strings::Split<current::strings::ByLines>(
+        HTTP(GET(base_url + "/follower/data/post?export&stream")).body);
+    EXPECT_EQ(5u, all_posts.size());
+
+    // So is the unordered matrix, by its pairs of keys; it is empty in this test.
+    const auto like_response = HTTP(GET(base_url + "/follower/data/like?export&stream"));
+    EXPECT_EQ(200, static_cast<int>(like_response.code));
+    EXPECT_EQ("", like_response.body);
+  }
+
+  {
+    // The cursor of the unordered collection is invalid once the collection has been rehashed, as the order of
+    // the iteration has changed.
+    const auto first_page = ParseJSON<posts_page_t>(HTTP(GET(base_url + "/hypermedia/data/post?cursor=&n=2")).body);
+    ASSERT_EQ(2u, first_page.data.size());
+    ASSERT_TRUE(Exists(first_page.url_next_page));
+    const auto bucket_count = [&storage]() {
+      return Value(
+          storage->ReadOnlyTransaction([](ImmutableFields<storage_t> fields) { return fields.post.BucketCount(); })
+              .Go());
+    };
+    const size_t bucket_count_before = bucket_count();
+    storage
+        ->ReadWriteTransaction([](MutableFields<storage_t> fields) {
+          for (int i = 0; i < 1000; ++i) {
+            fields.post.Add(SimplePost("p" + current::ToString(i), "Z"));
+          }
+        })
+        .Go();
+    EXPECT_NE(bucket_count_before, bucket_count());
+    const auto response = HTTP(GET(base_url + "/hypermedia" + Value(first_page.url_next_page)));
+    EXPECT_EQ(400, static_cast<int>(response.code));
+    EXPECT_EQ("InvalidCursor", Value(ParseJSON<generic::RESTGenericResponse>(response.body).error).name);
+  }
+}
+
+TEST(TransactionalStorage, RESTfulAPISecondaryIndexesTest) {
+  current::time::ResetToZero();
+
+  using namespace transactional_storage_test;
+  using namespace current::storage::rest;
+  using storage_t = IndexedStorage<StreamInMemoryStreamPersister>;
+
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port));
+  static_cast<void>(http_server);
+
+  auto storage = storage_t::CreateMasterStorage();
+
+  const auto base_url = current::strings::Printf("http://localhost:%d", port);
+
+  const auto rest = RESTfulStorage<storage_t, current::storage::rest::Hypermedia>(*storage, port, "/api", "");
+
+  EXPECT_EQ(201, static_cast<int>(HTTP(PUT(base_url + "/api/data/person/a", Person("a", "a@x", "Tallinn", 20u))).code));
+  EXPECT_EQ(201, static_cast<int>(HTTP(PUT(base_url + "/api/data/person/b", Person("b", "b@x", "Berlin", 30u))).code));
+  EXPECT_EQ(201, static_cast<int>(HTTP(PUT(base_url + "/api/data/person/c", Person("c", "c@x", "Tallinn", 30u))).code));
+
+  {
+    const auto response = HTTP(GET(base_url + "/api/data/person.by_email/b@x"));
+    EXPECT_EQ(200, static_cast<int>(response.code));
+    EXPECT_EQ("{\"key\":\"b\",\"email\":\"b@x\",\"city\":\"Berlin\",\"age\":30}\n", response.body);
+  }
+  EXPECT_EQ(404, static_cast<int>(HTTP(GET(base_url + "/api/data/person.by_email/z@x")).code));
+
+  {
+    const auto response = HTTP(GET(base_url + "/api/data/person.by_city/Tallinn"));
+    EXPECT_EQ(200, static_cast<int>(response.code));
+    EXPECT_EQ(
+        "{\"key\":\"a\",\"email\":\"a@x\",\"city\":\"Tallinn\",\"age\":20}\n"
+        "{\"key\":\"c\",\"email\":\"c@x\",\"city\":\"Tallinn\",\"age\":30}\n",
+        response.body);
+  }
+  EXPECT_EQ("", HTTP(GET(base_url + "/api/data/person.by_city/Paris")).body);
+  EXPECT_EQ(
+      2u,
+      current::strings::Split<current::strings::ByLines>(HTTP(GET(base_url + "/api/data/person.by_age/30")).body).size());
+
+  // Violating a unique index fails the mutation.
+  EXPECT_NE(201, static_cast<int>(HTTP(PUT(base_url + "/api/data/person/d", Person("d", "a@x", "Paris", 40u))).code));
+  EXPECT_EQ(404, static_cast<int>(HTTP(GET(base_url + "/api/data/person/d")).code));
+
+  // Index lookups are read-only.
+  EXPECT_EQ(405, static_cast<int>(HTTP(DELETE(base_url + "/api/data/person.by_email/a@x")).code));
+}
+
 TEST(TransactionalStorage, CQSTest) {
   current::time::ResetToZero();
 
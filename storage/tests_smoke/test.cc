@@ -1369,6 +1369,125 @@ TEST(TransactionalStorage, LastModifiedInDictionaryContainer) {
   }
 }
 
+TEST(TransactionalStorage, SecondaryIndexesInDictionaryContainer) {
+  current::time::ResetToZero();
+
+  using namespace transactional_storage_test;
+  using storage_t = IndexedStorage<StreamInMemoryStreamPersister>;
+
+  auto stream = storage_t::stream_t::CreateStream();
+  current::Owned<storage_t> storage = storage_t::CreateMasterStorageAtopExistingStream(stream);
+
+  const auto KeysInCity = [](const ImmutableFields<storage_t>& fields, const std::string& city) {
+    std::vector<std::string> keys;
+    for (const auto& person : fields.person.Index<Person::by_city>()[city]) {
+      keys.push_back(person.key);
+    }
+    return current::strings::Join(keys, ',');
+  };
+
+  {
+    const auto result = storage
+                            ->ReadWriteTransaction([&](MutableFields<storage_t> fields) {
+                              fields.person.Add(Person("c", "c@x", "Tallinn", 30u));
+                              fields.person.Add(Person("a", "a@x", "Tallinn", 20u));
+                              fields.person.Add(Person("b", "b@x", "Berlin", 30u));
+
+                              const auto& by_email = fields.person.Index<Person::by_email>();
+                              EXPECT_EQ(3u, by_email.Size());
+                              ASSERT_TRUE(Exists(by_email["b@x"]));
+                              EXPECT_EQ("b", Value(by_email["b@x"]).key);
+                              EXPECT_FALSE(Exists(by_email["z@x"]));
+
+                              // The entries under the same index key follow the order of the dictionary.
+                              EXPECT_EQ("a,c", KeysInCity(fields, "Tallinn"));
+                              EXPECT_EQ("b", KeysInCity(fields, "Berlin"));
+                              EXPECT_EQ("", KeysInCity(fields, "Paris"));
+                              EXPECT_EQ(2u, fields.person.Index<Person::by_city>().Size());
+
+                              std::vector<std::string> ages;
+                              const auto& by_age = fields.person.Index<Person::by_age>();
+                              for (auto it = by_age.LowerBound(25u); it != by_age.end(); ++it) {
+                                ages.push_back(current::ToString(it.key()) + ':' + current::ToString((*it).Size()));
+                              }
+                              EXPECT_EQ("30:2", current::strings::Join(ages, ','));
+                            })
+                            .Go();
+    EXPECT_TRUE(WasCommitted(result));
+  }
+
+  // Updates and deletions are reflected in the indexes, and so are their rollbacks.
+  {
+    const auto result = storage
+                            ->ReadWriteTransaction([&](MutableFields<storage_t> fields) {
+                              fields.person.Add(Person("a", "a2@x", "Berlin", 20u));
+                              fields.person.Erase("b");
+                              EXPECT_FALSE(Exists(fields.person.Index<Person::by_email>()["a@x"]));
+                              EXPECT_TRUE(Exists(fields.person.Index<Person::by_email>()["a2@x"]));
+                              EXPECT_FALSE(Exists(fields.person.Index<Person::by_email>()["b@x"]));
+                              EXPECT_EQ("c", KeysInCity(fields, "Tallinn"));
+                              EXPECT_EQ("a", KeysInCity(fields, "Berlin"));
+                              CURRENT_STORAGE_THROW_ROLLBACK();
+                            })
+                            .Go();
+    EXPECT_FALSE(WasCommitted(result));
+  }
+  {
+    const auto result = storage
+                            ->ReadOnlyTransaction([&](ImmutableFields<storage_t> fields) {
+                              EXPECT_TRUE(Exists(fields.person.Index<Person::by_email>()["a@x"]));
+                              EXPECT_FALSE(Exists(fields.person.Index<Person::by_email>()["a2@x"]));
+                              EXPECT_TRUE(Exists(fields.person.Index<Person::by_email>()["b@x"]));
+                              EXPECT_EQ("a,c", KeysInCity(fields, "Tallinn"));
+                              EXPECT_EQ("b", KeysInCity(fields, "Berlin"));
+                            })
+                            .Go();
+    EXPECT_TRUE(WasCommitted(result));
+  }
+
+  // Unique indexes are enforced, with the dictionary left intact.
+  {
+    const auto result = storage
+                            ->ReadWriteTransaction([](MutableFields<storage_t> fields) {
+                              fields.person.Add(Person("a", "a@x", "Paris", 21u));  // Same key, same email: fine.
+                              bool thrown = false;
+                              try {
+                                fields.person.Add(Person("d", "b@x", "Paris", 40u));
+                              } catch (const current::storage::StorageUniqueIndexViolationException&) {
+                                thrown = true;
+                              }
+                              EXPECT_TRUE(thrown);
+                              EXPECT_FALSE(fields.person.Has("d"));
+                              EXPECT_EQ("b", Value(fields.person.Index<Person::by_email>()["b@x"]).key);
+                            })
+                            .Go();
+    EXPECT_TRUE(WasCommitted(result));
+  }
+  EXPECT_THROW(storage
+                   ->ReadWriteTransaction(
+                       [](MutableFields<storage_t> fields) { fields.person.Add(Person("e", "c@x", "Paris", 50u)); })
+                   .Go(),
+               current::storage::StorageUniqueIndexViolationException);
+
+  // The indexes are rebuilt when the mutations are replayed.
+  {
+    current::Owned<storage_t> replayed = storage_t::CreateFollowingStorageAtopExistingStream(stream);
+    while (replayed->LastAppliedTimestamp() < storage->LastAppliedTimestamp()) {
+      std::this_thread::yield();
+    }
+    const auto result = replayed
+                            ->ReadOnlyTransaction([&](ImmutableFields<storage_t> fields) {
+                              EXPECT_EQ(3u, fields.person.Size());
+                              EXPECT_EQ("c", KeysInCity(fields, "Tallinn"));
+                              EXPECT_EQ("a", KeysInCity(fields, "Paris"));
+                              EXPECT_EQ("a", Value(fields.person.Index<Person::by_email>()["a@x"]).key);
+                              EXPECT_FALSE(Exists(fields.person.Index<Person::by_email>()["e@x"]));
+                            })
+                            .Go();
+    EXPECT_TRUE(WasCommitted(result));
+  }
+}
+
 TEST(TransactionalStorage, LastModifiedInMatrixContainers) {
   current::time::ResetToZero();
 
@@ -1730,4 +1849,229 @@ TEST(TransactionalStorage, GracefulShutdown) {
   ASSERT_THROW(result.Go(), current::storage::StorageInGracefulShutdownException);
 }
 
+TEST(TransactionalStorage, ReadOnlyTransactionsRunConcurrently) {
+  current::time::ResetToZero();
+
+  using namespace transactional_storage_test;
+  using storage_t = TestStorage<StreamInMemoryStreamPersister>;
+
+  auto storage = storage_t::CreateMasterStorage();
+  storage->ReadWriteTransaction([](MutableFields<storage_t> fields) { fields.d.Add(Record{"one", 1}); }).Go();
+
+  // Both read-only transactions are held open until both of them have started, which requires them to be concurrent.
+  std::atomic_int readers_inside(0);
+  std::atomic_bool release_readers(false);
+  std::atomic_bool writer_done(false);
+  const auto reader = [&]() {
+    const auto result = storage
+                            ->ReadOnlyTransaction([&](ImmutableFields<storage_t> fields) -> int {
+                              ++readers_inside;
+                              while (!release_readers) {
+                                std::this_thread::yield();
+                              }
+                              EXPECT_FALSE(writer_done);
+                              return Value(fields.d["one"]).rhs;
+                            })
+                            .Go();
+    EXPECT_EQ(1, Value(result));
+  };
+
+  std::thread first_reader(reader);
+  std::thread second_reader(reader);
+  while (readers_inside < 2) {
+    std::this_thread::yield();
+  }
+
+  // The read-write transaction is not allowed in while the read-only ones are in progress.
+  std::thread writer([&]() {
+    storage->ReadWriteTransaction([](MutableFields<storage_t> fields) { fields.d.Add(Record{"one", 2}); }).Go();
+    writer_done = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(writer_done);
+
+  release_readers = true;
+  first_reader.join();
+  second_reader.join();
+  writer.join();
+  EXPECT_TRUE(writer_done);
+
+  EXPECT_EQ(2,
+            Value(storage
+                      ->ReadOnlyTransaction([](ImmutableFields<storage_t> fields) -> int {
+                        return Value(fields.d["one"]).rhs;
+                      })
+                      .Go()));
+}
+
+namespace transactional_storage_test {
+
+// Dumps the contents of the fields, along with the last modified timestamps, to compare the storages.
+template <typename FIELDS>
+std::string DumpFieldsForSnapshotTest(const FIELDS& fields) {
+  std::vector<std::string> result;
+  for (const auto& record : fields.d) {
+    result.push_back("d " + JSON(record) + " @" + current::ToString(Value(fields.d.LastModified(record.lhs)).count()));
+  }
+  if (Exists(fields.d.LastModified("two"))) {
+    result.push_back("d two @" + current::ToString(Value(fields.d.LastModified("two")).count()));
+  }
+  const auto dump_matrix = [&result](const std::string& name, const auto& field) {
+    for (const auto& cell : field) {
+      result.push_back(name + ' ' + JSON(cell) + " @" +
+                       current::ToString(Value(field.LastModified(cell.foo, cell.bar)).count()));
+    }
+    if (Exists(field.LastModified(1, "a"))) {
+      result.push_back(name + " 1:a @" + current::ToString(Value(field.LastModified(1, "a")).count()));
+    }
+  };
+  dump_matrix("uone_to_uone", fields.uone_to_uone);
+  dump_matrix("omany_to_omany", fields.omany_to_omany);
+  dump_matrix("oone_to_omany", fields.oone_to_omany);
+  std::sort(result.begin(), result.end());
+  return current::strings::Join(result, '\n');
+}
+
+}  // namespace transactional_storage_test
+
+TEST(TransactionalStorage, Snapshots) {
+  current::time::ResetToZero();
+
+  using namespace transactional_storage_test;
+  using storage_t = TestStorage<StreamStreamPersister>;
+  using current::storage::StorageSnapshotParams;
+  using current::storage::persister::StorageSnapshotHeader;
+
+  const std::string storage_file_name =
+      current::FileSystem::JoinPath(FLAGS_transactional_storage_test_tmpdir, "storage_data");
+  const auto storage_file_remover = current::FileSystem::ScopedRmFile(storage_file_name);
+  const std::string snapshot_file_name =
+      current::FileSystem::JoinPath(FLAGS_transactional_storage_test_tmpdir, "storage_snapshot");
+  const auto snapshot_file_remover = current::FileSystem::ScopedRmFile(snapshot_file_name);
+
+  const auto snapshot_header = [&snapshot_file_name]() {
+    const std::string contents = current::FileSystem::ReadFileAsString(snapshot_file_name);
+    return ParseJSON<StorageSnapshotHeader>(contents.substr(0, contents.find('\n')));
+  };
+
+  // Save the snapshot in the middle of the stream.
+  {
+    auto storage =
+        storage_t::CreateMasterStorageWithSnapshots(StorageSnapshotParams(snapshot_file_name), storage_file_name);
+    storage
+        ->ReadWriteTransaction([](MutableFields<storage_t> fields) {
+          fields.d.Add(Record{"one", 1});
+          fields.d.Add(Record{"two", 2});
+          fields.uone_to_uone.Add(Cell{1, "a", 1});
+          fields.omany_to_omany.Add(Cell{1, "x", 1});
+          fields.omany_to_omany.Add(Cell{2, "x", 2});
+          fields.oone_to_omany.Add(Cell{1, "a", 1});
+        })
+        .Go();
+    storage
+        ->ReadWriteTransaction([](MutableFields<storage_t> fields) {
+          fields.d.Erase("two");
+          fields.uone_to_uone.Add(Cell{1, "b", 2});  // Replaces the conflicting `{1, "a"}` cell.
+          fields.omany_to_omany.Erase(2, "x");
+          fields.oone_to_omany.Add(Cell{2, "a", 2});  // Replaces the conflicting `{1, "a"}` cell.
+        })
+        .Go();
+    storage->SaveSnapshot();
+    EXPECT_EQ(2u, snapshot_header().next_index);
+    storage->ReadWriteTransaction([](MutableFields<storage_t> fields) { fields.d.Add(Record{"three", 3}); }).Go();
+    EXPECT_EQ(2u, snapshot_header().next_index);
+  }
+
+  // The storage restarted from the snapshot and the tail of the stream is the same as the one replayed from scratch.
+  std::string replayed;
+  {
+    auto storage = storage_t::CreateMasterStorage(storage_file_name);
+    replayed = Value(storage->ReadOnlyTransaction([](ImmutableFields<storage_t> fields) {
+                             return DumpFieldsForSnapshotTest(fields);
+                           }).Go());
+  }
+  EXPECT_EQ(8u, current::strings::Split(replayed, '\n').size()) << replayed;
+  {
+    auto storage =
+        storage_t::CreateMasterStorageWithSnapshots(StorageSnapshotParams(snapshot_file_name), storage_file_name);
+    EXPECT_EQ(replayed,
+              Value(storage->ReadOnlyTransaction([](ImmutableFields<storage_t> fields) {
+                               return DumpFieldsForSnapshotTest(fields);
+                             }).Go()));
+  }
+
+  // The part of the stream covered by the snapshot is indeed not replayed.
+  {
+    std::string snapshot = current::FileSystem::ReadFileAsString(snapshot_file_name);
+    const std::string original = "\"lhs\":\"one\",\"rhs\":1}";
+    const size_t original_offset = snapshot.find(original);
+    ASSERT_NE(std::string::npos, original_offset);
+    snapshot.replace(original_offset, original.length(), "\"lhs\":\"one\",\"rhs\":100}");
+    current::FileSystem::WriteStringToFile(snapshot, snapshot_file_name.c_str());
+    auto storage =
+        storage_t::CreateMasterStorageWithSnapshots(StorageSnapshotParams(snapshot_file_name), storage_file_name);
+    EXPECT_EQ(100, Value(storage->ReadOnlyTransaction([](ImmutableFields<storage_t> fields) {
+                                    return Value(fields.d["one"]).rhs;
+                                  }).Go()));
+    EXPECT_EQ(3, Value(storage->ReadOnlyTransaction([](ImmutableFields<storage_t> fields) {
+                                  return Value(fields.d["three"]).rhs;
+                                }).Go()));
+  }
+
+  // The snapshot which is empty, malformed, or does not match the stream is ignored, with none of it applied,
+  // and the stream replayed in full.
+  {
+    const std::string snapshot = current::FileSystem::ReadFileAsString(snapshot_file_name);
+    const std::string mutations = snapshot.substr(snapshot.find('\n') + 1u);
+    for (const std::string& contents :
+         {std::string(),
+          std::string("{malformed\n"),
+          snapshot + "{malformed\n",
+          JSON(StorageSnapshotHeader(100u, std::chrono::microseconds(1))) + '\n' + mutations}) {
+      current::FileSystem::WriteStringToFile(contents, snapshot_file_name.c_str());
+      auto storage =
+          storage_t::CreateMasterStorageWithSnapshots(StorageSnapshotParams(snapshot_file_name), storage_file_name);
+      EXPECT_EQ(replayed,
+                Value(storage->ReadOnlyTransaction([](ImmutableFields<storage_t> fields) {
+                                 return DumpFieldsForSnapshotTest(fields);
+                               }).Go()))
+          << contents;
+    }
+  }
+  current::FileSystem::RmFile(snapshot_file_name);
+
+  // Periodic snapshots, with the following storage starting from the snapshot as well.
+  {
+    auto storage =
+        storage_t::CreateMasterStorageWithSnapshots(StorageSnapshotParams(snapshot_file_name, 2u), storage_file_name);
+    storage->ReadWriteTransaction([](MutableFields<storage_t> fields) { fields.d.Add(Record{"four", 4}); }).Go();
+    ASSERT_THROW(current::FileSystem::ReadFileAsString(snapshot_file_name), current::CannotReadFileException);
+    storage->ReadWriteTransaction([](MutableFields<storage_t> fields) { fields.d.Add(Record{"five", 5}); }).Go();
+    // The periodic snapshot is saved in the background.
+    while (!std::ifstream(snapshot_file_name).good()) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(5u, snapshot_header().next_index);
+    storage->ReadWriteTransaction([](MutableFields<storage_t> fields) { fields.d.Add(Record{"six", 6}); }).Go();
+  }
+  {
+    auto stream = storage_t::stream_t::CreateStream(storage_file_name);
+    const auto stream_publisher = stream->BecomeFollowingStream();
+    auto storage = storage_t::CreateFollowingStorageAtopExistingStreamWithSnapshots(
+        stream, StorageSnapshotParams(snapshot_file_name));
+    while (!Value(storage
+                      ->ReadOnlyTransaction(
+                          [](ImmutableFields<storage_t> fields) -> bool { return Exists(fields.d["six"]); })
+                      .Go())) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(5u,
+              Value(storage->ReadOnlyTransaction([](ImmutableFields<storage_t> fields) -> size_t {
+                               return fields.d.Size();
+                             }).Go()));
+    // The following storage does not save the snapshots, as the master storage does.
+    ASSERT_THROW(storage->SaveSnapshot(), current::storage::StorageSnapshotException);
+  }
+}
+
 #endif  // STORAGE_ONLY_RUN_RESTFUL_TESTS
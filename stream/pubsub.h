@@ -28,6 +28,8 @@ SOFTWARE.
 
 #include "../port.h"
 
+#include <chrono>
+#include <string_view>
 #include <utility>
 
 #include "stream_impl.h"
@@ -259,6 +261,8 @@ class PubSubHTTPEndpointImpl : public AbstractSubscriberObject {
     if (params_.n > 0u) {
       n_ = params_.n;
     }
+    // Many entries go out as one HTTP chunk, flushed as soon as the subscriber has caught up with the stream.
+    http_response_.Coalesce(kOutputChunkSize, kOutputChunkMaxDelay);
   }
 
   // The implementation of the subscriber in `PubSubHTTPEndpointImpl` is an example of using:
@@ -310,6 +314,9 @@ class PubSubHTTPEndpointImpl : public AbstractSubscriberObject {
             }
           }
           http_response_(std::move(entry_json));
+          if (current.index == last.index) {
+            http_response_.Flush();
+          }
         } catch (const current::net::NetworkException&) {  // LCOV_EXCL_LINE
           return ss::EntryResponse::Done;                  // LCOV_EXCL_LINE
         }
@@ -331,12 +338,11 @@ class PubSubHTTPEndpointImpl : public AbstractSubscriberObject {
       }
       return ss::EntryResponse::More;
     }();
-    if (result == ss::EntryResponse::Done && params_.array) {
-      if (!output_started_) {
-        http_response_("[]\n");
-      } else {
-        http_response_("]\n");
+    if (result == ss::EntryResponse::Done) {
+      if (params_.array) {
+        SendOutput(output_started_ ? "]\n" : "[]\n");
       }
+      FlushOutput();
     }
     return result;
   }
@@ -374,29 +380,31 @@ class PubSubHTTPEndpointImpl : public AbstractSubscriberObject {
         if (to_timestamp_.count() && GetCurrentUs() > to_timestamp_) {
           return ss::EntryResponse::Done;
         }
-        const std::string response_data = [this, &raw_log_line]() {
-          if (!params_.entries_only) {
-            return raw_log_line;
-          } else {
-            const auto tab_pos = raw_log_line.find('\t');
-            return tab_pos != std::string::npos ? raw_log_line.substr(tab_pos + 1) : raw_log_line;
+        // The persisted line is passed through verbatim, without parsing and re-serializing the entry.
+        const char* line_begin = raw_log_line.data();
+        const char* const line_end = line_begin + raw_log_line.length();
+        if (params_.entries_only) {
+          const auto tab_pos = raw_log_line.find('\t');
+          if (tab_pos != std::string::npos) {
+            line_begin += tab_pos + 1;
           }
-        }() + '\n';
-        current_response_size_ += response_data.length();
-        try {
-          if (params_.array) {
-            if (!output_started_) {
-              http_response_("[\n", current::net::ChunkFlush::NoFlush);
-              output_started_ = true;
-            } else {
-              http_response_(",\n", current::net::ChunkFlush::NoFlush);
+        }
+        current_response_size_ += (line_end - line_begin) + 1u;
+        if (params_.array) {
+          if (!output_started_) {
+            output_started_ = true;
+            if (!SendOutput("[\n")) {
+              return ss::EntryResponse::Done;  // LCOV_EXCL_LINE
             }
+          } else if (!SendOutput(",\n")) {
+            return ss::EntryResponse::Done;  // LCOV_EXCL_LINE
           }
-          http_response_(
-              response_data,
-              current_index == last.index ? current::net::ChunkFlush::Flush : current::net::ChunkFlush::NoFlush);
-        } catch (const current::net::NetworkException&) {  // LCOV_EXCL_LINE
-          return ss::EntryResponse::Done;                  // LCOV_EXCL_LINE
+        }
+        if (!SendOutput(std::string_view(line_begin, line_end - line_begin)) || !SendOutput("\n")) {
+          return ss::EntryResponse::Done;  // LCOV_EXCL_LINE
+        }
+        if (current_index == last.index && !FlushOutput()) {
+          return ss::EntryResponse::Done;  // LCOV_EXCL_LINE
         }
         // Respect `stop_after_bytes`.
         if (params_.stop_after_bytes && current_response_size_ >= params_.stop_after_bytes) {
@@ -418,15 +426,9 @@ class PubSubHTTPEndpointImpl : public AbstractSubscriberObject {
     }();
     if (result == ss::EntryResponse::Done) {
       if (params_.array) {
-        if (!output_started_) {
-          http_response_("[]\n");
-        } else {
-          http_response_("]\n");
-        }
-      } else {
-        // flush cached response data.
-        http_response_("", current::net::ChunkFlush::Flush);
+        SendOutput(output_started_ ? "]\n" : "[]\n");
       }
+      FlushOutput();
     }
     return result;
   }
@@ -448,10 +450,13 @@ class PubSubHTTPEndpointImpl : public AbstractSubscriberObject {
       if (to_timestamp_.count() && us > to_timestamp_) {
         return ss::EntryResponse::Done;
       }
-      if (!params_.array && !params_.entries_only) {
-        http_response_(JSON<J>(ts_only_t(us)) + '\n');
+      if (!params_.array && !params_.entries_only && !SendOutput(JSON<J>(ts_only_t(us)) + '\n')) {
+        return ss::EntryResponse::Done;  // LCOV_EXCL_LINE
       }
     }
+    if (!FlushOutput()) {
+      return ss::EntryResponse::Done;  // LCOV_EXCL_LINE
+    }
     return ss::EntryResponse::More;
   }
 
@@ -465,15 +470,38 @@ class PubSubHTTPEndpointImpl : public AbstractSubscriberObject {
   ss::TerminationResponse Terminate() {
     static const std::string message = "{\"error\":\"The subscriber has terminated.\"}\n";
     if (params_.array && output_started_) {
-      http_response_(",\n" + message + "]\n");
+      SendOutput(",\n" + message + "]\n");
     } else {
-      http_response_(message);
+      SendOutput(message);
     }
+    FlushOutput();
     return ss::TerminationResponse::Terminate;
   }
   // LCOV_EXCL_STOP
 
  private:
+  // The output is coalesced into HTTP chunks of about this size, unless the subscriber has caught up sooner.
+  constexpr static size_t kOutputChunkSize = 64 * 1024;
+  constexpr static std::chrono::microseconds kOutputChunkMaxDelay = std::chrono::milliseconds(10);
+
+  // Both return false if the receiving end has closed the connection.
+  bool SendOutput(std::string_view data) {
+    try {
+      http_response_(std::move(data));
+      return true;
+    } catch (const current::net::NetworkException&) {  // LCOV_EXCL_LINE
+      return false;                                     // LCOV_EXCL_LINE
+    }
+  }
+  bool FlushOutput() {
+    try {
+      http_response_.Flush();
+      return true;
+    } catch (const current::net::NetworkException&) {  // LCOV_EXCL_LINE
+      return false;                                     // LCOV_EXCL_LINE
+    }
+  }
+
   // The HTTP listener must register itself as a user of stream data to ensure the lifetime of stream data.
   const BorrowedWithCallback<impl_t> impl_;
   std::atomic_bool time_to_terminate_{false};
@@ -27,13 +27,18 @@ SOFTWARE.
 
 #include "../port.h"
 
+#include <algorithm>
+#include <condition_variable>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <type_traits>
+#include <vector>
 
 #include "exceptions.h"
 #include "stream_impl.h"
@@ -54,6 +59,10 @@ SOFTWARE.
 #include "../bricks/util/sha256.h"
 #include "../bricks/util/waitable_terminate_signal.h"
 
+#ifndef CURRENT_STREAM_FAN_OUT_DISPATCHER_THREADS
+#define CURRENT_STREAM_FAN_OUT_DISPATCHER_THREADS 2
+#endif  // CURRENT_STREAM_FAN_OUT_DISPATCHER_THREADS
+
 // Stream is the overlord of streamed data storage and processing in Current.
 // Stream's streams are persistent, immutable, append-only typed sequences of records ("entries").
 // Each record is annotated with its 0-based index and its epoch microsecond timestamp.
@@ -72,6 +81,8 @@ SOFTWARE.
 //
 // Subscription is done via `auto scope = my_stream.Subscribe(my_subscriber);`, where `my_subscriber`
 // is an instance of the class doing the subscription. Stream runs each subscriber in a dedicated thread.
+// With `my_stream.SubscribeShared(my_subscriber)`, the subscriber only uses its own thread until it has caught up
+// with the stream, after which it is served, along with the other shared subscribers, by a few dispatcher threads.
 //
 // Stack ownership of `my_subscriber` is respected, and `SubscriberScope` is returned for the user to store.
 // As the returned `scope` object leaves the scope, the subscriber is sent a signal to terminate,
@@ -122,6 +133,10 @@ using DEFAULT_PERSISTENCE_LAYER = current::persistence::Memory<ENTRY>;
 
 enum class SubscriptionMode : bool { Checked = true, Unchecked = false };
 
+// The raw entries of the persisters, `std::string`-s or `std::string_view`-s, as passed to the unchecked subscribers.
+inline const std::string& RawEntryAsString(const std::string& raw_entry) { return raw_entry; }
+inline std::string RawEntryAsString(std::string_view raw_entry) { return std::string(raw_entry); }
+
 template <typename ENTRY, template <typename> class PERSISTENCE_LAYER = DEFAULT_PERSISTENCE_LAYER>
 class Stream final {
  public:
@@ -264,13 +279,212 @@ class Stream final {
   }
 
   // TODO(dkorolev): Master-follower flip between two streams belongs in Stream first, then in Storage.
+
+  // The new entries, read once by the fan-out dispatcher for all the subscribers it serves.
+  struct FanOutBatch final {
+    uint64_t begin_index = 0u;  // The index of the first entry in `entries` and `raw_entries`.
+    uint64_t size = 0u;         // The size of the stream as of this batch.
+    idxts_t last;
+    std::chrono::microseconds head = std::chrono::microseconds(-1);
+    std::vector<std::pair<idxts_t, entry_t>> entries;  // Populated if any of the subscribers is `Checked`.
+    std::vector<std::string> raw_entries;              // Populated if any of the subscribers is `Unchecked`.
+  };
+
+  // The subscriber as seen by the fan-out dispatcher.
+  class FanOutSubscriber {
+   public:
+    virtual ~FanOutSubscriber() = default;
+    virtual bool IsCheckedSubscriber() const = 0;
+    // The index of the next entry to pass to the subscriber, and the head it has already seen.
+    virtual uint64_t NextIndex() const = 0;
+    virtual std::chrono::microseconds Head() const = 0;
+    virtual bool WaitsForHeadUpdates() const = 0;
+    virtual bool TerminationRequested() const = 0;
+    // Passes what the subscriber has not yet seen from `batch` to it. Returns `Done` once it should be removed.
+    virtual ss::EntryResponse ServeBatch(const FanOutBatch& batch) = 0;
+    // Called once the subscriber has been removed from the dispatcher, outside of its locked sections.
+    virtual void OnRemovedFromFanOutDispatcher() = 0;
+  };
+
+  // Serves the subscribers which have caught up with the stream from `CURRENT_STREAM_FAN_OUT_DISPATCHER_THREADS`
+  // threads. Each thread reads the new entries once, and passes them to every subscriber assigned to it.
+  class FanOutDispatcher final : public AbstractFanOutDispatcher {
+   public:
+    explicit FanOutDispatcher(const impl_t& impl) : impl_(impl) {
+      for (size_t i = 0; i < CURRENT_STREAM_FAN_OUT_DISPATCHER_THREADS; ++i) {
+        groups_.push_back(std::make_unique<Group>());
+      }
+      for (auto& group : groups_) {
+        group->thread = std::thread(&FanOutDispatcher::Thread, this, std::ref(*group));
+      }
+    }
+
+    ~FanOutDispatcher() {
+      for (auto& group : groups_) {
+        group->stop = true;
+        group->signal.SignalExternalTermination();
+      }
+      for (auto& group : groups_) {
+        group->thread.join();
+      }
+    }
+
+    // Must be called from a section locked by `impl.publishing_mutex`. Returns the index of the group.
+    size_t Add(FanOutSubscriber* subscriber) {
+      size_t best = 0u;
+      for (size_t i = 1u; i < groups_.size(); ++i) {
+        if (groups_[i]->count < groups_[best]->count) {
+          best = i;
+        }
+      }
+      Group& group = *groups_[best];
+      ++group.count;
+      {
+        std::lock_guard<std::mutex> lock(group.pending_mutex);
+        group.pending.push_back(subscriber);
+      }
+      WakeUp(best);
+      return best;
+    }
+
+    void WakeUp(size_t group_index) {
+      Group& group = *groups_[group_index];
+      group.changed = true;
+      group.signal.NotifyOfExternalWaitableEvent();
+    }
+
+   private:
+    struct Group final {
+      std::atomic_bool stop{false};
+      std::atomic_bool changed{false};
+      std::atomic<size_t> count{0u};
+      current::WaitableTerminateSignal signal;
+      // The subscribers just handed over, to be moved into `subscribers` by the thread of this group.
+      std::mutex pending_mutex;
+      std::vector<FanOutSubscriber*> pending;
+      // The subscribers being served. Only accessed by the thread of this group.
+      std::vector<FanOutSubscriber*> subscribers;
+      // The smallest next index and head among `subscribers`, for the thread to know when to wake up.
+      std::atomic<uint64_t> min_next_index{static_cast<uint64_t>(-1)};
+      std::atomic<int64_t> min_head_us{std::numeric_limits<int64_t>::max()};
+      std::thread thread;
+    };
+
+    void Thread(Group& group) {
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(impl_.publishing_mutex);
+          current::WaitableTerminateSignalBulkNotifier::Scope scope(impl_.notifier, group.signal);
+          group.signal.WaitUntil(lock, [this, &group]() {
+            return group.changed ||
+                   impl_.persister.template Size<current::locks::MutexLockStatus::AlreadyLocked>() >
+                       group.min_next_index ||
+                   impl_.persister.template CurrentHead<current::locks::MutexLockStatus::AlreadyLocked>().count() >
+                       group.min_head_us;
+          });
+        }
+        if (group.stop) {
+          return;
+        }
+        group.changed = false;
+        {
+          std::lock_guard<std::mutex> lock(group.pending_mutex);
+          group.subscribers.insert(group.subscribers.end(), group.pending.begin(), group.pending.end());
+          group.pending.clear();
+        }
+        ServeGroup(group);
+      }
+    }
+
+    void ServeGroup(Group& group) {
+      FanOutBatch batch;
+      bool any_checked = false;
+      bool any_unchecked = false;
+      batch.begin_index = static_cast<uint64_t>(-1);
+      for (FanOutSubscriber* subscriber : group.subscribers) {
+        batch.begin_index = std::min(batch.begin_index, subscriber->NextIndex());
+        (subscriber->IsCheckedSubscriber() ? any_checked : any_unchecked) = true;
+      }
+      const auto head_idx = impl_.persister.HeadAndLastPublishedIndexAndTimestamp();
+      batch.size = Exists(head_idx.idxts) ? Value(head_idx.idxts).index + 1 : 0;
+      batch.head = head_idx.head;
+      if (Exists(head_idx.idxts)) {
+        batch.last = Value(head_idx.idxts);
+      }
+      // Each new entry is read from the persister once, regardless of the number of subscribers.
+      if (batch.begin_index < batch.size) {
+        if (any_checked) {
+          for (const auto& e : impl_.persister.Iterate(batch.begin_index, batch.size)) {
+            batch.entries.emplace_back(e.idx_ts, e.entry);
+          }
+        }
+        if (any_unchecked) {
+          for (const auto& e : impl_.persister.IterateUnsafe(batch.begin_index, batch.size)) {
+            batch.raw_entries.emplace_back(e);
+          }
+        }
+      }
+
+      std::vector<FanOutSubscriber*> removed;
+      uint64_t min_next_index = static_cast<uint64_t>(-1);
+      int64_t min_head_us = std::numeric_limits<int64_t>::max();
+      for (FanOutSubscriber*& subscriber : group.subscribers) {
+        // NOTE: The subscribers which have handed over after the batch was read get it on the next iteration.
+        if (subscriber->ServeBatch(batch) == ss::EntryResponse::Done) {
+          removed.push_back(subscriber);
+          subscriber = nullptr;
+        } else {
+          min_next_index = std::min(min_next_index, subscriber->NextIndex());
+          if (subscriber->WaitsForHeadUpdates()) {
+            min_head_us = std::min(min_head_us, static_cast<int64_t>(subscriber->Head().count()));
+          }
+          if (subscriber->TerminationRequested()) {
+            // Keep the thread awake until the subscriber is done terminating.
+            group.changed = true;
+          }
+        }
+      }
+      group.subscribers.erase(std::remove(group.subscribers.begin(), group.subscribers.end(), nullptr),
+                              group.subscribers.end());
+      group.min_next_index = min_next_index;
+      group.min_head_us = min_head_us;
+      group.count -= removed.size();
+      for (FanOutSubscriber* subscriber : removed) {
+        subscriber->OnRemovedFromFanOutDispatcher();
+      }
+    }
+
+    const impl_t& impl_;
+    std::vector<std::unique_ptr<Group>> groups_;
+  };
+
+  static FanOutDispatcher& FanOutDispatcherFor(const impl_t& impl) {
+    std::lock_guard<std::mutex> lock(impl.fan_out_dispatcher_mutex);
+    if (!impl.fan_out_dispatcher) {
+      impl.fan_out_dispatcher = std::make_unique<FanOutDispatcher>(impl);
+    }
+    return static_cast<FanOutDispatcher&>(*impl.fan_out_dispatcher);
+  }
+
   template <typename TYPE_SUBSCRIBED_TO, typename F, SubscriptionMode SM>
-  class SubscriberThreadInstance final : public current::stream::SubscriberScope::SubscriberThread {
+  class SubscriberThreadInstance final : public current::stream::SubscriberScope::SubscriberThread,
+                                         public FanOutSubscriber {
    private:
     bool this_is_valid_;
     std::function<void()> done_callback_;
     current::WaitableTerminateSignal terminate_signal_;
     bool terminate_sent_;
+    // Non-null for the shared subscriptions, which are handed over to the dispatcher once they have caught up.
+    FanOutDispatcher* const dispatcher_;
+    bool handed_over_ = false;
+    size_t group_index_ = 0u;
+    // The state of the handed over subscriber, only accessed by the thread of the dispatcher serving it.
+    uint64_t index_ = 0u;
+    std::chrono::microseconds head_;
+    // Set once the dispatcher is done with the handed over subscriber.
+    std::mutex finished_mutex_;
+    std::condition_variable finished_cv_;
+    bool finished_ = false;
     BorrowedWithCallback<impl_t> impl_;
     F& subscriber_;
     const uint64_t begin_idx_;
@@ -288,16 +502,21 @@ class Stream final {
                              F& subscriber,
                              uint64_t begin_idx,
                              std::chrono::microseconds from_us,
-                             std::function<void()> done_callback)
+                             std::function<void()> done_callback,
+                             bool shared)
         : this_is_valid_(false),
           done_callback_(done_callback),
           terminate_signal_(),
           terminate_sent_(false),
+          dispatcher_(shared ? &FanOutDispatcherFor(*impl) : nullptr),
           impl_(std::move(impl),
                 [this]() {
                   // NOTE(dkorolev): I'm uncertain whether this lock is necessary here. Keeping it for safety now.
                   std::lock_guard<std::mutex> lock(impl_->publishing_mutex);
                   terminate_signal_.SignalExternalTermination();
+                  if (handed_over_) {
+                    dispatcher_->WakeUp(group_index_);
+                  }
                 }),
           subscriber_(subscriber),
           begin_idx_(begin_idx),
@@ -317,6 +536,12 @@ class Stream final {
           terminate_signal_.SignalExternalTermination();
         }
         thread_.join();
+        if (handed_over_) {
+          // The subscriber is served by the fan-out dispatcher, wait until it is done with it.
+          dispatcher_->WakeUp(group_index_);
+          std::unique_lock<std::mutex> lock(finished_mutex_);
+          finished_cv_.wait(lock, [this]() { return finished_; });
+        }
       } else {
         // The constructor has not completed successfully. The thread was not started, and `impl_` is garbage.
         if (done_callback_) {
@@ -329,6 +554,12 @@ class Stream final {
       // Keep the subscriber thread exception-safe. By construction, it's guaranteed to live
       // strictly within the scope of existence of `impl_t` contained in `impl_`.
       ThreadImpl(begin_idx_);
+      if (!handed_over_) {
+        MarkDone();
+      }
+    }
+
+    void MarkDone() {
       subscriber_thread_done_ = true;
       std::lock_guard<std::mutex> lock(impl_->http_subscriptions_mutex);
       if (done_callback_) {
@@ -336,6 +567,70 @@ class Stream final {
       }
     }
 
+    // The `FanOutSubscriber` interface, for the dispatcher to serve this subscriber once it has been handed over.
+    bool IsCheckedSubscriber() const override { return SM == SubscriptionMode::Checked; }
+    uint64_t NextIndex() const override { return index_; }
+    std::chrono::microseconds Head() const override { return head_; }
+    bool WaitsForHeadUpdates() const override { return index_ > begin_idx_; }
+    bool TerminationRequested() const override { return !terminate_sent_ && terminate_signal_; }
+
+    ss::EntryResponse ServeBatch(const FanOutBatch& batch) override {
+      if (!terminate_sent_ && terminate_signal_) {
+        terminate_sent_ = true;
+        if (subscriber_.Terminate() != ss::TerminationResponse::Wait) {
+          return ss::EntryResponse::Done;
+        }
+      }
+      if (batch.head > head_) {
+        if (batch.size > index_ && index_ >= batch.begin_index) {
+          if (PassBatchToSubscriber(batch) == ss::EntryResponse::Done) {
+            return ss::EntryResponse::Done;
+          }
+          index_ = batch.size;
+          head_ = batch.last.us;
+        }
+        if (batch.size >= begin_idx_ && batch.head > head_ && subscriber_(batch.head) == ss::EntryResponse::Done) {
+          return ss::EntryResponse::Done;
+        }
+        head_ = batch.head;
+      }
+      return ss::EntryResponse::More;
+    }
+
+    void OnRemovedFromFanOutDispatcher() override {
+      MarkDone();
+      std::lock_guard<std::mutex> lock(finished_mutex_);
+      finished_ = true;
+      finished_cv_.notify_all();
+    }
+
+    template <SubscriptionMode MODE = SM>
+    std::enable_if_t<MODE == SubscriptionMode::Checked, ss::EntryResponse> PassBatchToSubscriber(
+        const FanOutBatch& batch) {
+      for (size_t i = static_cast<size_t>(index_ - batch.begin_index); i < batch.entries.size(); ++i) {
+        if (current::ss::PassEntryToSubscriberIfTypeMatches<TYPE_SUBSCRIBED_TO, entry_t>(
+                subscriber_,
+                [this]() -> ss::EntryResponse { return subscriber_.EntryResponseIfNoMorePassTypeFilter(); },
+                batch.entries[i].second,
+                batch.entries[i].first,
+                batch.last) == ss::EntryResponse::Done) {
+          return ss::EntryResponse::Done;
+        }
+      }
+      return ss::EntryResponse::More;
+    }
+
+    template <SubscriptionMode MODE = SM>
+    std::enable_if_t<MODE == SubscriptionMode::Unchecked, ss::EntryResponse> PassBatchToSubscriber(
+        const FanOutBatch& batch) {
+      for (size_t i = static_cast<size_t>(index_ - batch.begin_index); i < batch.raw_entries.size(); ++i) {
+        if (subscriber_(batch.raw_entries[i], batch.begin_index + i, batch.last) == ss::EntryResponse::Done) {
+          return ss::EntryResponse::Done;
+        }
+      }
+      return ss::EntryResponse::More;
+    }
+
     template <SubscriptionMode MODE = SM>
     std::enable_if_t<MODE == SubscriptionMode::Checked, ss::EntryResponse> PassEntriesToSubscriber(const impl_t& impl,
                                                                                                    uint64_t index,
@@ -370,7 +665,8 @@ class Stream final {
             return ss::EntryResponse::Done;
           }
         }
-        if (subscriber_(e, index++, impl.persister.LastPublishedIndexAndTimestamp()) == ss::EntryResponse::Done) {
+        if (subscriber_(RawEntryAsString(e), index++, impl.persister.LastPublishedIndexAndTimestamp()) ==
+            ss::EntryResponse::Done) {
           return ss::EntryResponse::Done;
         }
       }
@@ -404,13 +700,22 @@ class Stream final {
           head = head_idx.head;
         } else {
           std::unique_lock<std::mutex> lock(impl_->publishing_mutex);
-          current::WaitableTerminateSignalBulkNotifier::Scope scope(impl_->notifier, terminate_signal_);
-          terminate_signal_.WaitUntil(lock, [this, &index, &begin_idx, &head]() {
+          const auto has_news = [this, &index, &begin_idx, &head]() {
             return terminate_signal_ ||
                    impl_->persister.template Size<current::locks::MutexLockStatus::AlreadyLocked>() > index ||
                    (index > begin_idx &&
                     impl_->persister.template CurrentHead<current::locks::MutexLockStatus::AlreadyLocked>() > head);
-          });
+          };
+          if (dispatcher_ && !has_news()) {
+            // Caught up with the stream. From now on, the fan-out dispatcher passes the new entries over.
+            index_ = index;
+            head_ = head;
+            handed_over_ = true;
+            group_index_ = dispatcher_->Add(this);
+            return;
+          }
+          current::WaitableTerminateSignalBulkNotifier::Scope scope(impl_->notifier, terminate_signal_);
+          terminate_signal_.WaitUntil(lock, has_news);
         }
       }
     }
@@ -430,9 +735,10 @@ class Stream final {
                         F& subscriber,
                         uint64_t begin_idx,
                         std::chrono::microseconds from_us,
-                        std::function<void()> done_callback)
-        : base_t(std::move(
-              std::make_unique<subscriber_thread_t>(std::move(impl), subscriber, begin_idx, from_us, done_callback))) {}
+                        std::function<void()> done_callback,
+                        bool shared = false)
+        : base_t(std::move(std::make_unique<subscriber_thread_t>(
+              std::move(impl), subscriber, begin_idx, from_us, done_callback, shared))) {}
 
     SubscriberScopeImpl(SubscriberScopeImpl&&) = default;
     SubscriberScopeImpl& operator=(SubscriberScopeImpl&&) = default;
@@ -464,6 +770,33 @@ class Stream final {
     return SubscriberScopeUnchecked<F>(impl_, subscriber, begin_idx, from_us, done_callback);
   }
 
+  // Same as `Subscribe()` and `SubscribeUnchecked()`, except that once the subscriber has caught up with the stream,
+  // its thread is released, and it is served by the shared fan-out dispatcher, which reads each new entry once.
+  // NOTE: The subscribers sharing the thread of the dispatcher are served one after another, so a slow one
+  // delays the others. Use the regular subscriptions for the subscribers doing heavy processing.
+  template <typename TYPE_SUBSCRIBED_TO = entry_t, typename F>
+  SubscriberScope<F, TYPE_SUBSCRIBED_TO> SubscribeShared(
+      F& subscriber,
+      uint64_t begin_idx = 0u,
+      std::chrono::microseconds from_us = std::chrono::microseconds(0),
+      std::function<void()> done_callback = nullptr) const {
+    static_assert(current::ss::IsStreamSubscriber<F, TYPE_SUBSCRIBED_TO>::value, "");
+    return SubscriberScope<F, TYPE_SUBSCRIBED_TO>(impl_, subscriber, begin_idx, from_us, done_callback, true);
+  }
+
+  template <typename F>
+  SubscriberScopeUnchecked<F> SubscribeUncheckedShared(
+      F& subscriber,
+      uint64_t begin_idx = 0u,
+      std::chrono::microseconds from_us = std::chrono::microseconds(0),
+      std::function<void()> done_callback = nullptr) const {
+    return SubscriberScopeUnchecked<F>(impl_, subscriber, begin_idx, from_us, done_callback, true);
+  }
+
+  // Makes the HTTP subscribers of this stream use `SubscribeShared()` and `SubscribeUncheckedShared()`.
+  // Affects the subscriptions started after the call.
+  void SetHTTPSubscriptionsShared(bool shared = true) { impl_->http_subscriptions_shared = shared; }
+
   // Generates a random HTTP subscription.
   static std::string GenerateRandomHTTPSubscriptionID() {
     return current::SHA256("stream_http_subscription_" +
@@ -583,11 +916,16 @@ class Stream final {
         // Note: Called from a locked section of `borrowed_impl->http_subscriptions_mutex`.
         borrowed_impl->http_subscriptions[subscription_id].second = nullptr;
       };
+      // The persisted lines can only be passed through as is if they are already in the requested format.
+      // Otherwise, such as for `?json=minimalistic`, each entry is parsed and serialized again.
+      const bool parse_entries = request_params.checked || !std::is_same_v<J, JSONFormat::Current>;
+      using http_subscriber_t = PubSubHTTPEndpoint<entry_t, PERSISTENCE_LAYER, J>;
+      const bool shared = borrowed_impl->http_subscriptions_shared;
       current::stream::SubscriberScope http_chunked_subscriber_scope =
-          request_params.checked ? static_cast<current::stream::SubscriberScope>(
-                                       Subscribe(*http_chunked_subscriber, begin_idx, from_timestamp, done_callback))
-                                 : static_cast<current::stream::SubscriberScope>(SubscribeUnchecked(
-                                       *http_chunked_subscriber, begin_idx, from_timestamp, done_callback));
+          parse_entries ? static_cast<current::stream::SubscriberScope>(SubscriberScope<http_subscriber_t>(
+                              impl_, *http_chunked_subscriber, begin_idx, from_timestamp, done_callback, shared))
+                        : static_cast<current::stream::SubscriberScope>(SubscriberScopeUnchecked<http_subscriber_t>(
+                              impl_, *http_chunked_subscriber, begin_idx, from_timestamp, done_callback, shared));
 
       {
         std::lock_guard<std::mutex> lock(borrowed_impl->http_subscriptions_mutex);
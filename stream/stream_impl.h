@@ -27,7 +27,10 @@ SOFTWARE.
 
 #include "../port.h"
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
 #include <thread>
 #include <type_traits>
 
@@ -101,6 +104,23 @@ class AbstractSubscriberObject {
   virtual ~AbstractSubscriberObject() = default;
 };
 
+// The dispatcher serving the subscribers which have caught up with the stream from a few shared threads,
+// instead of each of them waiting for the new entries in its own thread. See `Stream::SubscribeShared()`.
+class AbstractFanOutDispatcher {
+ public:
+  virtual ~AbstractFanOutDispatcher() = default;
+};
+
+// Has the persister wake up the subscribers when it writes the published entries in background, if it ever does.
+template <typename PERSISTER, typename F>
+auto SetBackgroundFlushCallbackIfSupported(PERSISTER& persister, F&& callback, int)
+    -> decltype(persister.SetBackgroundFlushCallback(std::forward<F>(callback))) {
+  persister.SetBackgroundFlushCallback(std::forward<F>(callback));
+}
+
+template <typename PERSISTER, typename F>
+void SetBackgroundFlushCallbackIfSupported(PERSISTER&, F&&, long) {}
+
 template <typename ENTRY, template <typename> class PERSISTENCE_LAYER>
 struct StreamImpl {
   using entry_t = ENTRY;
@@ -116,9 +136,21 @@ struct StreamImpl {
       std::unordered_map<std::string, std::pair<SubscriberScope, std::unique_ptr<AbstractSubscriberObject>>>;
   mutable std::mutex http_subscriptions_mutex;
   mutable http_subscriptions_t http_subscriptions;
+  // Whether the HTTP subscribers are served by the shared fan-out dispatcher once they have caught up.
+  std::atomic_bool http_subscriptions_shared{false};
+
+  // Created upon the first shared subscription. Declared last to be destructed first, while the persister is alive.
+  mutable std::mutex fan_out_dispatcher_mutex;
+  mutable std::unique_ptr<AbstractFanOutDispatcher> fan_out_dispatcher;
 
   template <typename... ARGS>
-  StreamImpl(ARGS&&... args) : persister(publishing_mutex, std::forward<ARGS>(args)...) {}
+  StreamImpl(ARGS&&... args) : persister(publishing_mutex, std::forward<ARGS>(args)...) {
+    SetBackgroundFlushCallbackIfSupported(
+        persister, std::function<void()>([this]() { notifier.NotifyAllOfExternalWaitableEvent(); }), 0);
+  }
+
+  // The `notifier` is destructed before the `persister`, so the latter must stop using it first.
+  ~StreamImpl() { SetBackgroundFlushCallbackIfSupported(persister, std::function<void()>(), 0); }
 };
 
 template <typename ENTRY, template <typename> class PERSISTENCE_LAYER>
@@ -142,6 +174,13 @@ class StreamPublisherImpl {
     return result;
   }
 
+  template <current::locks::MutexLockStatus MLS, typename RANGE>
+  Optional<idxts_t> PublisherPublishBatchImpl(RANGE&& entries) {
+    const auto result = data_->persister.template PersisterPublishBatchImpl<MLS>(std::forward<RANGE>(entries));
+    data_->notifier.NotifyAllOfExternalWaitableEvent();
+    return result;
+  }
+
   template <current::locks::MutexLockStatus MLS>
   idxts_t PublisherPublishUnsafeImpl(const std::string& raw_log_line) {
     const auto result = data_->persister.template PersisterPublishUnsafeImpl<MLS>(raw_log_line);
@@ -149,6 +188,12 @@ class StreamPublisherImpl {
     return result;
   }
 
+  template <current::locks::MutexLockStatus MLS>
+  void PublisherFlushImpl() {
+    data_->persister.template PersisterFlushImpl<MLS>();
+    data_->notifier.NotifyAllOfExternalWaitableEvent();
+  }
+
   template <current::locks::MutexLockStatus MLS, typename TIMESTAMP>
   void PublisherUpdateHeadImpl(TIMESTAMP&& timestamp) {
     data_->persister.template PersisterUpdateHeadImpl<MLS>(std::forward<TIMESTAMP>(timestamp));
@@ -70,6 +70,12 @@ CURRENT_STRUCT(RecordWithTimestamp) {
   CURRENT_USE_FIELD_AS_TIMESTAMP(t);
 };
 
+CURRENT_STRUCT(RecordWithOptional) {
+  CURRENT_FIELD(s, std::string);
+  CURRENT_FIELD(o, Optional<int>);
+  CURRENT_CONSTRUCTOR(RecordWithOptional)(std::string s = "") : s(s) {}
+};
+
 CURRENT_STRUCT(AnotherRecord) {
   CURRENT_FIELD(y, int);
   CURRENT_CONSTRUCTOR(AnotherRecord)(int y = 0) : y(y) {}
@@ -494,6 +500,80 @@ using RecordsUncheckedCollector = current::ss::StreamSubscriber<RecordsUnchecked
 
 }  // namespace stream_unittest
 
+TEST(Stream, SharedSubscriptionsAreServedByTheFanOutDispatcher) {
+  current::time::ResetToZero();
+
+  using namespace stream_unittest;
+
+  auto stream = current::stream::Stream<Record>::CreateStream();
+  auto publisher = stream->BorrowPublisher();
+  publisher->Publish(Record(1), std::chrono::microseconds(10));
+  publisher->Publish(Record(2), std::chrono::microseconds(20));
+  publisher->Publish(Record(3), std::chrono::microseconds(30));
+
+  constexpr size_t kSubscribers = 5u;
+  std::vector<std::unique_ptr<Data>> data;
+  std::vector<std::unique_ptr<StreamTestProcessor>> processors;
+  for (size_t i = 0u; i < kSubscribers; ++i) {
+    data.push_back(std::make_unique<Data>());
+    processors.push_back(std::make_unique<StreamTestProcessor>(*data.back(), true));
+  }
+  // The last subscriber is done after the fourth entry, while being served by the dispatcher.
+  processors.back()->SetMax(4u);
+
+  {
+    std::vector<current::stream::SubscriberScope> scopes;
+    for (size_t i = 0u; i < kSubscribers; ++i) {
+      if (i % 2u) {
+        scopes.push_back(stream->SubscribeUncheckedShared(*processors[i]));
+      } else {
+        scopes.push_back(stream->SubscribeShared(*processors[i]));
+      }
+    }
+    for (const auto& d : data) {
+      while (d->seen_ < 3u) {
+        std::this_thread::yield();
+      }
+    }
+
+    publisher->Publish(Record(4), std::chrono::microseconds(40));
+    publisher->Publish(Record(5), std::chrono::microseconds(50));
+    publisher->UpdateHead(std::chrono::microseconds(60));
+    for (size_t i = 0u; i + 1u < kSubscribers; ++i) {
+      while (data[i]->seen_ < 6u) {
+        std::this_thread::yield();
+      }
+      EXPECT_EQ(60, data[i]->head_.count());
+      EXPECT_TRUE(scopes[i]);
+    }
+    while (scopes.back()) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(4u, data.back()->seen_);
+  }
+
+  for (size_t i = 0u; i + 1u < kSubscribers; ++i) {
+    EXPECT_EQ("1,2,3,4,5,TERMINATE", data[i]->results_) << i;
+  }
+  EXPECT_EQ("1,2,3,4", data.back()->results_);
+
+  // HTTP subscribers can be served by the dispatcher too.
+  stream->SetHTTPSubscriptionsShared();
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port));
+  const auto http_scope = http_server.Register("/shared", *stream);
+  std::string body;
+  // With `entries_only`: should the subscriber catch up before `Record(6)` is published, it would otherwise be sent
+  // the head, which is past the last entry since `UpdateHead()`, in between the entries.
+  std::thread http_thread(
+      [&body, port]() { body = HTTP(GET(Printf("http://localhost:%d/shared?i=4&n=3&entries_only", port))).body; });
+  publisher->Publish(Record(6), std::chrono::microseconds(70));
+  publisher->Publish(Record(7), std::chrono::microseconds(80));
+  http_thread.join();
+  EXPECT_EQ("{\"x\":5}\n{\"x\":6}\n{\"x\":7}\n", body);
+}
+
 TEST(Stream, SubscribeToStreamViaHTTP) {
   current::time::ResetToZero();
 
@@ -994,6 +1074,34 @@ const std::string stream_golden_data_chunks[] = {
 };
 // clang-format on
 
+TEST(Stream, PublishBatch) {
+  current::time::ResetToZero();
+
+  using namespace stream_unittest;
+
+  const std::string persistence_file_name = current::FileSystem::JoinPath(FLAGS_stream_test_tmpdir, "data");
+  const auto persistence_file_remover = current::FileSystem::ScopedRmFile(persistence_file_name);
+
+  auto persisted = current::stream::Stream<Record, current::persistence::File>::CreateStream(persistence_file_name);
+
+  // With `max_us` set, each call to mock `Now()` moves the time forward by 1us.
+  current::time::SetNow(std::chrono::microseconds(10), std::chrono::microseconds(1000));
+  const auto last = persisted->Publisher()->PublishBatch(std::vector<Record>({Record(1), Record(2), Record(3)}));
+  ASSERT_TRUE(Exists(last));
+  EXPECT_EQ(2u, Value(last).index);
+
+  Data d;
+  {
+    StreamTestProcessor p(d, false, true);
+    p.SetMax(3u);
+    persisted->Subscribe(p);
+    EXPECT_EQ(3u, d.seen_);
+  }
+  const std::vector<std::string> expected_values{"[0:10,2:12] 1", "[1:11,2:12] 2", "[2:12,2:12] 3"};
+  EXPECT_TRUE(CompareValuesMixedWithTerminate(d.results_, expected_values, StreamTestProcessor::kTerminateStr))
+      << Join(expected_values, ',') << " != " << d.results_;
+}
+
 TEST(Stream, PersistsToFile) {
   current::time::ResetToZero();
 
@@ -1304,6 +1412,41 @@ TEST(Stream, UncheckedVsCheckedSubscription) {
   }
 }
 
+TEST(Stream, HTTPSubscriptionPassesPersistedLinesThrough) {
+  using namespace stream_unittest;
+
+  auto exposed_stream = current::stream::Stream<RecordWithOptional>::CreateStream();
+  {
+    auto publisher = exposed_stream->BorrowPublisher();
+    // Enough entries for the response to span multiple HTTP chunks.
+    for (int i = 0; i < 5000; ++i) {
+      publisher->Publish(RecordWithOptional(Printf("entry %04d", i)), std::chrono::microseconds(i + 1));
+    }
+  }
+
+  auto reserved_port = current::net::ReserveLocalPort();
+  const int port = reserved_port;
+  auto& http_server = HTTP(std::move(reserved_port));
+  const std::string base_url = Printf("http://localhost:%d/exposed", port);
+  const auto scope = http_server.Register("/exposed", *exposed_stream);
+
+  // The persisted lines are returned as is, exactly as they would be after parsing and serializing them back.
+  const auto raw = HTTP(GET(base_url + "?nowait")).body;
+  EXPECT_EQ(HTTP(GET(base_url + "?nowait&checked")).body, raw);
+  EXPECT_EQ(5000u, current::strings::Split(raw, '\n').size());
+  EXPECT_EQ("{\"index\":0,\"us\":1}\t{\"s\":\"entry 0000\",\"o\":null}", raw.substr(0, raw.find('\n')));
+  EXPECT_EQ(HTTP(GET(base_url + "?nowait&array&checked")).body, HTTP(GET(base_url + "?nowait&array")).body);
+  EXPECT_EQ(HTTP(GET(base_url + "?nowait&entries_only&checked")).body,
+            HTTP(GET(base_url + "?nowait&entries_only")).body);
+  EXPECT_EQ("[\n{\"s\":\"entry 0002\",\"o\":null}\n,\n{\"s\":\"entry 0003\",\"o\":null}\n]\n",
+            HTTP(GET(base_url + "?i=2&n=2&array")).body);
+
+  // Other formats are serialized from the parsed entries.
+  const auto minimalistic = HTTP(GET(base_url + "?nowait&json=minimalistic")).body;
+  EXPECT_EQ("{\"index\":0,\"us\":1}\t{\"s\":\"entry 0000\"}", minimalistic.substr(0, minimalistic.find('\n')));
+  EXPECT_EQ(5000u, current::strings::Split(minimalistic, '\n').size());
+}
+
 TEST(Stream, ParseArbitrarilySplitChunks) {
   using namespace stream_unittest;
 
@@ -0,0 +1,269 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Maxim Zhurovich <zhurovich@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+// The compact binary format for Current types.
+//
+// * Unsigned integers, and enums with unsigned underlying types, are written as LEB128 varints.
+// * Signed integers, enums with signed underlying types, and `std::chrono` types are zigzag-encoded varints.
+// * `bool` and `char` are single bytes; `float` and `double` are their little-endian IEEE 754 bytes.
+// * Strings are the varint length followed by the raw bytes.
+// * Containers are the varint number of elements followed by the elements. Maps are key-value pairs.
+// * `Optional`-s are a single 0/1 byte followed by the value if present.
+// * `CURRENT_STRUCT`-s are their fields, the ones of the base struct first, in the order of declaration.
+//   The field names are not written, so the reader must have exactly the same schema as the writer.
+// * `Variant`-s are the 8-byte little-endian `TypeID` of the stored type followed by its value,
+//   or the eight zero bytes for an uninitialized `Variant`.
+//
+// `Binary()` and `ParseBinary()` work with standalone buffers. `SaveIntoBinary()` and `LoadFromBinary()` work with
+// streams, and prefix each object with its varint length, so that multiple objects can follow one another.
+
+#ifndef CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_BINARY_H
+#define CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_BINARY_H
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "exceptions.h"
+
+#include "../serialization.h"
+
+#include "../../struct.h"
+#include "../../optional.h"
+#include "../../helpers.h"
+
+#include "../../../bricks/strings/chunk.h"
+#include "../../../bricks/template/pod.h"  // `current::copy_free`.
+
+namespace current {
+namespace serialization {
+namespace binary {
+
+inline uint64_t ZigZagEncode(int64_t x) { return (static_cast<uint64_t>(x) << 1) ^ static_cast<uint64_t>(x >> 63); }
+inline int64_t ZigZagDecode(uint64_t x) { return static_cast<int64_t>((x >> 1) ^ (~(x & 1) + 1)); }
+
+class BinarySerializer final {
+ public:
+  void WriteByte(uint8_t byte) { buffer_.push_back(static_cast<char>(byte)); }
+
+  void WriteBytes(const void* data, size_t size) { buffer_.append(reinterpret_cast<const char*>(data), size); }
+
+  void WriteVarInt(uint64_t x) {
+    char bytes[10];
+    size_t i = 0u;
+    while (x >= 0x80u) {
+      bytes[i++] = static_cast<char>((x & 0x7fu) | 0x80u);
+      x >>= 7;
+    }
+    bytes[i++] = static_cast<char>(x);
+    buffer_.append(bytes, i);
+  }
+
+  void WriteFixed64(uint64_t x) {
+    char bytes[8];
+    for (size_t i = 0u; i < 8u; ++i) {
+      bytes[i] = static_cast<char>(x & 0xffu);
+      x >>= 8;
+    }
+    buffer_.append(bytes, 8u);
+  }
+
+  const std::string& ResultingBinary() const { return buffer_; }
+  std::string&& MoveResultingBinary() { return std::move(buffer_); }
+
+ private:
+  std::string buffer_;
+};
+
+class BinaryDeserializer final {
+ public:
+  BinaryDeserializer(const char* begin, size_t size) : begin_(begin), current_(begin), end_(begin + size) {}
+
+  size_t Offset() const { return static_cast<size_t>(current_ - begin_); }
+  size_t BytesLeft() const { return static_cast<size_t>(end_ - current_); }
+
+  uint8_t ReadByte() {
+    if (current_ == end_) {
+      CURRENT_THROW(BinaryUnexpectedEndOfInputException(Offset(), 1u));
+    }
+    return static_cast<uint8_t>(*current_++);
+  }
+
+  // Returns the pointer to `size` bytes of the input and skips past them.
+  const char* ReadBytes(size_t size) {
+    if (size > BytesLeft()) {
+      CURRENT_THROW(BinaryUnexpectedEndOfInputException(Offset(), size - BytesLeft()));
+    }
+    const char* result = current_;
+    current_ += size;
+    return result;
+  }
+
+  uint64_t ReadVarInt() {
+    uint64_t result = 0u;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const uint8_t byte = ReadByte();
+      result |= static_cast<uint64_t>(byte & 0x7fu) << shift;
+      if (!(byte & 0x80u)) {
+        return result;
+      }
+    }
+    CURRENT_THROW(BinarySchemaException("varint of at most ten bytes", Offset()));
+  }
+
+  uint64_t ReadFixed64() {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(ReadBytes(8u));
+    uint64_t result = 0u;
+    for (size_t i = 0u; i < 8u; ++i) {
+      result |= static_cast<uint64_t>(bytes[i]) << (8u * i);
+    }
+    return result;
+  }
+
+  // The number of elements in a container. Reserving more than there are bytes left would only be legitimate
+  // for zero-sized elements, which do not benefit from reserving anyway, hence the clamp.
+  size_t ReadSize(size_t* safe_to_reserve = nullptr) {
+    const uint64_t size = ReadVarInt();
+    if (safe_to_reserve) {
+      *safe_to_reserve = static_cast<size_t>(std::min(size, static_cast<uint64_t>(BytesLeft())));
+    }
+    return static_cast<size_t>(size);
+  }
+
+ private:
+  const char* const begin_;
+  const char* current_;
+  const char* const end_;
+};
+
+template <typename T>
+void ParseBinaryImpl(const char* data, size_t size, T& destination) {
+  BinaryDeserializer binary_deserializer(data, size);
+  Deserialize(binary_deserializer, destination);
+  if (binary_deserializer.BytesLeft()) {
+    CURRENT_THROW(BinarySchemaException("end of input", binary_deserializer.Offset()));
+  }
+}
+
+template <typename T>
+inline std::string Binary(const T& source) {
+  BinarySerializer binary_serializer;
+  Serialize(binary_serializer, source);
+  return binary_serializer.MoveResultingBinary();
+}
+
+template <typename T>
+inline void ParseBinary(const char* data, size_t size, T& destination) {
+  try {
+    ParseBinaryImpl(data, size, destination);
+    CheckIntegrity(destination);
+  } catch (UninitializedVariant) {
+    CURRENT_THROW(BinaryUninitializedVariantObjectException());
+  }
+}
+
+template <typename T>
+inline void ParseBinary(const std::string& source, T& destination) {
+  ParseBinary(source.data(), source.length(), destination);
+}
+
+template <typename T>
+inline void ParseBinary(const strings::Chunk& source, T& destination) {
+  ParseBinary(source.c_str(), source.length(), destination);
+}
+
+template <typename T>
+inline T ParseBinary(const std::string& source) {
+  T result;
+  ParseBinary(source, result);
+  return result;
+}
+
+template <typename T>
+inline T ParseBinary(const strings::Chunk& source) {
+  T result;
+  ParseBinary(source, result);
+  return result;
+}
+
+template <typename T>
+inline Optional<T> TryParseBinary(const std::string& source) {
+  try {
+    T result;
+    ParseBinary(source, result);
+    return result;
+  } catch (const TypeSystemParseBinaryException&) {
+    return nullptr;
+  }
+}
+
+template <typename T>
+inline void SaveIntoBinary(std::ostream& os, const T& source) {
+  const std::string payload = Binary(source);
+  BinarySerializer length;
+  length.WriteVarInt(payload.length());
+  os.write(length.ResultingBinary().data(), length.ResultingBinary().length());
+  os.write(payload.data(), payload.length());
+}
+
+template <typename T>
+inline T LoadFromBinary(std::istream& is) {
+  uint64_t length = 0u;
+  for (int shift = 0;; shift += 7) {
+    const int c = is.get();
+    if (c == std::istream::traits_type::eof() || shift >= 64) {
+      CURRENT_THROW(BinaryLoadFromStreamException("Can not read the length of the object."));
+    }
+    length |= static_cast<uint64_t>(c & 0x7f) << shift;
+    if (!(c & 0x80)) {
+      break;
+    }
+  }
+  std::string payload(static_cast<size_t>(length), '\0');
+  if (!is.read(&payload[0], static_cast<std::streamsize>(length))) {
+    CURRENT_THROW(BinaryLoadFromStreamException("Can not read the object of " + current::ToString(length) +
+                                                " byte(s)."));
+  }
+  return ParseBinary<T>(payload);
+}
+
+}  // namespace binary
+}  // namespace serialization
+
+using serialization::binary::Binary;
+using serialization::binary::LoadFromBinary;
+using serialization::binary::ParseBinary;
+using serialization::binary::SaveIntoBinary;
+using serialization::binary::TryParseBinary;
+}  // namespace current
+
+using current::Binary;
+using current::LoadFromBinary;
+using current::ParseBinary;
+using current::SaveIntoBinary;
+using current::TryParseBinary;
+
+#endif  // CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_BINARY_H
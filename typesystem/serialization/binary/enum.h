@@ -0,0 +1,55 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Maxim Zhurovich <zhurovich@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_ENUM_H
+#define CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_ENUM_H
+
+#include <type_traits>
+
+#include "primitives.h"
+
+namespace current {
+namespace serialization {
+
+template <typename T>
+struct SerializeImpl<binary::BinarySerializer, T, std::enable_if_t<std::is_enum_v<T>>> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, const T enum_value) {
+    Serialize(binary_serializer, static_cast<typename std::underlying_type<T>::type>(enum_value));
+  }
+};
+
+template <typename T>
+struct DeserializeImpl<binary::BinaryDeserializer, T, std::enable_if_t<std::is_enum_v<T>>> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, T& destination) {
+    typename std::underlying_type<T>::type value;
+    Deserialize(binary_deserializer, value);
+    destination = static_cast<T>(value);
+  }
+};
+
+}  // namespace serialization
+}  // namespace current
+
+#endif  // CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_ENUM_H
@@ -0,0 +1,68 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Maxim Zhurovich <zhurovich@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_EXCEPTIONS_H
+#define CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_EXCEPTIONS_H
+
+#include "../../../port.h"
+
+#include "../exceptions_base.h"
+
+namespace current {
+namespace serialization {
+namespace binary {
+
+struct TypeSystemParseBinaryException : Exception {
+  using Exception::Exception;
+};
+
+struct BinaryUnexpectedEndOfInputException : TypeSystemParseBinaryException {
+  BinaryUnexpectedEndOfInputException(size_t offset, size_t bytes_needed)
+      : TypeSystemParseBinaryException("Unexpected end of input at offset " + current::ToString(offset) + ", " +
+                                       current::ToString(bytes_needed) + " more byte(s) needed.") {}
+};
+
+struct BinarySchemaException : TypeSystemParseBinaryException {
+  BinarySchemaException(const std::string& expected, size_t offset)
+      : TypeSystemParseBinaryException("Expected " + expected + " at offset " + current::ToString(offset) + ".") {}
+};
+
+struct BinaryUninitializedVariantObjectException : TypeSystemParseBinaryException {};
+
+struct BinaryLoadFromStreamException : TypeSystemParseBinaryException {
+  using TypeSystemParseBinaryException::TypeSystemParseBinaryException;
+};
+
+}  // namespace binary
+}  // namespace serialization
+}  // namespace current
+
+using current::serialization::binary::BinaryLoadFromStreamException;
+using current::serialization::binary::BinarySchemaException;
+using current::serialization::binary::BinaryUnexpectedEndOfInputException;
+using current::serialization::binary::BinaryUninitializedVariantObjectException;
+using current::serialization::binary::TypeSystemParseBinaryException;
+
+#endif  // CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_EXCEPTIONS_H
@@ -0,0 +1,80 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Maxim Zhurovich <zhurovich@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_OPTIONAL_H
+#define CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_OPTIONAL_H
+
+#include "binary.h"
+
+#include "../../optional.h"
+
+namespace current {
+namespace serialization {
+
+template <typename T>
+struct SerializeImpl<binary::BinarySerializer, Optional<T>> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, const Optional<T>& value) {
+    if (Exists(value)) {
+      binary_serializer.WriteByte(1u);
+      Serialize(binary_serializer, Value(value));
+    } else {
+      binary_serializer.WriteByte(0u);
+    }
+  }
+};
+
+// `ImmutableOptional`-s are written the same way. They can be read back as `Optional`-s.
+template <typename T>
+struct SerializeImpl<binary::BinarySerializer, ImmutableOptional<T>> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, const ImmutableOptional<T>& value) {
+    if (Exists(value)) {
+      binary_serializer.WriteByte(1u);
+      Serialize(binary_serializer, Value(value));
+    } else {
+      binary_serializer.WriteByte(0u);
+    }
+  }
+};
+
+template <typename T>
+struct DeserializeImpl<binary::BinaryDeserializer, Optional<T>> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, Optional<T>& destination) {
+    const size_t offset = binary_deserializer.Offset();
+    const uint8_t exists = binary_deserializer.ReadByte();
+    if (exists == 1u) {
+      destination = T();
+      Deserialize(binary_deserializer, Value(destination));
+    } else if (exists == 0u) {
+      destination = nullptr;
+    } else {
+      CURRENT_THROW(BinarySchemaException("optional as 0 or 1", offset));
+    }
+  }
+};
+
+}  // namespace serialization
+}  // namespace current
+
+#endif  // CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_OPTIONAL_H
@@ -0,0 +1,197 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Maxim Zhurovich <zhurovich@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_PRIMITIVES_H
+#define CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_PRIMITIVES_H
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include "binary.h"
+
+namespace current {
+namespace serialization {
+
+namespace binary {
+template <typename T>
+struct IsBinaryVarIntType {
+  constexpr static bool value =
+      std::numeric_limits<T>::is_integer && !std::is_same_v<T, bool> && !std::is_same_v<T, char>;
+};
+
+static_assert(std::numeric_limits<float>::is_iec559 && sizeof(float) == 4u, "");
+static_assert(std::numeric_limits<double>::is_iec559 && sizeof(double) == 8u, "");
+}  // namespace binary
+
+// `uint*_t`.
+template <typename T>
+struct SerializeImpl<binary::BinarySerializer,
+                     T,
+                     std::enable_if_t<binary::IsBinaryVarIntType<T>::value && !std::numeric_limits<T>::is_signed>> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, T value) {
+    binary_serializer.WriteVarInt(static_cast<uint64_t>(value));
+  }
+};
+
+template <typename T>
+struct DeserializeImpl<binary::BinaryDeserializer,
+                       T,
+                       std::enable_if_t<binary::IsBinaryVarIntType<T>::value && !std::numeric_limits<T>::is_signed>> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, T& destination) {
+    const size_t offset = binary_deserializer.Offset();
+    const uint64_t value = binary_deserializer.ReadVarInt();
+    if (value > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+      CURRENT_THROW(BinarySchemaException("unsigned integer of " + current::ToString(sizeof(T)) + " byte(s)", offset));
+    }
+    destination = static_cast<T>(value);
+  }
+};
+
+// `int*_t`.
+template <typename T>
+struct SerializeImpl<binary::BinarySerializer,
+                     T,
+                     std::enable_if_t<binary::IsBinaryVarIntType<T>::value && std::numeric_limits<T>::is_signed>> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, T value) {
+    binary_serializer.WriteVarInt(binary::ZigZagEncode(static_cast<int64_t>(value)));
+  }
+};
+
+template <typename T>
+struct DeserializeImpl<binary::BinaryDeserializer,
+                       T,
+                       std::enable_if_t<binary::IsBinaryVarIntType<T>::value && std::numeric_limits<T>::is_signed>> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, T& destination) {
+    const size_t offset = binary_deserializer.Offset();
+    const int64_t value = binary::ZigZagDecode(binary_deserializer.ReadVarInt());
+    if (value < static_cast<int64_t>(std::numeric_limits<T>::min()) ||
+        value > static_cast<int64_t>(std::numeric_limits<T>::max())) {
+      CURRENT_THROW(BinarySchemaException("integer of " + current::ToString(sizeof(T)) + " byte(s)", offset));
+    }
+    destination = static_cast<T>(value);
+  }
+};
+
+// `bool`.
+template <>
+struct SerializeImpl<binary::BinarySerializer, bool> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, bool value) {
+    binary_serializer.WriteByte(value ? 1u : 0u);
+  }
+};
+
+template <>
+struct DeserializeImpl<binary::BinaryDeserializer, bool> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, bool& destination) {
+    const size_t offset = binary_deserializer.Offset();
+    const uint8_t byte = binary_deserializer.ReadByte();
+    if (byte > 1u) {
+      CURRENT_THROW(BinarySchemaException("bool", offset));
+    }
+    destination = (byte == 1u);
+  }
+};
+
+// `char`.
+template <>
+struct SerializeImpl<binary::BinarySerializer, char> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, char value) {
+    binary_serializer.WriteByte(static_cast<uint8_t>(value));
+  }
+};
+
+template <>
+struct DeserializeImpl<binary::BinaryDeserializer, char> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, char& destination) {
+    destination = static_cast<char>(binary_deserializer.ReadByte());
+  }
+};
+
+// `float` and `double`, via their bit patterns, to keep the values and the byte order exact.
+template <typename T>
+struct SerializeImpl<binary::BinarySerializer, T, std::enable_if_t<std::is_floating_point_v<T>>> {
+  using bits_t = std::conditional_t<sizeof(T) == 4u, uint32_t, uint64_t>;
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, T value) {
+    bits_t bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    for (size_t i = 0u; i < sizeof(T); ++i) {
+      binary_serializer.WriteByte(static_cast<uint8_t>(bits >> (8u * i)));
+    }
+  }
+};
+
+template <typename T>
+struct DeserializeImpl<binary::BinaryDeserializer, T, std::enable_if_t<std::is_floating_point_v<T>>> {
+  using bits_t = std::conditional_t<sizeof(T) == 4u, uint32_t, uint64_t>;
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, T& destination) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(binary_deserializer.ReadBytes(sizeof(T)));
+    bits_t bits = 0u;
+    for (size_t i = 0u; i < sizeof(T); ++i) {
+      bits |= static_cast<bits_t>(bytes[i]) << (8u * i);
+    }
+    std::memcpy(&destination, &bits, sizeof(T));
+  }
+};
+
+// `std::string`.
+template <>
+struct SerializeImpl<binary::BinarySerializer, std::string> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, const std::string& value) {
+    binary_serializer.WriteVarInt(value.length());
+    binary_serializer.WriteBytes(value.data(), value.length());
+  }
+};
+
+template <>
+struct DeserializeImpl<binary::BinaryDeserializer, std::string> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, std::string& destination) {
+    const size_t length = binary_deserializer.ReadSize();
+    destination.assign(binary_deserializer.ReadBytes(length), length);
+  }
+};
+
+// `std::chrono::milliseconds` and `std::chrono::microseconds`.
+template <typename R, typename P>
+struct SerializeImpl<binary::BinarySerializer, std::chrono::duration<R, P>> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, std::chrono::duration<R, P> value) {
+    binary_serializer.WriteVarInt(binary::ZigZagEncode(static_cast<int64_t>(value.count())));
+  }
+};
+
+template <typename R, typename P>
+struct DeserializeImpl<binary::BinaryDeserializer, std::chrono::duration<R, P>> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer,
+                            std::chrono::duration<R, P>& destination) {
+    destination = std::chrono::duration<R, P>(static_cast<R>(binary::ZigZagDecode(binary_deserializer.ReadVarInt())));
+  }
+};
+
+}  // namespace serialization
+}  // namespace current
+
+#endif  // CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_PRIMITIVES_H
@@ -0,0 +1,66 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Maxim Zhurovich <zhurovich@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_TUPLE_H
+#define CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_TUPLE_H
+
+#include <tuple>
+#include <utility>
+
+#include "binary.h"
+
+namespace current {
+namespace serialization {
+
+template <typename... TS>
+struct SerializeImpl<binary::BinarySerializer, std::tuple<TS...>> {
+  template <size_t... IS>
+  static void DoIt(binary::BinarySerializer& binary_serializer,
+                   const std::tuple<TS...>& value,
+                   std::index_sequence<IS...>) {
+    (Serialize(binary_serializer, std::get<IS>(value)), ...);
+  }
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, const std::tuple<TS...>& value) {
+    DoIt(binary_serializer, value, std::index_sequence_for<TS...>());
+  }
+};
+
+template <typename... TS>
+struct DeserializeImpl<binary::BinaryDeserializer, std::tuple<TS...>> {
+  template <size_t... IS>
+  static void DoIt(binary::BinaryDeserializer& binary_deserializer,
+                   std::tuple<TS...>& destination,
+                   std::index_sequence<IS...>) {
+    (Deserialize(binary_deserializer, std::get<IS>(destination)), ...);
+  }
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, std::tuple<TS...>& destination) {
+    DoIt(binary_deserializer, destination, std::index_sequence_for<TS...>());
+  }
+};
+
+}  // namespace serialization
+}  // namespace current
+
+#endif  // CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_TUPLE_H
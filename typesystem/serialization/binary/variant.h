@@ -0,0 +1,138 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Maxim Zhurovich <zhurovich@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_VARIANT_H
+#define CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_VARIANT_H
+
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+
+#include "binary.h"
+
+#include "../../variant.h"
+#include "../../reflection/reflection.h"
+
+#include "../../../bricks/template/call_all_constructors.h"
+
+namespace current {
+namespace serialization {
+
+namespace binary {
+
+// Reflecting the type takes a lock and a lookup, so the `TypeID` of each case is computed once.
+template <typename X>
+uint64_t BinaryVariantCaseTypeID() {
+  static const uint64_t type_id = static_cast<uint64_t>(
+      Value<reflection::ReflectedTypeBase>(reflection::Reflector().ReflectType<X>()).type_id);
+  return type_id;
+}
+
+class BinaryVariantSerializer {
+ public:
+  explicit BinaryVariantSerializer(BinarySerializer& binary_serializer) : binary_serializer_(binary_serializer) {}
+
+  template <typename X>
+  std::enable_if_t<IS_CURRENT_STRUCT_OR_VARIANT(X)> operator()(const X& object) {
+    binary_serializer_.WriteFixed64(BinaryVariantCaseTypeID<X>());
+    Serialize(binary_serializer_, object);
+  }
+
+ private:
+  BinarySerializer& binary_serializer_;
+};
+
+template <typename VARIANT>
+class BinaryVariantDeserializer {
+ public:
+  static const BinaryVariantDeserializer& Instance() {
+    static BinaryVariantDeserializer instance;
+    return instance;
+  }
+
+  void DoLoadVariant(BinaryDeserializer& binary_deserializer, VARIANT& destination) const {
+    const size_t offset = binary_deserializer.Offset();
+    const uint64_t type_id = binary_deserializer.ReadFixed64();
+    if (!type_id) {
+      CURRENT_THROW(BinaryUninitializedVariantObjectException());
+    }
+    const auto cit = deserializers_.find(type_id);
+    if (cit != deserializers_.end()) {
+      cit->second(binary_deserializer, destination);
+    } else {
+      CURRENT_THROW(BinarySchemaException("a type id listed in the type list", offset));
+    }
+  }
+
+ private:
+  using case_deserializer_t = void (*)(BinaryDeserializer&, VARIANT&);
+  using deserializers_map_t = std::unordered_map<uint64_t, case_deserializer_t>;
+
+  template <typename X>
+  struct Registerer {
+    static void DeserializeCase(BinaryDeserializer& binary_deserializer, VARIANT& destination) {
+      auto result = std::make_unique<X>();
+      Deserialize(binary_deserializer, *result);
+      destination.UncheckedMoveFromUniquePtr(std::move(result));
+    }
+    Registerer(deserializers_map_t& deserializers) {
+      // Silently discard duplicate types in the input type list. They would be deserialized correctly.
+      deserializers[BinaryVariantCaseTypeID<X>()] = DeserializeCase;
+    }
+  };
+
+  BinaryVariantDeserializer() {
+    current::metaprogramming::call_all_constructors_with<Registerer, deserializers_map_t, typename VARIANT::typelist_t>(
+        deserializers_);
+  }
+
+  deserializers_map_t deserializers_;
+};
+
+}  // namespace binary
+
+template <typename T>
+struct SerializeImpl<binary::BinarySerializer, T, std::enable_if_t<IS_CURRENT_VARIANT(T)>> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, const T& value) {
+    if (Exists(value)) {
+      binary::BinaryVariantSerializer impl(binary_serializer);
+      value.Call(impl);
+    } else {
+      binary_serializer.WriteFixed64(0u);
+    }
+  }
+};
+
+template <typename T>
+struct DeserializeImpl<binary::BinaryDeserializer, T, std::enable_if_t<IS_CURRENT_VARIANT(T)>> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, T& value) {
+    binary::BinaryVariantDeserializer<T>::Instance().DoLoadVariant(binary_deserializer, value);
+  }
+};
+
+}  // namespace serialization
+}  // namespace current
+
+#endif  // CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_VARIANT_H
@@ -0,0 +1,88 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Maxim Zhurovich <zhurovich@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+
+#ifndef CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_VECTOR_H
+#define CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_VECTOR_H
+
+#include <vector>
+
+#include "binary.h"
+
+namespace current {
+namespace serialization {
+
+template <typename T, typename TA>
+struct SerializeImpl<binary::BinarySerializer, std::vector<T, TA>> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, const std::vector<T, TA>& value) {
+    binary_serializer.WriteVarInt(value.size());
+    for (const auto& element : value) {
+      Serialize(binary_serializer, element);
+    }
+  }
+};
+
+template <typename TA>
+struct SerializeImpl<binary::BinarySerializer, std::vector<bool, TA>> {
+  static void DoSerialize(binary::BinarySerializer& binary_serializer, const std::vector<bool, TA>& value) {
+    binary_serializer.WriteVarInt(value.size());
+    for (const auto&& element : value) {
+      binary_serializer.WriteByte(element ? 1u : 0u);
+    }
+  }
+};
+
+template <typename T, typename TA>
+struct DeserializeImpl<binary::BinaryDeserializer, std::vector<T, TA>> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, std::vector<T, TA>& destination) {
+    size_t safe_to_reserve;
+    const size_t size = binary_deserializer.ReadSize(&safe_to_reserve);
+    destination.clear();
+    destination.reserve(safe_to_reserve);
+    for (size_t i = 0u; i < size; ++i) {
+      destination.emplace_back();
+      Deserialize(binary_deserializer, destination.back());
+    }
+  }
+};
+
+template <typename TA>
+struct DeserializeImpl<binary::BinaryDeserializer, std::vector<bool, TA>> {
+  static void DoDeserialize(binary::BinaryDeserializer& binary_deserializer, std::vector<bool, TA>& destination) {
+    size_t safe_to_reserve;
+    const size_t size = binary_deserializer.ReadSize(&safe_to_reserve);
+    destination.clear();
+    destination.reserve(safe_to_reserve);
+    for (size_t i = 0u; i < size; ++i) {
+      bool tmp;
+      Deserialize(binary_deserializer, tmp);
+      destination.push_back(tmp);
+    }
+  }
+};
+
+}  // namespace serialization
+}  // namespace current
+
+#endif  // CURRENT_TYPE_SYSTEM_SERIALIZATION_BINARY_VECTOR_H
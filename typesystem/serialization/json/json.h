@@ -179,6 +179,91 @@ class JSONStringifier final {
   rapidjson::Document document_;
 };
 
+// For the streaming JSON stringifier, primitive values are passed through a stack-allocated `rapidjson::Value`,
+// the very way `JSONStringifier` assigns them into the DOM, to keep the output byte-identical. No allocations here.
+template <typename T>
+struct JSONStreamingValueWriterImpl {
+  template <class WRITER>
+  static void WriteValue(WRITER& writer, current::copy_free<T> value) {
+    rapidjson::Value(value).Accept(writer);
+  }
+};
+
+// The JSON stringifier that emits the output directly, via a `rapidjson::Writer`, without building the DOM.
+// `JSON()` uses it; `JSONStringifier` is kept for `JSONViaRapidJSONDocument()`.
+//
+// Absent values, such as `Optional`-s or `Variant`-s in the `Minimalistic` format, are skipped within objects.
+// Since their keys precede them, the keys of `CURRENT_STRUCT` fields are only written before the first byte
+// of their respective values. An absent value anywhere else, such as an array element, is written as `null`.
+template <class JSON_FORMAT>
+class JSONStreamingStringifier final {
+ public:
+  JSONStreamingStringifier() : writer_(string_buffer_) {}
+
+  template <typename T>
+  void operator=(T&& x) {
+    WritePendingKey();
+    JSONStreamingValueWriterImpl<current::decay_t<T>>::WriteValue(writer_, std::forward<T>(x));
+  }
+
+  void Null() {
+    WritePendingKey();
+    writer_.Null();
+  }
+
+  void String(const char* s) {
+    WritePendingKey();
+    writer_.String(s);
+  }
+
+  void String(const std::string& s) {
+    WritePendingKey();
+    writer_.String(s.data(), static_cast<rapidjson::SizeType>(s.length()));
+  }
+
+  void StartObject() {
+    WritePendingKey();
+    writer_.StartObject();
+  }
+
+  void EndObject() { writer_.EndObject(); }
+
+  void StartArray() {
+    WritePendingKey();
+    writer_.StartArray();
+  }
+
+  void EndArray() { writer_.EndArray(); }
+
+  void Key(const char* key) { writer_.Key(key); }
+  void Key(const std::string& key) { writer_.Key(key.data(), static_cast<rapidjson::SizeType>(key.length())); }
+
+  // The key of an object member the value of which may turn out absent. Must be followed by exactly one value.
+  void MaybeKey(const char* key) { pending_key_ = key; }
+
+  void MarkAsAbsentValue() {
+    if (pending_key_) {
+      pending_key_ = nullptr;
+    } else {
+      writer_.Null();
+    }
+  }
+
+  std::string ResultingJSON() const { return std::string(string_buffer_.GetString(), string_buffer_.GetSize()); }
+
+ private:
+  void WritePendingKey() {
+    if (pending_key_) {
+      writer_.Key(pending_key_);
+      pending_key_ = nullptr;
+    }
+  }
+
+  rapidjson::StringBuffer string_buffer_;
+  rapidjson::Writer<rapidjson::StringBuffer> writer_;
+  const char* pending_key_ = nullptr;
+};
+
 enum class JSONVariantStyle : int { Current, Simple, NewtonsoftFSharp };
 
 template <JSONVariantStyle>
@@ -331,6 +416,14 @@ void ParseJSONViaRapidJSON(const char* json, T& destination) {
 
 template <class J = JSONFormat::Current, typename T>
 inline std::string JSON(const T& source) {
+  JSONStreamingStringifier<J> json_stringifier;
+  Serialize(json_stringifier, source);
+  return json_stringifier.ResultingJSON();
+}
+
+// Same output as `JSON()`, built via the intermediate `rapidjson::Document`. Slower; kept as the reference.
+template <class J = JSONFormat::Current, typename T>
+inline std::string JSONViaRapidJSONDocument(const T& source) {
   JSONStringifier<J> json_stringifier;
   Serialize(json_stringifier, source);
   return json_stringifier.ResultingJSON();
@@ -429,6 +522,7 @@ using serialization::json::JSON;
 using serialization::json::JSONFormat;
 using serialization::json::JSONSchemaException;
 using serialization::json::JSONUninitializedVariantObjectException;
+using serialization::json::JSONViaRapidJSONDocument;
 using serialization::json::ParseJSON;
 using serialization::json::PatchObjectWithJSON;
 using serialization::json::TryParseJSON;
@@ -440,6 +534,7 @@ using current::JSON;
 using current::JSONFormat;
 using current::JSONSchemaException;
 using current::JSONUninitializedVariantObjectException;
+using current::JSONViaRapidJSONDocument;
 using current::ParseJSON;
 using current::PatchObjectWithJSON;
 using current::TryParseJSON;
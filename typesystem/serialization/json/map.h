@@ -66,6 +66,34 @@ struct SerializeImpl<json::JSONStringifier<JSON_FORMAT>, std::map<std::string, T
   }
 };
 
+template <class JSON_FORMAT, typename TK, typename TV, typename TC, typename TA>
+struct SerializeImpl<json::JSONStreamingStringifier<JSON_FORMAT>, std::map<TK, TV, TC, TA>> {
+  static void DoSerialize(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier,
+                          const std::map<TK, TV, TC, TA>& value) {
+    json_stringifier.StartArray();
+    for (const auto& element : value) {
+      json_stringifier.StartArray();
+      Serialize(json_stringifier, element.first);
+      Serialize(json_stringifier, element.second);
+      json_stringifier.EndArray();
+    }
+    json_stringifier.EndArray();
+  }
+};
+
+template <class JSON_FORMAT, typename TV, typename TC, typename TA>
+struct SerializeImpl<json::JSONStreamingStringifier<JSON_FORMAT>, std::map<std::string, TV, TC, TA>> {
+  static void DoSerialize(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier,
+                          const std::map<std::string, TV, TC, TA>& value) {
+    json_stringifier.StartObject();
+    for (const auto& element : value) {
+      json_stringifier.Key(element.first);
+      Serialize(json_stringifier, element.second);
+    }
+    json_stringifier.EndObject();
+  }
+};
+
 template <class JSON_FORMAT, typename TK, typename TV, typename TC, typename TA, class J>
 struct DeserializeImpl<json::JSONParser<JSON_FORMAT>, std::map<TK, TV, TC, TA>, J> {
   template <typename K = TK>
@@ -84,6 +84,48 @@ struct SerializeImpl<json::JSONStringifier<json::JSONFormat::NewtonsoftFSharp>,
   }
 };
 
+template <class JSON_FORMAT, typename T>
+struct SerializeImpl<json::JSONStreamingStringifier<JSON_FORMAT>, Optional<T>> {
+  static void DoSerialize(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier, const Optional<T>& value) {
+    if (Exists(value)) {
+      Serialize(json_stringifier, Value(value));
+    } else {
+      json_stringifier.Null();
+    }
+  }
+};
+
+template <typename T>
+struct SerializeImpl<json::JSONStreamingStringifier<json::JSONFormat::Minimalistic>, Optional<T>> {
+  static void DoSerialize(json::JSONStreamingStringifier<json::JSONFormat::Minimalistic>& json_stringifier,
+                          const Optional<T>& value) {
+    if (Exists(value)) {
+      Serialize(json_stringifier, Value(value));
+    } else {
+      json_stringifier.MarkAsAbsentValue();
+    }
+  }
+};
+
+template <typename T>
+struct SerializeImpl<json::JSONStreamingStringifier<json::JSONFormat::NewtonsoftFSharp>, Optional<T>> {
+  static void DoSerialize(json::JSONStreamingStringifier<json::JSONFormat::NewtonsoftFSharp>& json_stringifier,
+                          const Optional<T>& value) {
+    if (Exists(value)) {
+      json_stringifier.StartObject();
+      json_stringifier.Key("Case");
+      json_stringifier.String("Some");
+      json_stringifier.Key("Fields");
+      json_stringifier.StartArray();
+      Serialize(json_stringifier, Value(value));
+      json_stringifier.EndArray();
+      json_stringifier.EndObject();
+    } else {
+      json_stringifier.MarkAsAbsentValue();
+    }
+  }
+};
+
 template <class JSON_FORMAT, typename T>
 struct DeserializeImpl<json::JSONParser<JSON_FORMAT>, Optional<T>> {
   static void DoDeserialize(json::JSONParser<JSON_FORMAT>& json_parser, Optional<T>& destination) {
@@ -60,6 +60,30 @@ struct SerializeImpl<json::JSONStringifier<json::JSONFormat::NewtonsoftFSharp>,
   }
 };
 
+template <class JSON_FORMAT, typename TF, typename TS>
+struct SerializeImpl<json::JSONStreamingStringifier<JSON_FORMAT>, std::pair<TF, TS>> {
+  static void DoSerialize(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier,
+                          const std::pair<TF, TS>& value) {
+    json_stringifier.StartArray();
+    Serialize(json_stringifier, value.first);
+    Serialize(json_stringifier, value.second);
+    json_stringifier.EndArray();
+  }
+};
+
+template <typename TF, typename TS>
+struct SerializeImpl<json::JSONStreamingStringifier<json::JSONFormat::NewtonsoftFSharp>, std::pair<TF, TS>> {
+  static void DoSerialize(json::JSONStreamingStringifier<json::JSONFormat::NewtonsoftFSharp>& json_stringifier,
+                          const std::pair<TF, TS>& value) {
+    json_stringifier.StartObject();
+    json_stringifier.Key("Item1");
+    Serialize(json_stringifier, value.first);
+    json_stringifier.Key("Item2");
+    Serialize(json_stringifier, value.second);
+    json_stringifier.EndObject();
+  }
+};
+
 template <class JSON_FORMAT, typename TF, typename TS>
 struct DeserializeImpl<json::JSONParser<JSON_FORMAT>, std::pair<TF, TS>> {
   static void DoDeserialize(json::JSONParser<JSON_FORMAT>& json_parser, std::pair<TF, TS>& destination) {
@@ -56,6 +56,30 @@ struct JSONValueAssignerImpl<std::chrono::milliseconds> {
     destination.SetInt64(value.count());
   }
 };
+
+template <>
+struct JSONStreamingValueWriterImpl<std::string> {
+  template <class WRITER>
+  static void WriteValue(WRITER& writer, const std::string& value) {
+    writer.String(value.data(), static_cast<rapidjson::SizeType>(value.length()));
+  }
+};
+
+template <>
+struct JSONStreamingValueWriterImpl<std::chrono::microseconds> {
+  template <class WRITER>
+  static void WriteValue(WRITER& writer, std::chrono::microseconds value) {
+    writer.Int64(value.count());
+  }
+};
+
+template <>
+struct JSONStreamingValueWriterImpl<std::chrono::milliseconds> {
+  template <class WRITER>
+  static void WriteValue(WRITER& writer, std::chrono::milliseconds value) {
+    writer.Int64(value.count());
+  }
+};
 }  // namespace json
 
 #define CURRENT_DECLARE_PRIMITIVE_TYPE(typeid_index, cpp_type, current_type, fs_type, md_type, typescript_type) \
@@ -65,6 +89,13 @@ struct JSONValueAssignerImpl<std::chrono::milliseconds> {
       json_stringifier = value;                                                                                 \
     }                                                                                                           \
   };                                                                                                            \
+  template <class JSON_FORMAT>                                                                                  \
+  struct SerializeImpl<json::JSONStreamingStringifier<JSON_FORMAT>, cpp_type> {                                 \
+    static void DoSerialize(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier,                      \
+                            copy_free<cpp_type> value) {                                                        \
+      json_stringifier = value;                                                                                 \
+    }                                                                                                           \
+  };                                                                                                            \
   namespace json {                                                                                              \
   template <>                                                                                                   \
   struct IsJSONSerializable<cpp_type> {                                                                         \
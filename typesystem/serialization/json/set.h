@@ -47,6 +47,18 @@ struct SerializeImpl<json::JSONStringifier<JSON_FORMAT>, std::set<T, EQ, ALLOCAT
   }
 };
 
+template <class JSON_FORMAT, typename T, class EQ, class ALLOCATOR>
+struct SerializeImpl<json::JSONStreamingStringifier<JSON_FORMAT>, std::set<T, EQ, ALLOCATOR>> {
+  static void DoSerialize(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier,
+                          const std::set<T, EQ, ALLOCATOR>& value) {
+    json_stringifier.StartArray();
+    for (const auto& element : value) {
+      Serialize(json_stringifier, element);
+    }
+    json_stringifier.EndArray();
+  }
+};
+
 template <class JSON_FORMAT, typename T, class EQ, class ALLOCATOR>
 struct DeserializeImpl<json::JSONParser<JSON_FORMAT>, std::set<T, EQ, ALLOCATOR>> {
   static void DoDeserialize(json::JSONParser<JSON_FORMAT>& json_parser, std::set<T, EQ, ALLOCATOR>& destination) {
@@ -27,6 +27,7 @@ SOFTWARE.
 #define CURRENT_TYPE_SYSTEM_SERIALIZATION_JSON_TUPLE_H
 
 #include <tuple>
+#include <utility>
 
 #include "json.h"
 
@@ -56,6 +57,22 @@ struct SerializeImpl<json::JSONStringifier<JSON_FORMAT>, std::tuple<TS...>> {
   }
 };
 
+template <class JSON_FORMAT, typename... TS>
+struct SerializeImpl<json::JSONStreamingStringifier<JSON_FORMAT>, std::tuple<TS...>> {
+  template <size_t... IS>
+  static void DoIt(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier,
+                   const std::tuple<TS...>& value,
+                   std::index_sequence<IS...>) {
+    (Serialize(json_stringifier, std::get<IS>(value)), ...);
+  }
+  static void DoSerialize(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier,
+                          const std::tuple<TS...>& value) {
+    json_stringifier.StartArray();
+    DoIt(json_stringifier, value, std::index_sequence_for<TS...>());
+    json_stringifier.EndArray();
+  }
+};
+
 template <class JSON_FORMAT, class TUPLE, int I, int N>
 struct DeserializeTupleImpl {
   static void DoIt(json::JSONParser<JSON_FORMAT>& json_parser, TUPLE& destination) {
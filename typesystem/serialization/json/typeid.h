@@ -42,6 +42,13 @@ struct SerializeImpl<json::JSONStringifier<JSON_FORMAT>, reflection::TypeID> {
   }
 };
 
+template <class JSON_FORMAT>
+struct SerializeImpl<json::JSONStreamingStringifier<JSON_FORMAT>, reflection::TypeID> {
+  static void DoSerialize(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier, reflection::TypeID value) {
+    json_stringifier.String("T" + current::ToString(value));
+  }
+};
+
 template <class JSON_FORMAT>
 struct DeserializeImpl<json::JSONParser<JSON_FORMAT>, reflection::TypeID> {
   static void DoDeserialize(json::JSONParser<JSON_FORMAT>& json_parser, reflection::TypeID& destination) {
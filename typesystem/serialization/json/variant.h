@@ -127,6 +127,74 @@ class JSONVariantSerializer<json::JSONVariantStyle::NewtonsoftFSharp, JSON_FORMA
   json::JSONStringifier<JSON_FORMAT>& json_stringifier_;
 };
 
+// Reflecting the type takes a lock and a lookup, so the streaming stringifier computes the `TypeID` once per type.
+template <typename X>
+reflection::TypeID JSONVariantCaseTypeID() {
+  static const reflection::TypeID type_id =
+      Value<reflection::ReflectedTypeBase>(reflection::Reflector().ReflectType<X>()).type_id;
+  return type_id;
+}
+
+template <json::JSONVariantStyle, class JSON_FORMAT>
+class JSONVariantStreamingSerializer;
+
+template <class JSON_FORMAT>
+class JSONVariantStreamingSerializer<json::JSONVariantStyle::Current, JSON_FORMAT> {
+ public:
+  explicit JSONVariantStreamingSerializer(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier)
+      : json_stringifier_(json_stringifier) {}
+
+  template <typename X>
+  std::enable_if_t<IS_CURRENT_STRUCT_OR_VARIANT(X)> operator()(const X& object) {
+    const char* name = reflection::CurrentTypeName<X, reflection::NameFormat::Z>();
+    json_stringifier_.StartObject();
+    json_stringifier_.Key(name);
+    Serialize(json_stringifier_, object);
+    if (json::JSONVariantTypeIDInEmptyKey<JSON_FORMAT>::value) {
+      json_stringifier_.Key("");
+      Serialize(json_stringifier_, JSONVariantCaseTypeID<X>());
+    }
+    if (json::JSONVariantTypeNameInDollarKey<JSON_FORMAT>::value) {
+      json_stringifier_.Key("$");
+      json_stringifier_.String(name);
+    }
+    json_stringifier_.EndObject();
+  }
+
+ private:
+  json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier_;
+};
+
+template <class JSON_FORMAT>
+class JSONVariantStreamingSerializer<json::JSONVariantStyle::Simple, JSON_FORMAT>
+    : public JSONVariantStreamingSerializer<json::JSONVariantStyle::Current, JSON_FORMAT> {
+  using JSONVariantStreamingSerializer<json::JSONVariantStyle::Current, JSON_FORMAT>::JSONVariantStreamingSerializer;
+};
+
+template <class JSON_FORMAT>
+class JSONVariantStreamingSerializer<json::JSONVariantStyle::NewtonsoftFSharp, JSON_FORMAT> {
+ public:
+  explicit JSONVariantStreamingSerializer(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier)
+      : json_stringifier_(json_stringifier) {}
+
+  template <typename X>
+  std::enable_if_t<IS_CURRENT_STRUCT_OR_VARIANT(X)> operator()(const X& object) {
+    json_stringifier_.StartObject();
+    json_stringifier_.Key("Case");
+    json_stringifier_.String(reflection::CurrentTypeName<X, reflection::NameFormat::Z>());
+    if (IS_CURRENT_VARIANT(X) || !IS_EMPTY_CURRENT_STRUCT(X)) {
+      json_stringifier_.Key("Fields");
+      json_stringifier_.StartArray();
+      Serialize(json_stringifier_, object);
+      json_stringifier_.EndArray();
+    }
+    json_stringifier_.EndObject();
+  }
+
+ private:
+  json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier_;
+};
+
 template <class JSON_FORMAT>
 class JSONVariantCaseAbstractBase {
  public:
@@ -416,6 +484,22 @@ struct SerializeImpl<json::JSONStringifier<JSON_FORMAT>, T, std::enable_if_t<IS_
   }
 };
 
+template <class JSON_FORMAT, typename T>
+struct SerializeImpl<json::JSONStreamingStringifier<JSON_FORMAT>, T, std::enable_if_t<IS_CURRENT_VARIANT(T)>> {
+  static void DoSerialize(json::JSONStreamingStringifier<JSON_FORMAT>& json_stringifier, const T& value) {
+    if (Exists(value)) {
+      json::JSONVariantStreamingSerializer<JSON_FORMAT::variant_style, JSON_FORMAT> impl(json_stringifier);
+      value.Call(impl);
+    } else {
+      if (json::JSONVariantStyleUseNulls<JSON_FORMAT::variant_style>::value) {
+        json_stringifier.Null();
+      } else {
+        json_stringifier.MarkAsAbsentValue();
+      }
+    }
+  }
+};
+
 template <class JSON_FORMAT, typename T>
 struct DeserializeImpl<json::JSONParser<JSON_FORMAT>, T, std::enable_if_t<IS_CURRENT_VARIANT(T)>> {
   static void DoDeserialize(json::JSONParser<JSON_FORMAT>& json_parser, T& value) {
@@ -36,6 +36,7 @@ SOFTWARE.
 #include "../schema/schema.h"
 
 #include "../../bricks/file/file.h"
+#include "../../bricks/time/chrono.h"
 
 #include "../../3rdparty/gtest/gtest-main.h"
 
@@ -182,8 +183,6 @@ CURRENT_STRUCT(WithInnerVariant) { CURRENT_FIELD(v, InnerVariant); };
 }  // namespace named_variant
 }  // namespace serialization_test
 
-#if 0
-// TODO(dkorolev): DIMA FIXME binary format.
 TEST(Serialization, Binary) {
   using namespace serialization_test;
 
@@ -254,7 +253,180 @@ TEST(Serialization, Binary) {
     ASSERT_THROW(LoadFromBinary<ComplexSerializable>(is), BinaryLoadFromStreamException);
   }
 }
-#endif
+
+TEST(BinarySerialization, CPPTypes) {
+  EXPECT_EQ(std::string(1, '\x2a'), Binary(static_cast<uint64_t>(42)));
+  EXPECT_EQ(std::string("\xac\x02", 2), Binary(static_cast<uint32_t>(300)));
+  EXPECT_EQ(std::string(1, '\x01'), Binary(static_cast<int32_t>(-1)));
+  EXPECT_EQ(std::string(1, '\x02'), Binary(static_cast<int64_t>(1)));
+  EXPECT_EQ(std::string("\x03" "foo", 4), Binary(std::string("foo")));
+  EXPECT_EQ(std::string(1, '\x01'), Binary(true));
+
+  EXPECT_EQ(42u, ParseBinary<uint64_t>(Binary(static_cast<uint64_t>(42))));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), ParseBinary<uint64_t>(Binary(std::numeric_limits<uint64_t>::max())));
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(), ParseBinary<int64_t>(Binary(std::numeric_limits<int64_t>::min())));
+  EXPECT_EQ(std::numeric_limits<int8_t>::min(), ParseBinary<int8_t>(Binary(std::numeric_limits<int8_t>::min())));
+  EXPECT_EQ('x', ParseBinary<char>(Binary('x')));
+  EXPECT_EQ(0.1f, ParseBinary<float>(Binary(0.1f)));
+  EXPECT_EQ(-1e100, ParseBinary<double>(Binary(-1e100)));
+  EXPECT_EQ(std::string("a\0b", 3), ParseBinary<std::string>(Binary(std::string("a\0b", 3))));
+  EXPECT_EQ(-5ll, ParseBinary<std::chrono::microseconds>(Binary(std::chrono::microseconds(-5))).count());
+  EXPECT_EQ(1000ll, ParseBinary<std::chrono::milliseconds>(Binary(std::chrono::milliseconds(1000))).count());
+
+  {
+    const auto t = std::make_tuple(1, std::string("two"), 3.0);
+    EXPECT_TRUE(t == (ParseBinary<std::tuple<int, std::string, double>>(Binary(t))));
+  }
+  {
+    const std::array<int, 3> a = {{1, -2, 3}};
+    EXPECT_TRUE(a == (ParseBinary<std::array<int, 3>>(Binary(a))));
+  }
+  {
+    const std::vector<bool> v = {true, false, true};
+    EXPECT_TRUE(v == ParseBinary<std::vector<bool>>(Binary(v)));
+  }
+  {
+    const std::unordered_map<std::string, int> m = {{"one", 1}, {"two", 2}};
+    EXPECT_TRUE(m == (ParseBinary<std::unordered_map<std::string, int>>(Binary(m))));
+  }
+  {
+    const std::unordered_set<int> s = {1, 2, 3};
+    EXPECT_TRUE(s == ParseBinary<std::unordered_set<int>>(Binary(s)));
+  }
+}
+
+TEST(BinarySerialization, Structs) {
+  using namespace serialization_test;
+
+  {
+    WithVectorOfPairs with_vector_of_pairs;
+    with_vector_of_pairs.v.emplace_back(-1, "foo");
+    with_vector_of_pairs.v.emplace_back(1, "bar");
+    const auto result = ParseBinary<WithVectorOfPairs>(Binary(with_vector_of_pairs));
+    EXPECT_EQ(JSON(with_vector_of_pairs), JSON(result));
+  }
+  {
+    WithTrivialSet with_trivial_set;
+    with_trivial_set.s.insert("one");
+    with_trivial_set.s.insert("two");
+    const auto result = ParseBinary<WithTrivialSet>(Binary(with_trivial_set));
+    EXPECT_EQ(JSON(with_trivial_set), JSON(result));
+  }
+  {
+    WithNontrivialUnorderedMap with_nontrivial_unordered_map;
+    with_nontrivial_unordered_map.q[Serializable(1, "one", false, Enum::DEFAULT)] = "yes";
+    const auto result = ParseBinary<WithNontrivialUnorderedMap>(Binary(with_nontrivial_unordered_map));
+    ASSERT_EQ(1u, result.q.size());
+    EXPECT_EQ("yes", result.q.at(Serializable(1)));
+    EXPECT_EQ("one", result.q.begin()->first.s);
+  }
+  {
+    WithOptional with_optional;
+    EXPECT_EQ(std::string("\x00\x00", 2), Binary(with_optional));
+    with_optional.i = -3;
+    EXPECT_EQ(std::string("\x01\x05\x00", 3), Binary(with_optional));
+    const auto result = ParseBinary<WithOptional>(Binary(with_optional));
+    ASSERT_TRUE(Exists(result.i));
+    EXPECT_EQ(-3, Value(result.i));
+    EXPECT_FALSE(Exists(result.b));
+  }
+  {
+    WithTime with_time;
+    with_time.number = 7u;
+    with_time.micros = std::chrono::microseconds(1000000);
+    const auto result = ParseBinary<WithTime>(Binary(with_time));
+    EXPECT_EQ(7u, result.number);
+    EXPECT_EQ(1000000ll, result.micros.count());
+  }
+}
+
+TEST(BinarySerialization, Variant) {
+  using namespace serialization_test;
+
+  {
+    ContainsVariant object;
+    object.variant = Serializable(42, "foo", true, Enum::SET);
+    const auto result = ParseBinary<ContainsVariant>(Binary(object));
+    ASSERT_TRUE(Exists<Serializable>(result.variant));
+    EXPECT_EQ(42u, Value<Serializable>(result.variant).i);
+    EXPECT_EQ("foo", Value<Serializable>(result.variant).s);
+    EXPECT_TRUE(Value<Serializable>(result.variant).b);
+    EXPECT_EQ(Enum::SET, Value<Serializable>(result.variant).e);
+  }
+  {
+    ContainsVariant object;
+    object.variant = ComplexSerializable('a', 'c');
+    const auto result = ParseBinary<ContainsVariant>(Binary(object));
+    ASSERT_TRUE(Exists<ComplexSerializable>(result.variant));
+    EXPECT_EQ(3u, Value<ComplexSerializable>(result.variant).v.size());
+    EXPECT_EQ(JSON(object), JSON(result));
+  }
+  {
+    const simple_variant_t empty_variant = AlternativeEmpty();
+    const auto result = ParseBinary<simple_variant_t>(Binary(empty_variant));
+    EXPECT_TRUE(Exists<AlternativeEmpty>(result));
+    EXPECT_FALSE(Exists<Empty>(result));
+  }
+  {
+    // An uninitialized `Variant` can be serialized, but not parsed back.
+    const std::string uninitialized = Binary(ContainsVariant());
+    EXPECT_EQ(std::string(8u, '\0'), uninitialized);
+    EXPECT_THROW(ParseBinary<ContainsVariant>(uninitialized), BinaryUninitializedVariantObjectException);
+  }
+  {
+    // A type outside the type list of the `Variant`.
+    using other_variant_t = Variant<Int, Float>;
+    const std::string other = Binary(other_variant_t(Int()));
+    EXPECT_THROW(ParseBinary<simple_variant_t>(other), BinarySchemaException);
+  }
+}
+
+TEST(BinarySerialization, Errors) {
+  using namespace serialization_test;
+
+  const std::string binary = Binary(Serializable(42, "foo", true, Enum::SET));
+  EXPECT_EQ(42u, ParseBinary<Serializable>(binary).i);
+  for (size_t i = 0u; i < binary.length(); ++i) {
+    EXPECT_THROW(ParseBinary<Serializable>(binary.substr(0u, i)), BinaryUnexpectedEndOfInputException);
+  }
+  EXPECT_THROW(ParseBinary<Serializable>(binary + 'x'), BinarySchemaException);
+  EXPECT_THROW(ParseBinary<uint8_t>(Binary(static_cast<uint16_t>(256))), BinarySchemaException);
+  EXPECT_THROW(ParseBinary<bool>(std::string(1, '\x02')), BinarySchemaException);
+  EXPECT_THROW(ParseBinary<uint64_t>(std::string(11u, '\xff')), BinarySchemaException);
+  EXPECT_FALSE(Exists(TryParseBinary<Serializable>("")));
+  EXPECT_TRUE(Exists(TryParseBinary<Serializable>(binary)));
+}
+
+TEST(BinarySerialization, MoreCompactAndFasterThanJSON) {
+  using namespace serialization_test;
+
+  ComplexSerializable object('a', 'z');
+  object.j = 1000000u;
+  object.q = "The quick brown fox jumps over the lazy dog.";
+  object.z = Serializable(42, "foo", true, Enum::SET);
+
+  const std::string json = JSON(object);
+  const std::string binary = Binary(object);
+  EXPECT_EQ(JSON(object), JSON(ParseBinary<ComplexSerializable>(binary)));
+  EXPECT_LT(binary.length(), json.length());
+
+  // The timings are only printed, not checked, as the test may run on a loaded machine.
+  // See `examples/benchmark/generic --scenario=binary` for the actual benchmark.
+  constexpr size_t N = 10000u;
+  const auto json_begin = current::time::Now();
+  for (size_t i = 0u; i < N; ++i) {
+    ParseJSON<ComplexSerializable>(JSON(object));
+  }
+  const auto json_end = current::time::Now();
+  for (size_t i = 0u; i < N; ++i) {
+    ParseBinary<ComplexSerializable>(Binary(object));
+  }
+  const auto binary_end = current::time::Now();
+  const auto json_us = (json_end - json_begin).count();
+  const auto binary_us = (binary_end - json_end).count();
+  std::cerr << "JSON round trip: " << json_us * 1000 / N << "ns, " << json.length() << " bytes.\n";
+  std::cerr << "Binary round trip: " << binary_us * 1000 / N << "ns, " << binary.length() << " bytes.\n";
+}
 
 TEST(JSONSerialization, CPPTypes) {
   using namespace serialization_test;
@@ -368,8 +540,6 @@ TEST(JSONSerialization, Tuple) {
   }
 }
 
-#if 0
-// TODO(dkorolev): DIMA FIXME binary format.
 TEST(Serialization, OptionalAsBinary) {
   using namespace serialization_test;
 
@@ -412,7 +582,6 @@ TEST(Serialization, OptionalAsBinary) {
     EXPECT_TRUE(Value(parsed_with_b.b));
   }
 }
-#endif
 
 TEST(JSONSerialization, CurrentStructs) {
   using namespace serialization_test;
@@ -881,8 +1050,6 @@ TEST(JSONSerialization, Time) {
   }
 }
 
-#if 0
-// TODO(dkorolev): DIMA FIXME binary format.
 TEST(Serialization, TimeAsBinary) {
   using namespace serialization_test;
 
@@ -890,7 +1057,8 @@ TEST(Serialization, TimeAsBinary) {
     WithTime zero;
     std::ostringstream oss;
     SaveIntoBinary(oss, zero);
-    EXPECT_EQ(16u, oss.str().length());
+    // The length prefix, and the two varint zeroes.
+    EXPECT_EQ(3u, oss.str().length());
   }
 
   {
@@ -905,7 +1073,6 @@ TEST(Serialization, TimeAsBinary) {
     EXPECT_EQ(6ll, parsed.micros.count());
   }
 }
-#endif
 
 TEST(JSONSerialization, Optional) {
   using namespace serialization_test;
@@ -1069,6 +1236,34 @@ TEST(JSONSerialization, Variant) {
   }
 }
 
+TEST(JSONSerialization, InlineVariant) {
+  using namespace serialization_test;
+
+  using inline_variant_t = InlineVariant<Empty, AlternativeEmpty, Serializable, ComplexSerializable>;
+  EXPECT_EQ(current::reflection::CurrentTypeID<simple_variant_t>(),
+            current::reflection::CurrentTypeID<inline_variant_t>());
+
+  ComplexSerializable complex('a', 'c');
+  complex.j = 42u;
+  complex.z = Serializable(1, "one", true, Enum::SET);
+
+  const simple_variant_t heap_object = complex;
+  const inline_variant_t inline_object = complex;
+  EXPECT_EQ(JSON(heap_object), JSON(inline_object));
+  EXPECT_EQ(JSON<JSONFormat::Minimalistic>(heap_object), JSON<JSONFormat::Minimalistic>(inline_object));
+  EXPECT_EQ(JSON<JSONFormat::NewtonsoftFSharp>(heap_object), JSON<JSONFormat::NewtonsoftFSharp>(inline_object));
+
+  const inline_variant_t parsed = ParseJSON<inline_variant_t>(JSON(heap_object));
+  ASSERT_TRUE(Exists<ComplexSerializable>(parsed));
+  EXPECT_EQ(42u, Value<ComplexSerializable>(parsed).j);
+  EXPECT_EQ("one", Value<ComplexSerializable>(parsed).z.s);
+  EXPECT_EQ(JSON(heap_object), JSON(parsed));
+
+  const auto empty = ParseJSON<inline_variant_t, JSONFormat::NewtonsoftFSharp>("{\"Case\":\"Empty\"}");
+  EXPECT_TRUE(Exists<Empty>(empty));
+  EXPECT_FALSE(Exists<AlternativeEmpty>(empty));
+}
+
 TEST(JSONSerialization, NamedVariant) {
   using namespace serialization_test::named_variant;
 
@@ -1254,6 +1449,75 @@ TEST(JSONSerialization, VariantNullOmittedInMinimalisticFormat) {
 
 namespace serialization_test {
 
+CURRENT_STRUCT(StreamingStringifierTestObject) {
+  CURRENT_FIELD(complex, ComplexSerializable);
+  CURRENT_FIELD(derived, DerivedSerializable);
+  CURRENT_FIELD(variant, simple_variant_t);
+  CURRENT_FIELD(variants, std::vector<simple_variant_t>);
+  CURRENT_FIELD(optionals, std::vector<Optional<int32_t>>);
+  CURRENT_FIELD(optional_variant, Optional<simple_variant_t>);
+  CURRENT_FIELD(map, (std::map<std::string, Optional<double>>));
+  CURRENT_FIELD(nontrivial_map, (std::map<Serializable, simple_variant_t>));
+  CURRENT_FIELD(pairs, (std::vector<std::pair<int32_t, Optional<std::string>>>));
+  CURRENT_FIELD(tuple, (std::tuple<int8_t, char, float, std::chrono::milliseconds>));
+  CURRENT_FIELD(flags, std::vector<bool>);
+  CURRENT_FIELD(time, WithTime);
+  CURRENT_FIELD(named, named_variant::WithInnerVariant);
+  CURRENT_FIELD(type_id, current::reflection::TypeID, current::reflection::TypeID::UInt64);
+};
+
+}  // namespace serialization_test
+
+TEST(JSONSerialization, StreamingStringifierMatchesRapidJSONDocument) {
+  using namespace serialization_test;
+
+  const auto check = [](const auto& object) {
+    EXPECT_EQ(JSONViaRapidJSONDocument(object), JSON(object));
+    EXPECT_EQ(JSONViaRapidJSONDocument<JSONFormat::Minimalistic>(object), JSON<JSONFormat::Minimalistic>(object));
+    EXPECT_EQ(JSONViaRapidJSONDocument<JSONFormat::JavaScript>(object), JSON<JSONFormat::JavaScript>(object));
+    EXPECT_EQ(JSONViaRapidJSONDocument<JSONFormat::NewtonsoftFSharp>(object),
+              JSON<JSONFormat::NewtonsoftFSharp>(object));
+  };
+
+  StreamingStringifierTestObject object;
+  check(object);
+
+  object.complex = ComplexSerializable('a', 'e');
+  object.complex.q = "Quotes \", backslashes \\, tabs \t, and the zero byte \0.";
+  object.derived.s = "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82";
+  object.derived.d = -1.5e-300;
+  object.variant = Empty();
+  object.variants.push_back(AlternativeEmpty());
+  object.variants.push_back(simple_variant_t());
+  object.variants.push_back(Serializable(42, "foo", true, Enum::SET));
+  object.optionals.push_back(nullptr);
+  object.optionals.push_back(-1);
+  object.optional_variant = simple_variant_t();
+  object.map["absent"] = nullptr;
+  object.map["present"] = 0.1;
+  object.nontrivial_map[Serializable(1)] = ComplexSerializable('x', 'z');
+  object.nontrivial_map[Serializable(2)] = simple_variant_t();
+  object.pairs.emplace_back(1, nullptr);
+  object.pairs.emplace_back(2, "two");
+  object.tuple = std::make_tuple(static_cast<int8_t>(-128), 'c', 0.25f, std::chrono::milliseconds(-1));
+  object.flags = {true, false};
+  object.time.number = std::numeric_limits<uint64_t>::max();
+  object.time.micros = std::chrono::microseconds(std::numeric_limits<int64_t>::min());
+  object.named.v = WithOptional();
+  check(object);
+
+  object.optional_variant = nullptr;
+  object.named.v = WithVectorOfPairs();
+  check(object);
+
+  check(simple_variant_t());
+  check(Optional<int>());
+  check(std::vector<Optional<simple_variant_t>>(2u));
+  check(std::make_pair(std::string("key"), Optional<Serializable>(Serializable(1))));
+}
+
+namespace serialization_test {
+
 CURRENT_STRUCT_T(TemplatedValue) {
   CURRENT_FIELD(value, T);
   CURRENT_DEFAULT_CONSTRUCTOR_T(TemplatedValue) : value() {}
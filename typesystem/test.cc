@@ -1551,6 +1551,75 @@ TEST(TypeSystemTest, InplaceVariantConstruction) {
   EXPECT_EQ(202u, Value<Bar>(v).j);
 }
 
+TEST(TypeSystemTest, InlineVariant) {
+  using namespace struct_definition_test;
+
+  static_assert(is_same_or_compile_error<InlineVariant<Foo, Bar>::typelist_t, TypeListImpl<Foo, Bar>>::value, "");
+  static_assert(is_same_or_compile_error<InlineVariant<Foo, Bar>, InlineVariant<SlowTypeList<Foo, Bar, Foo>>>::value,
+                "");
+  using foo_bar_t = InlineVariant<Foo, Bar>;
+  static_assert(IS_CURRENT_VARIANT(foo_bar_t), "");
+  static_assert(sizeof(foo_bar_t) <= sizeof(void*) + sizeof(Foo) + sizeof(uint64_t), "");
+  static_assert(std::is_nothrow_move_constructible_v<foo_bar_t>, "");
+  static_assert(std::is_nothrow_move_assignable_v<foo_bar_t>, "");
+
+  InlineVariant<Foo, Bar, DerivedFromFoo> v;
+  EXPECT_FALSE(Exists(v));
+  EXPECT_FALSE(Exists<Foo>(v));
+  using uninitialized_t = UninitializedVariantOfTypeException<Foo, Bar, DerivedFromFoo>;
+  ASSERT_THROW(v.Call([](const auto&) {}), uninitialized_t);
+
+  v = Foo(1u);
+  EXPECT_TRUE(Exists(v));
+  EXPECT_TRUE(Exists<Foo>(v));
+  EXPECT_FALSE(Exists<Bar>(v));
+  EXPECT_EQ(1u, Value<Foo>(v).i);
+  ASSERT_THROW(Value<Bar>(v), NoValueOfTypeException<Bar>);
+
+  struct Visitor {
+    std::string s;
+    void operator()(const Foo& foo) { s = "Foo " + current::ToString(foo.i); }
+    void operator()(const Bar& bar) { s = "Bar " + current::ToString(bar.j); }
+    void operator()(const DerivedFromFoo& derived) { s = "DerivedFromFoo " + current::ToString(derived.i); }
+  };
+  Visitor visitor;
+  v.Call(visitor);
+  EXPECT_EQ("Foo 1", visitor.s);
+
+  // Same-type assignment, including from the value held by this very variant.
+  v = Value<Foo>(v);
+  Value<Foo>(v).i = 2u;
+  v.Call(visitor);
+  EXPECT_EQ("Foo 2", visitor.s);
+
+  // Copy, move, and in-place construction.
+  InlineVariant<Foo, Bar, DerivedFromFoo> copy(v);
+  Value<Foo>(v).i = 3u;
+  EXPECT_EQ(2u, Value<Foo>(copy).i);
+  InlineVariant<Foo, Bar, DerivedFromFoo> moved(std::move(v));
+  EXPECT_FALSE(Exists(v));
+  EXPECT_EQ(3u, Value<Foo>(moved).i);
+  moved.template Construct<Bar>(4u);
+  static_cast<const InlineVariant<Foo, Bar, DerivedFromFoo>&>(moved).Call(visitor);
+  EXPECT_EQ("Bar 4", visitor.s);
+  copy = moved;
+  EXPECT_TRUE(Exists<Bar>(copy));
+  EXPECT_EQ(4u, Value<Bar>(copy).j);
+  EXPECT_TRUE((Exists<InlineVariant<Foo, Bar, DerivedFromFoo>>(copy)));
+
+  // A derived type is dispatched as itself, but is also accessible as its base, as with `Variant<>`.
+  copy = DerivedFromFoo(1u);
+  copy.Call(visitor);
+  EXPECT_EQ("DerivedFromFoo 1001", visitor.s);
+  EXPECT_TRUE(Exists<DerivedFromFoo>(copy));
+  EXPECT_TRUE(Exists<Foo>(copy));
+  EXPECT_FALSE(Exists<Bar>(copy));
+  EXPECT_EQ(1001u, Value<Foo>(copy).i);
+
+  copy = nullptr;
+  EXPECT_FALSE(Exists(copy));
+}
+
 namespace struct_definition_test {
 
 CURRENT_STRUCT(DoesNotSupportPatch) { CURRENT_FIELD(x, int32_t, 0); };
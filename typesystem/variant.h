@@ -34,7 +34,10 @@ SOFTWARE.
 
 #include "../port.h"  // `make_unique`.
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <new>
 #include <type_traits>
 
 #ifdef VARIANT_CHECKS_AT_RUNTIME_INSTEAD_OF_COMPILE_TIME
@@ -361,6 +364,284 @@ struct VariantImpl<NAME, TypeListImpl<TYPES...>> : IHasUncheckedMoveFromUniquePt
   std::unique_ptr<current::variant::object_base_t> object_;
 };
 
+// `InlineVariantImpl<>` is the allocation-free counterpart of `VariantImpl<>`.
+// The object is kept in place, in an aligned buffer large enough for any of `TYPES...`, next to a one-byte case index.
+// `Call()`, copy, move, and destruction dispatch through per-type static tables of function pointers, indexed by
+// that case index, instead of `RTTIDynamicCall<>` and `dynamic_cast<>`.
+//
+// The API mirrors `VariantImpl<>`: `Call()`, `Exists<T>()`, `Value<T>()`, `Construct<T>()`, and JSON and binary
+// serialization all work the same way, and the wire format, as well as the reflected schema, are identical.
+// The trade-off is size: each instance is as large as the largest of its cases, so it pays off for variants of
+// small, frequently created or copied objects, such as events and messages in hot paths.
+namespace variant {
+
+// The zero-based index of `T` in `TS...`, or `sizeof...(TS)` if `T` is not one of them.
+template <typename T, typename... TS>
+constexpr size_t IndexInTypes() {
+  constexpr bool matches[] = {std::is_same_v<T, TS>...};
+  for (size_t i = 0u; i < sizeof...(TS); ++i) {
+    if (matches[i]) {
+      return i;
+    }
+  }
+  return sizeof...(TS);
+}
+
+// Whether any of `TS...` is a type derived from `T`, which calls for a `dynamic_cast<>` to look for a `T`.
+template <typename T, typename... TS>
+constexpr bool HasCaseDerivedFrom() {
+  return (... || (std::is_base_of_v<T, TS> && !std::is_same_v<T, TS>));
+}
+
+}  // namespace variant
+
+template <typename NAME, typename TYPE_LIST>
+struct InlineVariantImpl;
+
+template <typename NAME, typename... TYPES>
+struct InlineVariantImpl<NAME, TypeListImpl<TYPES...>> : IHasUncheckedMoveFromUniquePtr {
+  using typelist_t = TypeListImpl<TYPES...>;
+
+  static constexpr size_t typelist_size = typelist_t::size;
+  static_assert(typelist_size < 255u, "`InlineVariant<>` keeps its case index in a single byte.");
+
+  // So that the containers of inline variants, such as `std::vector<>`, move them on reallocation, not copy them.
+  static constexpr bool is_nothrow_movable = (std::is_nothrow_move_constructible_v<TYPES> && ...);
+
+  InlineVariantImpl() {}
+
+  InlineVariantImpl(const InlineVariantImpl& rhs) { CopyFrom(rhs); }
+  InlineVariantImpl(InlineVariantImpl&& rhs) noexcept(is_nothrow_movable) { MoveFrom(rhs); }
+
+  template <typename X,
+            class ENABLE = std::enable_if_t<TypeListContains<typelist_t, current::decay_t<X>>::value &&
+                                            !std::is_same_v<current::decay_t<X>, InlineVariantImpl>>>
+  InlineVariantImpl(X&& input) {
+    Emplace<current::decay_t<X>>(std::forward<X>(input));
+  }
+
+  ~InlineVariantImpl() { Reset(); }
+
+  void operator=(std::nullptr_t) { Reset(); }
+
+  InlineVariantImpl& operator=(const InlineVariantImpl& rhs) {
+    if (&rhs != this) {
+      Reset();
+      CopyFrom(rhs);
+    }
+    return *this;
+  }
+
+  InlineVariantImpl& operator=(InlineVariantImpl&& rhs) noexcept(is_nothrow_movable) {
+    if (&rhs != this) {
+      Reset();
+      MoveFrom(rhs);
+    }
+    return *this;
+  }
+
+  // If the variant already holds an object of this very type, it is assigned to, which also makes
+  // `v = Value<T>(v)` safe. Otherwise the held object, if any, is destroyed first.
+  template <typename X, class ENABLE = std::enable_if_t<TypeListContains<typelist_t, current::decay_t<X>>::value>>
+  InlineVariantImpl& operator=(X&& input) {
+    using decayed_t = current::decay_t<X>;
+    if (index_ == CaseIndex<decayed_t>()) {
+      *Ptr<decayed_t>() = std::forward<X>(input);
+    } else {
+      Reset();
+      Emplace<decayed_t>(std::forward<X>(input));
+    }
+    return *this;
+  }
+
+  // Used by deserializers, which build the object on the heap. It is moved into the inline storage right away.
+  void UncheckedMoveFromUniquePtr(std::unique_ptr<current::variant::object_base_t> input) override {
+    Reset();
+    if (input) {
+      current::metaprogramming::RTTIDynamicCall<typelist_t>(*input, TypeAwareEmplace(*this));
+    }
+  }
+
+  template <typename T, typename... ARGS, class ENABLE = std::enable_if_t<TypeListContains<typelist_t, T>::value>>
+  T& Construct(ARGS&&... args) {
+    Reset();
+    return Emplace<T>(std::forward<ARGS>(args)...);
+  }
+
+  operator bool() const { return index_ != 0u; }
+
+  template <typename F>
+  void Call(F&& f) {
+    static constexpr void (*const handlers[])(void*, F&&) = {&CallCase<TYPES, F>...};
+    if (index_) {
+      handlers[index_ - 1u](&storage_, std::forward<F>(f));
+    } else {
+      CURRENT_THROW(UninitializedVariantOfTypeException<TYPES...>());
+    }
+  }
+
+  template <typename F>
+  void Call(F&& f) const {
+    static constexpr void (*const handlers[])(const void*, F&&) = {&ConstCallCase<TYPES, F>...};
+    if (index_) {
+      handlers[index_ - 1u](&storage_, std::forward<F>(f));
+    } else {
+      CURRENT_THROW(UninitializedVariantOfTypeException<TYPES...>());
+    }
+  }
+
+  // `VariantExistsImpl<T>()` and `VariantValueImpl<T>()` start with a single comparison of the case index.
+  // Only if some type from `typelist_t` is derived from `T` do they fall back to `dynamic_cast<>`, so that,
+  // same as with `VariantImpl<>`, a derived type can still be retrieved as its base one.
+
+  bool ExistsImpl() const { return index_ != 0u; }
+
+  template <typename X>
+  std::enable_if_t<!std::is_same_v<X, current::variant::object_base_t>, bool> VariantExistsImpl() const {
+    return Find<X>() != nullptr;
+  }
+
+  template <typename X>
+  std::enable_if_t<!std::is_same_v<X, current::variant::object_base_t>, X&> VariantValueImpl() {
+    X* ptr = const_cast<X*>(Find<X>());
+    if (ptr) {
+      return *ptr;
+    } else {
+      CURRENT_THROW(NoValueOfTypeException<X>());
+    }
+  }
+
+  template <typename X>
+  std::enable_if_t<!std::is_same_v<X, InlineVariantImpl>, const X&> VariantValueImpl() const {
+    const X* ptr = Find<X>();
+    if (ptr) {
+      return *ptr;
+    } else {
+      CURRENT_THROW(NoValueOfTypeException<X>());
+    }
+  }
+
+  template <typename X>
+  std::enable_if_t<std::is_same_v<X, InlineVariantImpl>, const InlineVariantImpl&> VariantValueImpl() const {
+    if (ExistsImpl()) {
+      return *this;
+    } else {
+      CURRENT_THROW(NoValueOfTypeException<InlineVariantImpl>());
+    }
+  }
+
+ private:
+  struct TypeAwareEmplace {
+    InlineVariantImpl& self;
+    explicit TypeAwareEmplace(InlineVariantImpl& self) : self(self) {}
+    template <typename U>
+    void operator()(U& instance) {
+      self.template Emplace<current::decay_t<U>>(std::move(instance));
+    }
+  };
+
+  template <typename T>
+  static constexpr uint8_t CaseIndex() {
+    return static_cast<uint8_t>(variant::IndexInTypes<T, TYPES...>() + 1u);
+  }
+
+  template <typename T>
+  T* Ptr() {
+    return std::launder(reinterpret_cast<T*>(&storage_));
+  }
+
+  template <typename T>
+  const T* Ptr() const {
+    return std::launder(reinterpret_cast<const T*>(&storage_));
+  }
+
+  template <typename X>
+  const X* Find() const {
+    return index_ == CaseIndex<X>() ? Ptr<X>() : FindAsBase<X>();
+  }
+
+  template <typename X>
+  std::enable_if_t<variant::HasCaseDerivedFrom<X, TYPES...>(), const X*> FindAsBase() const {
+    static constexpr const current::variant::object_base_t* (*const upcasts[])(const void*) = {&UpcastCase<TYPES>...};
+    return index_ ? dynamic_cast<const X*>(upcasts[index_ - 1u](&storage_)) : nullptr;
+  }
+
+  template <typename X>
+  std::enable_if_t<!variant::HasCaseDerivedFrom<X, TYPES...>(), const X*> FindAsBase() const {
+    return nullptr;
+  }
+
+  // The caller must ensure the storage is empty.
+  template <typename T, typename... ARGS>
+  T& Emplace(ARGS&&... args) {
+    T* result = new (&storage_) T(std::forward<ARGS>(args)...);
+    index_ = CaseIndex<T>();
+    return *result;
+  }
+
+  void Reset() {
+    static constexpr void (*const destructors[])(void*) = {&DestroyCase<TYPES>...};
+    if (index_) {
+      const uint8_t index = index_;
+      index_ = 0u;
+      destructors[index - 1u](&storage_);
+    }
+  }
+
+  // The caller must ensure the storage is empty.
+  void CopyFrom(const InlineVariantImpl& rhs) {
+    static constexpr void (*const cloners[])(void*, const void*) = {&CopyCase<TYPES>...};
+    if (rhs.index_) {
+      cloners[rhs.index_ - 1u](&storage_, &rhs.storage_);
+      index_ = rhs.index_;
+    }
+  }
+
+  // The caller must ensure the storage is empty. Same as with `VariantImpl<>`, the source is left empty.
+  void MoveFrom(InlineVariantImpl& rhs) noexcept(is_nothrow_movable) {
+    static constexpr void (*const movers[])(void*, void*) = {&MoveCase<TYPES>...};
+    if (rhs.index_) {
+      movers[rhs.index_ - 1u](&storage_, &rhs.storage_);
+      index_ = rhs.index_;
+      rhs.Reset();
+    }
+  }
+
+  template <typename T, typename F>
+  static void CallCase(void* p, F&& f) {
+    f(*std::launder(reinterpret_cast<T*>(p)));
+  }
+
+  template <typename T, typename F>
+  static void ConstCallCase(const void* p, F&& f) {
+    f(*std::launder(reinterpret_cast<const T*>(p)));
+  }
+
+  template <typename T>
+  static const current::variant::object_base_t* UpcastCase(const void* p) {
+    return std::launder(reinterpret_cast<const T*>(p));
+  }
+
+  template <typename T>
+  static void DestroyCase(void* p) {
+    std::launder(reinterpret_cast<T*>(p))->~T();
+  }
+
+  template <typename T>
+  static void CopyCase(void* into, const void* from) {
+    new (into) T(*std::launder(reinterpret_cast<const T*>(from)));
+  }
+
+  template <typename T>
+  static void MoveCase(void* into, void* from) {
+    new (into) T(std::move(*std::launder(reinterpret_cast<T*>(from))));
+  }
+
+ private:
+  alignas(TYPES...) unsigned char storage_[std::max({sizeof(TYPES)...})];
+  uint8_t index_ = 0u;
+};
+
 // `Variant<...>` can accept either a list of types, or a `TypeList<...>`.
 template <class NAME, typename T, typename... TS>
 struct VariantSelector {
@@ -377,6 +658,11 @@ struct VariantSelector<NAME, TypeListImpl<T, TS...>> {
 template <typename... TS>
 using Variant = typename VariantSelector<reflection::CurrentVariantDefaultName, TS...>::type;
 
+template <typename... TS>
+using InlineVariant =
+    InlineVariantImpl<reflection::CurrentVariantDefaultName,
+                      typename VariantSelector<reflection::CurrentVariantDefaultName, TS...>::typelist_t>;
+
 template <class NAME, class TYPELIST>
 struct NamedVariantTypeSelector {
   using type = VariantImpl<NAME, TYPELIST>;
@@ -392,6 +678,7 @@ using NamedVariant = typename NamedVariantTypeSelector<NAME, TypeListImpl<TS...>
 
 }  // namespace current
 
+using current::InlineVariant;
 using current::Variant;
 
 #define CURRENT_VARIANT(name, ...)                           \